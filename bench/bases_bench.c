@@ -0,0 +1,127 @@
+/** @file
+ * Pomiar operacji na zbiorze baz przekierowań przy bardzo wielu bazach:
+ * tworzenia baz, przełączania się między nimi (jak operator NEW dla
+ * istniejącej bazy), wyszukiwania nieistniejących identyfikatorów,
+ * usuwania połowy baz i zwalniania całego zbioru. Program korzysta tylko
+ * z interfejsu phone_bases_system.h, więc można go zbudować także ze
+ * starszymi wersjami i porównać wyniki.
+ *
+ * Użycie: bases_bench [liczba baz] [liczba przełączeń]
+ * (domyślnie 100000 baz i 1000000 przełączeń).
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "phone_bases_system.h"
+#include "bench_utils.h"
+
+/**
+ * @brief Domyślna liczba baz.
+ */
+#define BENCH_DEFAULT_BASES 100000
+
+/**
+ * @brief Domyślna liczba przełączeń.
+ */
+#define BENCH_DEFAULT_SWITCHES 1000000
+
+/**
+ * @brief Rozmiar bufora na identyfikator bazy.
+ */
+#define BENCH_ID_SIZE 32
+
+/**
+ * @brief Tworzy identyfikator bazy o danym numerze.
+ * @param[out] buf - bufor o rozmiarze BENCH_ID_SIZE.
+ * @param[in] index - numer bazy.
+ * @param[in] missing - czy identyfikator ma nie należeć do żadnej bazy.
+ */
+static void benchId(char *buf, size_t index, bool missing) {
+    snprintf(buf, BENCH_ID_SIZE, "%s%zu", missing ? "missing" : "tenant",
+             index);
+}
+
+/**
+ * @brief Wypisuje wynik pomiaru.
+ * @param[in] name - nazwa operacji.
+ * @param[in] count - liczba operacji.
+ * @param[in] time - czas w sekundach.
+ */
+static void benchReport(const char *name, size_t count, double time) {
+    printf("%-28s %8zu: %8.3f s, %8.0f ns/operację\n", name, count, time,
+           count == 0 ? 0 : time * 1e9 / (double) count);
+}
+
+/**
+ * @brief Funkcja main programu mierzącego operacje na zbiorze baz.
+ * @param[in] argc - liczba argumentów.
+ * @param[in] argv - argumenty.
+ * @return 0 w przypadku sukcesu, 1 w przypadku błędu.
+ */
+int main(int argc, char *argv[]) {
+    size_t bases = BENCH_DEFAULT_BASES, switches = BENCH_DEFAULT_SWITCHES;
+    if (argc > 3
+        || (argc > 1 && !benchParseCount(argv[1], &bases))
+        || (argc > 2 && !benchParseCount(argv[2], &switches))) {
+        fprintf(stderr, "Użycie: %s [bazy] [przełączenia]\n", argv[0]);
+        return 1;
+    }
+
+    PhoneBases pb = phoneBasesCreateNewPhoneBases();
+    if (pb == NULL) {
+        fprintf(stderr, "Brak pamięci\n");
+        return 1;
+    }
+
+    char id[BENCH_ID_SIZE];
+    int result = 0;
+    size_t i, found = 0, deleted = 0;
+    double start = benchNow();
+    for (i = 0; i < bases && result == 0; i++) {
+        benchId(id, i, false);
+        if (phoneBasesAddBase(pb, id) == NULL) {
+            result = 1;
+        }
+    }
+    benchReport("phoneBasesAddBase", bases, benchNow() - start);
+
+    start = benchNow();
+    for (i = 0; i < switches && result == 0; i++) {
+        benchId(id, benchRandom() % bases, false);
+        found += phoneBasesGetBase(pb, id) != NULL ? 1 : 0;
+    }
+    benchReport("phoneBasesGetBase (jest)", switches, benchNow() - start);
+
+    start = benchNow();
+    for (i = 0; i < switches && result == 0; i++) {
+        benchId(id, benchRandom() % bases, true);
+        found += phoneBasesGetBase(pb, id) != NULL ? 1 : 0;
+    }
+    benchReport("phoneBasesGetBase (brak)", switches, benchNow() - start);
+
+    start = benchNow();
+    for (i = 0; i < bases && result == 0; i += 2) {
+        benchId(id, i, false);
+        deleted += phoneBasesDelBase(pb, id) ? 1 : 0;
+    }
+    benchReport("phoneBasesDelBase", (bases + 1) / 2, benchNow() - start);
+
+    if (result != 0) {
+        fprintf(stderr, "Brak pamięci\n");
+    } else if (found != switches || deleted != (bases + 1) / 2
+               || phoneBasesHowManyBases(pb) != bases / 2) {
+        fprintf(stderr, "Niepoprawny stan zbioru baz\n");
+        result = 1;
+    }
+
+    start = benchNow();
+    phoneBasesDestroyPhoneBases(pb);
+    benchReport("phoneBasesDestroyPhoneBases", bases / 2, benchNow() - start);
+    return result;
+}
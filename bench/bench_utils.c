@@ -0,0 +1,62 @@
+/** @file
+ * Implementacja funkcji pomocniczych programów mierzących czas.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <time.h>
+#include "bench_utils.h"
+
+/**
+ * @brief Stan generatora liczb pseudolosowych.
+ */
+static uint64_t benchSeed = 88172645463325252ULL;
+
+uint64_t benchRandom(void) {
+    benchSeed ^= benchSeed << 13;
+    benchSeed ^= benchSeed >> 7;
+    benchSeed ^= benchSeed << 17;
+    return benchSeed;
+}
+
+void benchRandomNumber(char *buf, size_t length) {
+    size_t i;
+    for (i = 0; i < length; i++) {
+        buf[i] = (char) ('0' + benchRandom() % 10);
+    }
+    buf[length] = '\0';
+}
+
+size_t benchRandomLength(size_t minLength, size_t maxLength) {
+    return minLength + benchRandom() % (maxLength - minLength + 1);
+}
+
+double benchNow(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec + (double) time.tv_nsec * 1e-9;
+}
+
+bool benchParseCount(const char *arg, size_t *result) {
+    char *end;
+    unsigned long long value = strtoull(arg, &end, 10);
+    if (*arg == '\0' || *end != '\0' || value == 0 || value > SIZE_MAX) {
+        return false;
+    }
+    *result = (size_t) value;
+    return true;
+}
+
+size_t benchPeakMemory(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0 || usage.ru_maxrss < 0) {
+        return 0;
+    }
+    return (size_t) usage.ru_maxrss / 1024;
+}
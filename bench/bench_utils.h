@@ -0,0 +1,61 @@
+/** @file
+ * Interfejs funkcji pomocniczych programów mierzących czas.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#ifndef TELEFONY_BENCH_UTILS_H
+#define TELEFONY_BENCH_UTILS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Losuje kolejną liczbę (xorshift64).
+ * Generator ma stały zarodek, więc każde uruchomienie programu mierzy te
+ * same dane.
+ * @return Liczba pseudolosowa.
+ */
+uint64_t benchRandom(void);
+
+/**
+ * @brief Losuje numer złożony z cyfr od 0 do 9.
+ * @param[out] buf - bufor na co najmniej @p length + 1 znaków.
+ * @param[in] length - długość numeru.
+ */
+void benchRandomNumber(char *buf, size_t length);
+
+/**
+ * @brief Losuje długość numeru.
+ * @param[in] minLength - najmniejsza długość.
+ * @param[in] maxLength - największa długość (nie mniejsza niż
+ *            @p minLength).
+ * @return Długość z przedziału [@p minLength, @p maxLength].
+ */
+size_t benchRandomLength(size_t minLength, size_t maxLength);
+
+/**
+ * @brief Podaje bieżący czas.
+ * @return Czas w sekundach.
+ */
+double benchNow(void);
+
+/**
+ * @brief Wczytuje dodatnią liczbę z argumentu programu.
+ * @param[in] arg - argument programu.
+ * @param[out] result - wczytana liczba.
+ * @return true jeżeli @p arg jest dodatnią liczbą, false w przeciwnym
+ *         przypadku.
+ */
+bool benchParseCount(const char *arg, size_t *result);
+
+/**
+ * @brief Podaje największe dotychczasowe zużycie pamięci przez proces.
+ * @return Rozmiar w megabajtach, 0 jeżeli nie udało się go odczytać.
+ */
+size_t benchPeakMemory(void);
+
+#endif //TELEFONY_BENCH_UTILS_H
@@ -0,0 +1,231 @@
+/** @file
+ * Pomiar czasu dodawania wielu przekierowań do pustej struktury przez
+ * kolejne wywołania phfwdAdd, przez phfwdBulkLoad i przez
+ * phfwdBulkLoadParallel.
+ *
+ * Użycie: bulk_bench [liczba przekierowań] [liczba wątków]
+ * (domyślnie 1000000 przekierowań z prefiksów 5-12-cyfrowych na 3-10-cyfrowe
+ * i tyle wątków, ile jest dostępnych procesorów).
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "phone_forward.h"
+#include "bench_utils.h"
+
+/**
+ * @brief Domyślna liczba przekierowań.
+ */
+#define BENCH_DEFAULT_RULES 1000000
+
+/**
+ * @brief Najmniejsza długość prefiksów przekierowywanych.
+ */
+#define BENCH_MIN_SOURCE 5
+
+/**
+ * @brief Największa długość prefiksów przekierowywanych.
+ */
+#define BENCH_MAX_SOURCE 12
+
+/**
+ * @brief Najmniejsza długość prefiksów, na które są przekierowania.
+ */
+#define BENCH_MIN_TARGET 3
+
+/**
+ * @brief Największa długość prefiksów, na które są przekierowania.
+ */
+#define BENCH_MAX_TARGET 10
+
+/**
+ * @brief Miejsce zajmowane przez jeden numer w tablicy numerów.
+ */
+#define BENCH_SLOT (BENCH_MAX_SOURCE + 1)
+
+/**
+ * @brief Liczba zapytań phfwdGetInto, z których liczona jest suma
+ * kontrolna.
+ */
+#define BENCH_CHECK_QUERIES 100000
+
+/**
+ * @brief Długość numerów w zapytaniach.
+ */
+#define BENCH_QUERY_LENGTH 15
+
+/**
+ * @brief Rozmiar bufora na wynik phfwdGetInto.
+ */
+#define BENCH_BUFFER_SIZE 64
+
+/**
+ * @brief Sposób dodawania przekierowań.
+ */
+enum BenchMode {
+    BENCH_SEQUENTIAL, /**< kolejne wywołania phfwdAdd */
+    BENCH_BULK, /**< phfwdBulkLoad */
+    BENCH_PARALLEL /**< phfwdBulkLoadParallel */
+};
+
+/**
+ * @brief Losuje przekierowania.
+ * @param[out] numbers - tablica na 2 * @p rules numerów po BENCH_SLOT
+ *             znaków.
+ * @param[out] pairs - tablica na 2 * @p rules wskaźników na numery.
+ * @param[in] rules - liczba przekierowań.
+ */
+static void benchRandomPairs(char *numbers, const char **pairs,
+                             size_t rules) {
+    size_t i;
+    for (i = 0; i < 2 * rules; i += 2) {
+        char *source = numbers + i * BENCH_SLOT;
+        char *target = source + BENCH_SLOT;
+        benchRandomNumber(source, benchRandomLength(BENCH_MIN_SOURCE,
+                                                    BENCH_MAX_SOURCE));
+        do {
+            benchRandomNumber(target, benchRandomLength(BENCH_MIN_TARGET,
+                                                        BENCH_MAX_TARGET));
+        } while (strcmp(source, target) == 0);
+        pairs[i] = source;
+        pairs[i + 1] = target;
+    }
+}
+
+/**
+ * @brief Liczy sumę kontrolną struktury.
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[in] queries - numery zapytań, każdy zajmuje
+ *        BENCH_QUERY_LENGTH + 1 znaków.
+ * @return Suma długości wyników phfwdGetInto dla wszystkich zapytań.
+ */
+static size_t benchChecksum(struct PhoneForward *pf, const char *queries) {
+    char buf[BENCH_BUFFER_SIZE];
+    size_t sum = 0, i;
+    for (i = 0; i < BENCH_CHECK_QUERIES; i++) {
+        sum += phfwdGetInto(pf, queries + i * (BENCH_QUERY_LENGTH + 1), buf,
+                            BENCH_BUFFER_SIZE);
+    }
+    return sum;
+}
+
+/**
+ * @brief Dodaje przekierowania do pustej struktury i mierzy czas.
+ * @param[in] mode - sposób dodawania.
+ * @param[in] pairs - tablica 2 * @p rules wskaźników na numery.
+ * @param[in] rules - liczba przekierowań.
+ * @param[in] threads - liczba wątków dla BENCH_PARALLEL.
+ * @param[in] queries - numery zapytań dla benchChecksum.
+ * @param[out] checksum - suma kontrolna utworzonej struktury.
+ * @return Czas w sekundach, wartość ujemna w przypadku problemów
+ *         z pamięcią.
+ */
+static double benchLoad(enum BenchMode mode, const char *const *pairs,
+                        size_t rules, size_t threads, const char *queries,
+                        size_t *checksum) {
+    struct PhoneForward *pf = phfwdNew();
+    if (pf == NULL) {
+        return -1;
+    }
+
+    bool added = true;
+    size_t i;
+    double start = benchNow();
+    switch (mode) {
+        case BENCH_SEQUENTIAL:
+            for (i = 0; i < rules && added; i++) {
+                added = phfwdAdd(pf, pairs[2 * i], pairs[2 * i + 1]);
+            }
+            break;
+        case BENCH_BULK:
+            added = phfwdBulkLoad(pf, pairs, rules);
+            break;
+        case BENCH_PARALLEL:
+            added = phfwdBulkLoadParallel(pf, pairs, rules, threads);
+            break;
+    }
+    double time = benchNow() - start;
+
+    *checksum = added ? benchChecksum(pf, queries) : 0;
+    phfwdDelete(pf);
+    return added ? time : -1;
+}
+
+/**
+ * @brief Funkcja main programu mierzącego dodawanie wielu przekierowań.
+ * @param[in] argc - liczba argumentów.
+ * @param[in] argv - argumenty.
+ * @return 0 w przypadku sukcesu, 1 w przypadku błędu.
+ */
+int main(int argc, char *argv[]) {
+    size_t rules = BENCH_DEFAULT_RULES, threads = 0;
+    if (argc > 3
+        || (argc > 1 && !benchParseCount(argv[1], &rules))
+        || (argc > 2 && !benchParseCount(argv[2], &threads))) {
+        fprintf(stderr, "Użycie: %s [przekierowania] [wątki]\n", argv[0]);
+        return 1;
+    }
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (size_t) online : 1;
+    }
+
+    char *numbers = NULL;
+    const char **pairs = NULL;
+    char *queries = malloc(BENCH_CHECK_QUERIES * (BENCH_QUERY_LENGTH + 1));
+    if (rules <= SIZE_MAX / (2 * BENCH_SLOT)) {
+        numbers = malloc(2 * rules * BENCH_SLOT);
+        pairs = malloc(2 * rules * sizeof(const char *));
+    }
+    if (numbers == NULL || pairs == NULL || queries == NULL) {
+        fprintf(stderr, "Brak pamięci\n");
+        free(numbers);
+        free(pairs);
+        free(queries);
+        return 1;
+    }
+    benchRandomPairs(numbers, pairs, rules);
+    size_t i;
+    for (i = 0; i < BENCH_CHECK_QUERIES; i++) {
+        benchRandomNumber(queries + i * (BENCH_QUERY_LENGTH + 1),
+                          BENCH_QUERY_LENGTH);
+    }
+
+    const char *names[] = {"phfwdAdd", "phfwdBulkLoad",
+                           "phfwdBulkLoadParallel"};
+    size_t checksums[3];
+    int result = 0;
+    int mode;
+    for (mode = BENCH_SEQUENTIAL; mode <= BENCH_PARALLEL && result == 0;
+         mode++) {
+        double time = benchLoad((enum BenchMode) mode, pairs, rules, threads,
+                                queries, &checksums[mode]);
+        if (time < 0) {
+            fprintf(stderr, "Brak pamięci (%s)\n", names[mode]);
+            result = 1;
+        } else if (checksums[mode] != checksums[BENCH_SEQUENTIAL]) {
+            fprintf(stderr, "Różne wyniki phfwdAdd i %s\n", names[mode]);
+            result = 1;
+        } else if (mode == BENCH_PARALLEL) {
+            printf("%-22s %zu przekierowań, %zu wątków: %.3f s\n",
+                   names[mode], rules, threads, time);
+        } else {
+            printf("%-22s %zu przekierowań: %.3f s\n", names[mode], rules,
+                   time);
+        }
+    }
+    printf("największe zużycie pamięci: %zu MB\n", benchPeakMemory());
+
+    free(numbers);
+    free(pairs);
+    free(queries);
+    return result;
+}
@@ -0,0 +1,309 @@
+/** @file
+ * Pomiar skalowania zapytań phfwdGetInto na strukturze utworzonej przez
+ * phfwdNewConcurrent dla od 1 do N wątków czytających, podczas gdy jeden
+ * wątek piszący w pętli dodaje i usuwa przekierowania.
+ *
+ * Użycie: concurrency_bench [liczba przekierowań] [N] [czas pomiaru w ms]
+ * (domyślnie 200000 przekierowań, N równe dwukrotności liczby procesorów
+ * i 500 ms na każdą liczbę wątków).
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "phone_forward.h"
+#include "bench_utils.h"
+
+/**
+ * @brief Domyślna liczba przekierowań.
+ */
+#define BENCH_DEFAULT_RULES 200000
+
+/**
+ * @brief Domyślny czas pomiaru dla jednej liczby wątków w milisekundach.
+ */
+#define BENCH_DEFAULT_MILLISECONDS 500
+
+/**
+ * @brief Największa liczba wątków czytających.
+ */
+#define BENCH_MAX_THREADS 256
+
+/**
+ * @brief Liczba numerów zapytań (wspólna dla wszystkich wątków).
+ */
+#define BENCH_QUERIES 65536
+
+/**
+ * @brief Długość numerów w zapytaniach.
+ */
+#define BENCH_QUERY_LENGTH 12
+
+/**
+ * @brief Liczba przekierowań dodawanych i usuwanych przez wątek piszący.
+ */
+#define BENCH_WRITES 4096
+
+/**
+ * @brief Rozmiar bufora na wynik phfwdGetInto.
+ */
+#define BENCH_BUFFER_SIZE 64
+
+/**
+ * @brief Najmniejsza długość prefiksów w przekierowaniach.
+ */
+#define BENCH_MIN_PREFIX 3
+
+/**
+ * @brief Największa długość prefiksów w przekierowaniach.
+ */
+#define BENCH_MAX_PREFIX 10
+
+/**
+ * @brief Wspólny stan pomiaru.
+ */
+struct BenchState {
+    /**
+     * @brief Mierzona struktura.
+     */
+    struct PhoneForward *pf;
+
+    /**
+     * @brief Numery zapytań, każdy zajmuje BENCH_QUERY_LENGTH + 1 znaków.
+     */
+    const char *queries;
+
+    /**
+     * @brief Prefiksy dodawane i usuwane przez wątek piszący, każdy zajmuje
+     * BENCH_MAX_PREFIX + 1 znaków.
+     */
+    const char *writes;
+
+    /**
+     * @brief Czy wątki mają zakończyć pracę.
+     */
+    atomic_bool stop;
+
+    /**
+     * @brief Łączna liczba wykonanych zapytań.
+     */
+    atomic_size_t reads;
+
+    /**
+     * @brief Liczba wykonanych modyfikacji.
+     */
+    atomic_size_t writesDone;
+};
+
+/**
+ * @brief Dane wątku czytającego.
+ */
+struct BenchReader {
+    /**
+     * @brief Wspólny stan pomiaru.
+     */
+    struct BenchState *state;
+
+    /**
+     * @brief Pozycja pierwszego zapytania wątku.
+     */
+    size_t first;
+};
+
+/**
+ * @brief Wykonuje zapytania do zakończenia pomiaru.
+ * @param[in] data - wskaźnik na struct BenchReader.
+ * @return NULL.
+ */
+static void *benchReaderRun(void *data) {
+    struct BenchReader *reader = data;
+    struct BenchState *state = reader->state;
+    char buf[BENCH_BUFFER_SIZE];
+    size_t i = reader->first, done = 0;
+    while (!atomic_load_explicit(&state->stop, memory_order_relaxed)) {
+        phfwdGetInto(state->pf,
+                     state->queries + i * (BENCH_QUERY_LENGTH + 1), buf,
+                     BENCH_BUFFER_SIZE);
+        i = (i + 1) % BENCH_QUERIES;
+        done++;
+    }
+    atomic_fetch_add(&state->reads, done);
+    return NULL;
+}
+
+/**
+ * @brief Dodaje i usuwa przekierowania do zakończenia pomiaru.
+ * @param[in] data - wskaźnik na struct BenchState.
+ * @return NULL.
+ */
+static void *benchWriterRun(void *data) {
+    struct BenchState *state = data;
+    size_t i = 0, done = 0;
+    while (!atomic_load_explicit(&state->stop, memory_order_relaxed)) {
+        const char *num = state->writes + i * (BENCH_MAX_PREFIX + 1);
+        if (done % 2 == 0) {
+            phfwdAdd(state->pf, num, "9");
+        } else {
+            phfwdRemove(state->pf, num);
+            i = (i + 1) % BENCH_WRITES;
+        }
+        done++;
+    }
+    atomic_store(&state->writesDone, done);
+    return NULL;
+}
+
+/**
+ * @brief Mierzy przepustowość zapytań dla danej liczby wątków.
+ * @param[in, out] state - wspólny stan pomiaru.
+ * @param[in] howManyReaders - liczba wątków czytających.
+ * @param[in] writer - czy uruchomić wątek piszący.
+ * @param[in] milliseconds - czas pomiaru.
+ * @param[out] seconds - rzeczywisty czas pomiaru.
+ * @return true w przypadku sukcesu, false gdy nie udało się utworzyć
+ *         wątków.
+ */
+static bool benchMeasure(struct BenchState *state, size_t howManyReaders,
+                         bool writer, size_t milliseconds, double *seconds) {
+    pthread_t readers[BENCH_MAX_THREADS], writerThread;
+    struct BenchReader readerData[BENCH_MAX_THREADS];
+    size_t started = 0, i;
+    bool result = true;
+
+    atomic_store(&state->stop, false);
+    atomic_store(&state->reads, 0);
+    atomic_store(&state->writesDone, 0);
+    double start = benchNow();
+    for (i = 0; i < howManyReaders && result; i++) {
+        readerData[i].state = state;
+        readerData[i].first = i * (BENCH_QUERIES / howManyReaders);
+        result = pthread_create(&readers[i], NULL, benchReaderRun,
+                                &readerData[i]) == 0;
+        started += result ? 1 : 0;
+    }
+    bool writerStarted = result && writer
+                         && pthread_create(&writerThread, NULL,
+                                           benchWriterRun, state) == 0;
+    result = result && (writerStarted || !writer);
+
+    struct timespec pause;
+    pause.tv_sec = (time_t) (milliseconds / 1000);
+    pause.tv_nsec = (long) (milliseconds % 1000) * 1000000L;
+    if (result) {
+        nanosleep(&pause, NULL);
+    }
+    atomic_store(&state->stop, true);
+    for (i = 0; i < started; i++) {
+        pthread_join(readers[i], NULL);
+    }
+    if (writerStarted) {
+        pthread_join(writerThread, NULL);
+    }
+    *seconds = benchNow() - start;
+    return result;
+}
+
+/**
+ * @brief Funkcja main programu mierzącego skalowanie zapytań.
+ * @param[in] argc - liczba argumentów.
+ * @param[in] argv - argumenty.
+ * @return 0 w przypadku sukcesu, 1 w przypadku błędu.
+ */
+int main(int argc, char *argv[]) {
+    size_t rules = BENCH_DEFAULT_RULES, maxThreads = 0;
+    size_t milliseconds = BENCH_DEFAULT_MILLISECONDS;
+    if (argc > 4
+        || (argc > 1 && !benchParseCount(argv[1], &rules))
+        || (argc > 2 && !benchParseCount(argv[2], &maxThreads))
+        || (argc > 3 && !benchParseCount(argv[3], &milliseconds))) {
+        fprintf(stderr, "Użycie: %s [przekierowania] [wątki] [ms]\n",
+                argv[0]);
+        return 1;
+    }
+    if (maxThreads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        maxThreads = 2 * (online > 0 ? (size_t) online : 1);
+    }
+    if (maxThreads > BENCH_MAX_THREADS) {
+        maxThreads = BENCH_MAX_THREADS;
+    }
+
+    struct BenchState state;
+    char *queries = malloc(BENCH_QUERIES * (BENCH_QUERY_LENGTH + 1));
+    char *writes = malloc(BENCH_WRITES * (BENCH_MAX_PREFIX + 1));
+    struct PhoneForward *plain = phfwdNew();
+    struct PhoneForward *concurrent = phfwdNewConcurrent();
+    if (queries == NULL || writes == NULL || plain == NULL
+        || concurrent == NULL) {
+        fprintf(stderr, "Brak pamięci\n");
+        free(queries);
+        free(writes);
+        phfwdDelete(plain);
+        phfwdDelete(concurrent);
+        return 1;
+    }
+
+    char source[BENCH_MAX_PREFIX + 1], target[BENCH_MAX_PREFIX + 1];
+    size_t i;
+    for (i = 0; i < rules; i++) {
+        benchRandomNumber(source, benchRandomLength(BENCH_MIN_PREFIX,
+                                                    BENCH_MAX_PREFIX));
+        benchRandomNumber(target, benchRandomLength(BENCH_MIN_PREFIX,
+                                                    BENCH_MAX_PREFIX));
+        phfwdAdd(plain, source, target);
+        phfwdAdd(concurrent, source, target);
+    }
+    for (i = 0; i < BENCH_QUERIES; i++) {
+        benchRandomNumber(queries + i * (BENCH_QUERY_LENGTH + 1),
+                          BENCH_QUERY_LENGTH);
+    }
+    for (i = 0; i < BENCH_WRITES; i++) {
+        benchRandomNumber(writes + i * (BENCH_MAX_PREFIX + 1),
+                          benchRandomLength(BENCH_MIN_PREFIX,
+                                            BENCH_MAX_PREFIX));
+    }
+    state.queries = queries;
+    state.writes = writes;
+
+    int result = 0;
+    double seconds;
+    state.pf = plain;
+    if (benchMeasure(&state, 1, false, milliseconds, &seconds)) {
+        printf("phfwdNew, 1 wątek, bez zapisów: %.2f mln zapytań/s\n",
+               (double) atomic_load(&state.reads) / seconds * 1e-6);
+    } else {
+        result = 1;
+    }
+
+    state.pf = concurrent;
+    size_t threads;
+    for (threads = 1; threads <= maxThreads && result == 0; threads++) {
+        if (!benchMeasure(&state, threads, true, milliseconds, &seconds)) {
+            result = 1;
+        } else {
+            printf("phfwdNewConcurrent, %3zu wątków: %.2f mln zapytań/s, "
+                   "%.0f zmian/s\n", threads,
+                   (double) atomic_load(&state.reads) / seconds * 1e-6,
+                   (double) atomic_load(&state.writesDone) / seconds);
+        }
+    }
+    if (result != 0) {
+        fprintf(stderr, "Nie udało się utworzyć wątków\n");
+    }
+
+    phfwdDelete(plain);
+    phfwdDelete(concurrent);
+    free(queries);
+    free(writes);
+    return result;
+}
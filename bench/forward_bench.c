@@ -0,0 +1,168 @@
+/** @file
+ * Pomiar czasu wyznaczania przekierowań przez phfwdGetInto na drzewie
+ * i na zwartej postaci utworzonej przez phfwdCompile.
+ *
+ * Użycie: forward_bench [liczba przekierowań] [liczba zapytań]
+ * (domyślnie 1000000 przekierowań i 2000000 zapytań o numery 15-cyfrowe).
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "phone_forward.h"
+#include "bench_utils.h"
+
+/**
+ * @brief Domyślna liczba przekierowań.
+ */
+#define BENCH_DEFAULT_RULES 1000000
+
+/**
+ * @brief Domyślna liczba zapytań.
+ */
+#define BENCH_DEFAULT_QUERIES 2000000
+
+/**
+ * @brief Długość numerów w zapytaniach.
+ */
+#define BENCH_QUERY_LENGTH 15
+
+/**
+ * @brief Najmniejsza długość prefiksów w przekierowaniach.
+ */
+#define BENCH_MIN_PREFIX 3
+
+/**
+ * @brief Największa długość prefiksów w przekierowaniach.
+ */
+#define BENCH_MAX_PREFIX 12
+
+/**
+ * @brief Rozmiar bufora na wynik phfwdGetInto.
+ */
+#define BENCH_BUFFER_SIZE 64
+
+/**
+ * @brief Liczba powtórzeń każdego z pomiarów.
+ */
+#define BENCH_REPEATS 3
+
+/**
+ * @brief Losuje długość prefiksu w przekierowaniu.
+ * @return Długość z przedziału [BENCH_MIN_PREFIX, BENCH_MAX_PREFIX].
+ */
+static size_t benchRandomPrefixLength(void) {
+    return benchRandomLength(BENCH_MIN_PREFIX, BENCH_MAX_PREFIX);
+}
+
+/**
+ * @brief Wykonuje wszystkie zapytania i mierzy ich czas.
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[in] queries - numery zapytań, każdy zajmuje
+ *        BENCH_QUERY_LENGTH + 1 znaków.
+ * @param[in] howMany - liczba zapytań.
+ * @param[out] checksum - suma długości wyników.
+ * @return Najkrótszy z BENCH_REPEATS czasów jednego zapytania
+ *         w nanosekundach.
+ */
+static double benchQueries(struct PhoneForward *pf, const char *queries,
+                           size_t howMany, size_t *checksum) {
+    char buf[BENCH_BUFFER_SIZE];
+    double best = 0;
+    int repeat;
+    for (repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+        size_t sum = 0, i;
+        double start = benchNow();
+        for (i = 0; i < howMany; i++) {
+            sum += phfwdGetInto(pf, queries + i * (BENCH_QUERY_LENGTH + 1),
+                                buf, BENCH_BUFFER_SIZE);
+        }
+        double time = (benchNow() - start) * 1e9 / (double) howMany;
+        if (repeat == 0 || time < best) {
+            best = time;
+        }
+        *checksum = sum;
+    }
+    return best;
+}
+
+/**
+ * @brief Funkcja main programu mierzącego phfwdGetInto.
+ * @param[in] argc - liczba argumentów.
+ * @param[in] argv - argumenty.
+ * @return 0 w przypadku sukcesu, 1 w przypadku błędu.
+ */
+int main(int argc, char *argv[]) {
+    size_t rules = BENCH_DEFAULT_RULES;
+    size_t howManyQueries = BENCH_DEFAULT_QUERIES;
+    if (argc > 3
+        || (argc > 1 && !benchParseCount(argv[1], &rules))
+        || (argc > 2 && !benchParseCount(argv[2], &howManyQueries))) {
+        fprintf(stderr, "Użycie: %s [przekierowania] [zapytania]\n",
+                argv[0]);
+        return 1;
+    }
+
+    struct PhoneForward *pf = phfwdNew();
+    char *queries = malloc(howManyQueries * (BENCH_QUERY_LENGTH + 1));
+    if (pf == NULL || queries == NULL) {
+        fprintf(stderr, "Brak pamięci\n");
+        phfwdDelete(pf);
+        free(queries);
+        return 1;
+    }
+
+    char source[BENCH_MAX_PREFIX + 1], target[BENCH_MAX_PREFIX + 1];
+    size_t i;
+    double start = benchNow();
+    for (i = 0; i < rules; i++) {
+        benchRandomNumber(source, benchRandomPrefixLength());
+        benchRandomNumber(target, benchRandomPrefixLength());
+        if (!phfwdAdd(pf, source, target) && strcmp(source, target) != 0) {
+            fprintf(stderr, "Brak pamięci\n");
+            phfwdDelete(pf);
+            free(queries);
+            return 1;
+        }
+    }
+    printf("dodawanie %zu przekierowań: %.3f s\n", rules,
+           benchNow() - start);
+
+    for (i = 0; i < howManyQueries; i++) {
+        benchRandomNumber(queries + i * (BENCH_QUERY_LENGTH + 1),
+                          BENCH_QUERY_LENGTH);
+    }
+
+    size_t liveChecksum, compiledChecksum;
+    double live = benchQueries(pf, queries, howManyQueries, &liveChecksum);
+    printf("drzewo:          %.0f ns/zapytanie\n", live);
+
+    start = benchNow();
+    bool compiled = phfwdCompile(pf);
+    printf("phfwdCompile:    %.3f s\n", benchNow() - start);
+
+    int result = 0;
+    if (!compiled) {
+        fprintf(stderr, "Brak pamięci\n");
+        result = 1;
+    } else {
+        double flat = benchQueries(pf, queries, howManyQueries,
+                                   &compiledChecksum);
+        printf("zwarta postać:   %.0f ns/zapytanie (%.2fx)\n", flat,
+               live / flat);
+        if (liveChecksum != compiledChecksum) {
+            fprintf(stderr, "Różne wyniki drzewa i zwartej postaci\n");
+            result = 1;
+        }
+    }
+
+    phfwdDelete(pf);
+    free(queries);
+    return result;
+}
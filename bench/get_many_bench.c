@@ -0,0 +1,259 @@
+/** @file
+ * Pomiar czasu wyznaczania przekierowań paczek numerów przez phfwdGetMany
+ * w porównaniu z wywołaniami phfwdGet i phfwdGetInto dla każdego numeru.
+ * Numery w paczce mają wspólne długie prefiksy (jak numery z rekordów
+ * połączeń z jednej sieci).
+ *
+ * Użycie: get_many_bench [liczba przekierowań] [rozmiar paczki]
+ * [liczba paczek]
+ * (domyślnie 1000000 przekierowań i 20 paczek po 100000 numerów
+ * 15-cyfrowych).
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "phone_forward.h"
+#include "bench_utils.h"
+
+/**
+ * @brief Domyślna liczba przekierowań.
+ */
+#define BENCH_DEFAULT_RULES 1000000
+
+/**
+ * @brief Domyślna liczba numerów w paczce.
+ */
+#define BENCH_DEFAULT_BATCH 100000
+
+/**
+ * @brief Domyślna liczba paczek.
+ */
+#define BENCH_DEFAULT_BATCHES 20
+
+/**
+ * @brief Liczba wspólnych prefiksów numerów.
+ */
+#define BENCH_AREAS 1000
+
+/**
+ * @brief Długość wspólnych prefiksów numerów.
+ */
+#define BENCH_AREA_LENGTH 9
+
+/**
+ * @brief Długość numerów w zapytaniach.
+ */
+#define BENCH_QUERY_LENGTH 15
+
+/**
+ * @brief Najmniejsza długość prefiksów w przekierowaniach.
+ */
+#define BENCH_MIN_PREFIX 3
+
+/**
+ * @brief Największa długość prefiksów w przekierowaniach.
+ */
+#define BENCH_MAX_PREFIX 13
+
+/**
+ * @brief Rozmiar bufora na wynik phfwdGetInto.
+ */
+#define BENCH_BUFFER_SIZE 64
+
+/**
+ * @brief Sposób wyznaczania przekierowań.
+ */
+enum BenchMode {
+    BENCH_GET, /**< phfwdGet dla każdego numeru */
+    BENCH_GET_INTO, /**< phfwdGetInto dla każdego numeru */
+    BENCH_GET_MANY /**< phfwdGetMany dla całej paczki */
+};
+
+/**
+ * @brief Nazwy sposobów wyznaczania przekierowań.
+ */
+static const char *const benchModeNames[] = {
+        "n x phfwdGet", "n x phfwdGetInto", "phfwdGetMany"
+};
+
+/**
+ * @brief Długość napisu lub 0 dla NULL.
+ * @param[in] txt - wskaźnik na napis.
+ * @return Długość napisu.
+ */
+static size_t benchLength(const char *txt) {
+    return txt == NULL ? 0 : strlen(txt);
+}
+
+/**
+ * @brief Wyznacza przekierowania jednej paczki numerów.
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[in] mode - sposób wyznaczania przekierowań.
+ * @param[in] nums - numery paczki.
+ * @param[in] n - liczba numerów.
+ * @param[out] sum - suma długości wyników.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
+ */
+static bool benchBatch(struct PhoneForward *pf, enum BenchMode mode,
+                       const char *const *nums, size_t n, size_t *sum) {
+    char buf[BENCH_BUFFER_SIZE];
+    const struct PhoneNumbers *pnum;
+    size_t i;
+    switch (mode) {
+        case BENCH_GET:
+            for (i = 0; i < n; i++) {
+                pnum = phfwdGet(pf, nums[i]);
+                if (pnum == NULL) {
+                    return false;
+                }
+                *sum += benchLength(phnumGet(pnum, 0));
+                phnumDelete(pnum);
+            }
+            return true;
+        case BENCH_GET_INTO:
+            for (i = 0; i < n; i++) {
+                *sum += phfwdGetInto(pf, nums[i], buf, BENCH_BUFFER_SIZE);
+            }
+            return true;
+        case BENCH_GET_MANY:
+            pnum = phfwdGetMany(pf, nums, n);
+            if (pnum == NULL) {
+                return false;
+            }
+            for (i = 0; i < n; i++) {
+                *sum += benchLength(phnumGet(pnum, i));
+            }
+            phnumDelete(pnum);
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Mierzy wszystkie sposoby wyznaczania przekierowań.
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[in] nums - numery wszystkich paczek.
+ * @param[in] batch - liczba numerów w paczce.
+ * @param[in] batches - liczba paczek.
+ * @param[in] label - opis struktury.
+ * @return true jeżeli wszystkie sposoby dały te same wyniki, false
+ *         w przeciwnym przypadku lub w przypadku problemów z pamięcią.
+ */
+static bool benchAll(struct PhoneForward *pf, const char *const *nums,
+                     size_t batch, size_t batches, const char *label) {
+    size_t sums[3], b;
+    double times[3];
+    int mode;
+    for (mode = BENCH_GET; mode <= BENCH_GET_MANY; mode++) {
+        sums[mode] = 0;
+        double start = benchNow();
+        for (b = 0; b < batches; b++) {
+            if (!benchBatch(pf, (enum BenchMode) mode, nums + b * batch,
+                            batch, &sums[mode])) {
+                fprintf(stderr, "Brak pamięci\n");
+                return false;
+            }
+        }
+        times[mode] = (benchNow() - start) * 1e9
+                      / (double) (batch * batches);
+    }
+    for (mode = BENCH_GET; mode <= BENCH_GET_MANY; mode++) {
+        printf("%-13s %-16s %6.0f ns/numer (%.2fx)\n", label,
+               benchModeNames[mode], times[mode],
+               times[BENCH_GET] / times[mode]);
+    }
+    if (sums[BENCH_GET_INTO] != sums[BENCH_GET]
+        || sums[BENCH_GET_MANY] != sums[BENCH_GET]) {
+        fprintf(stderr, "Różne wyniki\n");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Funkcja main programu mierzącego phfwdGetMany.
+ * @param[in] argc - liczba argumentów.
+ * @param[in] argv - argumenty.
+ * @return 0 w przypadku sukcesu, 1 w przypadku błędu.
+ */
+int main(int argc, char *argv[]) {
+    size_t rules = BENCH_DEFAULT_RULES, batch = BENCH_DEFAULT_BATCH;
+    size_t batches = BENCH_DEFAULT_BATCHES;
+    if (argc > 4
+        || (argc > 1 && !benchParseCount(argv[1], &rules))
+        || (argc > 2 && !benchParseCount(argv[2], &batch))
+        || (argc > 3 && !benchParseCount(argv[3], &batches))) {
+        fprintf(stderr, "Użycie: %s [przekierowania] [paczka] [paczki]\n",
+                argv[0]);
+        return 1;
+    }
+
+    size_t total = batch * batches;
+    struct PhoneForward *pf = phfwdNew();
+    char *areas = malloc(BENCH_AREAS * (BENCH_AREA_LENGTH + 1));
+    char *numbers = NULL;
+    const char **nums = NULL;
+    if (batches > 0 && total / batches == batch
+        && total <= SIZE_MAX / (BENCH_QUERY_LENGTH + 1)) {
+        numbers = malloc(total * (BENCH_QUERY_LENGTH + 1));
+        nums = malloc(total * sizeof(const char *));
+    }
+    if (pf == NULL || areas == NULL || numbers == NULL || nums == NULL) {
+        fprintf(stderr, "Brak pamięci\n");
+        phfwdDelete(pf);
+        free(areas);
+        free(numbers);
+        free(nums);
+        return 1;
+    }
+
+    size_t i;
+    for (i = 0; i < BENCH_AREAS; i++) {
+        benchRandomNumber(areas + i * (BENCH_AREA_LENGTH + 1),
+                          BENCH_AREA_LENGTH);
+    }
+    char source[BENCH_MAX_PREFIX + 1], target[BENCH_MAX_PREFIX + 1];
+    for (i = 0; i < rules; i++) {
+        size_t length = benchRandomLength(BENCH_MIN_PREFIX, BENCH_MAX_PREFIX);
+        benchRandomNumber(source, length);
+        if (i % 2 == 0 && length > BENCH_AREA_LENGTH) {
+            memcpy(source, areas + benchRandom() % BENCH_AREAS
+                                   * (BENCH_AREA_LENGTH + 1),
+                   BENCH_AREA_LENGTH);
+        }
+        benchRandomNumber(target, benchRandomLength(BENCH_MIN_PREFIX,
+                                                    BENCH_MAX_PREFIX));
+        phfwdAdd(pf, source, target);
+    }
+    for (i = 0; i < total; i++) {
+        char *num = numbers + i * (BENCH_QUERY_LENGTH + 1);
+        memcpy(num, areas + benchRandom() % BENCH_AREAS
+                            * (BENCH_AREA_LENGTH + 1), BENCH_AREA_LENGTH);
+        benchRandomNumber(num + BENCH_AREA_LENGTH,
+                          BENCH_QUERY_LENGTH - BENCH_AREA_LENGTH);
+        nums[i] = num;
+    }
+
+    int result = benchAll(pf, nums, batch, batches, "drzewo") ? 0 : 1;
+    if (result == 0 && !phfwdCompile(pf)) {
+        fprintf(stderr, "Brak pamięci\n");
+        result = 1;
+    }
+    if (result == 0
+        && !benchAll(pf, nums, batch, batches, "zwarta postać")) {
+        result = 1;
+    }
+
+    phfwdDelete(pf);
+    free(areas);
+    free(numbers);
+    free(nums);
+    return result;
+}
@@ -0,0 +1,236 @@
+/** @file
+ * Pomiar przepustowości całego interpretera na dużych skryptach. Program
+ * tworzy w katalogu tymczasowym skrypty trzech rodzajów, uruchamia na
+ * każdym z nich podany program phone_forward (wyjście trafia do
+ * /dev/null) i wypisuje najlepszy czas oraz przepustowość w MB/s.
+ * Przekazując program zbudowany ze starszej wersji, można porównać wyniki.
+ *
+ * Użycie: interpreter_bench <program> [rozmiar skryptu w MB]
+ * (domyślnie 32 MB na skrypt).
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "bench_utils.h"
+
+/**
+ * @brief Domyślny rozmiar skryptu w MB.
+ */
+#define BENCH_DEFAULT_MEGABYTES 32
+
+/**
+ * @brief Liczba uruchomień programu na każdym skrypcie.
+ */
+#define BENCH_ROUNDS 3
+
+/**
+ * @brief Liczba przekierowań na początku skryptów z zapytaniami.
+ */
+#define BENCH_RULES 10000
+
+/**
+ * @brief Największa długość numeru w skryptach.
+ */
+#define BENCH_MAX_NUMBER 64
+
+/**
+ * @brief Największa długość komentarza w skryptach.
+ */
+#define BENCH_MAX_COMMENT 256
+
+/**
+ * @brief Rodzaj skryptu.
+ */
+enum BenchScript {
+    BENCH_QUERIES, /**< krótkie zapytania o przekierowanie numeru */
+    BENCH_PADDED, /**< zapytania z wcięciami i krótkimi komentarzami */
+    BENCH_LONG /**< długie przekierowania z długimi komentarzami */
+};
+
+/**
+ * @brief Opisy rodzajów skryptów.
+ */
+static const char *const benchScriptNames[] = {
+        "krótkie zapytania", "wcięcia i komentarze",
+        "długie przekierowania"
+};
+
+/**
+ * @brief Wypisuje do pliku losowy numer.
+ * @param[in, out] file - plik.
+ * @param[in] minLength - najmniejsza długość numeru.
+ * @param[in] maxLength - największa długość numeru.
+ * @return Liczba wypisanych znaków.
+ */
+static size_t benchPutNumber(FILE *file, size_t minLength, size_t maxLength) {
+    char buf[BENCH_MAX_NUMBER + 1];
+    size_t length = benchRandomLength(minLength, maxLength);
+    benchRandomNumber(buf, length);
+    fputs(buf, file);
+    return length;
+}
+
+/**
+ * @brief Wypisuje do pliku komentarz z losowych liter.
+ * @param[in, out] file - plik.
+ * @param[in] minLength - najmniejsza długość treści komentarza.
+ * @param[in] maxLength - największa długość treści komentarza.
+ * @return Liczba wypisanych znaków.
+ */
+static size_t benchPutComment(FILE *file, size_t minLength,
+                              size_t maxLength) {
+    char buf[BENCH_MAX_COMMENT + 1];
+    size_t length = benchRandomLength(minLength, maxLength), i;
+    for (i = 0; i < length; i++) {
+        buf[i] = (char) (i % 8 == 7 ? ' ' : 'a' + benchRandom() % 26);
+    }
+    buf[length] = '\0';
+    fprintf(file, "$$%s$$", buf);
+    return length + 4;
+}
+
+/**
+ * @brief Tworzy skrypt danego rodzaju.
+ * @param[in, out] file - plik na skrypt.
+ * @param[in] script - rodzaj skryptu.
+ * @param[in] bytes - najmniejszy rozmiar skryptu.
+ * @return true w przypadku sukcesu, false w przypadku błędu zapisu.
+ */
+static bool benchWriteScript(FILE *file, enum BenchScript script,
+                             size_t bytes) {
+    size_t written = (size_t) fprintf(file, "NEW bench\n"), i;
+    for (i = 0; i < BENCH_RULES && script != BENCH_LONG; i++) {
+        written += benchPutNumber(file, 5, 8);
+        fputc('>', file);
+        written += benchPutNumber(file, 3, 4) + 2;
+        fputc('\n', file);
+    }
+    while (written < bytes) {
+        switch (script) {
+            case BENCH_QUERIES:
+                written += benchPutNumber(file, 9, 12) + 3;
+                fputs(" ?\n", file);
+                break;
+            case BENCH_PADDED:
+                fputs("    ", file);
+                written += benchPutComment(file, 8, 24) + 4;
+                fputs("\t ", file);
+                written += benchPutNumber(file, 9, 12) + 7;
+                fputs("   ?\n", file);
+                break;
+            case BENCH_LONG:
+                written += benchPutNumber(file, 33, BENCH_MAX_NUMBER);
+                fputs(" > ", file);
+                written += benchPutNumber(file, 16, 32) + 4;
+                fputc('\n', file);
+                written += benchPutComment(file, 128, BENCH_MAX_COMMENT) + 1;
+                fputc('\n', file);
+                break;
+        }
+    }
+    return fflush(file) == 0 && !ferror(file);
+}
+
+/**
+ * @brief Uruchamia program na skrypcie i mierzy czas.
+ * @param[in] program - ścieżka do programu.
+ * @param[in] path - ścieżka do skryptu.
+ * @return Czas w sekundach, wartość ujemna gdy program nie zakończył się
+ *         poprawnie.
+ */
+static double benchRun(const char *program, const char *path) {
+    double start = benchNow();
+    pid_t pid = fork();
+    if (pid < 0) {
+        return -1;
+    }
+    if (pid == 0) {
+        int in = open(path, O_RDONLY);
+        int out = open("/dev/null", O_WRONLY);
+        if (in < 0 || out < 0 || dup2(in, STDIN_FILENO) < 0
+            || dup2(out, STDOUT_FILENO) < 0) {
+            _exit(127);
+        }
+        execl(program, program, (char *) NULL);
+        _exit(127);
+    }
+    int status;
+    if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status)
+        || WEXITSTATUS(status) != 0) {
+        return -1;
+    }
+    return benchNow() - start;
+}
+
+/**
+ * @brief Funkcja main programu mierzącego przepustowość interpretera.
+ * @param[in] argc - liczba argumentów.
+ * @param[in] argv - argumenty.
+ * @return 0 w przypadku sukcesu, 1 w przypadku błędu.
+ */
+int main(int argc, char *argv[]) {
+    size_t megabytes = BENCH_DEFAULT_MEGABYTES;
+    if (argc < 2 || argc > 3
+        || (argc > 2 && !benchParseCount(argv[2], &megabytes))
+        || megabytes > SIZE_MAX / (1 << 20)) {
+        fprintf(stderr, "Użycie: %s <program> [MB]\n",
+                argc > 0 ? argv[0] : "interpreter_bench");
+        return 1;
+    }
+
+    char path[] = "/tmp/interpreter_benchXXXXXX";
+    int fd = mkstemp(path);
+    FILE *file = fd < 0 ? NULL : fdopen(fd, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Nie udało się utworzyć pliku tymczasowego\n");
+        if (fd >= 0) {
+            close(fd);
+            unlink(path);
+        }
+        return 1;
+    }
+
+    int result = 0;
+    int script;
+    for (script = BENCH_QUERIES; script <= BENCH_LONG && result == 0;
+         script++) {
+        if (ftruncate(fileno(file), 0) != 0 || fseek(file, 0, SEEK_SET) != 0
+            || !benchWriteScript(file, (enum BenchScript) script,
+                                 megabytes << 20)) {
+            fprintf(stderr, "Błąd zapisu skryptu\n");
+            result = 1;
+            break;
+        }
+        double bytes = (double) ftell(file);
+        double best = 0;
+        int round;
+        for (round = 0; round < BENCH_ROUNDS && result == 0; round++) {
+            double time = benchRun(argv[1], path);
+            if (time < 0) {
+                fprintf(stderr, "Program %s zakończył się błędem\n",
+                        argv[1]);
+                result = 1;
+            }
+            best = round == 0 || time < best ? time : best;
+        }
+        if (result == 0) {
+            printf("%-22s %6.1f MB: %.3f s, %.1f MB/s\n",
+                   benchScriptNames[script], bytes / (1 << 20), best,
+                   bytes / (1 << 20) / best);
+        }
+    }
+
+    fclose(file);
+    unlink(path);
+    return result;
+}
@@ -0,0 +1,168 @@
+/** @file
+ * Pomiar operacji przechodzących po drzewie przekierowań (bez zwartej
+ * postaci): dodawania przez phfwdAdd, wyznaczania przekierowań przez
+ * phfwdGet i usuwania przez phfwdRemove. Program korzysta tylko
+ * z najstarszej części interfejsu, więc można go zbudować także ze
+ * starszymi wersjami biblioteki i porównać wyniki.
+ *
+ * Użycie: radix_bench [liczba przekierowań] [liczba zapytań]
+ * (domyślnie 100000 przekierowań i 1000000 zapytań o numery 12-cyfrowe).
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "phone_forward.h"
+#include "bench_utils.h"
+
+/**
+ * @brief Domyślna liczba przekierowań.
+ */
+#define BENCH_DEFAULT_RULES 100000
+
+/**
+ * @brief Domyślna liczba zapytań.
+ */
+#define BENCH_DEFAULT_QUERIES 1000000
+
+/**
+ * @brief Długość numerów w zapytaniach.
+ */
+#define BENCH_QUERY_LENGTH 12
+
+/**
+ * @brief Najmniejsza długość prefiksów w przekierowaniach.
+ */
+#define BENCH_MIN_PREFIX 3
+
+/**
+ * @brief Największa długość prefiksów w przekierowaniach.
+ */
+#define BENCH_MAX_PREFIX 10
+
+/**
+ * @brief Miejsce zajmowane przez jeden prefiks w tablicy prefiksów.
+ */
+#define BENCH_SLOT (BENCH_MAX_PREFIX + 1)
+
+/**
+ * @brief Liczba powtórzeń pomiaru zapytań, wypisywany jest najlepszy czas.
+ */
+#define BENCH_ROUNDS 5
+
+/**
+ * @brief Wyznacza przekierowania wszystkich zapytań.
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[in] queries - numery zapytań, każdy zajmuje
+ *        BENCH_QUERY_LENGTH + 1 znaków.
+ * @param[in] howManyQueries - liczba zapytań.
+ * @param[out] sum - suma długości wyników.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
+ */
+static bool benchQueries(struct PhoneForward *pf, const char *queries,
+                         size_t howManyQueries, size_t *sum) {
+    size_t i;
+    *sum = 0;
+    for (i = 0; i < howManyQueries; i++) {
+        const struct PhoneNumbers *pnum =
+                phfwdGet(pf, queries + i * (BENCH_QUERY_LENGTH + 1));
+        if (pnum == NULL) {
+            return false;
+        }
+        const char *result = phnumGet(pnum, 0);
+        *sum += result == NULL ? 0 : strlen(result);
+        phnumDelete(pnum);
+    }
+    return true;
+}
+
+/**
+ * @brief Funkcja main programu mierzącego operacje na drzewie.
+ * @param[in] argc - liczba argumentów.
+ * @param[in] argv - argumenty.
+ * @return 0 w przypadku sukcesu, 1 w przypadku błędu.
+ */
+int main(int argc, char *argv[]) {
+    size_t rules = BENCH_DEFAULT_RULES, howManyQueries = BENCH_DEFAULT_QUERIES;
+    if (argc > 3
+        || (argc > 1 && !benchParseCount(argv[1], &rules))
+        || (argc > 2 && !benchParseCount(argv[2], &howManyQueries))) {
+        fprintf(stderr, "Użycie: %s [przekierowania] [zapytania]\n", argv[0]);
+        return 1;
+    }
+
+    struct PhoneForward *pf = phfwdNew();
+    char *prefixes = NULL, *queries = NULL;
+    if (rules <= SIZE_MAX / (2 * BENCH_SLOT)
+        && howManyQueries <= SIZE_MAX / (BENCH_QUERY_LENGTH + 1)) {
+        prefixes = malloc(2 * rules * BENCH_SLOT);
+        queries = malloc(howManyQueries * (BENCH_QUERY_LENGTH + 1));
+    }
+    if (pf == NULL || prefixes == NULL || queries == NULL) {
+        fprintf(stderr, "Brak pamięci\n");
+        phfwdDelete(pf);
+        free(prefixes);
+        free(queries);
+        return 1;
+    }
+
+    size_t i;
+    for (i = 0; i < 2 * rules; i++) {
+        benchRandomNumber(prefixes + i * BENCH_SLOT,
+                          benchRandomLength(BENCH_MIN_PREFIX,
+                                            BENCH_MAX_PREFIX));
+    }
+    for (i = 0; i < howManyQueries; i++) {
+        benchRandomNumber(queries + i * (BENCH_QUERY_LENGTH + 1),
+                          BENCH_QUERY_LENGTH);
+    }
+
+    int result = 0;
+    double start = benchNow();
+    for (i = 0; i < rules && result == 0; i++) {
+        const char *source = prefixes + 2 * i * BENCH_SLOT;
+        if (!phfwdAdd(pf, source, source + BENCH_SLOT)
+            && strcmp(source, source + BENCH_SLOT) != 0) {
+            result = 1;
+        }
+    }
+    double addTime = benchNow() - start;
+
+    double best = 0;
+    size_t sum = 0, round;
+    for (round = 0; round < BENCH_ROUNDS && result == 0; round++) {
+        start = benchNow();
+        if (!benchQueries(pf, queries, howManyQueries, &sum)) {
+            result = 1;
+        }
+        double time = benchNow() - start;
+        best = round == 0 || time < best ? time : best;
+    }
+
+    start = benchNow();
+    for (i = 0; i < rules && result == 0; i++) {
+        phfwdRemove(pf, prefixes + 2 * i * BENCH_SLOT);
+    }
+    double removeTime = benchNow() - start;
+
+    if (result != 0) {
+        fprintf(stderr, "Brak pamięci\n");
+    } else {
+        printf("phfwdAdd:    %.2f mln/s\n", (double) rules / addTime * 1e-6);
+        printf("phfwdGet:    %.2f mln/s (najlepszy z %d, suma %zu)\n",
+               (double) howManyQueries / best * 1e-6, BENCH_ROUNDS, sum);
+        printf("phfwdRemove: %.2f mln/s\n",
+               (double) rules / removeTime * 1e-6);
+    }
+
+    phfwdDelete(pf);
+    free(prefixes);
+    free(queries);
+    return result;
+}
@@ -0,0 +1,170 @@
+/** @file
+ * Pomiar czasu phfwdReverse dla numeru, na który prowadzi wiele
+ * przekierowań. Dla każdej krotności k struktura zawiera k przekierowań
+ * na prefiksy numeru (połowa wyników się powtarza, więc mierzone jest też
+ * usuwanie powtórzeń) oraz przekierowania losowe. Program korzysta tylko
+ * z najstarszej części interfejsu, więc można go zbudować także ze
+ * starszymi wersjami biblioteki i porównać wyniki.
+ *
+ * Użycie: reverse_bench [k...]
+ * (domyślnie k równe 10, 1000 i 100000).
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "phone_forward.h"
+#include "bench_utils.h"
+
+/**
+ * @brief Liczba losowych przekierowań w każdej strukturze.
+ */
+#define BENCH_NOISE 10000
+
+/**
+ * @brief Łączna liczba wyników, po której kończy się pomiar dla jednej
+ * krotności.
+ */
+#define BENCH_WORK 2000000
+
+/**
+ * @brief Najmniejsza liczba zapytań dla jednej krotności.
+ */
+#define BENCH_MIN_ROUNDS 5
+
+/**
+ * @brief Numer, o który pytamy.
+ */
+#define BENCH_NUMBER "5550123"
+
+/**
+ * @brief Krótszy prefiks numeru, na który prowadzą przekierowania.
+ */
+#define BENCH_SHORT_TARGET "555"
+
+/**
+ * @brief Przyrostek, który wydłuża krótszy prefiks do dłuższego.
+ */
+#define BENCH_TARGET_SUFFIX "0"
+
+/**
+ * @brief Dłuższy prefiks numeru, na który prowadzą przekierowania.
+ */
+#define BENCH_LONG_TARGET (BENCH_SHORT_TARGET BENCH_TARGET_SUFFIX)
+
+/**
+ * @brief Najmniejsza długość prefiksów w przekierowaniach.
+ */
+#define BENCH_MIN_PREFIX 8
+
+/**
+ * @brief Największa długość prefiksów w przekierowaniach.
+ */
+#define BENCH_MAX_PREFIX 11
+
+/**
+ * @brief Domyślne krotności.
+ */
+static const size_t benchDefaultFanIns[] = {10, 1000, 100000};
+
+/**
+ * @brief Tworzy strukturę, w której na BENCH_NUMBER prowadzi @p fanIn
+ * przekierowań.
+ * @param[in] fanIn - krotność.
+ * @return Wskaźnik na strukturę lub NULL w przypadku problemów z pamięcią.
+ */
+static struct PhoneForward *benchCreate(size_t fanIn) {
+    struct PhoneForward *pf = phfwdNew();
+    char source[BENCH_MAX_PREFIX + 2], target[BENCH_MAX_PREFIX + 1];
+    bool added = pf != NULL;
+    size_t i;
+    for (i = 0; i < fanIn && added; i += 2) {
+        size_t length = benchRandomLength(BENCH_MIN_PREFIX, BENCH_MAX_PREFIX);
+        benchRandomNumber(source, length);
+        added = phfwdAdd(pf, source, BENCH_SHORT_TARGET);
+        if (added && i + 1 < fanIn) {
+            strcpy(source + length, BENCH_TARGET_SUFFIX);
+            added = phfwdAdd(pf, source, BENCH_LONG_TARGET);
+        }
+    }
+    for (i = 0; i < BENCH_NOISE && added; i++) {
+        benchRandomNumber(source, benchRandomLength(BENCH_MIN_PREFIX,
+                                                    BENCH_MAX_PREFIX));
+        benchRandomNumber(target, benchRandomLength(BENCH_MIN_PREFIX,
+                                                    BENCH_MAX_PREFIX));
+        added = phfwdAdd(pf, source, target) || strcmp(source, target) == 0;
+    }
+    if (!added) {
+        phfwdDelete(pf);
+        return NULL;
+    }
+    return pf;
+}
+
+/**
+ * @brief Mierzy phfwdReverse dla jednej krotności.
+ * @param[in] fanIn - krotność.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
+ */
+static bool benchFanIn(size_t fanIn) {
+    struct PhoneForward *pf = benchCreate(fanIn);
+    if (pf == NULL) {
+        return false;
+    }
+
+    size_t rounds = BENCH_WORK / fanIn, count = 0, sum = 0, round;
+    rounds = rounds < BENCH_MIN_ROUNDS ? BENCH_MIN_ROUNDS : rounds;
+    bool result = true;
+    double start = benchNow();
+    for (round = 0; round < rounds && result; round++) {
+        const struct PhoneNumbers *pnum = phfwdReverse(pf, BENCH_NUMBER);
+        if (pnum == NULL) {
+            result = false;
+        } else if (round == 0) {
+            const char *num;
+            for (count = 0; (num = phnumGet(pnum, count)) != NULL; count++) {
+                sum += strlen(num);
+            }
+        }
+        phnumDelete(pnum);
+    }
+    double time = benchNow() - start;
+
+    if (result) {
+        printf("k = %6zu: %10.2f us/zapytanie (%zu numerów, suma %zu)\n",
+               fanIn, time * 1e6 / (double) rounds, count, sum);
+    }
+    phfwdDelete(pf);
+    return result;
+}
+
+/**
+ * @brief Funkcja main programu mierzącego phfwdReverse.
+ * @param[in] argc - liczba argumentów.
+ * @param[in] argv - argumenty.
+ * @return 0 w przypadku sukcesu, 1 w przypadku błędu.
+ */
+int main(int argc, char *argv[]) {
+    size_t howMany = sizeof(benchDefaultFanIns) / sizeof(size_t), i;
+    if (argc > 1) {
+        howMany = (size_t) argc - 1;
+    }
+    for (i = 0; i < howMany; i++) {
+        size_t fanIn = argc > 1 ? 0 : benchDefaultFanIns[i];
+        if (argc > 1 && !benchParseCount(argv[i + 1], &fanIn)) {
+            fprintf(stderr, "Użycie: %s [k...]\n", argv[0]);
+            return 1;
+        }
+        if (!benchFanIn(fanIn)) {
+            fprintf(stderr, "Brak pamięci\n");
+            return 1;
+        }
+    }
+    return 0;
+}
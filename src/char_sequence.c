@@ -142,17 +142,40 @@ static void charSequenceInitNewNode(CharSequence node, char *letters) {
     }
 }
 
+/**
+ * @brief Przydziela z puli miejsce na litery bloku.
+ * @param[in] length - liczba liter (bez kończącego '\0').
+ * @param[in, out] pool - wskaźnik na pulę.
+ * @return Wskaźnik na miejsce na @p length liter i znak '\0',
+ *         w przypadku problemów z pamięcią NULL.
+ */
+static char *charSequenceAllocLetters(size_t length, MemoryPool pool) {
+    return memoryPoolAlloc(pool, sizeof(char) * (length + (size_t) 1));
+}
+
+/**
+ * @brief Zwraca do puli miejsce na litery bloku.
+ * @param[in] letters - wskaźnik na litery.
+ * @param[in] length - liczba liter podana przy przydziale.
+ * @param[in, out] pool - wskaźnik na pulę.
+ */
+static void charSequenceFreeLetters(char *letters, size_t length,
+                                    MemoryPool pool) {
+    memoryPoolFree(pool, letters, sizeof(char) * (length + (size_t) 1));
+}
+
 /**
  * @brief Usuwa węzeł.
  * @param[in, out] node - wskaźnik na węzeł.
+ * @param[in, out] pool - pula z której przydzielono węzeł.
  */
-static void charSequenceDeleteNode(CharSequence node) {
+static void charSequenceDeleteNode(CharSequence node, MemoryPool pool) {
     assert(node != NULL);
     if (node->letters != NULL) {
-        free(node->letters);
+        charSequenceFreeLetters(node->letters, strlen(node->letters), pool);
         node->letters = NULL;
     }
-    free(node);
+    memoryPoolFree(pool, node, sizeof(struct CharSequence));
 }
 
 CharSequenceIterator charSequenceGetIterator(CharSequence sequence) {
@@ -171,7 +194,7 @@ bool charSequenceIteratorsEqual(CharSequenceIterator *a,
            && a->isEnd == b->isEnd;
 }
 
-void charSequenceMerge(CharSequence a, CharSequence b) {
+void charSequenceMerge(CharSequence a, CharSequence b, MemoryPool pool) {
     assert(a != NULL);
     assert(b != NULL);
     CharSequence ptr = a;
@@ -184,13 +207,15 @@ void charSequenceMerge(CharSequence a, CharSequence b) {
     size_t rightLen = strlen(b->letters);
 
     if (leftLen + rightLen < CHAR_SEQUENCE_MAX_LETTERS_IN_BLOCK) {
-        char *txt = concatenate(ptr->letters, b->letters);
+        char *txt = charSequenceAllocLetters(leftLen + rightLen, pool);
         if (txt != NULL) {
-            free(ptr->letters);
+            copyText(ptr->letters, txt, leftLen);
+            copyText(b->letters, txt + leftLen, rightLen);
+            charSequenceFreeLetters(ptr->letters, leftLen, pool);
             ptr->letters = txt;
             ptr->availableDigits |= b->availableDigits;
             ptr->next = b->next;
-            charSequenceDeleteNode(b);
+            charSequenceDeleteNode(b, pool);
         } else {
             ptr->next = b;
         }
@@ -202,7 +227,8 @@ void charSequenceMerge(CharSequence a, CharSequence b) {
 }
 
 CharSequence charSequenceSplitByIterator(CharSequence sequence,
-                                         CharSequenceIterator *it) {
+                                         CharSequenceIterator *it,
+                                         MemoryPool pool) {
     assert(!charSequenceIteratorEnd(it));
 
     if (it->charId == 0) {
@@ -220,15 +246,15 @@ CharSequence charSequenceSplitByIterator(CharSequence sequence,
 
         return result;
     } else {
-        char *textA = malloc(sizeof(char) * (it->charId + (size_t) 1));
+        char *textA = charSequenceAllocLetters(it->charId, pool);
         if (textA == NULL) {
             return NULL;
         } else {
             size_t textLeftLen = strlen(it->sequenceBlockPtr->letters) - it->charId;
-            char *textB = malloc(sizeof(char) * (textLeftLen + (size_t) 1));
+            char *textB = charSequenceAllocLetters(textLeftLen, pool);
 
             if (textB == NULL) {
-                free(textA);
+                charSequenceFreeLetters(textA, it->charId, pool);
                 return NULL;
             } else {
                 copyText(it->sequenceBlockPtr->letters, textA, it->charId);
@@ -236,16 +262,18 @@ CharSequence charSequenceSplitByIterator(CharSequence sequence,
                          textLeftLen);
 
 
-                CharSequence newBlock = malloc(sizeof(struct CharSequence));
+                CharSequence newBlock = memoryPoolAlloc(pool,
+                                                        sizeof(struct CharSequence));
                 if (newBlock == NULL) {
-                    free(textB);
-                    free(textA);
+                    charSequenceFreeLetters(textB, textLeftLen, pool);
+                    charSequenceFreeLetters(textA, it->charId, pool);
                     return NULL;
                 } else {
                     charSequenceInitNewNode(newBlock, textB);
                     newBlock->next = it->sequenceBlockPtr->next;
 
-                    free(it->sequenceBlockPtr->letters);
+                    charSequenceFreeLetters(it->sequenceBlockPtr->letters,
+                                            it->charId + textLeftLen, pool);
                     charSequenceInitNewNode(it->sequenceBlockPtr, textA);
                     it->sequenceBlockPtr->next = NULL;
 
@@ -259,77 +287,63 @@ CharSequence charSequenceSplitByIterator(CharSequence sequence,
     }
 }
 
-void charSequenceDelete(CharSequence node) {
+void charSequenceDelete(CharSequence node, MemoryPool pool) {
     assert(node != NULL);
     CharSequence deletePtr = node, tmp;
     while (deletePtr != NULL) {
         tmp = deletePtr;
         deletePtr = deletePtr->next;
-        charSequenceDeleteNode(tmp);
+        charSequenceDeleteNode(tmp, pool);
     }
 }
 
-/**
- * @brief Funkcja pomocnicza do czyszczenia pamięci dla @p charSequenceFromCString.
- * @param[in] blocks - bloki do wyczyszczenia.
- * @param[in] last - numer ostatniego bloku do wyczyszczenia.
- */
-static void charSequenceFromCStringFreeBlocks(struct CharSequence **blocks,
-                                              size_t last) {
-    size_t i;
-    for (i = 0; i <= last; i++) {
-        if (blocks[i] != NULL) {
-            charSequenceDeleteNode(blocks[i]);
-        }
-    }
-
-    free(blocks);
+CharSequence charSequenceFromCString(const char *str, MemoryPool pool) {
+    return charSequenceFromText(str, strlen(str), pool);
 }
 
-CharSequence charSequenceFromCString(const char *str) {
-    size_t strLength = strlen(str);
+CharSequence charSequenceFromText(const char *str, size_t strLength,
+                                  MemoryPool pool) {
     size_t numberOfBlocks = strLength / CHAR_SEQUENCE_MAX_LETTERS_IN_BLOCK
                             + (strLength % CHAR_SEQUENCE_MAX_LETTERS_IN_BLOCK != 0);
 
-    struct CharSequence **blocks = malloc(sizeof(struct CharSequence *)
-                                          * numberOfBlocks);
-    if (blocks == NULL) {
-        return NULL;
-    } else {
-        size_t i;
-        for (i = 0; i < numberOfBlocks; i++) {
-            blocks[i] = malloc(sizeof(struct CharSequence));
-            if (blocks[i] == NULL) {
-                charSequenceFromCStringFreeBlocks(blocks, i);
-                return NULL;
-            } else {
-                charSequenceInitNewNode(blocks[i], NULL);
-                if (i > 0) {
-                    blocks[i - 1]->next = blocks[i];
-                }
-
-                size_t toAddSize
-                        = MIN(CHAR_SEQUENCE_MAX_LETTERS_IN_BLOCK,
-                              strLength - i * CHAR_SEQUENCE_MAX_LETTERS_IN_BLOCK);
+    CharSequence result = NULL;
+    CharSequence last = NULL;
+    size_t i;
+    for (i = 0; i < numberOfBlocks; i++) {
+        CharSequence block = memoryPoolAlloc(pool, sizeof(struct CharSequence));
+        if (block == NULL) {
+            if (result != NULL) {
+                charSequenceDelete(result, pool);
+            }
+            return NULL;
+        } else {
+            size_t toAddSize
+                    = MIN(CHAR_SEQUENCE_MAX_LETTERS_IN_BLOCK,
+                          strLength - i * CHAR_SEQUENCE_MAX_LETTERS_IN_BLOCK);
 
-                blocks[i]->letters = malloc(sizeof(char)
-                                            * (toAddSize + (size_t) 1));
+            char *letters = charSequenceAllocLetters(toAddSize, pool);
 
-                if (blocks[i]->letters == NULL) {
-                    charSequenceFromCStringFreeBlocks(blocks, i);
-                    return NULL;
+            if (letters == NULL) {
+                memoryPoolFree(pool, block, sizeof(struct CharSequence));
+                if (result != NULL) {
+                    charSequenceDelete(result, pool);
+                }
+                return NULL;
+            } else {
+                copyText(str + i * CHAR_SEQUENCE_MAX_LETTERS_IN_BLOCK,
+                         letters, toAddSize);
+                charSequenceInitNewNode(block, letters);
+                if (last != NULL) {
+                    last->next = block;
                 } else {
-                    copyText(str + i * CHAR_SEQUENCE_MAX_LETTERS_IN_BLOCK,
-                             blocks[i]->letters, toAddSize);
-                    charSequenceInitNewNode(blocks[i], blocks[i]->letters);
+                    result = block;
                 }
+                last = block;
             }
         }
     }
-    CharSequence result = *blocks;
-    free(blocks);
-    return result;
 
+    return result;
 }
 
 bool charSequenceNextChar(CharSequenceIterator *it, char *ch) {
@@ -11,6 +11,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include "memory_pool.h"
 
 /**
  * @see struct CharSequenceIterator
@@ -70,35 +71,51 @@ bool charSequenceIteratorsEqual(CharSequenceIterator *a,
  * ciąg @p b przestaje istnieć.
  * @param[in, out] a - wskaźnik na ciąg, aktualny po operacji.
  * @param[in, out] b - wskaźnik na ciąg, nieaktualny po operacji.
+ * @param[in, out] pool - pula z której przydzielono oba ciągi.
  */
-void charSequenceMerge(CharSequence a, CharSequence b);
+void charSequenceMerge(CharSequence a, CharSequence b, MemoryPool pool);
 
 /**
  * @brief Tnie Ciąg @p sequence w punkcie @p it.
  * @param[in, out] sequence - wskaźnik na cięty ciąg, po operacji
  *       odpowiada ciągowi [sequence; it).
  * @param[in, out] it - wskaźnik na punkt rozcięcia.
+ * @param[in, out] pool - pula z której przydzielono ciąg.
  * @return Wskaźnik na ciąg [it; ..],
  *         w przypadku problemów z pamięcią NULL.
  * @remarks Zakłada, że punkt przecięcia generuje dwa niepuste ciągi.
  */
 CharSequence charSequenceSplitByIterator(CharSequence sequence,
-                                         CharSequenceIterator *it);
+                                         CharSequenceIterator *it,
+                                         MemoryPool pool);
 
 /**
  * @brief Tworzy ciąg znaków z cstringa.
  * @param[in] str - ciąg znaków w stylu c.
+ * @param[in, out] pool - pula z której zostanie przydzielony ciąg.
  * @return Wskaźnik na strukturę reprezentującą ciąg znaków,
  *         w przypadku problemów z pamięcią NULL.
  */
-CharSequence charSequenceFromCString(const char *str);
+CharSequence charSequenceFromCString(const char *str, MemoryPool pool);
+
+/**
+ * @brief Tworzy ciąg znaków z pierwszych @p strLength znaków @p str.
+ * @param[in] str - wskaźnik na znaki (nie muszą być zakończone '\0').
+ * @param[in] strLength - liczba znaków.
+ * @param[in, out] pool - pula z której zostanie przydzielony ciąg.
+ * @return Wskaźnik na strukturę reprezentującą ciąg znaków,
+ *         w przypadku problemów z pamięcią NULL.
+ */
+CharSequence charSequenceFromText(const char *str, size_t strLength,
+                                  MemoryPool pool);
 
 /**
  * @brief Usuwa ciąg znaków.
  * @remarks node musi być wskaźnikiem na początek ciągu znaków.
  * @param[in] node - wskaźnik na początek ciągu znaków.
+ * @param[in, out] pool - pula z której przydzielono ciąg.
  */
-void charSequenceDelete(CharSequence node);
+void charSequenceDelete(CharSequence node, MemoryPool pool);
 
 /**
  * @brief Pobiera znak.
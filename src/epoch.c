@@ -0,0 +1,236 @@
+/** @file
+ * Implementacja odroczonego zwalniania pamięci opartego na epokach.
+ *
+ * Czytelnik wchodzący w epoce e zwiększa licznik o numerze e mod 2.
+ * Przejście z epoki e do e + 1 jest możliwe, gdy licznik o numerze
+ * (e + 1) mod 2 (czyli czytelników epoki e - 1) jest równy zero.
+ * Obiekt odrzucony w epoce e mogą widzieć tylko czytelnicy epok e - 1
+ * oraz e, więc może zostać zwolniony po przejściu do epoki e + 2.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "epoch.h"
+
+/**
+ * @brief Liczba list obiektów oczekujących na zwolnienie.
+ * Obiekty odrzucone w epoce e trafiają na listę o numerze
+ * e mod EPOCH_NUMBER_OF_LISTS.
+ */
+#define EPOCH_NUMBER_OF_LISTS 3
+
+/**
+ * @brief Rozmiar linii pamięci podręcznej w bajtach.
+ * @see EpochCounter
+ */
+#define EPOCH_CACHE_LINE_SIZE 64
+
+/**
+ * @brief Opis obiektu oczekującego na zwolnienie.
+ */
+struct EpochRetired {
+    /**
+     * @brief Wskaźnik na obiekt.
+     */
+    void *ptr;
+
+    /**
+     * @brief Funkcja zwalniająca obiekt.
+     */
+    void (*f)(void *, void *);
+
+    /**
+     * @brief Dane pomocnicze do funkcji zwalniającej.
+     */
+    void *fData;
+
+    /**
+     * @brief Następny obiekt odrzucony w tej samej epoce.
+     */
+    struct EpochRetired *next;
+};
+
+/**
+ * @brief Licznik czytelników przebywających w epokach danej parzystości.
+ * Każdy licznik zajmuje osobną linię pamięci podręcznej, aby czytelnicy
+ * różnych epok nie unieważniali sobie nawzajem pamięci podręcznej.
+ */
+struct EpochCounter {
+    /**
+     * @brief Liczba czytelników.
+     */
+    atomic_size_t readers;
+
+    /**
+     * @brief Wypełnienie do rozmiaru linii pamięci podręcznej.
+     */
+    char padding[EPOCH_CACHE_LINE_SIZE - sizeof(atomic_size_t)];
+};
+
+/**
+ * @brief Struktura przechowująca bieżącą epokę, liczniki czytelników
+ * i obiekty oczekujące na zwolnienie.
+ */
+struct Epoch {
+    /**
+     * @brief Liczniki czytelników epok parzystych i nieparzystych.
+     */
+    struct EpochCounter counters[2];
+
+    /**
+     * @brief Numer bieżącej epoki.
+     */
+    atomic_size_t current;
+
+    /**
+     * @brief Pula z której przydzielane są opisy obiektów.
+     */
+    MemoryPool pool;
+
+    /**
+     * @brief Listy obiektów oczekujących na zwolnienie.
+     * @see EPOCH_NUMBER_OF_LISTS
+     */
+    struct EpochRetired *retired[EPOCH_NUMBER_OF_LISTS];
+};
+
+Epoch epochCreate(MemoryPool pool) {
+    Epoch epoch = malloc(sizeof(struct Epoch));
+    if (epoch == NULL) {
+        return NULL;
+    } else {
+        atomic_init(&epoch->counters[0].readers, 0);
+        atomic_init(&epoch->counters[1].readers, 0);
+        atomic_init(&epoch->current, 0);
+        epoch->pool = pool;
+        size_t i;
+        for (i = 0; i < EPOCH_NUMBER_OF_LISTS; i++) {
+            epoch->retired[i] = NULL;
+        }
+        return epoch;
+    }
+}
+
+/**
+ * @brief Zwalnia obiekty z listy @p epoch->retired[@p list].
+ * @param[in, out] epoch - wskaźnik na strukturę epok.
+ * @param[in] list - numer listy.
+ */
+static void epochFreeList(Epoch epoch, size_t list) {
+    struct EpochRetired *pos = epoch->retired[list], *next;
+    epoch->retired[list] = NULL;
+    while (pos != NULL) {
+        next = pos->next;
+        pos->f(pos->ptr, pos->fData);
+        memoryPoolFree(epoch->pool, pos, sizeof(struct EpochRetired));
+        pos = next;
+    }
+}
+
+void epochDestroy(Epoch epoch) {
+    if (epoch == NULL) {
+        return;
+    } else {
+        size_t i;
+        for (i = 0; i < EPOCH_NUMBER_OF_LISTS; i++) {
+            epochFreeList(epoch, i);
+        }
+        free(epoch);
+    }
+}
+
+size_t epochEnter(Epoch epoch) {
+    if (epoch == NULL) {
+        return 0;
+    }
+
+    size_t ticket;
+    bool entered = false;
+    do {
+        ticket = atomic_load(&epoch->current);
+        atomic_fetch_add(&epoch->counters[ticket % 2].readers, 1);
+        if (atomic_load(&epoch->current) == ticket) {
+            entered = true;
+        } else {
+            atomic_fetch_sub(&epoch->counters[ticket % 2].readers, 1);
+        }
+    } while (!entered);
+    return ticket;
+}
+
+void epochLeave(Epoch epoch, size_t ticket) {
+    if (epoch != NULL) {
+        atomic_fetch_sub_explicit(&epoch->counters[ticket % 2].readers, 1,
+                                  memory_order_release);
+    }
+}
+
+/**
+ * @brief Przechodzi do następnej epoki, jeżeli jest to możliwe.
+ * @see epochCollect
+ * @param[in, out] epoch - wskaźnik na strukturę epok.
+ * @return true jeżeli rozpoczęto nową epokę, false w przeciwnym przypadku.
+ */
+static bool epochTryAdvance(Epoch epoch) {
+    size_t current = atomic_load(&epoch->current);
+    if (atomic_load(&epoch->counters[(current + 1) % 2].readers) != 0) {
+        return false;
+    } else {
+        atomic_store(&epoch->current, current + 1);
+        epochFreeList(epoch, (current + 2) % EPOCH_NUMBER_OF_LISTS);
+        return true;
+    }
+}
+
+/**
+ * @brief Czeka aż zostaną zwolnione wszystkie odrzucone obiekty.
+ * Dwukrotnie przechodzi do następnej epoki, w razie potrzeby czekając
+ * na opuszczenie poprzedniej epoki przez czytelników.
+ * @param[in, out] epoch - wskaźnik na strukturę epok.
+ */
+static void epochSynchronize(Epoch epoch) {
+    size_t i;
+    for (i = 0; i < 2; i++) {
+        while (!epochTryAdvance(epoch)) {
+            sched_yield();
+        }
+    }
+}
+
+void epochRetire(Epoch epoch, void *ptr, void (*f)(void *, void *),
+                 void *fData) {
+    if (epoch == NULL) {
+        f(ptr, fData);
+        return;
+    }
+
+    struct EpochRetired *retired = memoryPoolAlloc(epoch->pool,
+                                                   sizeof(struct EpochRetired));
+    if (retired == NULL) {
+        epochSynchronize(epoch);
+        f(ptr, fData);
+    } else {
+        size_t list = atomic_load_explicit(&epoch->current,
+                                           memory_order_relaxed)
+                      % EPOCH_NUMBER_OF_LISTS;
+        retired->ptr = ptr;
+        retired->f = f;
+        retired->fData = fData;
+        retired->next = epoch->retired[list];
+        epoch->retired[list] = retired;
+    }
+}
+
+void epochCollect(Epoch epoch) {
+    if (epoch != NULL) {
+        epochTryAdvance(epoch);
+    }
+}
@@ -0,0 +1,108 @@
+/** @file
+ * Interfejs odroczonego zwalniania pamięci opartego na epokach.
+ * Czytelnicy przed odczytem struktury wchodzą do bieżącej epoki,
+ * a po jego zakończeniu ją opuszczają. Pisarz zamiast zwalniać obiekty
+ * odłączone od struktury przekazuje je do @ref epochRetire, a obiekty
+ * te są zwalniane dopiero gdy żaden czytelnik, który mógł je widzieć,
+ * nie pozostaje w swojej epoce. Czytelnicy nigdy nie czekają na pisarza.
+ *
+ * Funkcje pisarza (@ref epochRetire, @ref epochCollect, @ref epochDestroy)
+ * nie mogą być wykonywane jednocześnie przez kilka wątków.
+ * Wszystkie funkcje akceptują NULL w miejsce epoki, wtedy obiekty są
+ * zwalniane natychmiast.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#ifndef TELEFONY_EPOCH_H
+#define TELEFONY_EPOCH_H
+
+#include <stddef.h>
+#include "memory_pool.h"
+
+/**
+ * @brief Wskaźnik na strukturę epok.
+ * @see struct Epoch
+ */
+typedef struct Epoch *Epoch;
+
+/**
+ * @brief Struktura przechowująca bieżącą epokę, liczniki czytelników
+ * i obiekty oczekujące na zwolnienie.
+ */
+struct Epoch;
+
+/**
+ * @brief Tworzy nową strukturę epok.
+ * #### Złożoność
+ * O(1)
+ * @param[in, out] pool - pula z której będą przydzielane opisy obiektów
+ *        oczekujących na zwolnienie.
+ * @return Wskaźnik na nową strukturę, w przypadku problemów
+ *         z pamięcią NULL.
+ */
+Epoch epochCreate(MemoryPool pool);
+
+/**
+ * @brief Usuwa strukturę epok.
+ * Zwalnia wszystkie obiekty oczekujące na zwolnienie.
+ * @remarks Zakłada, że żaden czytelnik nie przebywa w epoce oraz że pula
+ *          podana przy tworzeniu nie została jeszcze usunięta.
+ * #### Złożoność
+ * O(liczba oczekujących obiektów)
+ * @param[in] epoch - wskaźnik na strukturę epok.
+ */
+void epochDestroy(Epoch epoch);
+
+/**
+ * @brief Rozpoczyna odczyt.
+ * Obiekty osiągalne w strukturze w chwili wejścia nie zostaną zwolnione
+ * przed wywołaniem @ref epochLeave z otrzymanym biletem.
+ * Nie czeka na pisarza.
+ * #### Złożoność
+ * O(1)
+ * @param[in, out] epoch - wskaźnik na strukturę epok.
+ * @return Bilet do przekazania @ref epochLeave.
+ */
+size_t epochEnter(Epoch epoch);
+
+/**
+ * @brief Kończy odczyt rozpoczęty przez @ref epochEnter.
+ * #### Złożoność
+ * O(1)
+ * @param[in, out] epoch - wskaźnik na strukturę epok.
+ * @param[in] ticket - bilet zwrócony przez @ref epochEnter.
+ */
+void epochLeave(Epoch epoch, size_t ticket);
+
+/**
+ * @brief Odracza zwolnienie obiektu.
+ * Obiekt musi być już nieosiągalny dla nowych czytelników. Zostanie
+ * zwolniony wywołaniem f(@p ptr, @p fData) gdy opuszczą swoje epoki
+ * wszyscy czytelnicy, którzy mogli go widzieć.
+ * W przypadku problemów z pamięcią czeka na zakończenie bieżących odczytów
+ * i zwalnia obiekt od razu.
+ * #### Złożoność
+ * O(1), w przypadku problemów z pamięcią O(liczba oczekujących obiektów)
+ * @param[in, out] epoch - wskaźnik na strukturę epok.
+ * @param[in] ptr - wskaźnik na obiekt.
+ * @param[in] f - wskaźnik na funkcję zwalniającą.
+ * @param fData - dane pomocnicze do funkcji zwalniającej.
+ */
+void epochRetire(Epoch epoch, void *ptr, void (*f)(void *, void *),
+                 void *fData);
+
+/**
+ * @brief Próbuje przejść do następnej epoki.
+ * Jeżeli wszyscy czytelnicy poprzedniej epoki ją opuścili, rozpoczyna
+ * nową epokę i zwalnia obiekty, których nie może już widzieć żaden
+ * czytelnik. Nie czeka na czytelników.
+ * #### Złożoność
+ * O(liczba zwalnianych obiektów)
+ * @param[in, out] epoch - wskaźnik na strukturę epok.
+ */
+void epochCollect(Epoch epoch);
+
+#endif //TELEFONY_EPOCH_H
@@ -0,0 +1,617 @@
+/** @file
+ * Implementacja zwartej postaci skompresowanego drzewa TRIE.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "flat_tree.h"
+#include "character.h"
+
+/**
+ * @brief Maksymalna długość numeru na krawędzi przechowywanego
+ * bezpośrednio w węźle.
+ */
+#define FLAT_TREE_INLINE_TXT_LENGTH 16
+
+/**
+ * @brief Liczba bitów przeznaczonych na jeden znak spakowanego numeru.
+ */
+#define FLAT_TREE_PACKED_CHAR_BITS 4
+
+/**
+ * @brief Maska wycinająca jeden znak spakowanego numeru.
+ */
+#define FLAT_TREE_PACKED_CHAR_MASK ((uint64_t) 0xF)
+
+/**
+ * @brief Początkowy rozmiar kolejki węzłów w @ref flatTreeCreate.
+ */
+#define FLAT_TREE_INITIAL_QUEUE_SIZE 64
+
+/**
+ * @brief Wyrównanie (w bajtach) obrazu zwartej postaci drzewa.
+ * @see flatTreeSave
+ */
+#define FLAT_TREE_IMAGE_ALIGNMENT 8
+
+/**
+ * @brief Węzeł zwartej postaci drzewa.
+ */
+struct FlatTreeNode {
+    /**
+     * @brief Numer krawędzi wchodzącej do węzła.
+     * Spakowany (znak o indeksie i zajmuje bity od
+     * FLAT_TREE_PACKED_CHAR_BITS * i i ma wartość kod_ascii - '0'), jeżeli
+     * jego długość nie przekracza FLAT_TREE_INLINE_TXT_LENGTH,
+     * w przeciwnym przypadku pozycja numeru w FlatTree->chars.
+     */
+    uint64_t txt;
+
+    /**
+     * @brief Długość numeru na krawędzi wchodzącej do węzła.
+     */
+    uint32_t txtLength;
+
+    /**
+     * @brief Pozycja pierwszego syna w FlatTree->nodes.
+     */
+    uint32_t firstSon;
+
+    /**
+     * @brief Wartość najgłębszego węzła na ścieżce od korzenia do tego
+     * węzła (włącznie), któremu przypisano wartość,
+     * FLAT_TREE_NO_VALUE w przypadku braku.
+     */
+    uint32_t value;
+
+    /**
+     * @brief Maska synów, bit i jest zapalony jeżeli węzeł ma syna o numerze i.
+     */
+    uint32_t sons;
+};
+
+/**
+ * @brief Struktura reprezentująca zwartą postać drzewa.
+ */
+struct FlatTree {
+    /**
+     * @brief Węzły w kolejności przeszukiwania wszerz, korzeń na pozycji 0.
+     */
+    struct FlatTreeNode *nodes;
+
+    /**
+     * @brief Numery krawędzi dłuższe niż FLAT_TREE_INLINE_TXT_LENGTH.
+     */
+    char *chars;
+
+    /**
+     * @brief Liczba węzłów.
+     */
+    size_t howManyNodes;
+
+    /**
+     * @brief Łączna długość numerów w @p chars.
+     */
+    size_t howManyChars;
+
+    /**
+     * @brief Czy tablice @p nodes i @p chars należą do struktury
+     * (false dla widoku obrazu utworzonego przez @ref flatTreeView).
+     */
+    bool owned;
+};
+
+/**
+ * @brief Nagłówek obrazu zwartej postaci drzewa.
+ * Za nagłówkiem znajdują się węzły, a za nimi numery krawędzi
+ * dopełnione do wielokrotności FLAT_TREE_IMAGE_ALIGNMENT bajtów.
+ */
+struct FlatTreeImageHeader {
+    /**
+     * @brief Liczba węzłów.
+     */
+    uint64_t howManyNodes;
+
+    /**
+     * @brief Łączna długość numerów krawędzi przechowywanych poza węzłami.
+     */
+    uint64_t howManyChars;
+};
+
+/**
+ * @brief Liczba zapalonych bitów.
+ * @param[in] x - liczba.
+ * @return Liczba zapalonych bitów w @p x.
+ */
+static uint32_t flatTreePopCount(uint32_t x) {
+    x = x - ((x >> 1) & 0x55555555u);
+    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+    x = (x + (x >> 4)) & 0x0F0F0F0Fu;
+    return (x * 0x01010101u) >> 24;
+}
+
+/**
+ * @brief Ustawia w kolejce kolejność przeszukiwania wszerz węzłów drzewa.
+ * @param[in] tree - wskaźnik na drzewo.
+ * @param[out] queue - @p *queue po udanym wykonaniu wskazuje na tablicę
+ *        węzłów w kolejności przeszukiwania wszerz (do zwolnienia przez free).
+ * @param[out] howManyNodes - liczba węzłów drzewa.
+ * @param[out] howManyChars - łączna długość numerów krawędzi dłuższych niż
+ *        FLAT_TREE_INLINE_TXT_LENGTH.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią
+ *         lub zbyt dużego drzewa.
+ */
+static bool flatTreeOrder(RadixTree tree, RadixTreeNode **queue,
+                          size_t *howManyNodes, size_t *howManyChars) {
+    size_t capacity = FLAT_TREE_INITIAL_QUEUE_SIZE;
+    size_t size = 1, i, j;
+    RadixTreeNode son;
+
+    *queue = malloc(capacity * sizeof(RadixTreeNode));
+    if (*queue == NULL) {
+        return false;
+    }
+    (*queue)[0] = tree;
+    *howManyChars = 0;
+
+    for (i = 0; i < size; i++) {
+        if (radixTreeHowManyChars((*queue)[i]) > FLAT_TREE_INLINE_TXT_LENGTH) {
+            *howManyChars += radixTreeHowManyChars((*queue)[i]);
+        }
+        for (j = 0; j < RADIX_TREE_NUMBER_OF_SONS; j++) {
+            son = radixTreeSon((*queue)[i], j);
+            if (son == NULL) {
+                continue;
+            }
+            if (size == capacity) {
+                RadixTreeNode *grown = NULL;
+                if (capacity < FLAT_TREE_NO_VALUE / 2) {
+                    grown = realloc(*queue, 2 * capacity
+                                            * sizeof(RadixTreeNode));
+                }
+                if (grown == NULL) {
+                    free(*queue);
+                    return false;
+                }
+                *queue = grown;
+                capacity *= 2;
+            }
+            (*queue)[size] = son;
+            size++;
+        }
+    }
+
+    *howManyNodes = size;
+    return *howManyChars < FLAT_TREE_NO_VALUE;
+}
+
+/**
+ * @brief Zapisuje numer krawędzi wchodzącej do @p node w węźle @p flat.
+ * @param[in, out] tree - wskaźnik na tworzoną zwartą postać drzewa.
+ * @param[out] flat - wskaźnik na węzeł zwartej postaci.
+ * @param[in] node - wskaźnik na węzeł drzewa.
+ * @param[in, out] charsUsed - liczba zajętych znaków @p tree->chars.
+ */
+static void flatTreeSetTxt(FlatTree tree, struct FlatTreeNode *flat,
+                           RadixTreeNode node, size_t *charsUsed) {
+    size_t length = radixTreeHowManyChars(node);
+    flat->txtLength = (uint32_t) length;
+    if (length <= FLAT_TREE_INLINE_TXT_LENGTH) {
+        char buffer[FLAT_TREE_INLINE_TXT_LENGTH];
+        radixTreeCopyTxt(node, buffer);
+        flat->txt = 0;
+        size_t i;
+        for (i = length; i != 0; i--) {
+            flat->txt <<= FLAT_TREE_PACKED_CHAR_BITS;
+            flat->txt |= (uint64_t) (buffer[i - 1] - '0');
+        }
+    } else {
+        flat->txt = *charsUsed;
+        radixTreeCopyTxt(node, tree->chars + *charsUsed);
+        *charsUsed += length;
+    }
+}
+
+FlatTree flatTreeCreate(RadixTree tree, uint32_t (*f)(void *, void *),
+                        void *fData) {
+    RadixTreeNode *queue;
+    size_t howManyNodes, howManyChars;
+    if (!flatTreeOrder(tree, &queue, &howManyNodes, &howManyChars)) {
+        return NULL;
+    }
+
+    FlatTree result = malloc(sizeof(struct FlatTree));
+    if (result == NULL) {
+        free(queue);
+        return NULL;
+    }
+    result->howManyNodes = howManyNodes;
+    result->howManyChars = howManyChars;
+    result->owned = true;
+    result->nodes = malloc(howManyNodes * sizeof(struct FlatTreeNode));
+    result->chars = malloc(howManyChars + (size_t) 1);
+    if (result->nodes == NULL || result->chars == NULL) {
+        free(queue);
+        flatTreeDelete(result);
+        return NULL;
+    }
+
+    size_t i, j, next = 1, charsUsed = 0;
+    struct FlatTreeNode *flat;
+    void *data;
+    result->nodes[0].value = FLAT_TREE_NO_VALUE;
+    for (i = 0; i < howManyNodes; i++) {
+        flat = &result->nodes[i];
+        flatTreeSetTxt(result, flat, queue[i], &charsUsed);
+        data = radixTreeGetNodeData(queue[i]);
+        if (data != NULL) {
+            flat->value = f(data, fData);
+            assert(flat->value != FLAT_TREE_NO_VALUE);
+        }
+
+        flat->firstSon = (uint32_t) next;
+        flat->sons = 0;
+        for (j = 0; j < RADIX_TREE_NUMBER_OF_SONS; j++) {
+            if (radixTreeSon(queue[i], j) != NULL) {
+                assert(queue[next] == radixTreeSon(queue[i], j));
+                flat->sons |= (uint32_t) 1 << j;
+                result->nodes[next].value = flat->value;
+                next++;
+            }
+        }
+    }
+    assert(next == howManyNodes && charsUsed == howManyChars);
+
+    free(queue);
+    return result;
+}
+
+void flatTreeDelete(FlatTree tree) {
+    if (tree != NULL) {
+        if (tree->owned) {
+            free(tree->nodes);
+            free(tree->chars);
+        }
+        free(tree);
+    }
+}
+
+/**
+ * @brief Zaokrągla rozmiar w górę do FLAT_TREE_IMAGE_ALIGNMENT.
+ * @param[in] size - rozmiar w bajtach.
+ * @return Najmniejsza wielokrotność FLAT_TREE_IMAGE_ALIGNMENT nie mniejsza
+ *         niż @p size.
+ */
+static size_t flatTreeAlign(size_t size) {
+    return (size + (FLAT_TREE_IMAGE_ALIGNMENT - 1))
+           / FLAT_TREE_IMAGE_ALIGNMENT * FLAT_TREE_IMAGE_ALIGNMENT;
+}
+
+size_t flatTreeSave(FlatTree tree, FILE *file) {
+    struct FlatTreeImageHeader header;
+    header.howManyNodes = tree->howManyNodes;
+    header.howManyChars = tree->howManyChars;
+    size_t padding = flatTreeAlign(tree->howManyChars) - tree->howManyChars;
+    const char zeros[FLAT_TREE_IMAGE_ALIGNMENT] = {0};
+
+    if (fwrite(&header, sizeof(header), 1, file) != 1
+        || fwrite(tree->nodes, sizeof(struct FlatTreeNode),
+                  tree->howManyNodes, file) != tree->howManyNodes
+        || fwrite(tree->chars, 1, tree->howManyChars, file)
+           != tree->howManyChars
+        || fwrite(zeros, 1, padding, file) != padding) {
+        return 0;
+    } else {
+        return sizeof(header)
+               + tree->howManyNodes * sizeof(struct FlatTreeNode)
+               + tree->howManyChars + padding;
+    }
+}
+
+FlatTree flatTreeView(const void *image, size_t size, size_t *imageSize) {
+    struct FlatTreeImageHeader header;
+    if (size < sizeof(header)) {
+        return NULL;
+    }
+    header = *(const struct FlatTreeImageHeader *) image;
+    size -= sizeof(header);
+    if (header.howManyNodes == 0 || header.howManyNodes > FLAT_TREE_NO_VALUE
+        || header.howManyNodes > size / sizeof(struct FlatTreeNode)) {
+        return NULL;
+    }
+    size -= (size_t) header.howManyNodes * sizeof(struct FlatTreeNode);
+    if (header.howManyChars >= FLAT_TREE_NO_VALUE
+        || flatTreeAlign((size_t) header.howManyChars) > size) {
+        return NULL;
+    }
+
+    FlatTree result = malloc(sizeof(struct FlatTree));
+    if (result == NULL) {
+        return NULL;
+    } else {
+        result->howManyNodes = (size_t) header.howManyNodes;
+        result->howManyChars = (size_t) header.howManyChars;
+        result->owned = false;
+        result->nodes = (struct FlatTreeNode *) ((const char *) image
+                                                 + sizeof(header));
+        result->chars = (char *) (result->nodes + result->howManyNodes);
+        *imageSize = sizeof(header)
+                     + result->howManyNodes * sizeof(struct FlatTreeNode)
+                     + flatTreeAlign(result->howManyChars);
+        return result;
+    }
+}
+
+/**
+ * @brief Sprawdza numer na krawędzi wchodzącej do węzła obrazu.
+ * @param[in] tree - wskaźnik na zwartą postać drzewa.
+ * @param[in] node - wskaźnik na węzeł.
+ * @return true jeżeli numer mieści się w FlatTree->chars i składa się
+ *         z cyfr, false w przeciwnym przypadku.
+ */
+static bool flatTreeTxtValid(FlatTree tree, const struct FlatTreeNode *node) {
+    uint32_t i;
+    if (node->txtLength <= FLAT_TREE_INLINE_TXT_LENGTH) {
+        uint64_t packed = node->txt;
+        for (i = 0; i < node->txtLength; i++) {
+            if ((packed & FLAT_TREE_PACKED_CHAR_MASK)
+                >= RADIX_TREE_NUMBER_OF_SONS) {
+                return false;
+            }
+            packed >>= FLAT_TREE_PACKED_CHAR_BITS;
+        }
+        return true;
+    } else if (node->txt > tree->howManyChars
+               || node->txtLength > tree->howManyChars - node->txt) {
+        return false;
+    } else {
+        const char *chars = tree->chars + node->txt;
+        for (i = 0; i < node->txtLength; i++) {
+            if (!characterIsDigit(chars[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+bool flatTreeValid(FlatTree tree, bool (*f)(uint32_t, size_t, void *),
+                   void *fData) {
+    const uint32_t allSons = ((uint32_t) 1 << RADIX_TREE_NUMBER_OF_SONS) - 1;
+    size_t *lengths = malloc(tree->howManyNodes * sizeof(size_t));
+    size_t next = 1, i, j;
+    bool result = lengths != NULL && tree->nodes[0].txtLength == 0;
+
+    if (result) {
+        lengths[0] = 0;
+        result = tree->nodes[0].value == FLAT_TREE_NO_VALUE
+                 || f(tree->nodes[0].value, 0, fData);
+    }
+    for (i = 0; i < tree->howManyNodes && result; i++) {
+        const struct FlatTreeNode *node = tree->nodes + i;
+        uint32_t howManySons = flatTreePopCount(node->sons);
+        result = (i == 0 || i < next) && node->firstSon == next
+                 && (node->sons & ~allSons) == 0
+                 && howManySons <= tree->howManyNodes - next
+                 && flatTreeTxtValid(tree, node);
+        for (j = next; result && j < next + howManySons; j++) {
+            const struct FlatTreeNode *son = tree->nodes + j;
+            lengths[j] = lengths[i] + son->txtLength;
+            result = son->value == node->value
+                     || son->value == FLAT_TREE_NO_VALUE
+                     || f(son->value, lengths[j], fData);
+        }
+        next += howManySons;
+    }
+
+    free(lengths);
+    return result && next == tree->howManyNodes;
+}
+
+/**
+ * @brief Wyznacza syna węzła odpowiadającego znakowi.
+ * @param[in] tree - wskaźnik na zwartą postać drzewa.
+ * @param[in] node - wskaźnik na węzeł.
+ * @param[in] c - znak odpowiadający synowi (patrz RADIX_TREE_NUMBER_OF_SONS).
+ * @return Wskaźnik na syna, NULL jeżeli węzeł nie ma takiego syna.
+ */
+static const struct FlatTreeNode *flatTreeSon(FlatTree tree,
+                                              const struct FlatTreeNode *node,
+                                              char c) {
+    uint32_t bit = (uint32_t) 1 << (c - '0');
+    if ((node->sons & bit) == 0) {
+        return NULL;
+    } else {
+        return tree->nodes + node->firstSon
+               + flatTreePopCount(node->sons & (bit - 1));
+    }
+}
+
+/**
+ * @brief Próbuje dopasować numer krawędzi wchodzącej do @p node.
+ * @param[in] tree - wskaźnik na zwartą postać drzewa.
+ * @param[in] node - wskaźnik na węzeł.
+ * @param[in, out] txt - wskaźnik na dopasowywany tekst, w przypadku pełnego
+ *        dopasowania przesuwany za dopasowany numer.
+ * @return true jeżeli cały numer krawędzi jest prefiksem @p *txt,
+ *         false w przeciwnym przypadku.
+ */
+static bool flatTreeMatch(FlatTree tree, const struct FlatTreeNode *node,
+                          const char **txt) {
+    const char *pos = *txt;
+    uint32_t i;
+    if (node->txtLength <= FLAT_TREE_INLINE_TXT_LENGTH) {
+        uint64_t packed = node->txt;
+        char expected;
+        for (i = 0; i < node->txtLength; i++) {
+            expected = (char) ('0' + (packed & FLAT_TREE_PACKED_CHAR_MASK));
+            if (pos[i] != expected) {
+                return false;
+            }
+            packed >>= FLAT_TREE_PACKED_CHAR_BITS;
+        }
+    } else {
+        const char *chars = tree->chars + node->txt;
+        for (i = 0; i < node->txtLength; i++) {
+            if (pos[i] != chars[i]) {
+                return false;
+            }
+        }
+    }
+    *txt = pos + node->txtLength;
+    return true;
+}
+
+uint32_t flatTreeFind(FlatTree tree, const char *txt) {
+    const struct FlatTreeNode *node = tree->nodes, *son;
+
+    while (*txt != '\0') {
+        son = flatTreeSon(tree, node, *txt);
+        if (son == NULL || !flatTreeMatch(tree, son, &txt)) {
+            break;
+        }
+        node = son;
+    }
+    return node->value;
+}
+
+void flatTreeForEachPrefix(FlatTree tree, const char *txt,
+                           void (*f)(uint32_t, size_t, void *), void *fData) {
+    const struct FlatTreeNode *node = tree->nodes, *son;
+    const char *pos = txt;
+
+    if (node->value != FLAT_TREE_NO_VALUE) {
+        f(node->value, 0, fData);
+    }
+    while (*pos != '\0') {
+        son = flatTreeSon(tree, node, *pos);
+        if (son == NULL || !flatTreeMatch(tree, son, &pos)) {
+            break;
+        }
+        if (son->value != node->value) {
+            f(son->value, (size_t) (pos - txt), fData);
+        }
+        node = son;
+    }
+}
+
+/**
+ * @brief Sprawdza czy numer na krawędzi wchodzącej do @p node
+ * składa się tylko z dostępnych cyfr.
+ * @param[in] tree - wskaźnik na zwartą postać drzewa.
+ * @param[in] node - wskaźnik na węzeł.
+ * @param[in] availableDigits - dostępne cyfry.
+ * @return true jeżeli tak, false w przeciwnym wypadku.
+ */
+static bool flatTreeCheckDigits(FlatTree tree, const struct FlatTreeNode *node,
+                                const bool *availableDigits) {
+    uint32_t i;
+    if (node->txtLength <= FLAT_TREE_INLINE_TXT_LENGTH) {
+        uint64_t packed = node->txt;
+        for (i = 0; i < node->txtLength; i++) {
+            if (!availableDigits[packed & FLAT_TREE_PACKED_CHAR_MASK]) {
+                return false;
+            }
+            packed >>= FLAT_TREE_PACKED_CHAR_BITS;
+        }
+    } else {
+        const char *chars = tree->chars + node->txt;
+        for (i = 0; i < node->txtLength; i++) {
+            if (!availableDigits[chars[i] - '0']) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Liczba numerów długości @p length złożonych z @p howManyDigits
+ * różnych cyfr.
+ * @param[in] length - długość numeru.
+ * @param[in] howManyDigits - liczba dostępnych cyfr.
+ * @return @p howManyDigits do potęgi @p length (modulo 2^w, gdzie w to
+ *         liczba bitów size_t).
+ */
+static size_t flatTreePower(size_t length, size_t howManyDigits) {
+    size_t result = 1;
+    size_t i;
+    for (i = length; i != 0; i >>= 1) {
+        if (i & (size_t) 1) {
+            result *= howManyDigits;
+        }
+        howManyDigits *= howManyDigits;
+    }
+    return result;
+}
+
+/**
+ * @brief Element stosu węzłów w @ref flatTreeNonTrivialCount.
+ */
+struct FlatTreeStackItem {
+    /**
+     * @brief Pozycja węzła w FlatTree->nodes.
+     */
+    uint32_t node;
+
+    /**
+     * @brief Długość numeru reprezentowanego przez węzeł.
+     */
+    size_t length;
+};
+
+size_t flatTreeNonTrivialCount(FlatTree tree, size_t maxLen,
+                               const bool *availableDigits,
+                               size_t howManyDigitsAvailable) {
+    size_t capacity = FLAT_TREE_INITIAL_QUEUE_SIZE, size = 1, result = 0;
+    struct FlatTreeStackItem *stack, item;
+    const struct FlatTreeNode *node, *son;
+    uint32_t i, howManySons;
+
+    assert(maxLen != 0);
+    stack = malloc(capacity * sizeof(struct FlatTreeStackItem));
+    if (stack == NULL) {
+        return 0;
+    }
+    stack[0].node = 0;
+    stack[0].length = 0;
+
+    while (size != 0) {
+        item = stack[--size];
+        node = tree->nodes + item.node;
+        howManySons = flatTreePopCount(node->sons);
+        for (i = 0; i < howManySons; i++) {
+            son = tree->nodes + node->firstSon + i;
+            if (son->txtLength > maxLen - item.length
+                || !flatTreeCheckDigits(tree, son, availableDigits)) {
+                continue;
+            } else if (son->value != node->value) {
+                result += flatTreePower(maxLen - item.length - son->txtLength,
+                                        howManyDigitsAvailable);
+            } else if (item.length + son->txtLength < maxLen) {
+                if (size == capacity) {
+                    struct FlatTreeStackItem *grown =
+                            realloc(stack, 2 * capacity
+                                           * sizeof(struct FlatTreeStackItem));
+                    if (grown == NULL) {
+                        free(stack);
+                        return 0;
+                    }
+                    stack = grown;
+                    capacity *= 2;
+                }
+                stack[size].node = node->firstSon + i;
+                stack[size].length = item.length + son->txtLength;
+                size++;
+            }
+        }
+    }
+
+    free(stack);
+    return result;
+}
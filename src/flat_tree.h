@@ -0,0 +1,158 @@
+/** @file
+ * Interfejs zwartej postaci skompresowanego drzewa TRIE tylko do odczytu.
+ * Węzły są przechowywane w jednej tablicy w kolejności przeszukiwania
+ * wszerz, więc synowie każdego węzła zajmują kolejne pozycje tablicy.
+ * Węzeł pamięta jedynie pozycję pierwszego syna i maskę bitową obecnych
+ * synów, a numery krawędzi nie dłuższe niż FLAT_TREE_INLINE_TXT_LENGTH
+ * są spakowane w węźle. Struktura nie zawiera wskaźników, więc może być
+ * zapisana do pliku (@ref flatTreeSave) i odczytywana bezpośrednio
+ * z odwzorowanego w pamięci obrazu (@ref flatTreeView).
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#ifndef TELEFONY_FLAT_TREE_H
+#define TELEFONY_FLAT_TREE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "radix_tree.h"
+
+/**
+ * @brief Wartość oznaczająca brak danych.
+ * @see flatTreeFind
+ */
+#define FLAT_TREE_NO_VALUE UINT32_MAX
+
+/**
+ * @brief Wskaźnik na zwartą postać drzewa.
+ * @see struct FlatTree
+ */
+typedef struct FlatTree *FlatTree;
+
+/**
+ * @brief Struktura reprezentująca zwartą postać drzewa.
+ */
+struct FlatTree;
+
+/**
+ * @brief Tworzy zwartą postać drzewa @p tree.
+ * Dla każdego węzła z przypisanymi danymi wywołuje
+ * f(wskaźnik_na_dane_przechowywane_przez_węzeł, fData) w kolejności
+ * przeszukiwania wszerz, a zwróconą wartość (różną od FLAT_TREE_NO_VALUE)
+ * zapamiętuje jako wartość węzła.
+ * #### Złożoność
+ * O(liczba węzłów + łączna długość numerów na krawędziach)
+ * @param[in] tree - wskaźnik na drzewo.
+ * @param[in] f - wskaźnik na funkcję wyznaczającą wartość węzła.
+ * @param fData - dane pomocnicze do funkcji @p f.
+ * @return Wskaźnik na zwartą postać drzewa, w przypadku problemów
+ *         z pamięcią NULL.
+ */
+FlatTree flatTreeCreate(RadixTree tree, uint32_t (*f)(void *, void *),
+                        void *fData);
+
+/**
+ * @brief Usuwa zwartą postać drzewa.
+ * @param[in] tree - wskaźnik na zwartą postać drzewa (NULL jest ignorowany).
+ */
+void flatTreeDelete(FlatTree tree);
+
+/**
+ * @brief Zapisuje obraz zwartej postaci drzewa do pliku.
+ * Rozmiar obrazu jest wielokrotnością 8 bajtów, a obraz wymaga
+ * wyrównania do 8 bajtów.
+ * #### Złożoność
+ * O(rozmiar obrazu)
+ * @param[in] tree - wskaźnik na zwartą postać drzewa.
+ * @param[in, out] file - plik do zapisu.
+ * @return Liczba zapisanych bajtów, 0 w przypadku błędu zapisu.
+ */
+size_t flatTreeSave(FlatTree tree, FILE *file);
+
+/**
+ * @brief Tworzy zwartą postać drzewa korzystającą z obrazu w pamięci.
+ * Obraz nie jest kopiowany i musi istnieć do czasu usunięcia zwróconej
+ * struktury. Sprawdzane są jedynie rozmiary zapisane w nagłówku obrazu,
+ * zawartość węzłów sprawdza @ref flatTreeValid.
+ * #### Złożoność
+ * O(1)
+ * @param[in] image - wskaźnik na obraz zapisany przez @ref flatTreeSave,
+ *        wyrównany do 8 bajtów.
+ * @param[in] size - liczba dostępnych bajtów od @p image.
+ * @param[out] imageSize - rozmiar obrazu w bajtach.
+ * @return Wskaźnik na zwartą postać drzewa, NULL w przypadku problemów
+ *         z pamięcią lub niepoprawnego obrazu.
+ */
+FlatTree flatTreeView(const void *image, size_t size, size_t *imageSize);
+
+/**
+ * @brief Sprawdza węzły zwartej postaci drzewa utworzonej przez
+ * @ref flatTreeView.
+ * Sprawdza, czy węzły tworzą drzewo w kolejności przeszukiwania wszerz,
+ * a numery na krawędziach składają się z cyfr i mieszczą się w obrazie.
+ * Dla korzenia i każdego węzła, którego wartość różni się od wartości ojca,
+ * wywołuje f(wartość, długość_numeru_reprezentowanego_przez_węzeł, fData).
+ * #### Złożoność
+ * O(rozmiar obrazu + łączny czas wywołań @p f)
+ * @param[in] tree - wskaźnik na zwartą postać drzewa.
+ * @param[in] f - wskaźnik na funkcję sprawdzającą wartość węzła.
+ * @param fData - dane pomocnicze do funkcji @p f.
+ * @return true jeżeli drzewo jest poprawne, a @p f zwróciła true dla
+ *         wszystkich wartości, false w przeciwnym przypadku lub
+ *         w przypadku problemów z pamięcią.
+ */
+bool flatTreeValid(FlatTree tree, bool (*f)(uint32_t, size_t, void *),
+                   void *fData);
+
+/**
+ * @brief Wyszukuje najdłuższy prefiks @p txt przechowujący wartość.
+ * Funkcja tylko odczytuje strukturę, więc może być wykonywana
+ * współbieżnie przez wiele wątków.
+ * #### Złożoność
+ * O(długość @p txt)
+ * @param[in] tree - wskaźnik na zwartą postać drzewa.
+ * @param[in] txt - wskaźnik na numer złożony ze znaków odpowiadających
+ *        synom węzła drzewa (patrz RADIX_TREE_NUMBER_OF_SONS).
+ * @return Wartość węzła reprezentującego najdłuższy prefiks @p txt, któremu
+ *         przypisano wartość, FLAT_TREE_NO_VALUE jeżeli takiego nie ma.
+ */
+uint32_t flatTreeFind(FlatTree tree, const char *txt);
+
+/**
+ * @brief Przegląda prefiksy @p txt przechowujące wartość.
+ * Dla każdego węzła reprezentującego prefiks @p txt, któremu przypisano
+ * wartość, wywołuje f(wartość, długość_prefiksu, fData) w kolejności
+ * rosnącej długości prefiksu.
+ * #### Złożoność
+ * O(długość @p txt + liczba wywołań @p f)
+ * @param[in] tree - wskaźnik na zwartą postać drzewa.
+ * @param[in] txt - wskaźnik na numer.
+ * @param[in] f - wskaźnik na funkcję.
+ * @param fData - dane pomocnicze do funkcji @p f.
+ */
+void flatTreeForEachPrefix(FlatTree tree, const char *txt,
+                           void (*f)(uint32_t, size_t, void *), void *fData);
+
+/**
+ * @brief Działa jak @ref radixTreeNonTrivialCount dla zwartej postaci.
+ * Liczy numery długości @p maxLen złożone z dostępnych cyfr, których
+ * prefiks jest reprezentowany przez węzeł z przypisaną wartością.
+ * #### Złożoność
+ * O(liczba rozpatrzonych węzłów * długość numeru na krawędzi)
+ * @param[in] tree - wskaźnik na zwartą postać drzewa.
+ * @param[in] maxLen - długość numerów (różna od 0).
+ * @param[in] availableDigits - dostępne cyfry (tablica
+ *        CHARACTER_NUMBER_OF_DIGITS wartości).
+ * @param[in] howManyDigitsAvailable - liczba różnych dostępnych cyfr.
+ * @return Liczba numerów modulo 2^w, gdzie w to liczba bitów size_t,
+ *         0 w przypadku problemów z pamięcią.
+ */
+size_t flatTreeNonTrivialCount(FlatTree tree, size_t maxLen,
+                               const bool *availableDigits,
+                               size_t howManyDigitsAvailable);
+
+#endif //TELEFONY_FLAT_TREE_H
@@ -5,33 +5,165 @@
  * @copyright Konrad Staniszewski
  * @date 25.05.2018
  */
+
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <assert.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
 
 #include "input.h"
 #include "character.h"
 #include "vector.h"
 
+/**
+ * @brief Rozmiar bufora wejścia w bajtach.
+ */
+#define INPUT_BUFFER_SIZE (1 << 18)
+
+/**
+ * @brief Bufor dla wejścia wczytywanego funkcją read.
+ */
+static char inputBufferData[INPUT_BUFFER_SIZE];
+
+/**
+ * @brief Pierwszy niewczytany znak z bufora.
+ */
+static const char *inputBegin = inputBufferData;
+
+/**
+ * @brief Koniec danych w buforze.
+ */
+static const char *inputEnd = inputBufferData;
+
+/**
+ * @brief Odwzorowany w pamięci plik standardowego wejścia (NULL jeżeli brak).
+ */
+static void *inputMapped = NULL;
+
+/**
+ * @brief Rozmiar odwzorowania @ref inputMapped.
+ */
+static size_t inputMappedSize = 0;
+
+/**
+ * @brief Czy sprawdzono możliwość odwzorowania standardowego wejścia.
+ */
+static bool inputMapTried = false;
 
 /**
- * @brief Czy identyfikator końca pliku ustawiony.
- * @return Niezerowa wartość jeżeli tak zerowa w przeciwnym wypadku.
+ * @brief Czy napotkano koniec wejścia.
  */
-static int inputIsStreamEnded() {
-    return feof(stdin);
+static bool inputStreamEnded = false;
+
+/**
+ * @brief Odwzorowuje w pamięci standardowe wejście.
+ * Udaje się jedynie dla zwykłego pliku. Dane są udostępniane od bieżącej
+ * pozycji w pliku, a pozycja w pliku jest przesuwana na koniec
+ * odwzorowania, więc po jego przetworzeniu wczytywanie może być
+ * kontynuowane funkcją read (np. jeżeli plik urósł).
+ * @return true jeżeli udało się odwzorować niepusty fragment pliku,
+ *         false w przeciwnym przypadku.
+ */
+static bool inputTryMap() {
+    inputMapTried = true;
+
+    struct stat status;
+    if (fstat(STDIN_FILENO, &status) != 0 || !S_ISREG(status.st_mode)
+        || (uintmax_t) status.st_size > SIZE_MAX) {
+        return false;
+    }
+    off_t offset = lseek(STDIN_FILENO, 0, SEEK_CUR);
+    if (offset < 0 || offset >= status.st_size) {
+        return false;
+    }
+
+    size_t size = (size_t) status.st_size;
+    void *mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, STDIN_FILENO, 0);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    if (lseek(STDIN_FILENO, status.st_size, SEEK_SET) < 0) {
+        munmap(mapped, size);
+        return false;
+    }
+    posix_madvise(mapped, size, POSIX_MADV_SEQUENTIAL);
+
+    inputMapped = mapped;
+    inputMappedSize = size;
+    inputBegin = (const char *) mapped + offset;
+    inputEnd = (const char *) mapped + size;
+    return true;
 }
 
-int inputPeekCharacter() {
-    int characterCode = getc(stdin);
+/**
+ * @brief Uzupełnia pusty bufor.
+ * Przy pierwszym wywołaniu próbuje odwzorować standardowe wejście
+ * w pamięci, w pozostałych przypadkach wczytuje kolejny blok funkcją read.
+ * @return true jeżeli w buforze są nowe dane, false jeżeli napotkano
+ *         koniec wejścia lub błąd odczytu.
+ */
+static bool inputRefill() {
+    assert(inputBegin == inputEnd);
 
-    ungetc(characterCode, stdin);
+    if (inputStreamEnded) {
+        return false;
+    }
+    if (inputMapped != NULL) {
+        munmap(inputMapped, inputMappedSize);
+        inputMapped = NULL;
+        inputMappedSize = 0;
+    } else if (!inputMapTried && inputTryMap()) {
+        return true;
+    }
 
-    return characterCode;
+    ssize_t readBytes;
+    do {
+        readBytes = read(STDIN_FILENO, inputBufferData, INPUT_BUFFER_SIZE);
+    } while (readBytes < 0 && errno == EINTR);
+
+    if (readBytes <= 0) {
+        inputStreamEnded = true;
+        inputBegin = inputEnd = inputBufferData;
+        return false;
+    }
+    inputBegin = inputBufferData;
+    inputEnd = inputBufferData + readBytes;
+    return true;
+}
+
+size_t inputBuffered(const char **begin) {
+    if (inputBegin == inputEnd) {
+        inputRefill();
+    }
+    *begin = inputBegin;
+    return (size_t) (inputEnd - inputBegin);
+}
+
+void inputSkip(size_t count) {
+    assert(count <= (size_t) (inputEnd - inputBegin));
+    inputBegin += count;
+}
+
+int inputPeekCharacter() {
+    if (inputBegin == inputEnd && !inputRefill()) {
+        return EOF;
+    }
+    return (unsigned char) *inputBegin;
 }
 
 int inputGetCharacter() {
-    return getc(stdin);
+    if (inputBegin == inputEnd && !inputRefill()) {
+        return EOF;
+    }
+    return (unsigned char) *inputBegin++;
 }
 
 size_t inputIgnoreUntil(int (*predicate)(int)) {
@@ -64,8 +196,7 @@ void inputIgnoreNewLine() {
     if (characterIsNewLine(inputPeekCharacter())) {
         int c = inputGetCharacter();
 
-        if (!inputIsStreamEnded()
-            && characterIsCarriageReturn(inputPeekCharacter())
+        if (characterIsCarriageReturn(inputPeekCharacter())
             && characterIsUnixNewLine(c)) {
             inputGetCharacter();
         }
@@ -104,39 +235,57 @@ int inputIgnoreUnixLine() {
     return returnCode;
 }
 
-int inputReadWhile(int (*predicate)(int),
-                   size_t maxLength, Vector destination) {
-    size_t readBytes = 0;
+/**
+ * @brief Wczytuje znaki do kontenera blokami.
+ * Przenosi do @p destination kolejne znaki z bufora, dla których
+ * (*predicate)(znak) jest różne od 0 dokładnie wtedy, gdy @p expected
+ * jest równe true, nie więcej niż @p maxLength znaków.
+ * @param[in] predicate - predykat.
+ * @param[in] expected - oczekiwana wartość logiczna predykatu.
+ * @param[in] maxLength - maksymalna długość.
+ * @param[out] destination - miejsce docelowe.
+ * @return INPUT_READ_SUCCESS, lub w przypadku problemów z pamięcią
+ *         INPUT_READ_FAIL.
+ */
+static int inputReadSpan(int (*predicate)(int), bool expected,
+                         size_t maxLength, Vector destination) {
+    const char *begin;
+    size_t available;
 
-    while ((*predicate)(inputPeekCharacter())
-           && readBytes < maxLength) {
-        if (vectorPushBack(destination, (char) inputGetCharacter())
+    while (maxLength > 0 && (available = inputBuffered(&begin)) > 0) {
+        size_t limit = available < maxLength ? available : maxLength;
+        size_t length = 0;
+        while (length < limit
+               && ((*predicate)((unsigned char) begin[length]) != 0)
+                  == expected) {
+            length++;
+        }
+
+        if (vectorPushBackArray(destination, begin, length)
             != VECTOR_SUCCES) {
             return INPUT_READ_FAIL;
         }
+        inputSkip(length);
+        maxLength -= length;
 
-        readBytes++;
+        if (length < available) {
+            break;
+        }
     }
     return INPUT_READ_SUCCESS;
 }
 
-int inputReadUntil(int (*predicate)(int),
+int inputReadWhile(int (*predicate)(int),
                    size_t maxLength, Vector destination) {
-    size_t readedBytes = 0;
-
-    while (!(*predicate)(inputPeekCharacter())
-           && readedBytes < maxLength) {
-        if (vectorPushBack(destination, (char) inputGetCharacter())
-            != VECTOR_SUCCES) {
-            return INPUT_READ_FAIL;
-        }
+    return inputReadSpan(predicate, true, maxLength, destination);
+}
 
-        readedBytes++;
-    }
-    return INPUT_READ_SUCCESS;
+int inputReadUntil(int (*predicate)(int),
+                   size_t maxLength, Vector destination) {
+    return inputReadSpan(predicate, false, maxLength, destination);
 }
 
 
 int inputIsEOF() {
-    return inputIsStreamEnded() || characterIsEOF(inputPeekCharacter());
-}
\ No newline at end of file
+    return characterIsEOF(inputPeekCharacter());
+}
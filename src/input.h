@@ -1,5 +1,8 @@
 /** @file
  * Interfejs modułu służącego do parsowania wejścia.
+ * Standardowe wejście jest wczytywane dużymi blokami funkcją read
+ * (zwykły plik jest odwzorowywany w pamięci), a funkcje modułu
+ * korzystają z bufora zamiast z funkcji getc i ungetc.
  *
  * @author Konrad Staniszewski
  * @copyright Konrad Staniszewski
@@ -27,6 +30,24 @@
  */
 #define INPUT_READ_FAIL 0
 
+/**
+ * @brief Udostępnia zbuforowane znaki.
+ * Jeżeli bufor jest pusty, wczytuje kolejny blok standardowego wejścia.
+ * Wskaźnik @p *begin pozostaje ważny do najbliższego wywołania innej
+ * funkcji modułu, po którym bufor może zostać uzupełniony.
+ * #### Złożoność
+ * O(1) bez uwzględnienia wczytywania bloku.
+ * @param[out] begin - @p *begin wskazuje na pierwszy niewczytany znak.
+ * @return Liczba dostępnych znaków, 0 jeżeli napotkano koniec wejścia.
+ */
+size_t inputBuffered(const char **begin);
+
+/**
+ * @brief Pomija zbuforowane znaki.
+ * @param[in] count - liczba znaków do pominięcia, nie większa od wyniku
+ *        ostatniego wywołania @ref inputBuffered.
+ */
+void inputSkip(size_t count);
 
 /**
  * @brief Następny oczekujący znak.
@@ -0,0 +1,316 @@
+/** @file
+ * Implementacja puli pamięci (alokatora blokowego).
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "memory_pool.h"
+#include "stdfunc.h"
+
+/**
+ * @brief Liczba klas rozmiaru obsługiwanych przez listy wolnych fragmentów.
+ */
+#define MEMORY_POOL_NUMBER_OF_CLASSES \
+    (MEMORY_POOL_MAX_SMALL_SIZE / MEMORY_POOL_ALIGNMENT)
+
+/**
+ * @brief Rozmiar pierwszego bloku puli w bajtach.
+ * Kolejne bloki są dwukrotnie większe od poprzednich, aż do
+ * osiągnięcia MEMORY_POOL_MAX_CHUNK_SIZE.
+ */
+#define MEMORY_POOL_MIN_CHUNK_SIZE ((size_t) 4096)
+
+/**
+ * @brief Maksymalny rozmiar bloku puli w bajtach.
+ */
+#define MEMORY_POOL_MAX_CHUNK_SIZE ((size_t) 1 << 20)
+
+/**
+ * @brief Nagłówek bloku puli.
+ * Za nagłówkiem znajduje się pamięć przydzielana fragmentami.
+ */
+struct MemoryPoolChunk {
+    /**
+     * @brief Następny blok puli.
+     */
+    struct MemoryPoolChunk *next;
+};
+
+/**
+ * @brief Nagłówek fragmentu większego niż MEMORY_POOL_MAX_SMALL_SIZE.
+ * Za nagłówkiem znajduje się pamięć fragmentu.
+ */
+struct MemoryPoolLargeBlock {
+    /**
+     * @brief Poprzedni duży fragment, NULL w przypadku braku.
+     */
+    struct MemoryPoolLargeBlock *previous;
+
+    /**
+     * @brief Następny duży fragment, NULL w przypadku braku.
+     */
+    struct MemoryPoolLargeBlock *next;
+};
+
+/**
+ * @brief Węzeł listy wolnych fragmentów.
+ * Przechowywany w pamięci zwolnionego fragmentu.
+ */
+struct MemoryPoolFreeNode {
+    /**
+     * @brief Następny wolny fragment tej samej klasy.
+     */
+    struct MemoryPoolFreeNode *next;
+};
+
+/**
+ * @brief Struktura reprezentująca pulę pamięci.
+ */
+struct MemoryPool {
+    /**
+     * @brief Listy wolnych fragmentów dla kolejnych klas rozmiaru.
+     * Klasa i obejmuje fragmenty o rozmiarze
+     * (i + 1) * MEMORY_POOL_ALIGNMENT.
+     */
+    struct MemoryPoolFreeNode *freeLists[MEMORY_POOL_NUMBER_OF_CLASSES];
+
+    /**
+     * @brief Lista bloków puli (ostatnio przydzielony na początku).
+     */
+    struct MemoryPoolChunk *chunks;
+
+    /**
+     * @brief Lista fragmentów większych niż MEMORY_POOL_MAX_SMALL_SIZE.
+     */
+    struct MemoryPoolLargeBlock *largeBlocks;
+
+    /**
+     * @brief Początek nieprzydzielonej części aktualnego bloku.
+     */
+    char *current;
+
+    /**
+     * @brief Koniec aktualnego bloku.
+     */
+    char *currentEnd;
+
+    /**
+     * @brief Rozmiar następnego bloku do przydzielenia.
+     */
+    size_t nextChunkSize;
+};
+
+/**
+ * @brief Zaokrągla @p size w górę do wielokrotności MEMORY_POOL_ALIGNMENT.
+ * @param[in] size - rozmiar w bajtach.
+ * @return Zaokrąglony rozmiar (co najmniej MEMORY_POOL_ALIGNMENT).
+ */
+static size_t memoryPoolRoundSize(size_t size) {
+    if (size == 0) {
+        return MEMORY_POOL_ALIGNMENT;
+    } else {
+        return (size + MEMORY_POOL_ALIGNMENT - 1)
+               / MEMORY_POOL_ALIGNMENT * MEMORY_POOL_ALIGNMENT;
+    }
+}
+
+/**
+ * @param[in] roundedSize - rozmiar zaokrąglony przez @ref memoryPoolRoundSize.
+ * @return Numer klasy rozmiaru.
+ */
+static size_t memoryPoolClass(size_t roundedSize) {
+    return roundedSize / MEMORY_POOL_ALIGNMENT - 1;
+}
+
+MemoryPool memoryPoolCreate() {
+    MemoryPool pool = malloc(sizeof(struct MemoryPool));
+    if (pool == NULL) {
+        return NULL;
+    } else {
+        size_t i;
+        for (i = 0; i < MEMORY_POOL_NUMBER_OF_CLASSES; i++) {
+            pool->freeLists[i] = NULL;
+        }
+        pool->chunks = NULL;
+        pool->largeBlocks = NULL;
+        pool->current = NULL;
+        pool->currentEnd = NULL;
+        pool->nextChunkSize = MEMORY_POOL_MIN_CHUNK_SIZE;
+        return pool;
+    }
+}
+
+void memoryPoolDestroy(MemoryPool pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    struct MemoryPoolChunk *chunk = pool->chunks, *nextChunk;
+    while (chunk != NULL) {
+        nextChunk = chunk->next;
+        free(chunk);
+        chunk = nextChunk;
+    }
+
+    struct MemoryPoolLargeBlock *block = pool->largeBlocks, *nextBlock;
+    while (block != NULL) {
+        nextBlock = block->next;
+        free(block);
+        block = nextBlock;
+    }
+
+    free(pool);
+}
+
+/**
+ * @brief Przydziela nowy blok puli i czyni go aktualnym.
+ * Niewykorzystana końcówka poprzedniego bloku przepada
+ * (zostanie zwolniona razem z pulą).
+ * @param[in, out] pool - wskaźnik na pulę.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
+ */
+static bool memoryPoolAddChunk(MemoryPool pool) {
+    size_t headerSize = memoryPoolRoundSize(sizeof(struct MemoryPoolChunk));
+    struct MemoryPoolChunk *chunk = malloc(pool->nextChunkSize);
+    if (chunk == NULL) {
+        return false;
+    } else {
+        chunk->next = pool->chunks;
+        pool->chunks = chunk;
+        pool->current = (char *) chunk + headerSize;
+        pool->currentEnd = (char *) chunk + pool->nextChunkSize;
+        pool->nextChunkSize = MIN(2 * pool->nextChunkSize,
+                                  MEMORY_POOL_MAX_CHUNK_SIZE);
+        return true;
+    }
+}
+
+/**
+ * @brief Przydziela fragment większy niż MEMORY_POOL_MAX_SMALL_SIZE.
+ * @param[in, out] pool - wskaźnik na pulę.
+ * @param[in] size - rozmiar fragmentu.
+ * @return Wskaźnik na fragment, w przypadku problemów z pamięcią NULL.
+ */
+static void *memoryPoolAllocLarge(MemoryPool pool, size_t size) {
+    size_t headerSize =
+            memoryPoolRoundSize(sizeof(struct MemoryPoolLargeBlock));
+    struct MemoryPoolLargeBlock *block = malloc(headerSize + size);
+    if (block == NULL) {
+        return NULL;
+    } else {
+        block->previous = NULL;
+        block->next = pool->largeBlocks;
+        if (block->next != NULL) {
+            block->next->previous = block;
+        }
+        pool->largeBlocks = block;
+        return (char *) block + headerSize;
+    }
+}
+
+/**
+ * @brief Zwalnia fragment przydzielony przez @ref memoryPoolAllocLarge.
+ * @param[in, out] pool - wskaźnik na pulę.
+ * @param[in] ptr - wskaźnik na fragment.
+ */
+static void memoryPoolFreeLarge(MemoryPool pool, void *ptr) {
+    size_t headerSize =
+            memoryPoolRoundSize(sizeof(struct MemoryPoolLargeBlock));
+    struct MemoryPoolLargeBlock *block =
+            (struct MemoryPoolLargeBlock *) ((char *) ptr - headerSize);
+    if (block->previous != NULL) {
+        block->previous->next = block->next;
+    } else {
+        pool->largeBlocks = block->next;
+    }
+    if (block->next != NULL) {
+        block->next->previous = block->previous;
+    }
+    free(block);
+}
+
+void *memoryPoolAlloc(MemoryPool pool, size_t size) {
+    size_t roundedSize = memoryPoolRoundSize(size);
+    if (roundedSize > MEMORY_POOL_MAX_SMALL_SIZE) {
+        return memoryPoolAllocLarge(pool, roundedSize);
+    }
+
+    struct MemoryPoolFreeNode **freeList =
+            &pool->freeLists[memoryPoolClass(roundedSize)];
+    if (*freeList != NULL) {
+        void *result = *freeList;
+        *freeList = (*freeList)->next;
+        return result;
+    }
+
+    if ((pool->current == NULL
+         || (size_t) (pool->currentEnd - pool->current) < roundedSize)
+        && !memoryPoolAddChunk(pool)) {
+        return NULL;
+    }
+
+    assert((size_t) (pool->currentEnd - pool->current) >= roundedSize);
+    void *result = pool->current;
+    pool->current += roundedSize;
+    return result;
+}
+
+void memoryPoolFree(MemoryPool pool, void *ptr, size_t size) {
+    if (ptr == NULL) {
+        return;
+    }
+
+    size_t roundedSize = memoryPoolRoundSize(size);
+    if (roundedSize > MEMORY_POOL_MAX_SMALL_SIZE) {
+        memoryPoolFreeLarge(pool, ptr);
+    } else {
+        struct MemoryPoolFreeNode *node = ptr;
+        struct MemoryPoolFreeNode **freeList =
+                &pool->freeLists[memoryPoolClass(roundedSize)];
+        node->next = *freeList;
+        *freeList = node;
+    }
+}
+
+void memoryPoolMerge(MemoryPool pool, MemoryPool other) {
+    struct MemoryPoolChunk *chunk = other->chunks;
+    if (chunk != NULL) {
+        while (chunk->next != NULL) {
+            chunk = chunk->next;
+        }
+        chunk->next = pool->chunks;
+        pool->chunks = other->chunks;
+    }
+
+    struct MemoryPoolLargeBlock *block = other->largeBlocks;
+    if (block != NULL) {
+        while (block->next != NULL) {
+            block = block->next;
+        }
+        block->next = pool->largeBlocks;
+        if (pool->largeBlocks != NULL) {
+            pool->largeBlocks->previous = block;
+        }
+        pool->largeBlocks = other->largeBlocks;
+    }
+
+    size_t i;
+    struct MemoryPoolFreeNode *node;
+    for (i = 0; i < MEMORY_POOL_NUMBER_OF_CLASSES; i++) {
+        node = other->freeLists[i];
+        if (node != NULL) {
+            while (node->next != NULL) {
+                node = node->next;
+            }
+            node->next = pool->freeLists[i];
+            pool->freeLists[i] = other->freeLists[i];
+        }
+    }
+
+    free(other);
+}
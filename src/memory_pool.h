@@ -0,0 +1,95 @@
+/** @file
+ * Interfejs puli pamięci (alokatora blokowego).
+ * Pula przydziela pamięć z dużych bloków (arena) i przechowuje
+ * zwolnione fragmenty na listach wolnych fragmentów, osobnych dla
+ * każdej klasy rozmiaru. Cała pamięć puli zostaje zwolniona naraz
+ * przy jej usunięciu.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#ifndef TELEFONY_MEMORY_POOL_H
+#define TELEFONY_MEMORY_POOL_H
+
+#include <stddef.h>
+
+/**
+ * @brief Wyrównanie pamięci przydzielanej przez pulę.
+ */
+#define MEMORY_POOL_ALIGNMENT sizeof(void *)
+
+/**
+ * @brief Największy rozmiar obsługiwany przez listy wolnych fragmentów.
+ * Większe fragmenty są przydzielane osobno (nadal należą do puli).
+ */
+#define MEMORY_POOL_MAX_SMALL_SIZE 512
+
+/**
+ * @brief Wskaźnik na pulę pamięci.
+ * @see struct MemoryPool
+ */
+typedef struct MemoryPool *MemoryPool;
+
+/**
+ * @brief Struktura reprezentująca pulę pamięci.
+ */
+struct MemoryPool;
+
+/**
+ * @brief Tworzy nową pustą pulę.
+ * #### Złożoność
+ * O(1)
+ * @return Wskaźnik na nową pulę, w przypadku problemów
+ *         z pamięcią NULL.
+ */
+MemoryPool memoryPoolCreate();
+
+/**
+ * @brief Usuwa pulę.
+ * Zwalnia całą pamięć przydzieloną z puli @p pool (także tę, która
+ * nie została zwolniona przy pomocy @ref memoryPoolFree) oraz samą pulę.
+ * #### Złożoność
+ * O(liczba bloków puli)
+ * @param[in] pool - wskaźnik na pulę.
+ */
+void memoryPoolDestroy(MemoryPool pool);
+
+/**
+ * @brief Przydziela fragment pamięci.
+ * #### Złożoność
+ * O(1)
+ * @param[in, out] pool - wskaźnik na pulę.
+ * @param[in] size - rozmiar fragmentu w bajtach.
+ * @return Wskaźnik na fragment pamięci wyrównany do
+ *         MEMORY_POOL_ALIGNMENT, w przypadku problemów z pamięcią NULL.
+ */
+void *memoryPoolAlloc(MemoryPool pool, size_t size);
+
+/**
+ * @brief Zwraca fragment pamięci do puli.
+ * Fragment trafia na listę wolnych fragmentów i zostanie
+ * wykorzystany przy kolejnym przydziale tej samej klasy rozmiaru.
+ * #### Złożoność
+ * O(1)
+ * @param[in, out] pool - wskaźnik na pulę z której przydzielono fragment.
+ * @param[in] ptr - wskaźnik na fragment (NULL jest ignorowany).
+ * @param[in] size - rozmiar podany przy przydziale fragmentu.
+ */
+void memoryPoolFree(MemoryPool pool, void *ptr, size_t size);
+
+/**
+ * @brief Włącza pulę @p other do puli @p pool.
+ * Bloki, duże fragmenty i wolne fragmenty @p other przechodzą do @p pool,
+ * więc pamięć przydzieloną z @p other zwalnia się odtąd do @p pool,
+ * a zostanie zwolniona razem z @p pool. Struktura @p other jest usuwana.
+ * Pozwala wątkom przydzielać pamięć z własnych pul bez synchronizacji.
+ * #### Złożoność
+ * O(liczba bloków, dużych i wolnych fragmentów @p other)
+ * @param[in, out] pool - wskaźnik na pulę docelową.
+ * @param[in] other - wskaźnik na włączaną pulę.
+ */
+void memoryPoolMerge(MemoryPool pool, MemoryPool other);
+
+#endif //TELEFONY_MEMORY_POOL_H
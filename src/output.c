@@ -0,0 +1,156 @@
+/** @file
+ * Implementacja modułu służącego do wypisywania wyników na standardowe
+ * wyjście.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "output.h"
+#include "character.h"
+
+/**
+ * @brief Rozmiar bufora wyjścia w bajtach.
+ */
+#define OUTPUT_BUFFER_SIZE (1 << 18)
+
+/**
+ * @brief Najmniejsza długość ciągu wypisywanego razem z buforem funkcją
+ * writev zamiast kopiowania do bufora.
+ * @see outputAppend
+ */
+#define OUTPUT_DIRECT_WRITE_LENGTH (1 << 12)
+
+/**
+ * @brief Maksymalna liczba cyfr dziesiętnych liczby typu size_t.
+ */
+#define OUTPUT_SIZE_MAX_DIGITS 20
+
+/**
+ * @brief Bufor wyjścia.
+ */
+static char outputBuffer[OUTPUT_BUFFER_SIZE];
+
+/**
+ * @brief Liczba zajętych bajtów bufora.
+ */
+static size_t outputUsed = 0;
+
+/**
+ * @brief Czy sprawdzono rodzaj standardowego wyjścia.
+ */
+static bool outputModeChecked = false;
+
+/**
+ * @brief Czy wypisywać bufor po każdej linii.
+ */
+static bool outputLineFlush = false;
+
+/**
+ * @brief Czy wystąpił błąd zapisu.
+ */
+static bool outputError = false;
+
+void outputSetLineFlush(bool lineFlush) {
+    outputModeChecked = true;
+    outputLineFlush = lineFlush;
+}
+
+/**
+ * @brief Zapisuje na standardowe wyjście ciągi opisane przez @p iov.
+ * Ponawia zapis po przerwaniu przez sygnał i po zapisaniu jedynie części
+ * danych. W przypadku błędu ustawia @ref outputError.
+ * @param[in, out] iov - tablica opisów ciągów (modyfikowana).
+ * @param[in] count - liczba opisów.
+ */
+static void outputWriteAll(struct iovec *iov, int count) {
+    while (count > 0) {
+        if (iov->iov_len == 0) {
+            iov++;
+            count--;
+            continue;
+        }
+
+        ssize_t written = writev(STDOUT_FILENO, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            outputError = true;
+            return;
+        }
+
+        size_t left = (size_t) written;
+        while (count > 0 && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char *) iov->iov_base + left;
+            iov->iov_len -= left;
+        }
+    }
+}
+
+bool outputFlush() {
+    struct iovec iov = {outputBuffer, outputUsed};
+    outputWriteAll(&iov, 1);
+    outputUsed = 0;
+    return !outputError;
+}
+
+void outputAppend(const char *data, size_t length) {
+    if (length <= OUTPUT_BUFFER_SIZE - outputUsed) {
+        memcpy(outputBuffer + outputUsed, data, length);
+        outputUsed += length;
+    } else if (length >= OUTPUT_DIRECT_WRITE_LENGTH) {
+        struct iovec iov[2] = {{outputBuffer, outputUsed},
+                               {(void *) data, length}};
+        outputWriteAll(iov, 2);
+        outputUsed = 0;
+    } else {
+        outputFlush();
+        memcpy(outputBuffer, data, length);
+        outputUsed = length;
+    }
+}
+
+void outputAppendString(const char *str) {
+    outputAppend(str, strlen(str));
+}
+
+void outputAppendSize(size_t number) {
+    char digits[OUTPUT_SIZE_MAX_DIGITS];
+    size_t position = OUTPUT_SIZE_MAX_DIGITS;
+    do {
+        digits[--position] = (char) ('0' + number % 10);
+        number /= 10;
+    } while (number != 0);
+
+    outputAppend(digits + position, OUTPUT_SIZE_MAX_DIGITS - position);
+}
+
+void outputEndLine() {
+    if (!outputModeChecked) {
+        outputSetLineFlush(isatty(STDOUT_FILENO) != 0);
+    }
+
+    if (outputUsed == OUTPUT_BUFFER_SIZE) {
+        outputFlush();
+    }
+    outputBuffer[outputUsed++] = CHARACTER_UNIX_NEW_LINE;
+
+    if (outputLineFlush) {
+        outputFlush();
+    }
+}
@@ -0,0 +1,64 @@
+/** @file
+ * Interfejs modułu służącego do wypisywania wyników na standardowe wyjście.
+ * Wyniki są gromadzone w dużym buforze i wypisywane funkcją write,
+ * a długie napisy, które nie mieszczą się w buforze, są wypisywane
+ * razem z nim funkcją writev bez kopiowania. Moduł nie korzysta
+ * z buforów biblioteki stdio, więc standardowe wyjście nie powinno być
+ * jednocześnie używane przez funkcje stdio.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#ifndef TELEFONY_OUTPUT_H
+#define TELEFONY_OUTPUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Ustawia wypisywanie bufora po każdej linii.
+ * Domyślnie bufor jest wypisywany po każdej linii jedynie wtedy, gdy
+ * standardowe wyjście jest terminalem.
+ * @param[in] lineFlush - true jeżeli bufor ma być wypisywany po każdej
+ *        linii, false jeżeli jedynie po zapełnieniu i w @ref outputFlush.
+ */
+void outputSetLineFlush(bool lineFlush);
+
+/**
+ * @brief Dopisuje ciąg znaków do bufora.
+ * #### Złożoność
+ * O(@p length) bez uwzględnienia wypisywania bufora.
+ * @param[in] data - wskaźnik na ciąg znaków.
+ * @param[in] length - długość ciągu.
+ */
+void outputAppend(const char *data, size_t length);
+
+/**
+ * @brief Dopisuje napis do bufora.
+ * @param[in] str - wskaźnik na napis zakończony '\0'.
+ */
+void outputAppendString(const char *str);
+
+/**
+ * @brief Dopisuje liczbę w zapisie dziesiętnym do bufora.
+ * @param[in] number - liczba.
+ */
+void outputAppendSize(size_t number);
+
+/**
+ * @brief Kończy linię.
+ * Dopisuje znak nowej linii, a w trybie wypisywania po każdej linii
+ * (patrz @ref outputSetLineFlush) wypisuje bufor.
+ */
+void outputEndLine();
+
+/**
+ * @brief Wypisuje zawartość bufora.
+ * @return true w przypadku sukcesu, false jeżeli wystąpił błąd zapisu
+ *         (również podczas wcześniejszego wypisywania bufora).
+ */
+bool outputFlush();
+
+#endif //TELEFONY_OUTPUT_H
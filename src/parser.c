@@ -12,6 +12,7 @@
 #include "character.h"
 #include "input.h"
 #include "parser.h"
+#include "scan.h"
 
 
 struct Parser parserCreateNew() {
@@ -28,16 +29,16 @@ struct Parser parserCreateNew() {
  *         reprezentuje znak biały lub znak nowej lini.
  */
 static int parserCharacterCanBeSkipped(int characterCode) {
-    return characterIsWhite(characterCode)
-           || characterIsNewLine(characterCode);
+    return isspace(characterCode);
 }
 
 /**
  * @brief Pomija symbole spełniające predykat @p parserCharacterCanBeSkipped.
+ * Przegląda bezpośrednio bufor wejścia funkcją @ref scanWhiteRun.
  * @see parserCharacterCanBeSkipped
  * @param[in, out] parser - wskaźnik na strukturę reprezentującą stan parsowania.
  *       Po wykonaniu @p parser zostaje uaktualniony.
- * @return true jeżeli coś zostało pominięte false w przeciwnym przypadku.
+ * @return true jeżeli coś zostało pominięte false w przeciwnym przypadku.
  * @remarks Nie robi nic jeżeli funkcja @p parserFinished(parser) zwraca true.
  */
 static bool parserSkipCharactersThatCanBeSkipped(Parser parser) {
@@ -45,16 +46,60 @@ static bool parserSkipCharactersThatCanBeSkipped(Parser parser) {
         return false;
     }
 
-    size_t skipped = inputIgnoreWhile(parserCharacterCanBeSkipped);
+    size_t skipped = 0;
+    const char *begin;
+    size_t available;
+    while ((available = inputBuffered(&begin)) > 0) {
+        size_t length = scanWhiteRun(begin, available);
+        inputSkip(length);
+        skipped += length;
+        if (length < available) {
+            break;
+        }
+    }
+
     parser->readBytes += skipped;
     return skipped != 0;
 }
 
+/**
+ * @brief Pomija treść komentarza wraz z sekwencją kończącą.
+ * Sekwencja kończąca jest wyszukiwana w buforze wejścia funkcją
+ * @ref scanFindDouble, więc musi składać się z dwóch jednakowych znaków.
+ * @param[in, out] parser - wskaźnik na strukturę reprezentującą stan parsowania.
+ *       Po wykonaniu @p parser zostaje uaktualniony.
+ * @return true jeżeli znaleziono koniec komentarza, false jeżeli wcześniej
+ *         napotkano koniec wejścia.
+ */
+static bool parserSkipCommentBody(Parser parser) {
+    const char *begin;
+    size_t available;
+    while ((available = inputBuffered(&begin)) > 0) {
+        size_t position = scanFindDouble(begin, available,
+                                         PARSER_COMMENT_SEQUENCE[0]);
+        if (position + 1 < available) {
+            inputSkip(position + 2);
+            parser->readBytes += position + 2;
+            return true;
+        }
+
+        inputSkip(available);
+        parser->readBytes += available;
+        if (position < available
+            && inputPeekCharacter() == PARSER_COMMENT_SEQUENCE[1]) {
+            inputGetCharacter();
+            parser->readBytes++;
+            return true;
+        }
+    }
+    return false;
+}
+
 /**
  * @brief Pomija komentarze.
  * @param[in, out] parser - wskaźnik na strukturę reprezentującą stan parsowania.
  *       Po wykonaniu @p parser zostaje uaktualniony.
- * @return true jeżeli coś zostało pominięte false w przeciwnym przypadku.
+ * @return true jeżeli coś zostało pominięte false w przeciwnym przypadku.
  * @remarks Nie robi nic jeżeli funkcja @p parserFinished(parser) zwraca true.
  */
 static bool parserSkipComments(Parser parser) {
@@ -74,24 +119,12 @@ static bool parserSkipComments(Parser parser) {
     inputGetCharacter();
     parser->readBytes++;
 
-
-    while (true) {
-        int r = inputGetCharacter();
-        parser->readBytes++;
-        if (parserFinished(parser)) {
-            if (characterIsEOF(r)) {
-                parser->readBytes--;
-            }
-            parser->isError = true;
-            parser->isCommentEofError = true;
-            return false;
-        } else if (r == PARSER_COMMENT_SEQUENCE[0]
-                   && inputPeekCharacter() == PARSER_COMMENT_SEQUENCE[1]) {
-            inputGetCharacter();
-            parser->readBytes++;
-
-            return true;
-        }
+    if (parserSkipCommentBody(parser)) {
+        return true;
+    } else {
+        parser->isError = true;
+        parser->isCommentEofError = true;
+        return false;
     }
 }
 
@@ -169,6 +202,12 @@ int parserReadOperator(Parser parser) {
         } else if (ch == PARSER_OPERATOR_DELETE[0]) {
             toCmp = PARSER_OPERATOR_DELETE + 1;
             result = PARSER_ELEMENT_TYPE_OPERATOR_DELETE;
+        } else if (ch == PARSER_OPERATOR_LIMIT[0]) {
+            toCmp = PARSER_OPERATOR_LIMIT + 1;
+            result = PARSER_ELEMENT_TYPE_OPERATOR_LIMIT;
+        } else if (ch == PARSER_OPERATOR_OFFSET[0]) {
+            toCmp = PARSER_OPERATOR_OFFSET + 1;
+            result = PARSER_ELEMENT_TYPE_OPERATOR_OFFSET;
         } else {
             parser->isError = true;
             return PARSER_FAIL;
@@ -199,29 +238,86 @@ int parserReadOperator(Parser parser) {
     }
 }
 
+int parserNextWordOperator(Parser parser) {
+    if (parserFinished(parser)) {
+        return PARSER_FAIL;
+    }
+
+    int c = inputPeekCharacter();
+    if (c == PARSER_OPERATOR_NEW[0]) {
+        return PARSER_ELEMENT_TYPE_OPERATOR_NEW;
+    } else if (c == PARSER_OPERATOR_DELETE[0]) {
+        return PARSER_ELEMENT_TYPE_OPERATOR_DELETE;
+    } else if (c == PARSER_OPERATOR_LIMIT[0]) {
+        return PARSER_ELEMENT_TYPE_OPERATOR_LIMIT;
+    } else if (c == PARSER_OPERATOR_OFFSET[0]) {
+        return PARSER_ELEMENT_TYPE_OPERATOR_OFFSET;
+    } else {
+        return PARSER_FAIL;
+    }
+}
+
 /**
  * @param[in] characterCode - kod znaku
  * @return Niezerowa wartość jeżeli @p characterCode jest literą
  *         lub cyfrą dzeisiętną.
  */
 static int parserIsLetterOrDecimalDigit(int characterCode) {
-    return characterIsLetter(characterCode) || isdigit(characterCode);
+    return isalpha(characterCode) || isdigit(characterCode);
 }
 
-bool parserReadIdentificator(Parser parser, Vector destination) {
-    size_t prefSize = vectorSize(destination);
-    int readStatus = inputReadWhile(parserIsLetterOrDecimalDigit, SIZE_MAX, destination);
-    parser->readBytes += vectorSize(destination) - prefSize;
+/**
+ * @param[in] txt - wskaźnik na tekst.
+ * @param[in] length - długość tekstu.
+ * @return Długość najdłuższego prefiksu @p txt złożonego z liter
+ *         i cyfr dziesiętnych.
+ */
+static size_t parserIdentificatorRun(const char *txt, size_t length) {
+    size_t i = 0;
+    while (i < length && parserIsLetterOrDecimalDigit((unsigned char) txt[i])) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief Wczytuje ciąg znaków.
+ * Przegląda bezpośrednio bufor wejścia i kopiuje do @p destination
+ * całe fragmenty wyznaczone przez funkcję @p run.
+ * @param[in, out] parser - wskaźnik na strukturę reprezentującą stan parsowania.
+ *       Po wykonaniu @p parser zostaje uaktualniony.
+ * @param[in] run - funkcja zwracająca długość prefiksu tekstu należącego
+ *        do wczytywanego ciągu.
+ * @param[out] destination - do podanego wektora zapisuje wczytane znaki.
+ * @return false w przypadku problemów z pamięcią,
+ *         true w przeciwnym wypadku.
+ */
+static bool parserReadRun(Parser parser,
+                          size_t (*run)(const char *, size_t),
+                          Vector destination) {
+    const char *begin;
+    size_t available;
+    while ((available = inputBuffered(&begin)) > 0) {
+        size_t length = (*run)(begin, available);
+        if (vectorPushBackArray(destination, begin, length)
+            != VECTOR_SUCCES) {
+            return false;
+        }
+        inputSkip(length);
+        parser->readBytes += length;
+        if (length < available) {
+            break;
+        }
+    }
+    return true;
+}
 
-    return readStatus == INPUT_READ_SUCCESS;
+bool parserReadIdentificator(Parser parser, Vector destination) {
+    return parserReadRun(parser, parserIdentificatorRun, destination);
 }
 
 bool parserReadNumber(Parser parser, Vector destination) {
-    size_t prefSize = vectorSize(destination);
-    int readStatus = inputReadWhile(characterIsDigit, SIZE_MAX, destination);
-    parser->readBytes += vectorSize(destination) - prefSize;
-
-    return readStatus == INPUT_READ_SUCCESS;
+    return parserReadRun(parser, scanDigitRun, destination);
 }
 
 size_t parserGetReadBytes(Parser parser) {
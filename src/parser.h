@@ -60,6 +60,16 @@
  */
 #define PARSER_OPERATOR_DELETE "DEL"
 
+/**
+ * @brief Ciąg znaków odpowiadający ograniczeniu liczby numerów wyniku.
+ */
+#define PARSER_OPERATOR_LIMIT "LIMIT"
+
+/**
+ * @brief Ciąg znaków odpowiadający pominięciu początkowych numerów wyniku.
+ */
+#define PARSER_OPERATOR_OFFSET "OFFSET"
+
 
 /**
  * @see parserNextType
@@ -108,6 +118,16 @@
  */
 #define PARSER_ELEMENT_TYPE_OPERATOR_NONTRIVIAL 8
 
+/**
+ * @see parserReadOperator
+ */
+#define PARSER_ELEMENT_TYPE_OPERATOR_LIMIT 9
+
+/**
+ * @see parserReadOperator
+ */
+#define PARSER_ELEMENT_TYPE_OPERATOR_OFFSET 10
+
 
 /**
  * @see struct Parser
@@ -168,8 +188,9 @@ bool parserFinished(Parser parser);
  * @return Przewidywany typ następnego słowa, wydedukowany
  *         na podstawie następnego znaku z wejścia. Możliwe wyniki:
  *         PARSER_ELEMENT_TYPE_NUMBER (numer),
- *         PARSER_ELEMENT_TYPE_WORD (identyfikator lub PARSER_OPERATOR_NEW
- *         lub PARSER_OPERATOR_DELETE),
+ *         PARSER_ELEMENT_TYPE_WORD (identyfikator lub operator słowny:
+ *         PARSER_OPERATOR_NEW, PARSER_OPERATOR_DELETE,
+ *         PARSER_OPERATOR_LIMIT, PARSER_OPERATOR_OFFSET),
  *         PARSER_ELEMENT_TYPE_SINGLE_CHARACTER_OPERATOR
  *         (PARSER_OPERATOR_QM lub PARSER_OPERATOR_REDIRECT,
  *         lub PARSER_OPERATOR_NONTRIVIAL),
@@ -190,11 +211,24 @@ int parserNextType(Parser parser);
  *         PARSER_ELEMENT_TYPE_OPERATOR_NEW (PARSER_OPERATOR_NEW),
  *         PARSER_ELEMENT_TYPE_OPERATOR_DELETE (PARSER_OPERATOR_DELETE)
  *         PARSER_ELEMENT_TYPE_OPERATOR_NONTRIVIAL (PARSER_OPERATOR_NONTRIVIAL)
+ *         PARSER_ELEMENT_TYPE_OPERATOR_LIMIT (PARSER_OPERATOR_LIMIT)
+ *         PARSER_ELEMENT_TYPE_OPERATOR_OFFSET (PARSER_OPERATOR_OFFSET)
  *         PARSER_FAIL (Nieznany operator
  *         lub @p parserFinished(parser) zwraca true).
  */
 int parserReadOperator(Parser parser);
 
+/**
+ * @brief Podaje operator słowny, którym może być następne słowo na wejściu.
+ * Operatory słowne różnią się pierwszym znakiem, więc sprawdzany jest
+ * jedynie następny znak z wejścia, który nie zostaje wczytany.
+ * @param[in] parser - wskaźnik na strukturę reprezentującą stan parsowania.
+ * @return Typ operatora (jak w @ref parserReadOperator) lub PARSER_FAIL,
+ *         jeżeli następne słowo nie może być operatorem słownym lub
+ *         @p parserFinished(parser) zwraca true.
+ */
+int parserNextWordOperator(Parser parser);
+
 /**
  * @brief Wczytuje identyfikator.
  * @param[in, out] parser - wskaźnik na strukturę reprezentującą stan parsowania.
@@ -6,6 +6,7 @@
  * @date 25.05.2018
  */
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -18,9 +19,10 @@
 typedef struct PhoneBaseInfo PhoneBaseInfo;
 
 /**
- * @see struct PhoneBasesNode
+ * @brief Początkowa liczba miejsc tablicy baz.
+ * Liczba miejsc jest zawsze potęgą dwójki.
  */
-typedef struct PhoneBasesNode *PhoneBasesNode;
+#define PHONE_BASES_INITIAL_CAPACITY 16
 
 /**
  * @brief Informacje o bazie przekierowań.
@@ -38,38 +40,26 @@ struct PhoneBaseInfo {
 
     /**
      * @brief Wskaźnik na bazę przekierowań.
+     * NULL oznacza wolne miejsce tablicy.
      */
     struct PhoneForward *base;
 };
 
-
 /**
- *  @brief Węzeł listy baz przekierowań.
- *  @see PhoneBases.
+ * @brief Struktura przechowująca bazy przekierowań numerów telefonów.
+ * Bazy są przechowywane w tablicy mieszającej z adresowaniem otwartym
+ * i liniowym przeszukiwaniem. Tablica jest co najwyżej w połowie pełna.
  */
-struct PhoneBasesNode {
+struct PhoneBases {
     /**
-     * @brief Informacje o przechowywanej bazie.
+     * @brief Tablica mieszająca.
      */
-    PhoneBaseInfo baseInfo;
+    PhoneBaseInfo *table;
 
     /**
-     * @brief Następny węzeł.
-     * Jeżeli nie ma następnego węzła to @p next
-     * ma wartość NULL.
+     * @brief Liczba miejsc tablicy @p table (potęga dwójki).
      */
-    PhoneBasesNode next;
-};
-
-/**
- * @brief Struktura przechowująca bazy przekierowań numerów telefonów.
- */
-struct PhoneBases {
-    /**
-     * @brief Pierwszy węzeł listy.
-     * NULL w przypadku przechowywania zera baz.
-     */
-    PhoneBasesNode basesList;
+    size_t capacity;
 
     /**
      * @brief Liczba przechowywanych baz.
@@ -80,29 +70,32 @@ struct PhoneBases {
 /**
  * @see phoneBasesHashId
  */
-const size_t PHONE_BASES_HASH_BASE = 127;
+const uint64_t PHONE_BASES_HASH_OFFSET = 14695981039346656037ULL;
 
 /**
  * @see phoneBasesHashId
  */
-const size_t PHONE_BASES_HASH_MOD = 1000000009;
+const uint64_t PHONE_BASES_HASH_PRIME = 1099511628211ULL;
 
 /**
  * @brief Przyporządkowuje identyfikatorowi @p id numer.
+ * Funkcja FNV-1a z dodatkowym wymieszaniem bitów, aby młodsze bity wyniku
+ * (wyznaczające miejsce w tablicy) zależały od wszystkich znaków.
  * @param[in] id - ciąg znaków w stylu c.
  * @return Wartość funkcji mieszającej dla @p id.
  */
 static size_t phoneBasesHashId(const char *id) {
-    size_t result = 0;
+    uint64_t result = PHONE_BASES_HASH_OFFSET;
     const char *ptr = id;
 
     while (*ptr != '\0') {
-        result = ((result * PHONE_BASES_HASH_BASE) + (*ptr))
-                 % PHONE_BASES_HASH_MOD;
+        result ^= (unsigned char) *ptr;
+        result *= PHONE_BASES_HASH_PRIME;
         ptr++;
     }
 
-    return result;
+    result ^= result >> 32;
+    return (size_t) result;
 }
 
 /**
@@ -119,22 +112,32 @@ static int phoneBasesInfoEqualId(PhoneBaseInfo pbi, const char *id, size_t hash)
 }
 
 /**
- * @brief Usuwa węzeł @p pbn
- * @param[in] pbn - wskaźnik na usuwany węzeł.
+ * @brief Zwalnia bazę opisaną przez @p pbi i jej identyfikator.
+ * @param[in] pbi - wskaźnik na informacje o bazie.
  */
-static void phoneBasesFreeNode(PhoneBasesNode pbn) {
-    free((void *) pbn->baseInfo.id);
-    phfwdDelete(pbn->baseInfo.base);
-    free(pbn);
+static void phoneBasesFreeInfo(PhoneBaseInfo *pbi) {
+    free((void *) pbi->id);
+    phfwdDelete(pbi->base);
+    pbi->id = NULL;
+    pbi->base = NULL;
 }
 
 /**
- * @brief Inicjuje strukturę przechowującą bazy przekierowań.
- * @param[in, out] pb - wskaźnik na strukturę przechowującą bazy przekierowań.
+ * @brief Tworzy pustą tablicę mieszającą.
+ * @param[in] capacity - liczba miejsc tablicy.
+ * @return Wskaźnik na tablicę, NULL w przypadku problemów z pamięcią.
  */
-static void phoneBasesInitPhoneBases(PhoneBases pb) {
-    pb->basesList = NULL;
-    pb->numberOfBases = 0;
+static PhoneBaseInfo *phoneBasesCreateTable(size_t capacity) {
+    PhoneBaseInfo *table = malloc(capacity * sizeof(PhoneBaseInfo));
+    if (table != NULL) {
+        size_t i;
+        for (i = 0; i < capacity; i++) {
+            table[i].base = NULL;
+            table[i].id = NULL;
+            table[i].hash = 0;
+        }
+    }
+    return table;
 }
 
 PhoneBases phoneBasesCreateNewPhoneBases() {
@@ -142,26 +145,25 @@ PhoneBases phoneBasesCreateNewPhoneBases() {
     if (pb == NULL) {
         return NULL;
     }
-    phoneBasesInitPhoneBases(pb);
+    pb->table = phoneBasesCreateTable(PHONE_BASES_INITIAL_CAPACITY);
+    if (pb->table == NULL) {
+        free(pb);
+        return NULL;
+    }
+    pb->capacity = PHONE_BASES_INITIAL_CAPACITY;
+    pb->numberOfBases = 0;
 
     return pb;
 }
 
-/**
- * @brief Usuwa wszystkie węzły występujące za @p node włącznie.
- * @param[in] node - wskaźnik na strukturę reprezentującą węzeł.
- */
-static void phoneBasesDeleteNodesList(PhoneBasesNode node) {
-    if (node != NULL) {
-        phoneBasesDeleteNodesList(node->next);
-        node->next = NULL;
-        phoneBasesFreeNode(node);
-    }
-}
-
 void phoneBasesDestroyPhoneBases(PhoneBases pb) {
-    phoneBasesDeleteNodesList(pb->basesList);
-    pb->basesList = NULL;
+    size_t i;
+    for (i = 0; i < pb->capacity; i++) {
+        if (pb->table[i].base != NULL) {
+            phoneBasesFreeInfo(&pb->table[i]);
+        }
+    }
+    free(pb->table);
     free(pb);
 }
 
@@ -169,16 +171,93 @@ size_t phoneBasesHowManyBases(PhoneBases pb) {
     return pb->numberOfBases;
 }
 
+/**
+ * @brief Wyszukuje miejsce bazy o identyfikatorze @p id.
+ * #### Złożoność
+ * Oczekiwana O(długość @p id)
+ * @param[in] pb - wskaźnik na strukturę przechowującą bazy przekierowań.
+ * @param[in] id - identyfikator bazy.
+ * @param[in] hash - wartość @p phoneBasesHashId dla @p id.
+ * @return Pozycja bazy o identyfikatorze @p id w tablicy, jeżeli takiej
+ *         bazy nie ma to pozycja wolnego miejsca, na którym należy ją
+ *         umieścić.
+ */
+static size_t phoneBasesFindSlot(PhoneBases pb, const char *id, size_t hash) {
+    size_t mask = pb->capacity - 1;
+    size_t i = hash & mask;
+    while (pb->table[i].base != NULL
+           && !phoneBasesInfoEqualId(pb->table[i], id, hash)) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+/**
+ * @brief Przenosi bazy do nowej tablicy o @p capacity miejscach.
+ * @param[in, out] pb - wskaźnik na strukturę przechowującą bazy przekierowań.
+ * @param[in] capacity - nowa liczba miejsc (potęga dwójki, większa od
+ *        dwukrotności liczby baz).
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią
+ *         (wtedy @p pb pozostaje bez zmian).
+ */
+static bool phoneBasesResize(PhoneBases pb, size_t capacity) {
+    PhoneBaseInfo *table = phoneBasesCreateTable(capacity);
+    if (table == NULL) {
+        return false;
+    }
+
+    size_t mask = capacity - 1;
+    size_t i;
+    for (i = 0; i < pb->capacity; i++) {
+        if (pb->table[i].base != NULL) {
+            size_t j = pb->table[i].hash & mask;
+            while (table[j].base != NULL) {
+                j = (j + 1) & mask;
+            }
+            table[j] = pb->table[i];
+        }
+    }
+
+    free(pb->table);
+    pb->table = table;
+    pb->capacity = capacity;
+    return true;
+}
+
 struct PhoneForward *phoneBasesGetBase(PhoneBases pb, const char *id) {
     size_t idHash = phoneBasesHashId(id);
-    PhoneBasesNode ptr = pb->basesList;
-    while (ptr != NULL) {
-        if (phoneBasesInfoEqualId(ptr->baseInfo, id, idHash)) {
-            return ptr->baseInfo.base;
-        }
-        ptr = ptr->next;
+    return pb->table[phoneBasesFindSlot(pb, id, idHash)].base;
+}
+
+/**
+ * @brief Dodaje bazę przekierowań do tablicy.
+ * Zakłada, że baza o identyfikatorze @p id nie istnieje.
+ * @param[in, out] pb - wskaźnik na strukturę przechowującą bazy przekierowań.
+ * @param[in] id - identyfikator bazy.
+ * @param[in] base - wskaźnik na bazę przekierowań.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
+ */
+static bool phoneBasesInsertNode(PhoneBases pb, const char *id,
+                                 struct PhoneForward *base) {
+    if (2 * (pb->numberOfBases + 1) > pb->capacity
+        && !phoneBasesResize(pb, 2 * pb->capacity)) {
+        return false;
+    }
+
+    char *copyId = duplicateText(id);
+    if (copyId == NULL) {
+        return false;
+    } else {
+        size_t idHash = phoneBasesHashId(copyId);
+        PhoneBaseInfo *slot = &pb->table[phoneBasesFindSlot(pb, copyId,
+                                                            idHash)];
+        slot->base = base;
+        slot->hash = idHash;
+        slot->id = copyId;
+
+        pb->numberOfBases++;
+        return true;
     }
-    return NULL;
 }
 
 struct PhoneForward *phoneBasesAddBase(PhoneBases pb, const char *id) {
@@ -189,59 +268,67 @@ struct PhoneForward *phoneBasesAddBase(PhoneBases pb, const char *id) {
     if (result != NULL) {
         return result;
     } else {
-        PhoneBasesNode newNode = malloc(sizeof(struct PhoneBasesNode));
-        if (newNode == NULL) {
+        result = phfwdNew();
+        if (result == NULL) {
+            return NULL;
+        } else if (!phoneBasesInsertNode(pb, id, result)) {
+            phfwdDelete(result);
             return NULL;
         } else {
-            char *copyId = duplicateText(id);
-
-            if (copyId == NULL) {
-                free(newNode);
-                return NULL;
-            } else {
-                newNode->baseInfo.base = phfwdNew();
-                if (newNode->baseInfo.base == NULL) {
-                    free(copyId);
-                    free(newNode);
-                    return NULL;
-                } else {
-                    newNode->baseInfo.hash = phoneBasesHashId(copyId);
-                    newNode->baseInfo.id = copyId;
-                    newNode->next = pb->basesList;
-                    pb->basesList = newNode;
-
-                    pb->numberOfBases++;
-                    return newNode->baseInfo.base;
-                }
-            }
+            return result;
         }
+    }
+}
+
+bool phoneBasesAttachBase(PhoneBases pb, const char *id,
+                          struct PhoneForward *base) {
+    if (phoneBasesGetBase(pb, id) != NULL) {
+        return false;
+    } else {
+        return phoneBasesInsertNode(pb, id, base);
+    }
+}
 
+void phoneBasesFold(PhoneBases pb,
+                    void (*f)(const char *, struct PhoneForward *, void *),
+                    void *fData) {
+    size_t i;
+    for (i = 0; i < pb->capacity; i++) {
+        if (pb->table[i].base != NULL) {
+            f(pb->table[i].id, pb->table[i].base, fData);
+        }
     }
 }
 
 bool phoneBasesDelBase(PhoneBases pb, const char *id) {
-    PhoneBasesNode prev = NULL;
-    PhoneBasesNode cur = pb->basesList;
     size_t idHash = phoneBasesHashId(id);
+    size_t i = phoneBasesFindSlot(pb, id, idHash);
+    if (pb->table[i].base == NULL) {
+        return false;
+    }
 
-    while (cur != NULL) {
-        if (phoneBasesInfoEqualId(cur->baseInfo, id, idHash)) {
-            PhoneBasesNode *mnt;
-            if (prev != NULL) {
-                mnt = &prev->next;
-            } else {
-                mnt = &pb->basesList;
-            }
-            (*mnt) = cur->next;
-            phoneBasesFreeNode(cur);
+    phoneBasesFreeInfo(&pb->table[i]);
+    pb->numberOfBases--;
 
-            pb->numberOfBases--;
-            return true;
-        } else {
-            prev = cur;
-            cur = cur->next;
+    size_t mask = pb->capacity - 1;
+    size_t j = i;
+    while (true) {
+        j = (j + 1) & mask;
+        if (pb->table[j].base == NULL) {
+            break;
+        }
+        size_t home = pb->table[j].hash & mask;
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            pb->table[i] = pb->table[j];
+            pb->table[j].base = NULL;
+            pb->table[j].id = NULL;
+            i = j;
         }
     }
 
-    return false;
-}
\ No newline at end of file
+    if (pb->capacity > PHONE_BASES_INITIAL_CAPACITY
+        && 8 * pb->numberOfBases < pb->capacity) {
+        phoneBasesResize(pb, pb->capacity / 2);
+    }
+    return true;
+}
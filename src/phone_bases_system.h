@@ -72,5 +72,28 @@ struct PhoneForward *phoneBasesAddBase(PhoneBases pb, const char *id);
  */
 bool phoneBasesDelBase(PhoneBases pb, const char *id);
 
+/**
+ * @brief Dodaje istniejącą bazę przekierowań.
+ * W przypadku sukcesu struktura @p pb przejmuje bazę @p base na własność.
+ * @param[in, out] pb - wskaźnik na strukturę przechowującą bazy przekierowań.
+ * @param[in] id - identyfikator bazy.
+ * @param[in] base - wskaźnik na bazę przekierowań.
+ * @return true w przypadku sukcesu, false jeżeli baza o identyfikatorze
+ *         @p id już istnieje lub w przypadku problemów z pamięcią.
+ */
+bool phoneBasesAttachBase(PhoneBases pb, const char *id,
+                          struct PhoneForward *base);
+
+/**
+ * @brief Wywołuje funkcję dla każdej bazy przekierowań.
+ * Wywołuje f(identyfikator_bazy, wskaźnik_na_bazę, fData).
+ * @param[in] pb - wskaźnik na strukturę przechowującą bazy przekierowań.
+ * @param[in] f - wskaźnik na funkcję.
+ * @param fData - dane pomocnicze do funkcji @p f.
+ */
+void phoneBasesFold(PhoneBases pb,
+                    void (*f)(const char *, struct PhoneForward *, void *),
+                    void *fData);
+
 
 #endif //TELEFONY_PHONE_BASES_SYSTEM_H
@@ -6,15 +6,25 @@
  * @date 06.05.2018
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <assert.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <string.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "phone_forward.h"
 #include "radix_tree.h"
-#include "list.h"
-#include "text.h"
 #include "character.h"
+#include "memory_pool.h"
+#include "epoch.h"
+#include "flat_tree.h"
+#include "stdfunc.h"
 
 /**
  * @brief Struktura przechowująca przekierowania numerów telefonów.
@@ -24,9 +34,11 @@ struct PhoneForward {
      * @brief Drzewo reprezentujące przekierowania.
      * Jego węzły przechowują informacje
      * o tym na jaki numer zostały przekierowane (ForwardData->treeNode)
-     * oraz o węźle na liście przechowującym informację pozwalającą odwrócić
-     * przekierowanie (ForwardData->listNode).
+     * oraz o swojej pozycji w tablicy BackwardData tego węzła, pozwalającej
+     * odwrócić przekierowanie (ForwardData->backwardIndex).
      * Sam węzeł drzewa reprezentuje numer.
+     * Modyfikowane z użyciem epok @p epoch, więc adresy jego węzłów mogą
+     * się zmieniać.
      * @see ForwardData
      */
     RadixTree forward;
@@ -34,64 +46,281 @@ struct PhoneForward {
     /**
      * @brief Drzewo reprezentujące odwrócone przekierowania.
      * Pozwala na odtworzenie numerów przekierowanych na dany numer.
-     * Jego wierzchołki przechowują listy wskaźników na wierzchołki
-     * drzewa forward przekierowywane na
-     * dany wierzchołek.
+     * Jego wierzchołki przechowują tablice informacji o przekierowaniach
+     * (ForwardData) na dany wierzchołek, złożone z części posortowanej
+     * względem przekierowywanych prefiksów i nieposortowanej końcówki.
      * Sam węzeł reprezentuje numer.
+     * @see BackwardData
      */
     RadixTree backward;
+
+    /**
+     * @brief Pula z której przydzielane są węzły obu drzew
+     * oraz przechowywane w nich dane (ForwardData, struct BackwardData
+     * i ich tablice BackwardData->items).
+     * @see ForwardData
+     * @see BackwardData
+     */
+    MemoryPool pool;
+
+    /**
+     * @brief Czy struktura jest tylko do odczytu.
+     * @see phfwdLoadMapped
+     */
+    bool readOnly;
+
+    /**
+     * @brief Czy struktura została utworzona do współbieżnego użytku.
+     * @see phfwdNewConcurrent
+     */
+    bool concurrent;
+
+    /**
+     * @brief Blokada czytelników i pisarzy (używana gdy concurrent == true).
+     * phfwdReverse i phfwdNonTrivialCount zajmują ją do czytania,
+     * phfwdAdd i phfwdRemove do pisania.
+     */
+    pthread_rwlock_t lock;
+
+    /**
+     * @brief Epoki czytelników drzewa forward, NULL gdy
+     * concurrent == false.
+     * phfwdGet, phfwdGetInto i phfwdGetMany nie zajmują blokady, tylko
+     * wchodzą do epoki, a informacje o przekierowaniach i węzły drzewa
+     * forward są zwalniane dopiero po opuszczeniu epok przez czytelników.
+     */
+    Epoch epoch;
+
+    /**
+     * @brief Zwarta postać drzewa forward, NULL jeżeli nie została
+     * utworzona lub drzewo zmieniło się od jej utworzenia.
+     * @see phfwdCompile
+     */
+    _Atomic(struct CompiledForward *) compiled;
+
+    /**
+     * @brief Odwzorowany w pamięci obraz struktury, NULL jeżeli struktura
+     * nie została wczytana przez @ref phfwdLoadMapped.
+     * Drzewa forward i backward odwzorowanej struktury są puste.
+     */
+    struct MappedForward *mapped;
 };
 
+/**
+ * @brief Pozycja numeru w PhoneNumbers->offsets oznaczająca brak numeru
+ * (phnumGet zwraca dla niej NULL).
+ */
+#define PHFWD_NO_NUMBER SIZE_MAX
+
 /**
  * @brief Struktura przechowująca ciąg numerów telefonów.
+ * Wszystkie numery (zakończone '\0') znajdują się w jednym buforze
+ * @p chars, a ich pozycje w tablicy @p offsets. Obie tablice nie są
+ * zmniejszane, więc struktura użyta ponownie (patrz phfwdGetReuse)
+ * nie przydziela pamięci, o ile wynik się w nich mieści.
  */
 struct PhoneNumbers {
     /**
-     * @brief Tablica wskaźników na numery.
+     * @brief Pozycje kolejnych numerów w @p chars (PHFWD_NO_NUMBER dla
+     * brakującego numeru).
      */
-    char **numbers;
+    size_t *offsets;
 
     /**
      * @brief Liczba numerów.
      */
     size_t howMany;
+
+    /**
+     * @brief Rozmiar tablicy @p offsets.
+     */
+    size_t capacity;
+
+    /**
+     * @brief Bufor na znaki wszystkich numerów.
+     */
+    char *chars;
+
+    /**
+     * @brief Liczba zajętych bajtów @p chars.
+     */
+    size_t length;
+
+    /**
+     * @brief Rozmiar bufora @p chars.
+     */
+    size_t charsCapacity;
+};
+
+/**
+ * @brief Zwarta postać drzewa PhoneForward->forward.
+ * @see phfwdCompile
+ */
+struct CompiledForward {
+    /**
+     * @brief Zwarta postać drzewa, wartością węzła jest pozycja informacji
+     * o przekierowaniu w @p redirections.
+     */
+    FlatTree tree;
+
+    /**
+     * @brief Informacje o przekierowaniach w kolejności przeszukiwania wszerz,
+     * NULL dla zwartej postaci odwzorowanej struktury.
+     */
+    struct ForwardData **redirections;
+
+    /**
+     * @brief Odwzorowany obraz struktury, NULL jeżeli
+     * @p redirections != NULL.
+     * @see MappedForward
+     */
+    const char *image;
+
+    /**
+     * @brief Pozycje informacji o przekierowaniach w @p image.
+     */
+    const uint64_t *offsets;
+};
+
+/**
+ * @brief Odwzorowany w pamięci obraz struktury.
+ * @see phfwdLoadMapped
+ */
+struct MappedForward {
+    /**
+     * @brief Początek obrazu.
+     */
+    void *image;
+
+    /**
+     * @brief Rozmiar obrazu w bajtach.
+     */
+    size_t size;
+
+    /**
+     * @brief Zwarta postać drzewa backward, wartością węzła jest numer listy
+     * przekierowań na reprezentowany numer.
+     */
+    FlatTree backward;
+
+    /**
+     * @brief Liczba przekierowań.
+     */
+    size_t howManyRedirections;
+
+    /**
+     * @brief Początki list, lista i zajmuje pozycje od listStarts[i] do
+     * listStarts[i + 1] - 1 tablicy @p listItems.
+     */
+    const uint32_t *listStarts;
+
+    /**
+     * @brief Numery przekierowań (pozycje w CompiledForward->offsets).
+     */
+    const uint32_t *listItems;
 };
 
 /**
- * @brief Tworzy strukturę do przechowywania numerów.
- * @param[in] howMany - ilość przechowywanych numerów.
- * @return Wskaźnik na strukturę do przechowywania @p howMany numerów,
- *         NULL w przypadku problemów z pamięcią.
+ * @brief Zwalnia zwartą postać drzewa.
+ * @param[in] data - wskaźnik na struct CompiledForward (NULL jest
+ *        ignorowany).
+ * @param ignored - nieużywany wskaźnik.
  */
-static struct PhoneNumbers *phfwdCreatePhoneNumbersStructure(size_t howMany) {
+static void phfwdCompiledFree(void *data, void *ignored) {
+    (void) ignored;
+    struct CompiledForward *compiled = data;
+    if (compiled != NULL) {
+        flatTreeDelete(compiled->tree);
+        free(compiled->redirections);
+        free(compiled);
+    }
+}
+
+struct PhoneNumbers *phnumNew(void) {
     struct PhoneNumbers *result = malloc(sizeof(struct PhoneNumbers));
     if (result == NULL) {
         return NULL;
     } else {
-        result->howMany = howMany;
-        result->numbers = malloc(result->howMany * sizeof(char *));
-        if (result->numbers == NULL) {
-            free(result);
-            return NULL;
-        } else {
-            size_t i;
-            for (i = 0; i < result->howMany; i++) {
-                result->numbers[i] = NULL;
-            }
-            return result;
+        result->offsets = NULL;
+        result->howMany = 0;
+        result->capacity = 0;
+        result->chars = NULL;
+        result->length = 0;
+        result->charsCapacity = 0;
+        return result;
+    }
+}
+
+/**
+ * @brief Zapewnia miejsce na numery.
+ * Tablice są powiększane co najmniej dwukrotnie, więc kolejne dodawanie
+ * numerów ma zamortyzowany koszt stały.
+ * @param[in, out] pnum - wskaźnik na strukturę przechowującą numery.
+ * @param[in] howMany - wymagany rozmiar tablicy PhoneNumbers->offsets.
+ * @param[in] length - wymagany rozmiar bufora PhoneNumbers->chars.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
+ */
+static bool phfwdNumbersReserve(struct PhoneNumbers *pnum, size_t howMany,
+                                size_t length) {
+    if (howMany > pnum->capacity) {
+        size_t capacity = MAX(howMany, 2 * pnum->capacity);
+        size_t *offsets = realloc(pnum->offsets, capacity * sizeof(size_t));
+        if (offsets == NULL) {
+            return false;
+        }
+        pnum->offsets = offsets;
+        pnum->capacity = capacity;
+    }
+    if (length > pnum->charsCapacity) {
+        size_t capacity = MAX(length, 2 * pnum->charsCapacity);
+        char *chars = realloc(pnum->chars, capacity);
+        if (chars == NULL) {
+            return false;
         }
+        pnum->chars = chars;
+        pnum->charsCapacity = capacity;
     }
+    return true;
 }
 
 /**
- * @brief Tworzy strukturę przechowującą zero numerów.
- * @see phfwdCreatePhoneNumbersStructure.
- * @return Wskaźnik na strukturę przechowującą zero numerów,
- *         NULL w przypadku problemów z pamięcią.
+ * @brief Dodaje numer na koniec ciągu.
+ * Numer jest tekstem @p first, po którym następuje @p second.
+ * Wcześniej pobrane wskaźniki na numery (phnumGet) mogą przestać być
+ * ważne.
+ * @param[in, out] pnum - wskaźnik na strukturę przechowującą numery.
+ * @param[in] first - początek numeru.
+ * @param[in] firstLength - długość @p first.
+ * @param[in] second - koniec numeru (zakończony '\0'), NULL oznacza
+ *        pusty tekst.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
  */
-static struct PhoneNumbers *phfwdEmptySequenceResult() {
-    struct PhoneNumbers *result = phfwdCreatePhoneNumbersStructure(0);
-    return result;
+static bool phfwdNumbersAppend(struct PhoneNumbers *pnum, const char *first,
+                               size_t firstLength, const char *second) {
+    size_t secondLength = second == NULL ? 0 : strlen(second);
+    if (!phfwdNumbersReserve(pnum, pnum->howMany + 1,
+                             pnum->length + firstLength + secondLength + 1)) {
+        return false;
+    }
+    char *out = pnum->chars + pnum->length;
+    memcpy(out, first, firstLength);
+    if (secondLength != 0) {
+        memcpy(out + firstLength, second, secondLength);
+    }
+    out[firstLength + secondLength] = '\0';
+    pnum->offsets[pnum->howMany] = pnum->length;
+    pnum->howMany++;
+    pnum->length += firstLength + secondLength + 1;
+    return true;
+}
+
+/**
+ * @brief Usuwa numery z ciągu nie zwalniając pamięci.
+ * @param[in, out] pnum - wskaźnik na strukturę przechowującą numery.
+ */
+static void phfwdNumbersClear(struct PhoneNumbers *pnum) {
+    pnum->howMany = 0;
+    pnum->length = 0;
 }
 
 
@@ -100,15 +329,20 @@ struct PhoneForward *phfwdNew(void) {
     if (result == NULL) {
         return NULL;
     } else {
-        result->forward = radixTreeCreate();
-        if (result->forward == NULL) {
+        result->readOnly = false;
+        result->concurrent = false;
+        result->epoch = NULL;
+        result->mapped = NULL;
+        atomic_init(&result->compiled, NULL);
+        result->pool = memoryPoolCreate();
+        if (result->pool == NULL) {
             free(result);
             return NULL;
         } else {
-            result->backward = radixTreeCreate();
-            if (result->backward == NULL) {
-                radixTreeDelete(result->forward, radixTreeEmptyDelFunction,
-                                NULL);
+            result->forward = radixTreeCreate(result->pool);
+            result->backward = radixTreeCreate(result->pool);
+            if (result->forward == NULL || result->backward == NULL) {
+                memoryPoolDestroy(result->pool);
                 free(result);
                 return NULL;
             } else {
@@ -118,46 +352,89 @@ struct PhoneForward *phfwdNew(void) {
     }
 }
 
-/**
- * @brief Do usuwania drzewa PhoneForward->forward.
- * @see PhoneForward
- * @see radixTreeDelete
- * @param[in] ptrA - wskaźnik na dane do usunięcia.
- * @param ptrB - nieużywany wskaźnik (powinien wskazywać na NULL).
- */
-static void phfwdForwardJustDelete(void *ptrA, void *ptrB) {
-    assert(ptrA != NULL);
-    assert(ptrB == NULL);
-    (void) ptrA;
-    (void) ptrB;
-    free(ptrA);
-}
+struct PhoneForward *phfwdNewConcurrent(void) {
+    struct PhoneForward *result = phfwdNew();
+    if (result == NULL) {
+        return NULL;
+    }
 
-/**
- * @brief Do usuwania drzewa PhoneForward->backward.
- * @see PhoneForward
- * @see radixTreeDelete
- * @param[in] ptrA - wskaźnik na dane (listę) do usunięcia.
- * @param ptrB - nieużywany wskaźnik (powinien wskazywać na NULL).
- */
-static void phfwdBackwardJustDelete(void *ptrA, void *ptrB) {
-    assert(ptrA != NULL);
-    assert(ptrB == NULL);
-    (void) ptrA;
-    (void) ptrB;
-    listDestroy(ptrA);
+    result->epoch = epochCreate(result->pool);
+    if (result->epoch == NULL) {
+        phfwdDelete(result);
+        return NULL;
+    } else if (pthread_rwlock_init(&result->lock, NULL) != 0) {
+        phfwdDelete(result);
+        return NULL;
+    } else {
+        result->concurrent = true;
+        return result;
+    }
 }
 
 void phfwdDelete(struct PhoneForward *pf) {
     if (pf == NULL) {
         return;
     } else {
-        radixTreeDelete(pf->forward, phfwdForwardJustDelete, NULL);
-        radixTreeDelete(pf->backward, phfwdBackwardJustDelete, NULL);
+        if (pf->concurrent) {
+            pthread_rwlock_destroy(&pf->lock);
+        }
+        phfwdCompiledFree(atomic_load(&pf->compiled), NULL);
+        if (pf->mapped != NULL) {
+            flatTreeDelete(pf->mapped->backward);
+            munmap(pf->mapped->image, pf->mapped->size);
+            free(pf->mapped);
+        }
+        epochDestroy(pf->epoch);
+        memoryPoolDestroy(pf->pool);
         free(pf);
     }
 }
 
+/**
+ * @brief Rozpoczyna operację odczytu.
+ * W przypadku struktury utworzonej przez @ref phfwdNewConcurrent zajmuje
+ * blokadę do czytania, w przeciwnym przypadku nic nie robi.
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania.
+ */
+static void phfwdLockRead(struct PhoneForward *pf) {
+    if (pf->concurrent) {
+        pthread_rwlock_rdlock(&pf->lock);
+    }
+}
+
+/**
+ * @brief Rozpoczyna operację modyfikacji.
+ * W przypadku struktury utworzonej przez @ref phfwdNewConcurrent zajmuje
+ * blokadę do pisania, w przeciwnym przypadku nic nie robi.
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania.
+ */
+static void phfwdLockWrite(struct PhoneForward *pf) {
+    if (pf->concurrent) {
+        pthread_rwlock_wrlock(&pf->lock);
+    }
+}
+
+/**
+ * @brief Kończy operację rozpoczętą przez @ref phfwdLockRead
+ * lub @ref phfwdLockWrite.
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania.
+ */
+static void phfwdUnlock(struct PhoneForward *pf) {
+    if (pf->concurrent) {
+        pthread_rwlock_unlock(&pf->lock);
+    }
+}
+
+/**
+ * @brief Kończy operację modyfikacji rozpoczętą przez @ref phfwdLockWrite.
+ * Zwalnia pamięć, której nie mogą już odczytywać czytelnicy.
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania.
+ */
+static void phfwdUnlockWrite(struct PhoneForward *pf) {
+    epochCollect(pf->epoch);
+    phfwdUnlock(pf);
+}
+
 /**
  * @brief Przygotowuje drzewa struktury @p pf do dodania danych.
  * Dodaje do drzew struktury @p pf węzły reprezentujące numery
@@ -180,15 +457,15 @@ static bool phfwdPrepareTreesForAdd(struct PhoneForward *pf,
     RadixTree fw = pf->forward;
     RadixTree bw = pf->backward;
 
-    *fwInsert = radixTreeInsert(fw, num1);
+    *fwInsert = radixTreeInsert(fw, num1, pf->pool, pf->epoch);
 
     if (*fwInsert == NULL) {
         return false;
     } else {
-        *bwInsert = radixTreeInsert(bw, num2);
+        *bwInsert = radixTreeInsert(bw, num2, pf->pool, NULL);
 
         if (*bwInsert == NULL) {
-            radixTreeBalance(*fwInsert);
+            radixTreeBalance(*fwInsert, pf->pool, pf->epoch);
             return false;
         } else {
             return true;
@@ -196,36 +473,6 @@ static bool phfwdPrepareTreesForAdd(struct PhoneForward *pf,
     }
 }
 
-/**
- * @brief Uzupełnia dane w węźle bw.
- * Uzupełnia dane w węźle bw pozwalające odwrócić przekierowanie.
- * @param[in] bw - wskaźnik na węzeł.
- * @param[in] redirection - wskaźnik na węzeł reprezentujący
- *        prefiks przekierowywany na @p bw.
- * @return Wskaźnik na uzupełnione dane, w przypadku problemów
- *         z przydzieleniem pamięci NULL.
- */
-static ListNode phfwdPrepareBw(RadixTreeNode bw, RadixTreeNode redirection) {
-    List list = radixTreeGetNodeData(bw);
-    if (list == NULL) {
-        list = listCreate();
-        if (list == NULL) {
-            return NULL;
-        }
-    }
-    ListNode result = listPushBack(list, redirection);
-    if (result == NULL) {
-        if (listIsEmpty(list)) {
-            listDestroy(list);
-            assert(radixTreeGetNodeData(bw) == NULL);
-        }
-        return NULL;
-    } else {
-        radixTreeSetData(bw, list);
-        return result;
-    }
-}
-
 /**
  * @brief wskaźnik na struct ForwardData.
  * @see struct ForwardData
@@ -243,488 +490,3155 @@ struct ForwardData {
     RadixTreeNode treeNode;
 
     /**
-     * Wskaźnik na element listy w węźle treeNode z drzewa
-     * PhoneForward->backward reprezentujący wskaźnik na dany węzeł.
+     * Pozycja w tablicy (BackwardData->items) węzła treeNode z drzewa
+     * PhoneForward->backward zawierająca wskaźnik na dane przekierowanie.
      * @see treeNode
      * @see PhoneForward
      */
-    ListNode listNode;
+    size_t backwardIndex;
+
+    /**
+     * @brief Długość przekierowywanego prefiksu.
+     */
+    size_t sourceLength;
+
+    /**
+     * @brief Długość prefiksu na który jest przekierowywany prefiks
+     * (tekstu reprezentowanego przez treeNode).
+     */
+    size_t targetLength;
+
+    /**
+     * @brief Przekierowywany prefiks i prefiks na który jest przekierowywany,
+     * każdy zakończony '\0'.
+     * Tekst reprezentowany przez węzeł drzewa nie zmienia się przy
+     * rozcinaniu i scalaniu krawędzi, więc nie wymaga aktualizacji.
+     * @see phfwdForwardDataSource
+     * @see phfwdForwardDataTarget
+     */
+    char numbers[];
 };
 
 /**
- * @brief Do balansowania drzewa w przypadku nieudanego wstawienia.
- * Usuwa zbyteczne węzły.
- * @see radixTreeBalance
- * @param[in] fwInsert - wskaźnik na
- * @param[in] bwInsert
+ * @brief Rozmiar struktury ForwardData.
+ * @param[in] sourceLength - długość przekierowywanego prefiksu.
+ * @param[in] targetLength - długość prefiksu na który jest przekierowywany.
+ * @return Rozmiar w bajtach struktury przechowującej oba prefiksy.
  */
-static void phfwdPrepareClean(RadixTreeNode fwInsert, RadixTreeNode bwInsert) {
-    radixTreeBalance(bwInsert);
-    radixTreeBalance(fwInsert);
+static size_t phfwdForwardDataSize(size_t sourceLength, size_t targetLength) {
+    return sizeof(struct ForwardData) + sourceLength + targetLength
+           + (size_t) 2;
 }
 
 /**
- * @brief Usuwa odwrócone przekierowanie.
- * Usuwa informacje o przekierowaniu z drzewa PhoneForward->backward.
- * @see ForwardData
  * @param[in] fd - informacje o przekierowaniu.
+ * @return Wskaźnik na przekierowywany prefiks.
  */
-static void phfwdDeleteNodeFromBackwardTree(ForwardData fd) {
-    assert(fd != NULL);
-    assert(fd->treeNode != NULL);
-    assert(fd->listNode != NULL);
-    List list = radixTreeGetNodeData(fd->treeNode);
-    assert(list != NULL);
-    listDeleteNode(fd->listNode);
-    if (listIsEmpty(list)) {
-        listDestroy(list);
-        radixTreeSetData(fd->treeNode, NULL);
-        radixTreeBalance(fd->treeNode);
-    }
+static const char *phfwdForwardDataSource(ForwardData fd) {
+    return fd->numbers;
 }
 
 /**
- * @brief Wstawia dane o przekierowaniach do węzłów.
- * @param[in] fwInsert - wskaźnik na węzeł do wstawienia danych w drzewie
- *        PhoneForward->forward.
- * @param[in] bwInsert wskaźnik na węzeł do wstawienia danych w drzewie
- *        PhoneForward->backward.
- * @return W przypadku sukcesu zwraca true, w przeciwnym przypadku false.
+ * @param[in] fd - informacje o przekierowaniu.
+ * @return Wskaźnik na prefiks na który jest przekierowywany prefiks.
  */
-static bool phfwdAddSetNodes(RadixTreeNode fwInsert, RadixTreeNode bwInsert) {
-    ListNode newNode = phfwdPrepareBw(bwInsert, fwInsert);
-    if (newNode == NULL) {
-        phfwdPrepareClean(fwInsert, bwInsert);
-        return false;
-    } else {
-        ForwardData fd = malloc(sizeof(struct ForwardData));
-        if (fd == NULL) {
-            listDeleteNode(newNode);
-            List list = radixTreeGetNodeData(bwInsert);
-            if (listIsEmpty(list)) {
-                listDestroy(list);
-                radixTreeSetData(bwInsert, NULL);
-            }
-            phfwdPrepareClean(fwInsert, bwInsert);
-            return false;
-        } else {
-            ForwardData old = radixTreeGetNodeData(fwInsert);
-            if (old != NULL) {
-                phfwdDeleteNodeFromBackwardTree(old);
-                free(old);
-                radixTreeSetData(fwInsert, NULL);
-            }
+static const char *phfwdForwardDataTarget(ForwardData fd) {
+    return fd->numbers + fd->sourceLength + 1;
+}
 
-            fd->treeNode = bwInsert;
-            fd->listNode = newNode;
-            radixTreeSetData(fwInsert, fd);
+/**
+ * @brief Liczba elementów dodanych do tablicy BackwardData poza kolejnością
+ * (lub dziur po usuniętych elementach), po przekroczeniu której tablica może
+ * zostać posortowana.
+ * @see phfwdBackwardDataAdd
+ * @see phfwdBackwardDataRemove
+ */
+#define PHFWD_BACKWARD_UNSORTED_LIMIT 32
 
-            return true;
+/**
+ * @brief Tablica BackwardData jest sortowana, gdy elementy dodane poza
+ * kolejnością (lub dziury w części posortowanej) stanowią więcej niż
+ * 1 / PHFWD_BACKWARD_UNSORTED_RATIO części posortowanej.
+ * @see phfwdBackwardDataAdd
+ * @see phfwdBackwardDataRemove
+ */
+#define PHFWD_BACKWARD_UNSORTED_RATIO 32
 
-        }
-    }
+/**
+ * @brief wskaźnik na struct BackwardData.
+ * @see struct BackwardData
+ */
+typedef struct BackwardData *BackwardData;
+
+/**
+ * @brief Dane przechowywane w węzłach PhoneForward->backward.
+ * Tablica przekierowań na numer reprezentowany przez węzeł składa się
+ * z części posortowanej względem przekierowywanych prefiksów (pierwsze
+ * @p sortedSize pozycji, usunięte elementy zostawiają w niej dziury - NULL)
+ * i krótkiej nieposortowanej końcówki bez dziur. Pozwala to phfwdReverse
+ * scalać posortowane ciągi numerów zamiast je sortować.
+ * Każde przekierowanie pamięta swoją pozycję (ForwardData->backwardIndex).
+ * @see phfwdAddRedir
+ */
+struct BackwardData {
+    /**
+     * @brief Tablica informacji o przekierowaniach (ForwardData),
+     * przydzielona z puli.
+     */
+    ForwardData *items;
+
+    /**
+     * @brief Rozmiar tablicy @p items.
+     */
+    size_t capacity;
+
+    /**
+     * @brief Liczba zajętych pozycji @p items (razem z dziurami).
+     */
+    size_t size;
+
+    /**
+     * @brief Długość posortowanej części @p items (razem z dziurami).
+     */
+    size_t sortedSize;
 
+    /**
+     * @brief Liczba dziur w posortowanej części @p items.
+     */
+    size_t holes;
+};
 
+/**
+ * @brief Porównuje przekierowania względem przekierowywanych prefiksów.
+ * @param[in] a - informacje o przekierowaniu (ForwardData).
+ * @param[in] b - informacje o przekierowaniu (ForwardData).
+ * @return Wynik strcmp dla przekierowywanych prefiksów @p a i @p b.
+ */
+static int phfwdCompareSources(void *a, void *b) {
+    return strcmp(phfwdForwardDataSource(a), phfwdForwardDataSource(b));
 }
 
 /**
- * @brief Sprawdza czy @p num1 to poprawny numer.
- * @param[in] num1 - wskaźnik na numer.
- * @return Jeżeli odpowiedź jest pozytywna to true,
- *         w przeciwnym przypadku false.
+ * @brief Porównuje przekierowania względem przekierowywanych prefiksów.
+ * Używany w qsort.
+ * @param[in] a - wskaźnik na informacje o przekierowaniu (ForwardData).
+ * @param[in] b - wskaźnik na informacje o przekierowaniu (ForwardData).
+ * @return Wynik strcmp dla przekierowywanych prefiksów @p a i @p b.
  */
-static bool phfwdIsNumber(const char *num1) {
-    if (num1 == NULL || *num1 == '\0') {
-        return false;
-    } else {
-        const char *ptr = num1;
-        while (*ptr != '\0') {
-            if (!(characterIsDigit(*ptr))) {
-                return false;
-            }
-            ptr++;
-        }
-        return true;
-    }
+static int phfwdCompareSourcesQsort(const void *a, const void *b) {
+    return phfwdCompareSources(*(const ForwardData *) a,
+                               *(const ForwardData *) b);
 }
 
-bool phfwdAdd(struct PhoneForward *pf, const char *num1, const char *num2) {
-    if (!phfwdIsNumber(num1) || !phfwdIsNumber(num2)
-        || strcmp(num1, num2) == 0) {
-        return false;
-    } else {
-        RadixTree fwInsert;
-        RadixTree bwInsert;
-        return phfwdPrepareTreesForAdd(pf, num1, num2, &fwInsert, &bwInsert)
-               && phfwdAddSetNodes(fwInsert, bwInsert);
+/**
+ * @brief Tworzy dane węzła drzewa backward z pustą tablicą.
+ * @param[in, out] pool - pula z której przydzielane są dane.
+ * @return Wskaźnik na dane, NULL w przypadku problemów z pamięcią.
+ */
+static BackwardData phfwdBackwardDataCreate(MemoryPool pool) {
+    BackwardData data = memoryPoolAlloc(pool, sizeof(struct BackwardData));
+    if (data == NULL) {
+        return NULL;
     }
-
+    data->items = NULL;
+    data->capacity = 0;
+    data->size = 0;
+    data->sortedSize = 0;
+    data->holes = 0;
+    return data;
 }
 
 /**
- * @brief Usuwa odpowiedniki danych z PhoneForward->forward w backward.
- * Używany w radixTreeDeleteSubTree.
- * @see radixTreeDeleteSubTree
- * @see phfwdRemove
- * @param[in] data - wskaźnik na dane z węzła drzewa PhoneForward->forward.
- * @param[in] backwardTree - wskaźnik na drzewo PhoneForward->backward.
+ * @brief Usuwa dane węzła drzewa backward.
+ * @param[in] data - wskaźnik na dane.
+ * @param[in, out] pool - pula z której przydzielono dane.
  */
-static void phfwdRemoveCleaner(void *data, void *backwardTree) {
-    assert(data != NULL);
-    assert(backwardTree != NULL);
-    (void) backwardTree;
-    ForwardData fd = (ForwardData) data;
-    phfwdDeleteNodeFromBackwardTree(fd);
-    free(fd);
+static void phfwdBackwardDataDestroy(BackwardData data, MemoryPool pool) {
+    if (data->items != NULL) {
+        memoryPoolFree(pool, data->items,
+                       data->capacity * sizeof(ForwardData));
+    }
+    memoryPoolFree(pool, data, sizeof(struct BackwardData));
+}
 
+/**
+ * @brief Zwraca pierwszą pozycję od @p pos, która nie jest dziurą.
+ * @param[in] pos - wskaźnik na pozycję w tablicy BackwardData->items.
+ * @param[in] end - wskaźnik za koniec przeglądanego fragmentu.
+ * @return Wskaźnik na pozycję z przekierowaniem albo @p end.
+ */
+static ForwardData *phfwdBackwardDataSkipHoles(ForwardData *pos,
+                                               ForwardData *end) {
+    while (pos != end && *pos == NULL) {
+        pos++;
+    }
+    return pos;
 }
 
-void phfwdRemove(struct PhoneForward *pf, const char *num) {
-    if (!phfwdIsNumber(num)) {
-        return;
+/**
+ * @brief Sortuje całą tablicę przekierowań usuwając dziury.
+ * Posortowana część jest jedynie scalana z posortowaną końcówką.
+ * W przypadku problemów z pamięcią tablica pozostaje bez zmian.
+ * #### Złożoność
+ * O(m + k log k), gdzie m to rozmiar tablicy, a k to długość końcówki
+ * @param[in, out] data - wskaźnik na dane węzła drzewa backward.
+ * @param[in, out] pool - pula z której przydzielana jest tablica.
+ */
+static void phfwdBackwardDataSort(BackwardData data, MemoryPool pool) {
+    ForwardData *merged = memoryPoolAlloc(pool,
+                                          data->capacity
+                                          * sizeof(ForwardData));
+    if (merged == NULL) {
+        return;
+    }
+    qsort(data->items + data->sortedSize, data->size - data->sortedSize,
+          sizeof(ForwardData), phfwdCompareSourcesQsort);
+
+    ForwardData *sortedEnd = data->items + data->sortedSize;
+    ForwardData *end = data->items + data->size;
+    ForwardData *a = phfwdBackwardDataSkipHoles(data->items, sortedEnd);
+    ForwardData *b = sortedEnd;
+    size_t i = 0;
+    while (a != sortedEnd || b != end) {
+        if (b == end
+            || (a != sortedEnd && phfwdCompareSources(*a, *b) <= 0)) {
+            merged[i] = *a;
+            a = phfwdBackwardDataSkipHoles(a + 1, sortedEnd);
+        } else {
+            merged[i] = *b;
+            b++;
+        }
+        merged[i]->backwardIndex = i;
+        i++;
+    }
+
+    memoryPoolFree(pool, data->items, data->capacity * sizeof(ForwardData));
+    data->items = merged;
+    data->size = i;
+    data->sortedSize = i;
+    data->holes = 0;
+}
+
+/**
+ * @brief Dopisuje przekierowanie na koniec tablicy.
+ * W razie potrzeby podwaja rozmiar tablicy.
+ * @param[in, out] data - wskaźnik na dane węzła drzewa backward.
+ * @param[in] fd - informacje o przekierowaniu.
+ * @param[in, out] pool - pula z której przydzielana jest tablica.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
+ */
+static bool phfwdBackwardDataPush(BackwardData data, ForwardData fd,
+                                  MemoryPool pool) {
+    if (data->size == data->capacity) {
+        size_t capacity = data->capacity == 0 ? 1 : 2 * data->capacity;
+        ForwardData *items = memoryPoolAlloc(pool,
+                                             capacity * sizeof(ForwardData));
+        if (items == NULL) {
+            return false;
+        }
+        if (data->items != NULL) {
+            memcpy(items, data->items, data->size * sizeof(ForwardData));
+            memoryPoolFree(pool, data->items,
+                           data->capacity * sizeof(ForwardData));
+        }
+        data->items = items;
+        data->capacity = capacity;
+    }
+    fd->backwardIndex = data->size;
+    data->items[data->size] = fd;
+    data->size++;
+    return true;
+}
+
+/**
+ * @brief Dodaje przekierowanie do tablicy.
+ * Przekierowanie z prefiksem nie mniejszym od ostatniego w posortowanej
+ * części, przy pustej końcówce, przedłuża część posortowaną, pozostałe
+ * trafiają do końcówki. Gdy końcówka urośnie (patrz
+ * PHFWD_BACKWARD_UNSORTED_LIMIT i PHFWD_BACKWARD_UNSORTED_RATIO), cała
+ * tablica jest sortowana.
+ * #### Złożoność
+ * Zamortyzowana O(log m + PHFWD_BACKWARD_UNSORTED_RATIO), gdzie m to
+ * rozmiar tablicy
+ * @param[in, out] data - wskaźnik na dane węzła drzewa backward.
+ * @param[in] fd - informacje o przekierowaniu.
+ * @param[in, out] pool - pula z której przydzielana jest tablica.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
+ */
+static bool phfwdBackwardDataAdd(BackwardData data, ForwardData fd,
+                                 MemoryPool pool) {
+    if (!phfwdBackwardDataPush(data, fd, pool)) {
+        return false;
+    }
+
+    size_t index = fd->backwardIndex;
+    if (data->sortedSize == index
+        && (index == 0
+            || (data->items[index - 1] != NULL
+                && phfwdCompareSources(data->items[index - 1], fd) <= 0))) {
+        data->sortedSize++;
+    } else if (data->size - data->sortedSize > PHFWD_BACKWARD_UNSORTED_LIMIT
+               && (data->size - data->sortedSize)
+                  * PHFWD_BACKWARD_UNSORTED_RATIO > data->sortedSize) {
+        phfwdBackwardDataSort(data, pool);
+    }
+    return true;
+}
+
+/**
+ * @brief Usuwa przekierowanie z tablicy.
+ * Z końcówki przekierowanie jest usuwane przez wstawienie na jego miejsce
+ * ostatniego elementu, w części posortowanej zostaje po nim dziura.
+ * Gdy dziur jest dużo (patrz PHFWD_BACKWARD_UNSORTED_LIMIT
+ * i PHFWD_BACKWARD_UNSORTED_RATIO), tablica jest sortowana.
+ * #### Złożoność
+ * Zamortyzowana O(PHFWD_BACKWARD_UNSORTED_RATIO)
+ * @param[in, out] data - wskaźnik na dane węzła drzewa backward.
+ * @param[in] fd - informacje o przekierowaniu.
+ * @param[in, out] pool - pula z której przydzielana jest tablica.
+ * @return true jeżeli tablica stała się pusta, false w przeciwnym przypadku.
+ */
+static bool phfwdBackwardDataRemove(BackwardData data, ForwardData fd,
+                                    MemoryPool pool) {
+    size_t index = fd->backwardIndex;
+    assert(index < data->size && data->items[index] == fd);
+    if (index >= data->sortedSize) {
+        data->size--;
+        data->items[index] = data->items[data->size];
+        data->items[index]->backwardIndex = index;
+    } else if (index + 1 == data->size) {
+        data->size--;
+        data->sortedSize--;
+        while (data->size > 0 && data->items[data->size - 1] == NULL) {
+            data->size--;
+            data->sortedSize--;
+            data->holes--;
+        }
     } else {
-        RadixTreeNode subTreeNode;
-        int findResult = radixTreeFindLite(pf->forward, num, &subTreeNode);
+        data->items[index] = NULL;
+        data->holes++;
+        if (data->holes > PHFWD_BACKWARD_UNSORTED_LIMIT
+            && data->holes * PHFWD_BACKWARD_UNSORTED_RATIO
+               > data->sortedSize) {
+            phfwdBackwardDataSort(data, pool);
+        }
+    }
+    return data->size == data->holes;
+}
 
-        if (findResult == RADIX_TREE_FOUND
-            || findResult == RADIX_TREE_SUBSTR) {
-            radixTreeDeleteSubTree(subTreeNode, phfwdRemoveCleaner,
-                                   pf->backward);
-        } else {
-            return;
+/**
+ * @brief Uzupełnia dane w węźle bw.
+ * Uzupełnia dane w węźle bw pozwalające odwrócić przekierowanie.
+ * @param[in] bw - wskaźnik na węzeł.
+ * @param[in] redirection - wskaźnik na informacje o przekierowaniu
+ *        na @p bw.
+ * @param[in, out] pool - pula z której przydzielane są dane węzłów.
+ * @return W przypadku sukcesu zwraca true, w przypadku problemów
+ *         z przydzieleniem pamięci false.
+ */
+static bool phfwdPrepareBw(RadixTreeNode bw, ForwardData redirection,
+                           MemoryPool pool) {
+    BackwardData data = radixTreeGetNodeData(bw);
+    if (data == NULL) {
+        data = phfwdBackwardDataCreate(pool);
+        if (data == NULL) {
+            return false;
+        }
+    }
+    if (!phfwdBackwardDataAdd(data, redirection, pool)) {
+        if (data->size == data->holes) {
+            phfwdBackwardDataDestroy(data, pool);
+            assert(radixTreeGetNodeData(bw) == NULL);
         }
+        return false;
+    } else {
+        radixTreeSetData(bw, data);
+        return true;
     }
 }
 
 /**
- * @brief Poprawia wskaźniki dla phfwdGetNumber.
- * @see phfwdGetNumber
- * @param[in] tree - wskaźnik na drzewo numerów.
- * @param[in] num - wskaźnik na tekst reprezentujący numer.
- * @param[in, out] ptr - wskaźnik na wskaźnik na węzeł którego ojciec
- *        reprezentuje
- *        najdłuższy możliwy pasujący prefiks numeru
- *        a krawędź wchodząca do @p ptr pewną jego część
- *        następującą po prefiksie. Po wykonaniu operacji @p *ptr wskazuje
- *        na węzeł reprezentujący najdłuższy pasujący prefiks numeru.
- * @param[in,out] matchedTxt - wskaźnik na wskaźnik na tekst
- *        reprezentujący dopasowanie
- *        numeru w drzewie. Po wykonaniu operacji wskazuje na dopasowanie
- *        wyłączające częściowe dopasowanie krawędzi w @p tree.
+ * @brief Zwalnia informacje o przekierowaniu.
+ * @param[in] data - informacje o przekierowaniu (ForwardData).
+ * @param[in, out] pool - pula z której przydzielono @p data.
  */
-static void
-phfwdSetPointersForGettingText(RadixTree tree,
-                               const char *num, RadixTreeNode *ptr,
-                               const char **matchedTxt) {
-    size_t nodeMatch = 0;
-    int matchMode;
-    int findResult = radixTreeFind(tree, num, ptr, matchedTxt,
-                                   &nodeMatch, &matchMode);
-    if (findResult != RADIX_TREE_FOUND
-        && (matchMode != RADIX_TREE_NODE_MATCH_FULL)) {
+static void phfwdForwardDataFree(void *data, void *pool) {
+    ForwardData fd = data;
+    memoryPoolFree(pool, fd,
+                   phfwdForwardDataSize(fd->sourceLength, fd->targetLength));
+}
 
-        *matchedTxt = (*matchedTxt) - nodeMatch;
-        *ptr = radixTreeFather(*ptr);
+/**
+ * @brief Zwalnia informacje o przekierowaniu odłączone od drzewa forward,
+ * gdy nie będą ich już odczytywać czytelnicy.
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[in] fd - informacje o przekierowaniu.
+ */
+static void phfwdForwardDataRetire(struct PhoneForward *pf, ForwardData fd) {
+    epochRetire(pf->epoch, fd, phfwdForwardDataFree, pf->pool);
+}
+
+/**
+ * @brief Pobiera informacje o przekierowaniu ze zwartej postaci drzewa.
+ * @param[in] compiled - wskaźnik na zwartą postać drzewa.
+ * @param[in] index - wartość węzła zwartej postaci.
+ * @return Informacje o przekierowaniu.
+ */
+static ForwardData phfwdCompiledRedirection(
+        const struct CompiledForward *compiled, uint32_t index) {
+    if (compiled->redirections != NULL) {
+        return compiled->redirections[index];
+    } else {
+        return (ForwardData) (compiled->image + compiled->offsets[index]);
     }
 }
 
 /**
- * @brief Pobiera przekierowany numer.
- * @param[in] forward - wskaźnik na węzeł reprezentujący drzewo.
- * @param[in] num - wskaźnik na numer.
- * @return Przekierowany numer.
+ * @brief Odłącza zwartą postać drzewa przed modyfikacją drzewa forward.
+ * Zwartą postać zwalnia gdy nie będą jej już odczytywać czytelnicy.
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania.
  */
-static const char *phfwdGetNumber(RadixTree forward, const char *num) {
-    RadixTreeNode ptr;
-    const char *matchedTxt;
+static void phfwdDropCompiled(struct PhoneForward *pf) {
+    struct CompiledForward *compiled = atomic_load_explicit(
+            &pf->compiled, memory_order_relaxed);
+    if (compiled != NULL) {
+        atomic_store_explicit(&pf->compiled, NULL, memory_order_release);
+        epochRetire(pf->epoch, compiled, phfwdCompiledFree, NULL);
+    }
+}
+
+/**
+ * @brief Do balansowania drzewa w przypadku nieudanego wstawienia.
+ * Usuwa zbyteczne węzły.
+ * @see radixTreeBalance
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[in] fwInsert - wskaźnik na węzeł w drzewie PhoneForward->forward.
+ * @param[in] bwInsert - wskaźnik na węzeł w drzewie PhoneForward->backward.
+ */
+static void phfwdPrepareClean(struct PhoneForward *pf, RadixTreeNode fwInsert,
+                              RadixTreeNode bwInsert) {
+    radixTreeBalance(bwInsert, pf->pool, NULL);
+    radixTreeBalance(fwInsert, pf->pool, pf->epoch);
+}
 
-    phfwdSetPointersForGettingText(forward, num, &ptr, &matchedTxt);
+/**
+ * @brief Usuwa odwrócone przekierowanie.
+ * Usuwa informacje o przekierowaniu z drzewa PhoneForward->backward.
+ * @see ForwardData
+ * @param[in] fd - informacje o przekierowaniu.
+ * @param[in, out] pool - pula z której przydzielane są dane i węzły drzew.
+ */
+static void phfwdDeleteNodeFromBackwardTree(ForwardData fd, MemoryPool pool) {
+    assert(fd != NULL);
+    assert(fd->treeNode != NULL);
+    BackwardData data = radixTreeGetNodeData(fd->treeNode);
+    assert(data != NULL);
+    if (phfwdBackwardDataRemove(data, fd, pool)) {
+        phfwdBackwardDataDestroy(data, pool);
+        radixTreeSetData(fd->treeNode, NULL);
+        radixTreeBalance(fd->treeNode, pool, NULL);
+    }
+}
 
-    while (!radixTreeIsRoot(ptr) && radixTreeGetNodeData(ptr) == NULL) {
-        matchedTxt = matchedTxt - radixTreeHowManyChars(ptr);
-        ptr = radixTreeFather(ptr);
+/**
+ * @brief Wstawia dane o przekierowaniach do węzłów.
+ * Poprzednie przekierowanie @p fwInsert jest zastępowane jednym zapisem,
+ * więc czytelnicy widzą stare albo nowe przekierowanie.
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[in] fwInsert - wskaźnik na węzeł do wstawienia danych w drzewie
+ *        PhoneForward->forward.
+ * @param[in] bwInsert wskaźnik na węzeł do wstawienia danych w drzewie
+ *        PhoneForward->backward.
+ * @param[in] num1 - numer reprezentowany przez @p fwInsert.
+ * @param[in] num2 - numer reprezentowany przez @p bwInsert.
+ * @return W przypadku sukcesu zwraca true, w przeciwnym przypadku false.
+ */
+static bool phfwdAddSetNodes(struct PhoneForward *pf,
+                             RadixTreeNode fwInsert, RadixTreeNode bwInsert,
+                             const char *num1, const char *num2) {
+    size_t sourceLength = strlen(num1);
+    size_t targetLength = strlen(num2);
+    ForwardData fd = memoryPoolAlloc(pf->pool,
+                                     phfwdForwardDataSize(sourceLength,
+                                                          targetLength));
+    if (fd == NULL) {
+        phfwdPrepareClean(pf, fwInsert, bwInsert);
+        return false;
     }
-    char *result = NULL;
-    if (radixTreeIsRoot(ptr)) {
-        assert(matchedTxt == num);
-        result = malloc(strlen(matchedTxt) + (size_t) 1);
-        if (result == NULL) {
-            return NULL;
-        } else {
-            strcpy(result, matchedTxt);
-            return result;
+
+    fd->sourceLength = sourceLength;
+    fd->targetLength = targetLength;
+    memcpy(fd->numbers, num1, sourceLength + (size_t) 1);
+    memcpy(fd->numbers + sourceLength + 1, num2, targetLength + (size_t) 1);
+
+    if (!phfwdPrepareBw(bwInsert, fd, pf->pool)) {
+        memoryPoolFree(pf->pool, fd,
+                       phfwdForwardDataSize(sourceLength, targetLength));
+        phfwdPrepareClean(pf, fwInsert, bwInsert);
+        return false;
+    } else {
+        fd->treeNode = bwInsert;
+
+        ForwardData old = radixTreeGetNodeData(fwInsert);
+        radixTreeSetData(fwInsert, fd);
+        if (old != NULL) {
+            phfwdDeleteNodeFromBackwardTree(old, pf->pool);
+            phfwdForwardDataRetire(pf, old);
         }
+        return true;
+    }
+}
+
+/**
+ * @brief Sprawdza czy @p num1 to poprawny numer.
+ * @param[in] num1 - wskaźnik na numer.
+ * @return Jeżeli odpowiedź jest pozytywna to true,
+ *         w przeciwnym przypadku false.
+ */
+static bool phfwdIsNumber(const char *num1) {
+    if (num1 == NULL || *num1 == '\0') {
+        return false;
     } else {
-        ForwardData fd = (ForwardData) radixTreeGetNodeData(ptr);
-        assert(fd != NULL);
-        char *prefix = radixGetFullText(fd->treeNode);
-        if (prefix == NULL) {
-            return NULL;
-        } else {
-            result = concatenate(prefix, matchedTxt);
-            free(prefix);
-            return result;
+        const char *ptr = num1;
+        while (*ptr != '\0') {
+            if (!(characterIsDigit(*ptr))) {
+                return false;
+            }
+            ptr++;
         }
+        return true;
+    }
+}
+
+bool phfwdAdd(struct PhoneForward *pf, const char *num1, const char *num2) {
+    if (pf->readOnly || !phfwdIsNumber(num1) || !phfwdIsNumber(num2)
+        || strcmp(num1, num2) == 0) {
+        return false;
+    } else {
+        RadixTree fwInsert;
+        RadixTree bwInsert;
+        phfwdLockWrite(pf);
+        phfwdDropCompiled(pf);
+        bool result =
+                phfwdPrepareTreesForAdd(pf, num1, num2, &fwInsert, &bwInsert)
+                && phfwdAddSetNodes(pf, fwInsert, bwInsert, num1, num2);
+        phfwdUnlockWrite(pf);
+        return result;
     }
 
 }
 
-const struct PhoneNumbers *phfwdGet(struct PhoneForward *pf, const char *num) {
-    if (!phfwdIsNumber(num)) {
-        return phfwdEmptySequenceResult();
+/**
+ * @brief Usuwa odpowiedniki danych z PhoneForward->forward w backward.
+ * Używany w radixTreeDeleteSubTree.
+ * @see radixTreeDeleteSubTree
+ * @see phfwdRemove
+ * @param[in] data - wskaźnik na dane z węzła drzewa PhoneForward->forward.
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania.
+ */
+static void phfwdRemoveCleaner(void *data, void *pf) {
+    assert(data != NULL);
+    assert(pf != NULL);
+    ForwardData fd = (ForwardData) data;
+    phfwdDeleteNodeFromBackwardTree(fd, ((struct PhoneForward *) pf)->pool);
+    phfwdForwardDataRetire(pf, fd);
+
+}
+
+void phfwdRemove(struct PhoneForward *pf, const char *num) {
+    if (pf->readOnly || !phfwdIsNumber(num)) {
+        return;
     } else {
-        struct PhoneNumbers *result = phfwdCreatePhoneNumbersStructure(1);
-        if (result == NULL) {
-            return NULL;
-        } else {
-            const char *number = phfwdGetNumber(pf->forward, num);
-            if (number == NULL) {
-                phnumDelete(result);
-                return NULL;
-            } else {
-                result->numbers[0] = (char *) number;
-                return result;
-            }
+        RadixTreeNode subTreeNode;
+        phfwdLockWrite(pf);
+        int findResult = radixTreeFindLite(pf->forward, num, &subTreeNode);
+
+        if (findResult == RADIX_TREE_FOUND
+            || findResult == RADIX_TREE_SUBSTR) {
+            phfwdDropCompiled(pf);
+            radixTreeDeleteSubTree(subTreeNode, phfwdRemoveCleaner,
+                                   pf, pf->pool, pf->epoch);
         }
+        phfwdUnlockWrite(pf);
+    }
+}
 
+/**
+ * @brief Dane dla funkcji numerującej przekierowania przy kompilacji.
+ * @see phfwdCompileIndex
+ */
+struct CompileData {
+    /**
+     * @brief Tablica na informacje o przekierowaniach.
+     */
+    ForwardData *redirections;
+
+    /**
+     * @brief Liczba zapisanych informacji o przekierowaniach.
+     */
+    size_t howMany;
+};
+
+/**
+ * @brief Zapisuje informacje o przekierowaniu w tablicy przekierowań.
+ * Używany w flatTreeCreate.
+ * @see phfwdCompile
+ * @param[in] data - wskaźnik na dane z węzła drzewa PhoneForward->forward.
+ * @param[in, out] compileData - wskaźnik na struct CompileData.
+ * @return Pozycja informacji o przekierowaniu w tablicy.
+ */
+static uint32_t phfwdCompileIndex(void *data, void *compileData) {
+    struct CompileData *state = compileData;
+    state->redirections[state->howMany] = data;
+    state->howMany++;
+    return (uint32_t) (state->howMany - 1);
+}
+
+/**
+ * @brief Tworzy zwartą postać drzewa forward.
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[out] redirections - @p *redirections po udanym wykonaniu wskazuje
+ *        na tablicę informacji o przekierowaniach w kolejności przeszukiwania
+ *        wszerz (do zwolnienia przez free).
+ * @param[out] howMany - liczba przekierowań.
+ * @return Zwarta postać drzewa, której wartościami są pozycje
+ *         w @p *redirections, NULL w przypadku problemów z pamięcią.
+ */
+static FlatTree phfwdFlattenForward(struct PhoneForward *pf,
+                                    ForwardData **redirections,
+                                    size_t *howMany) {
+    *howMany = 0;
+    radixTreeFold(pf->forward, radixTreeCountDataFunction, howMany);
+    if (*howMany >= FLAT_TREE_NO_VALUE) {
+        return NULL;
     }
-    return NULL;
+
+    struct CompileData compileData;
+    compileData.howMany = 0;
+    compileData.redirections = malloc((*howMany + (size_t) 1)
+                                      * sizeof(ForwardData));
+    if (compileData.redirections == NULL) {
+        return NULL;
+    }
+    FlatTree result = flatTreeCreate(pf->forward, phfwdCompileIndex,
+                                     &compileData);
+    if (result == NULL) {
+        free(compileData.redirections);
+    } else {
+        assert(compileData.howMany == *howMany);
+        *redirections = compileData.redirections;
+    }
+    return result;
 }
 
-void phnumDelete(const struct PhoneNumbers *pnum) {
-    if (pnum != NULL) {
-        size_t i;
-        for (i = 0; i < pnum->howMany; i++) {
-            free(pnum->numbers[i]);
-            pnum->numbers[i] = NULL;
+bool phfwdCompile(struct PhoneForward *pf) {
+    if (pf == NULL) {
+        return false;
+    } else if (pf->mapped != NULL) {
+        return true;
+    }
+
+    phfwdLockWrite(pf);
+    bool result = false;
+    size_t howMany;
+    struct CompiledForward *compiled = malloc(sizeof(struct CompiledForward));
+    if (compiled != NULL) {
+        compiled->image = NULL;
+        compiled->offsets = NULL;
+        compiled->tree = phfwdFlattenForward(pf, &compiled->redirections,
+                                             &howMany);
+        if (compiled->tree != NULL) {
+            phfwdDropCompiled(pf);
+            atomic_store_explicit(&pf->compiled, compiled,
+                                  memory_order_release);
+            result = true;
+        } else {
+            free(compiled);
         }
-        free(pnum->numbers);
-        free((void *) pnum);
+    }
+    phfwdUnlockWrite(pf);
+    return result;
+}
+
+/**
+ * @brief Początek pliku z obrazem struktury.
+ * @see phfwdSave
+ */
+#define PHFWD_IMAGE_MAGIC "PHFWDIMG"
+
+/**
+ * @brief Długość @ref PHFWD_IMAGE_MAGIC.
+ */
+#define PHFWD_IMAGE_MAGIC_LENGTH 8
+
+/**
+ * @brief Wersja formatu obrazu struktury.
+ */
+#define PHFWD_IMAGE_VERSION 1
+
+/**
+ * @brief Wartość pozwalająca wykryć obraz zapisany przy innej kolejności
+ * bajtów.
+ */
+#define PHFWD_IMAGE_BYTE_ORDER ((uint64_t) 0x0102030405060708)
+
+/**
+ * @brief Wyrównanie (w bajtach) sekcji obrazu struktury.
+ */
+#define PHFWD_IMAGE_ALIGNMENT 8
+
+/**
+ * @brief Nagłówek obrazu struktury.
+ * Obraz składa się z nagłówka, zwartej postaci drzewa forward (wartościami
+ * są numery przekierowań), zwartej postaci drzewa backward (wartościami są
+ * numery list), tablicy pozycji informacji o przekierowaniach, początków
+ * list, numerów przekierowań na listach oraz informacji o przekierowaniach
+ * (ForwardData bez wskaźników na węzły). Pozycje są liczone od początku
+ * obrazu, a sekcje są wyrównane do PHFWD_IMAGE_ALIGNMENT bajtów.
+ * @see phfwdSave
+ */
+struct ImageHeader {
+    /**
+     * @brief PHFWD_IMAGE_MAGIC (bez kończącego '\0').
+     */
+    char magic[PHFWD_IMAGE_MAGIC_LENGTH];
+
+    /**
+     * @brief PHFWD_IMAGE_VERSION.
+     */
+    uint32_t version;
+
+    /**
+     * @brief Rozmiar wskaźnika, od którego zależy układ ForwardData.
+     */
+    uint32_t pointerSize;
+
+    /**
+     * @brief PHFWD_IMAGE_BYTE_ORDER.
+     */
+    uint64_t byteOrder;
+
+    /**
+     * @brief Rozmiar obrazu w bajtach.
+     */
+    uint64_t size;
+
+    /**
+     * @brief Pozycja zwartej postaci drzewa forward.
+     */
+    uint64_t forward;
+
+    /**
+     * @brief Pozycja zwartej postaci drzewa backward.
+     */
+    uint64_t backward;
+
+    /**
+     * @brief Pozycja tablicy pozycji informacji o przekierowaniach
+     * (uint64_t).
+     */
+    uint64_t offsets;
+
+    /**
+     * @brief Liczba przekierowań.
+     */
+    uint64_t howManyRedirections;
+
+    /**
+     * @brief Pozycja tablicy howManyLists + 1 początków list (uint32_t).
+     */
+    uint64_t listStarts;
+
+    /**
+     * @brief Liczba list.
+     */
+    uint64_t howManyLists;
+
+    /**
+     * @brief Pozycja tablicy numerów przekierowań na listach (uint32_t).
+     */
+    uint64_t listItems;
+};
+
+/**
+ * @brief Informacje o przekierowaniu razem z jego numerem.
+ * @see phfwdSaveList
+ */
+struct IndexedRedirection {
+    /**
+     * @brief Informacje o przekierowaniu.
+     */
+    ForwardData fd;
+
+    /**
+     * @brief Numer przekierowania w zwartej postaci drzewa forward.
+     */
+    uint32_t index;
+};
+
+/**
+ * @brief Porównuje adresy informacji o przekierowaniach.
+ * Używany w qsort i bsearch.
+ * @param[in] a - wskaźnik na struct IndexedRedirection.
+ * @param[in] b - wskaźnik na struct IndexedRedirection.
+ * @return Liczba ujemna, zero lub dodatnia, gdy adres z @p a jest
+ *         odpowiednio mniejszy, równy lub większy od adresu z @p b.
+ */
+static int phfwdCompareRedirections(const void *a, const void *b) {
+    uintptr_t x = (uintptr_t) ((const struct IndexedRedirection *) a)->fd;
+    uintptr_t y = (uintptr_t) ((const struct IndexedRedirection *) b)->fd;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Dane dla funkcji zapisującej listy przy tworzeniu obrazu.
+ * @see phfwdSaveList
+ */
+struct SaveData {
+    /**
+     * @brief Przekierowania posortowane według adresów.
+     */
+    struct IndexedRedirection *sorted;
+
+    /**
+     * @brief Liczba przekierowań.
+     */
+    size_t howManyRedirections;
+
+    /**
+     * @brief Początki list.
+     */
+    uint32_t *listStarts;
+
+    /**
+     * @brief Liczba zapisanych list.
+     */
+    size_t howManyLists;
+
+    /**
+     * @brief Numery przekierowań na listach.
+     */
+    uint32_t *listItems;
+
+    /**
+     * @brief Liczba zapisanych numerów przekierowań.
+     */
+    size_t howManyItems;
+};
+
+/**
+ * @brief Zapisuje listę przekierowań z węzła drzewa backward.
+ * Używany w flatTreeCreate.
+ * @see phfwdSaveImage
+ * @param[in] data - wskaźnik na dane (BackwardData) z węzła drzewa
+ *        PhoneForward->backward.
+ * @param[in, out] saveData - wskaźnik na struct SaveData.
+ * @return Numer listy.
+ */
+static uint32_t phfwdSaveList(void *data, void *saveData) {
+    struct SaveData *state = saveData;
+    struct IndexedRedirection key, *found;
+    BackwardData backwardData = data;
+    size_t i;
+
+    assert(state->howManyLists < state->howManyRedirections);
+    state->listStarts[state->howManyLists] = (uint32_t) state->howManyItems;
+    for (i = 0; i < backwardData->size; i++) {
+        if (backwardData->items[i] == NULL) {
+            continue;
+        }
+        key.fd = backwardData->items[i];
+        found = bsearch(&key, state->sorted, state->howManyRedirections,
+                        sizeof(struct IndexedRedirection),
+                        phfwdCompareRedirections);
+        assert(found != NULL);
+        assert(state->howManyItems < state->howManyRedirections);
+        state->listItems[state->howManyItems] = found->index;
+        state->howManyItems++;
+    }
+    state->howManyLists++;
+    state->listStarts[state->howManyLists] = (uint32_t) state->howManyItems;
+    return (uint32_t) (state->howManyLists - 1);
+}
+
+/**
+ * @brief Zaokrągla rozmiar w górę do PHFWD_IMAGE_ALIGNMENT.
+ * @param[in] size - rozmiar w bajtach.
+ * @return Najmniejsza wielokrotność PHFWD_IMAGE_ALIGNMENT nie mniejsza
+ *         niż @p size.
+ */
+static uint64_t phfwdImageAlign(uint64_t size) {
+    return (size + (PHFWD_IMAGE_ALIGNMENT - 1))
+           / PHFWD_IMAGE_ALIGNMENT * PHFWD_IMAGE_ALIGNMENT;
+}
+
+/**
+ * @brief Zapisuje dane do pliku obrazu.
+ * @param[in, out] file - plik.
+ * @param[in] data - wskaźnik na dane.
+ * @param[in] size - rozmiar danych w bajtach.
+ * @param[in, out] position - pozycja w pliku, zwiększana o @p size.
+ * @return true w przypadku sukcesu, false w przypadku błędu zapisu.
+ */
+static bool phfwdImageWrite(FILE *file, const void *data, size_t size,
+                            uint64_t *position) {
+    *position += size;
+    return fwrite(data, 1, size, file) == size;
+}
+
+/**
+ * @brief Dopełnia plik obrazu zerami do wielokrotności
+ * PHFWD_IMAGE_ALIGNMENT bajtów.
+ * @param[in, out] file - plik.
+ * @param[in, out] position - pozycja w pliku.
+ * @return true w przypadku sukcesu, false w przypadku błędu zapisu.
+ */
+static bool phfwdImagePad(FILE *file, uint64_t *position) {
+    const char zeros[PHFWD_IMAGE_ALIGNMENT] = {0};
+    return phfwdImageWrite(file, zeros,
+                           (size_t) (phfwdImageAlign(*position) - *position),
+                           position);
+}
+
+/**
+ * @brief Zapisuje informacje o przekierowaniach do pliku obrazu.
+ * Wskaźniki na węzły drzewa backward nie są zapisywane.
+ * @param[in, out] file - plik.
+ * @param[in] redirections - tablica informacji o przekierowaniach.
+ * @param[in] howMany - liczba przekierowań.
+ * @param[in, out] position - pozycja w pliku.
+ * @return true w przypadku sukcesu, false w przypadku błędu zapisu.
+ */
+static bool phfwdImageWriteRedirections(FILE *file, ForwardData *redirections,
+                                        size_t howMany, uint64_t *position) {
+    struct ForwardData head;
+    size_t i;
+    bool result = true;
+    for (i = 0; i < howMany && result; i++) {
+        memcpy(&head, redirections[i], sizeof(struct ForwardData));
+        head.treeNode = NULL;
+        head.backwardIndex = 0;
+        result = phfwdImageWrite(file, &head, sizeof(struct ForwardData),
+                                 position)
+                 && phfwdImageWrite(file, redirections[i]->numbers,
+                                    head.sourceLength + head.targetLength
+                                    + (size_t) 2, position)
+                 && phfwdImagePad(file, position);
+    }
+    return result;
+}
+
+/**
+ * @brief Zapisuje obraz struktury do pliku.
+ * @see ImageHeader
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[in, out] file - plik otwarty do zapisu.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią
+ *         lub błędu zapisu.
+ */
+static bool phfwdSaveImage(struct PhoneForward *pf, FILE *file) {
+    ForwardData *redirections;
+    size_t howMany, i;
+    FlatTree forward = phfwdFlattenForward(pf, &redirections, &howMany);
+    if (forward == NULL) {
+        return false;
+    }
+
+    struct SaveData saveData;
+    saveData.howManyRedirections = howMany;
+    saveData.howManyLists = 0;
+    saveData.howManyItems = 0;
+    saveData.sorted = malloc((howMany + 1)
+                             * sizeof(struct IndexedRedirection));
+    saveData.listStarts = malloc((howMany + 1) * sizeof(uint32_t));
+    saveData.listItems = malloc((howMany + 1) * sizeof(uint32_t));
+    uint64_t *offsets = malloc((howMany + 1) * sizeof(uint64_t));
+    FlatTree backward = NULL;
+    bool result = false;
+
+    if (saveData.sorted != NULL && saveData.listStarts != NULL
+        && saveData.listItems != NULL && offsets != NULL) {
+        for (i = 0; i < howMany; i++) {
+            saveData.sorted[i].fd = redirections[i];
+            saveData.sorted[i].index = (uint32_t) i;
+        }
+        qsort(saveData.sorted, howMany, sizeof(struct IndexedRedirection),
+              phfwdCompareRedirections);
+        saveData.listStarts[0] = 0;
+        backward = flatTreeCreate(pf->backward, phfwdSaveList, &saveData);
+    }
+
+    if (backward != NULL) {
+        assert(saveData.howManyItems == howMany);
+        struct ImageHeader header;
+        uint64_t position = 0;
+        size_t written;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, PHFWD_IMAGE_MAGIC, PHFWD_IMAGE_MAGIC_LENGTH);
+        header.version = PHFWD_IMAGE_VERSION;
+        header.pointerSize = (uint32_t) sizeof(void *);
+        header.byteOrder = PHFWD_IMAGE_BYTE_ORDER;
+        header.howManyRedirections = howMany;
+        header.howManyLists = saveData.howManyLists;
+
+        result = phfwdImageWrite(file, &header, sizeof(header), &position);
+        header.forward = position;
+        written = result ? flatTreeSave(forward, file) : 0;
+        position += written;
+        header.backward = position;
+        written = written != 0 ? flatTreeSave(backward, file) : 0;
+        position += written;
+        result = written != 0;
+
+        header.offsets = position;
+        header.listStarts = header.offsets + howMany * sizeof(uint64_t);
+        header.listItems = phfwdImageAlign(header.listStarts
+                                           + (saveData.howManyLists + 1)
+                                             * sizeof(uint32_t));
+        uint64_t next = phfwdImageAlign(header.listItems
+                                        + howMany * sizeof(uint32_t));
+        for (i = 0; i < howMany; i++) {
+            offsets[i] = next;
+            next += phfwdImageAlign(sizeof(struct ForwardData)
+                                    + redirections[i]->sourceLength
+                                    + redirections[i]->targetLength + 2);
+        }
+
+        result = result
+                 && phfwdImageWrite(file, offsets, howMany * sizeof(uint64_t),
+                                    &position)
+                 && phfwdImageWrite(file, saveData.listStarts,
+                                    (saveData.howManyLists + 1)
+                                    * sizeof(uint32_t), &position)
+                 && phfwdImagePad(file, &position)
+                 && phfwdImageWrite(file, saveData.listItems,
+                                    howMany * sizeof(uint32_t), &position)
+                 && phfwdImagePad(file, &position)
+                 && phfwdImageWriteRedirections(file, redirections, howMany,
+                                                &position);
+        assert(!result || position == next);
+        header.size = position;
+        result = result && fseek(file, 0, SEEK_SET) == 0
+                 && fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+
+    flatTreeDelete(backward);
+    flatTreeDelete(forward);
+    free(offsets);
+    free(saveData.listItems);
+    free(saveData.listStarts);
+    free(saveData.sorted);
+    free(redirections);
+    return result;
+}
+
+bool phfwdSave(struct PhoneForward *pf, const char *filename) {
+    if (pf == NULL || filename == NULL) {
+        return false;
+    }
+    FILE *file = fopen(filename, "wb");
+    if (file == NULL) {
+        return false;
+    }
+
+    bool result;
+    if (pf->mapped != NULL) {
+        result = fwrite(pf->mapped->image, 1, pf->mapped->size, file)
+                 == pf->mapped->size;
+    } else {
+        phfwdLockRead(pf);
+        result = phfwdSaveImage(pf, file);
+        phfwdUnlock(pf);
+    }
+
+    result = fclose(file) == 0 && result;
+    if (!result) {
+        remove(filename);
+    }
+    return result;
+}
+
+/**
+ * @brief Sprawdza czy tablica mieści się w obrazie.
+ * @param[in] size - rozmiar obrazu w bajtach.
+ * @param[in] offset - pozycja tablicy.
+ * @param[in] count - liczba elementów tablicy.
+ * @param[in] elementSize - rozmiar elementu w bajtach.
+ * @return true jeżeli tablica jest wyrównana i mieści się w obrazie,
+ *         false w przeciwnym przypadku.
+ */
+static bool phfwdImageSectionValid(size_t size, uint64_t offset,
+                                   uint64_t count, size_t elementSize) {
+    return offset % PHFWD_IMAGE_ALIGNMENT == 0 && offset <= size
+           && count <= (size - offset) / elementSize;
+}
+
+/**
+ * @brief Sprawdza nagłówek obrazu struktury.
+ * @param[in] image - wskaźnik na obraz.
+ * @param[in] size - rozmiar obrazu w bajtach.
+ * @return true jeżeli nagłówek jest poprawny, a opisane w nim sekcje
+ *         mieszczą się w obrazie, false w przeciwnym przypadku.
+ */
+static bool phfwdImageValid(const char *image, size_t size) {
+    const struct ImageHeader *header = (const struct ImageHeader *) image;
+    if (size < sizeof(struct ImageHeader)
+        || memcmp(header->magic, PHFWD_IMAGE_MAGIC,
+                  PHFWD_IMAGE_MAGIC_LENGTH) != 0
+        || header->version != PHFWD_IMAGE_VERSION
+        || header->pointerSize != sizeof(void *)
+        || header->byteOrder != PHFWD_IMAGE_BYTE_ORDER
+        || header->size != size
+        || header->howManyRedirections >= FLAT_TREE_NO_VALUE
+        || header->howManyLists >= FLAT_TREE_NO_VALUE
+        || !phfwdImageSectionValid(size, header->forward, 0, 1)
+        || !phfwdImageSectionValid(size, header->backward, 0, 1)
+        || !phfwdImageSectionValid(size, header->offsets,
+                                   header->howManyRedirections,
+                                   sizeof(uint64_t))
+        || !phfwdImageSectionValid(size, header->listStarts,
+                                   header->howManyLists + 1,
+                                   sizeof(uint32_t))) {
+        return false;
+    } else {
+        const uint32_t *listStarts =
+                (const uint32_t *) (image + header->listStarts);
+        return phfwdImageSectionValid(size, header->listItems,
+                                      listStarts[header->howManyLists],
+                                      sizeof(uint32_t));
+    }
+}
+
+/**
+ * @brief Sprawdza numer zapisany w obrazie.
+ * @param[in] num - wskaźnik na numer.
+ * @param[in] length - długość numeru.
+ * @return true jeżeli @p num jest niepustym numerem długości @p length
+ *         zakończonym '\0', false w przeciwnym przypadku.
+ */
+static bool phfwdImageNumberValid(const char *num, size_t length) {
+    size_t i;
+    for (i = 0; i < length; i++) {
+        if (!characterIsDigit(num[i])) {
+            return false;
+        }
+    }
+    return length != 0 && num[length] == '\0';
+}
+
+/**
+ * @brief Sprawdza informacje o przekierowaniu zapisane w obrazie.
+ * @param[in] image - wskaźnik na obraz.
+ * @param[in] size - rozmiar obrazu w bajtach.
+ * @param[in] offset - pozycja informacji o przekierowaniu.
+ * @return true jeżeli informacje mieszczą się w obrazie, a oba prefiksy są
+ *         poprawnymi numerami, false w przeciwnym przypadku.
+ */
+static bool phfwdImageRedirectionValid(const char *image, size_t size,
+                                       uint64_t offset) {
+    if (!phfwdImageSectionValid(size, offset, 1, sizeof(struct ForwardData))) {
+        return false;
+    }
+    const struct ForwardData *fd =
+            (const struct ForwardData *) (image + offset);
+    size_t available = size - (size_t) offset - sizeof(struct ForwardData);
+    return fd->sourceLength < available
+           && fd->targetLength < available - fd->sourceLength - 1
+           && phfwdImageNumberValid(fd->numbers, fd->sourceLength)
+           && phfwdImageNumberValid(fd->numbers + fd->sourceLength + 1,
+                                    fd->targetLength);
+}
+
+/**
+ * @brief Sprawdza wartość węzła drzewa forward zapisanego w obrazie.
+ * Używany w flatTreeValid.
+ * @param[in] index - numer przekierowania.
+ * @param[in] length - długość numeru reprezentowanego przez węzeł.
+ * @param[in] image - wskaźnik na obraz (struct ImageHeader).
+ * @return true jeżeli przekierowanie istnieje, a jego prefiks jest numerem
+ *         reprezentowanym przez węzeł, false w przeciwnym przypadku.
+ */
+static bool phfwdImageForwardValid(uint32_t index, size_t length,
+                                   void *image) {
+    const struct ImageHeader *header = image;
+    const uint64_t *offsets =
+            (const uint64_t *) ((const char *) image + header->offsets);
+    return index < header->howManyRedirections
+           && ((const struct ForwardData *)
+                       ((const char *) image + offsets[index]))->sourceLength
+              == length;
+}
+
+/**
+ * @brief Sprawdza wartość węzła drzewa backward zapisanego w obrazie.
+ * Używany w flatTreeValid.
+ * @param[in] list - numer listy.
+ * @param[in] length - długość numeru reprezentowanego przez węzeł.
+ * @param[in] image - wskaźnik na obraz (struct ImageHeader).
+ * @return true jeżeli lista istnieje, false w przeciwnym przypadku.
+ */
+static bool phfwdImageBackwardValid(uint32_t list, size_t length,
+                                    void *image) {
+    (void) length;
+    const struct ImageHeader *header = image;
+    return list < header->howManyLists;
+}
+
+/**
+ * @brief Sprawdza zawartość obrazu o poprawnym nagłówku.
+ * Dzięki temu zapytania na odwzorowanej strukturze nie wychodzą poza obraz
+ * nawet dla uszkodzonego lub celowo spreparowanego pliku.
+ * #### Złożoność
+ * O(rozmiar obrazu)
+ * @see phfwdImageValid
+ * @param[in] image - wskaźnik na obraz.
+ * @param[in] size - rozmiar obrazu w bajtach.
+ * @param[in] forward - zwarta postać drzewa forward z obrazu.
+ * @param[in] backward - zwarta postać drzewa backward z obrazu.
+ * @return true jeżeli obraz jest poprawny, false w przeciwnym przypadku
+ *         lub w przypadku problemów z pamięcią.
+ */
+static bool phfwdImageContentValid(void *image, size_t size, FlatTree forward,
+                                   FlatTree backward) {
+    const char *bytes = image;
+    const struct ImageHeader *header = image;
+    const uint64_t *offsets = (const uint64_t *) (bytes + header->offsets);
+    const uint32_t *listStarts =
+            (const uint32_t *) (bytes + header->listStarts);
+    const uint32_t *listItems = (const uint32_t *) (bytes + header->listItems);
+    uint64_t i;
+
+    for (i = 0; i < header->howManyRedirections; i++) {
+        if (!phfwdImageRedirectionValid(bytes, size, offsets[i])) {
+            return false;
+        }
+    }
+    for (i = 0; i < header->howManyLists; i++) {
+        if (listStarts[i] > listStarts[i + 1]) {
+            return false;
+        }
+    }
+    for (i = 0; i < listStarts[header->howManyLists]; i++) {
+        if (listItems[i] >= header->howManyRedirections) {
+            return false;
+        }
+    }
+    return flatTreeValid(forward, phfwdImageForwardValid, image)
+           && flatTreeValid(backward, phfwdImageBackwardValid, image);
+}
+
+/**
+ * @brief Tworzy strukturę korzystającą z obrazu w pamięci.
+ * @param[in] image - wskaźnik na obraz zapisany przez @ref phfwdSave.
+ * @param[in] size - rozmiar obrazu w bajtach.
+ * @return Wskaźnik na strukturę, NULL w przypadku problemów z pamięcią
+ *         lub niepoprawnego obrazu.
+ */
+static struct PhoneForward *phfwdLoadImage(void *image, size_t size) {
+    if (!phfwdImageValid(image, size)) {
+        return NULL;
+    }
+
+    const char *bytes = image;
+    const struct ImageHeader *header = image;
+    size_t imageSize;
+    struct PhoneForward *result = phfwdNew();
+    struct MappedForward *mapped = malloc(sizeof(struct MappedForward));
+    struct CompiledForward *compiled = malloc(sizeof(struct CompiledForward));
+    FlatTree forward = flatTreeView(bytes + header->forward,
+                                    size - header->forward, &imageSize);
+    FlatTree backward = flatTreeView(bytes + header->backward,
+                                     size - header->backward, &imageSize);
+
+    if (result == NULL || mapped == NULL || compiled == NULL
+        || forward == NULL || backward == NULL
+        || !phfwdImageContentValid(image, size, forward, backward)) {
+        phfwdDelete(result);
+        free(mapped);
+        free(compiled);
+        flatTreeDelete(forward);
+        flatTreeDelete(backward);
+        return NULL;
+    } else {
+        compiled->tree = forward;
+        compiled->redirections = NULL;
+        compiled->image = bytes;
+        compiled->offsets = (const uint64_t *) (bytes + header->offsets);
+        mapped->image = image;
+        mapped->size = size;
+        mapped->backward = backward;
+        mapped->howManyRedirections = (size_t) header->howManyRedirections;
+        mapped->listStarts = (const uint32_t *) (bytes + header->listStarts);
+        mapped->listItems = (const uint32_t *) (bytes + header->listItems);
+        result->mapped = mapped;
+        result->readOnly = true;
+        atomic_store(&result->compiled, compiled);
+        return result;
+    }
+}
+
+struct PhoneForward *phfwdLoadMapped(const char *filename) {
+    if (filename == NULL) {
+        return NULL;
+    }
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat status;
+    void *image = MAP_FAILED;
+    if (fstat(fd, &status) == 0 && status.st_size > 0
+        && (uintmax_t) status.st_size <= SIZE_MAX) {
+        image = mmap(NULL, (size_t) status.st_size, PROT_READ, MAP_PRIVATE,
+                     fd, 0);
+    }
+    close(fd);
+    if (image == MAP_FAILED) {
+        return NULL;
+    }
+
+    struct PhoneForward *result = phfwdLoadImage(image,
+                                                 (size_t) status.st_size);
+    if (result == NULL) {
+        munmap(image, (size_t) status.st_size);
+    }
+    return result;
+}
+
+/**
+ * @brief Kopiuje przekierowania odwzorowanej struktury do nowej struktury.
+ * #### Złożoność
+ * O(n * L), gdzie n to liczba przekierowań, a L to długość numerów
+ * @see phfwdLoad
+ * @param[in] pf - wskaźnik na strukturę utworzoną przez phfwdLoadMapped.
+ * @return Wskaźnik na nową strukturę (do modyfikacji) przechowującą
+ *         te same przekierowania co @p pf, NULL w przypadku problemów
+ *         z pamięcią.
+ */
+static struct PhoneForward *phfwdCopyMapped(struct PhoneForward *pf) {
+    struct PhoneForward *result = phfwdNew();
+    struct CompiledForward *compiled = atomic_load(&pf->compiled);
+    size_t i;
+    for (i = 0; result != NULL && i < pf->mapped->howManyRedirections; i++) {
+        ForwardData fd = phfwdCompiledRedirection(compiled, (uint32_t) i);
+        if (!phfwdAdd(result, phfwdForwardDataSource(fd),
+                      phfwdForwardDataTarget(fd))) {
+            phfwdDelete(result);
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+struct PhoneForward *phfwdLoad(const char *filename) {
+    struct PhoneForward *mapped = phfwdLoadMapped(filename);
+    if (mapped == NULL) {
+        return NULL;
+    } else {
+        struct PhoneForward *result = phfwdCopyMapped(mapped);
+        phfwdDelete(mapped);
+        return result;
+    }
+}
+
+/**
+ * @brief Poprawia wskaźniki dla phfwdGetReuse.
+ * @see phfwdGetReuse
+ * @param[in] tree - wskaźnik na drzewo numerów.
+ * @param[in] num - wskaźnik na tekst reprezentujący numer.
+ * @param[in, out] ptr - wskaźnik na wskaźnik na węzeł którego ojciec
+ *        reprezentuje
+ *        najdłuższy możliwy pasujący prefiks numeru
+ *        a krawędź wchodząca do @p ptr pewną jego część
+ *        następującą po prefiksie. Po wykonaniu operacji @p *ptr wskazuje
+ *        na węzeł reprezentujący najdłuższy pasujący prefiks numeru.
+ * @param[in,out] matchedTxt - wskaźnik na wskaźnik na tekst
+ *        reprezentujący dopasowanie
+ *        numeru w drzewie. Po wykonaniu operacji wskazuje na dopasowanie
+ *        wyłączające częściowe dopasowanie krawędzi w @p tree.
+ */
+static void
+phfwdSetPointersForGettingText(RadixTree tree,
+                               const char *num, RadixTreeNode *ptr,
+                               const char **matchedTxt) {
+    size_t nodeMatch = 0;
+    int matchMode;
+    int findResult = radixTreeFind(tree, num, ptr, matchedTxt,
+                                   &nodeMatch, &matchMode);
+    if (findResult != RADIX_TREE_FOUND
+        && (matchMode != RADIX_TREE_NODE_MATCH_FULL)) {
+
+        *matchedTxt = (*matchedTxt) - nodeMatch;
+        *ptr = radixTreeFather(*ptr);
+    }
+}
+
+/**
+ * @brief Wyszukuje najbliższy przodek węzła przechowujący przekierowanie.
+ * @param[in] ptr - wskaźnik na węzeł drzewa forward reprezentujący
+ *        najdłuższy pasujący prefiks numeru.
+ * @param[in, out] suffix - @p *suffix wskazuje na część numeru
+ *        następującą po tekście reprezentowanym przez @p ptr, po wykonaniu
+ *        na część następującą po najdłuższym przekierowanym prefiksie.
+ * @return Informacje o przekierowaniu najdłuższego pasującego prefiksu
+ *         numeru, NULL w przypadku braku przekierowania.
+ */
+static ForwardData phfwdResolveUp(RadixTreeNode ptr, const char **suffix) {
+    ForwardData fd = radixTreeGetNodeData(ptr);
+    while (fd == NULL && !radixTreeIsRoot(ptr)) {
+        *suffix = *suffix - radixTreeHowManyChars(ptr);
+        ptr = radixTreeFather(ptr);
+        fd = radixTreeGetNodeData(ptr);
+    }
+    return fd;
+}
+
+/**
+ * @brief Wyznacza przekierowanie numeru bez przydzielania pamięci.
+ * @param[in] forward - wskaźnik na węzeł reprezentujący drzewo.
+ * @param[in] num - wskaźnik na numer.
+ * @param[out] suffix - @p *suffix wskazuje na część numeru @p num
+ *        następującą po najdłuższym przekierowanym prefiksie
+ *        (na cały numer w przypadku braku przekierowania).
+ * @return Informacje o przekierowaniu najdłuższego pasującego prefiksu
+ *         numeru, NULL w przypadku braku przekierowania.
+ */
+static ForwardData phfwdResolve(RadixTree forward, const char *num,
+                                const char **suffix) {
+    RadixTreeNode ptr;
+
+    phfwdSetPointersForGettingText(forward, num, &ptr, suffix);
+
+    ForwardData result = phfwdResolveUp(ptr, suffix);
+    assert(result != NULL || *suffix == num);
+    return result;
+}
+
+/**
+ * @brief Wyznacza przekierowanie numeru bez przydzielania pamięci.
+ * Korzysta ze zwartej postaci drzewa forward, jeżeli została utworzona.
+ * Musi być wywoływany wewnątrz epoki.
+ * @see phfwdResolve
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[in] num - wskaźnik na numer.
+ * @param[out] suffix - @p *suffix wskazuje na część numeru @p num
+ *        następującą po najdłuższym przekierowanym prefiksie
+ *        (na cały numer w przypadku braku przekierowania).
+ * @return Informacje o przekierowaniu najdłuższego pasującego prefiksu
+ *         numeru, NULL w przypadku braku przekierowania.
+ */
+static ForwardData phfwdFind(struct PhoneForward *pf, const char *num,
+                             const char **suffix) {
+    struct CompiledForward *compiled = atomic_load_explicit(
+            &pf->compiled, memory_order_acquire);
+    if (compiled == NULL) {
+        return phfwdResolve(pf->forward, num, suffix);
+    }
+
+    uint32_t index = flatTreeFind(compiled->tree, num);
+    if (index == FLAT_TREE_NO_VALUE) {
+        *suffix = num;
+        return NULL;
+    } else {
+        ForwardData result = phfwdCompiledRedirection(compiled, index);
+        *suffix = num + result->sourceLength;
+        return result;
+    }
+}
+
+bool phfwdGetReuse(struct PhoneForward *pf, const char *num,
+                   struct PhoneNumbers *pnum) {
+    phfwdNumbersClear(pnum);
+    if (!phfwdIsNumber(num)) {
+        return true;
+    }
+
+    const char *matchedTxt;
+    size_t ticket = epochEnter(pf->epoch);
+    ForwardData target = phfwdFind(pf, num, &matchedTxt);
+    bool success;
+    if (target == NULL) {
+        success = phfwdNumbersAppend(pnum, matchedTxt, strlen(matchedTxt),
+                                     NULL);
+    } else {
+        success = phfwdNumbersAppend(pnum, phfwdForwardDataTarget(target),
+                                     target->targetLength, matchedTxt);
+    }
+    epochLeave(pf->epoch, ticket);
+    return success;
+}
+
+const struct PhoneNumbers *phfwdGet(struct PhoneForward *pf, const char *num) {
+    struct PhoneNumbers *result = phnumNew();
+    if (result != NULL && !phfwdGetReuse(pf, num, result)) {
+        phnumDelete(result);
+        return NULL;
+    }
+    return result;
+}
+
+size_t phfwdGetInto(struct PhoneForward *pf, const char *num,
+                    char *buf, size_t cap) {
+    if (cap != 0) {
+        buf[0] = '\0';
+    }
+    if (pf == NULL || !phfwdIsNumber(num)) {
+        return 0;
+    }
+
+    const char *suffix;
+    size_t ticket = epochEnter(pf->epoch);
+    ForwardData target = phfwdFind(pf, num, &suffix);
+    size_t prefixLength = 0;
+    if (target != NULL) {
+        prefixLength = target->targetLength;
+    }
+    size_t suffixLength = strlen(suffix);
+    size_t length = prefixLength + suffixLength;
+
+    if (length < cap) {
+        if (target != NULL) {
+            memcpy(buf, phfwdForwardDataTarget(target), prefixLength);
+        }
+        memcpy(buf + prefixLength, suffix, suffixLength + (size_t) 1);
+    }
+    epochLeave(pf->epoch, ticket);
+    return length;
+}
+
+/**
+ * @brief Liczba początkowych znaków numeru zapisywanych w kluczu sortowania.
+ * @see phfwdGetManyKey
+ */
+#define PHFWD_GET_MANY_KEY_LENGTH 16
+
+/**
+ * @brief Liczba bitów klucza sortowania przetwarzanych w jednej fazie.
+ * @see phfwdGetManySort
+ */
+#define PHFWD_GET_MANY_RADIX_BITS 8
+
+/**
+ * @brief Liczba kubełków w jednej fazie sortowania.
+ * @see phfwdGetManySort
+ */
+#define PHFWD_GET_MANY_RADIX (1 << PHFWD_GET_MANY_RADIX_BITS)
+
+/**
+ * @brief Liczba faz sortowania.
+ * @see phfwdGetManySort
+ */
+#define PHFWD_GET_MANY_PASSES (64 / PHFWD_GET_MANY_RADIX_BITS)
+
+/**
+ * @brief Numer z wejścia phfwdGetMany.
+ * @see phfwdGetMany
+ */
+struct GetManyItem {
+    /**
+     * @brief Klucz sortowania.
+     * @see phfwdGetManyKey
+     */
+    uint64_t key;
+
+    /**
+     * @brief Pozycja numeru na wejściu (i w wyniku).
+     */
+    size_t id;
+};
+
+/**
+ * @brief Przekierowanie numeru z wejścia phfwdGetMany.
+ * @see phfwdGetMany
+ */
+struct GetManyResult {
+    /**
+     * @brief Informacje o przekierowaniu numeru, NULL w przypadku braku.
+     */
+    ForwardData target;
+
+    /**
+     * @brief Część numeru następująca po przekierowanym prefiksie.
+     */
+    const char *suffix;
+};
+
+/**
+ * @brief Przedział elementów o równych kluczach do dalszego sortowania.
+ * @see phfwdGetManySort
+ */
+struct GetManySortRange {
+    /**
+     * @brief Początek przedziału.
+     */
+    size_t begin;
+
+    /**
+     * @brief Koniec przedziału (wyłącznie).
+     */
+    size_t end;
+
+    /**
+     * @brief Długość wspólnego prefiksu numerów z przedziału.
+     */
+    size_t offset;
+};
+
+/**
+ * @brief Wyznacza klucz sortowania numeru.
+ * Kolejne znaki z pierwszych PHFWD_GET_MANY_KEY_LENGTH znaków numeru
+ * zajmują kolejne czwórki bitów klucza, od najbardziej znaczącej.
+ * Znak jest zapisywany jako (kod_ascii - '0' + 1), koniec numeru jako 0,
+ * dzięki czemu porządek kluczy odpowiada porządkowi leksykograficznemu
+ * prefiksów numerów.
+ * @param[in] num - wskaźnik na numer.
+ * @return Klucz sortowania.
+ */
+static uint64_t phfwdGetManyKey(const char *num) {
+    uint64_t key = 0;
+    size_t i;
+    for (i = 0; i < PHFWD_GET_MANY_KEY_LENGTH; i++) {
+        key <<= 4;
+        if (*num != '\0') {
+            key |= (uint64_t) (*num - '0' + 1);
+            num++;
+        }
+    }
+    return key;
+}
+
+/**
+ * @brief Sortuje pozycyjnie (LSD) elementy względem kluczy.
+ * Fazy w których wszystkie klucze trafiają do jednego kubełka są pomijane.
+ * @param[in, out] items - tablica elementów.
+ * @param[in] n - liczba elementów.
+ * @param[out] tmp - bufor pomocniczy na @p n elementów.
+ */
+static void phfwdGetManyRadixSort(struct GetManyItem *items, size_t n,
+                                  struct GetManyItem *tmp) {
+    if (n < 2) {
+        return;
+    }
+    size_t count[PHFWD_GET_MANY_PASSES][PHFWD_GET_MANY_RADIX];
+    memset(count, 0, sizeof(count));
+    size_t i, pass, b;
+    for (i = 0; i < n; i++) {
+        for (pass = 0; pass < PHFWD_GET_MANY_PASSES; pass++) {
+            count[pass][(items[i].key >> (pass * PHFWD_GET_MANY_RADIX_BITS))
+                        & (PHFWD_GET_MANY_RADIX - 1)]++;
+        }
+    }
+
+    struct GetManyItem *from = items, *to = tmp, *swap;
+    for (pass = 0; pass < PHFWD_GET_MANY_PASSES; pass++) {
+        size_t shift = pass * PHFWD_GET_MANY_RADIX_BITS;
+        if (count[pass][(from[0].key >> shift) & (PHFWD_GET_MANY_RADIX - 1)]
+            == n) {
+            continue;
+        }
+        size_t position = 0, bucketSize;
+        for (b = 0; b < PHFWD_GET_MANY_RADIX; b++) {
+            bucketSize = count[pass][b];
+            count[pass][b] = position;
+            position += bucketSize;
+        }
+        for (i = 0; i < n; i++) {
+            to[count[pass][(from[i].key >> shift)
+                           & (PHFWD_GET_MANY_RADIX - 1)]++] = from[i];
+        }
+        swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != items) {
+        memcpy(items, from, n * sizeof(struct GetManyItem));
+    }
+}
+
+/**
+ * @brief Sortuje elementy leksykograficznie względem numerów.
+ * Elementy są sortowane względem kluczy wyznaczonych z kolejnych
+ * PHFWD_GET_MANY_KEY_LENGTH znaków numerów; przedziały elementów o równych
+ * kluczach, których numery są dłuższe, są sortowane względem kluczy
+ * wyznaczonych z dalszych znaków.
+ * @param[in, out] items - tablica elementów.
+ * @param[in] n - liczba elementów.
+ * @param[in] nums - tablica numerów z wejścia phfwdGetMany.
+ * @param[out] tmp - bufor pomocniczy na @p n elementów.
+ * @return W przypadku sukcesu true, w przypadku problemów z pamięcią false.
+ */
+static bool phfwdGetManySort(struct GetManyItem *items, size_t n,
+                             const char *const *nums,
+                             struct GetManyItem *tmp) {
+    struct GetManySortRange *stack = NULL;
+    size_t stackSize = 0;
+    struct GetManySortRange range;
+    range.begin = 0;
+    range.end = n;
+    range.offset = 0;
+
+    while (true) {
+        struct GetManyItem *begin = items + range.begin;
+        size_t size = range.end - range.begin;
+        size_t i, j;
+        if (range.offset != 0) {
+            for (i = 0; i < size; i++) {
+                begin[i].key = phfwdGetManyKey(nums[begin[i].id]
+                                               + range.offset);
+            }
+        }
+        phfwdGetManyRadixSort(begin, size, tmp);
+
+        for (i = 0; i < size; i = j) {
+            j = i + 1;
+            while (j < size && begin[j].key == begin[i].key) {
+                j++;
+            }
+            if (j - i > 1 && (begin[i].key & (uint64_t) 0xF) != 0) {
+                if (stack == NULL) {
+                    stack = malloc((n / 2 + 1)
+                                   * sizeof(struct GetManySortRange));
+                    if (stack == NULL) {
+                        return false;
+                    }
+                }
+                stack[stackSize].begin = range.begin + i;
+                stack[stackSize].end = range.begin + j;
+                stack[stackSize].offset = range.offset
+                                          + PHFWD_GET_MANY_KEY_LENGTH;
+                stackSize++;
+            }
+        }
+
+        if (stackSize == 0) {
+            free(stack);
+            return true;
+        }
+        range = stack[--stackSize];
+    }
+}
+
+/**
+ * @brief Wyznacza przekierowania posortowanych numerów.
+ * Kolejny numer jest wyszukiwany w drzewie począwszy od najgłębszego węzła
+ * reprezentującego wspólny prefiks z poprzednim numerem, a jeżeli została
+ * utworzona zwarta postać drzewa, w niej od korzenia.
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[in] items - tablica elementów posortowana leksykograficznie
+ *        względem numerów.
+ * @param[in] n - liczba elementów.
+ * @param[in] nums - tablica numerów z wejścia phfwdGetMany.
+ * @param[out] results - tablica na przekierowania kolejnych elementów.
+ * @return Łączny rozmiar wyników (razem z kończącymi '\0').
+ */
+static size_t phfwdGetManyResolve(struct PhoneForward *pf,
+                                  const struct GetManyItem *items, size_t n,
+                                  const char *const *nums,
+                                  struct GetManyResult *results) {
+    bool compiled = atomic_load_explicit(&pf->compiled,
+                                         memory_order_acquire) != NULL;
+    RadixTreeNode node = pf->forward;
+    size_t depth = 0;
+    size_t total = 0;
+    size_t i;
+    for (i = 0; i < n; i++) {
+        const char *num = nums[items[i].id];
+        if (compiled) {
+            results[i].target = phfwdFind(pf, num, &results[i].suffix);
+            if (results[i].target != NULL) {
+                total += results[i].target->targetLength;
+            }
+            total += strlen(results[i].suffix) + (size_t) 1;
+            continue;
+        }
+        if (i != 0) {
+            const char *previous = nums[items[i - 1].id];
+            size_t common = 0;
+            while (common < depth && previous[common] == num[common]) {
+                common++;
+            }
+            while (depth > common) {
+                depth -= radixTreeHowManyChars(node);
+                node = radixTreeFather(node);
+            }
+        }
+
+        const char *matchedTxt;
+        phfwdSetPointersForGettingText(node, num + depth, &node, &matchedTxt);
+        depth = (size_t) (matchedTxt - num);
+
+        results[i].suffix = matchedTxt;
+        results[i].target = phfwdResolveUp(node, &results[i].suffix);
+        if (results[i].target != NULL) {
+            total += results[i].target->targetLength;
+        }
+        total += strlen(results[i].suffix) + (size_t) 1;
+    }
+    return total;
+}
+
+const struct PhoneNumbers *phfwdGetMany(struct PhoneForward *pf,
+                                        const char *const *nums, size_t n) {
+    struct PhoneNumbers *result = phnumNew();
+    if (result == NULL || !phfwdNumbersReserve(result, n, 0)) {
+        phnumDelete(result);
+        return NULL;
+    }
+    struct GetManyItem *items = malloc(n * sizeof(struct GetManyItem));
+    struct GetManyItem *tmp = malloc(n * sizeof(struct GetManyItem));
+    if ((items == NULL || tmp == NULL) && n != 0) {
+        free(items);
+        free(tmp);
+        phnumDelete(result);
+        return NULL;
+    }
+
+    size_t howManyValid = 0;
+    size_t i;
+    for (i = 0; i < n; i++) {
+        if (phfwdIsNumber(nums[i])) {
+            items[howManyValid].key = phfwdGetManyKey(nums[i]);
+            items[howManyValid].id = i;
+            howManyValid++;
+        }
+    }
+    if (!phfwdGetManySort(items, howManyValid, nums, tmp)) {
+        free(items);
+        free(tmp);
+        phnumDelete(result);
+        return NULL;
+    }
+
+    assert(sizeof(struct GetManyResult) <= sizeof(struct GetManyItem));
+    struct GetManyResult *results = (struct GetManyResult *) tmp;
+    size_t ticket = epochEnter(pf->epoch);
+    size_t total = phfwdGetManyResolve(pf, items, howManyValid, nums,
+                                       results);
+    if (!phfwdNumbersReserve(result, n, total)) {
+        epochLeave(pf->epoch, ticket);
+        free(items);
+        free(tmp);
+        phnumDelete(result);
+        return NULL;
+    }
+
+    for (i = 0; i < n; i++) {
+        result->offsets[i] = PHFWD_NO_NUMBER;
+    }
+    result->howMany = n;
+    char *out = result->chars;
+    for (i = 0; i < howManyValid; i++) {
+        result->offsets[items[i].id] = (size_t) (out - result->chars);
+        if (results[i].target != NULL) {
+            memcpy(out, phfwdForwardDataTarget(results[i].target),
+                   results[i].target->targetLength);
+            out += results[i].target->targetLength;
+        }
+        size_t suffixLength = strlen(results[i].suffix);
+        memcpy(out, results[i].suffix, suffixLength + (size_t) 1);
+        out += suffixLength + 1;
+    }
+    result->length = total;
+    assert((size_t) (out - result->chars) == total);
+    epochLeave(pf->epoch, ticket);
+
+    free(items);
+    free(tmp);
+    return result;
+}
+
+/**
+ * @brief Sprawdza czy pary z wejścia @ref phfwdBulkLoad są poprawne.
+ * @param[in] pairs - tablica 2 * @p n wskaźników na numery.
+ * @param[in] n - liczba par.
+ * @return true jeżeli każda para jest poprawnym argumentem phfwdAdd,
+ *         false w przeciwnym przypadku.
+ */
+static bool phfwdBulkLoadValid(const char *const *pairs, size_t n) {
+    size_t i;
+    for (i = 0; i < n; i++) {
+        if (!phfwdIsNumber(pairs[2 * i]) || !phfwdIsNumber(pairs[2 * i + 1])
+            || strcmp(pairs[2 * i], pairs[2 * i + 1]) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Sortuje pary względem prefiksów przekierowywanych i usuwa
+ * zastąpione przekierowania.
+ * Sortowanie jest stabilne, więc z par o równych prefiksach
+ * przekierowywanych zostaje ostatnia.
+ * @param[in, out] items - tablica @p n elementów z pozycjami (w @p pairs)
+ *        prefiksów przekierowywanych w kolejności par, po wykonaniu jej
+ *        początek zawiera pozycje pozostawionych par w kolejności
+ *        leksykograficznej.
+ * @param[in] pairs - tablica wskaźników na numery.
+ * @param[in] n - liczba elementów @p items.
+ * @param[out] tmp - bufor pomocniczy na @p n elementów.
+ * @return Liczba pozostawionych par, w przypadku problemów z pamięcią
+ *         SIZE_MAX.
+ */
+static size_t phfwdBulkLoadUnique(struct GetManyItem *items,
+                                  const char *const *pairs, size_t n,
+                                  struct GetManyItem *tmp) {
+    size_t i, howMany = 0;
+    for (i = 0; i < n; i++) {
+        items[i].key = phfwdGetManyKey(pairs[items[i].id]);
+    }
+    if (!phfwdGetManySort(items, n, pairs, tmp)) {
+        return SIZE_MAX;
+    }
+
+    for (i = 0; i < n; i++) {
+        if (i + 1 == n || items[i].key != items[i + 1].key
+            || strcmp(pairs[items[i].id], pairs[items[i + 1].id]) != 0) {
+            items[howMany++] = items[i];
+        }
+    }
+    return howMany;
+}
+
+/**
+ * @brief Tworzy informacje o przekierowaniach dodawanych przez
+ * @ref phfwdBulkLoad.
+ * @param[in, out] pool - pula z której przydzielane są informacje.
+ * @param[in] items - pozycje prefiksów przekierowywanych w @p pairs.
+ * @param[in] pairs - tablica wskaźników na numery.
+ * @param[in] n - liczba elementów @p items.
+ * @return Tablica @p n informacji o przekierowaniach (ForwardData) bez
+ *         węzłów drzewa backward, NULL w przypadku problemów z pamięcią.
+ */
+static void **phfwdBulkLoadRedirections(MemoryPool pool,
+                                        const struct GetManyItem *items,
+                                        const char *const *pairs, size_t n) {
+    void **redirections = malloc(n * sizeof(void *));
+    if (redirections == NULL) {
+        return NULL;
+    }
+
+    size_t i;
+    for (i = 0; i < n; i++) {
+        const char *num1 = pairs[items[i].id];
+        const char *num2 = pairs[items[i].id + 1];
+        size_t sourceLength = strlen(num1);
+        size_t targetLength = strlen(num2);
+        ForwardData fd = memoryPoolAlloc(pool,
+                                         phfwdForwardDataSize(sourceLength,
+                                                              targetLength));
+        if (fd == NULL) {
+            free(redirections);
+            return NULL;
+        }
+        fd->treeNode = NULL;
+        fd->backwardIndex = 0;
+        fd->sourceLength = sourceLength;
+        fd->targetLength = targetLength;
+        memcpy(fd->numbers, num1, sourceLength + (size_t) 1);
+        memcpy(fd->numbers + sourceLength + 1, num2,
+               targetLength + (size_t) 1);
+        redirections[i] = fd;
+    }
+    return redirections;
+}
+
+/**
+ * @brief Grupuje informacje o przekierowaniach na równe prefiksy w tablice
+ * BackwardData.
+ * Tablice są w całości posortowane względem przekierowywanych prefiksów.
+ * @param[in, out] pool - pula z której przydzielane są tablice.
+ * @param[in] items - pozycje w @p redirections posortowane względem
+ *        prefiksów na które są przekierowania.
+ * @param[in] n - liczba elementów @p items.
+ * @param[in] redirections - tablica informacji o przekierowaniach.
+ * @param[out] txts - tablica na co najmniej @p n numerów, na jej początek
+ *        trafiają kolejne różne prefiksy na które są przekierowania.
+ * @param[out] howManyLists - liczba utworzonych tablic.
+ * @return Tablica danych węzłów drzewa backward (BackwardData) kolejnych
+ *         prefiksów z @p txts, NULL w przypadku problemów z pamięcią.
+ */
+static void **phfwdBulkLoadLists(MemoryPool pool,
+                                 const struct GetManyItem *items, size_t n,
+                                 void *const *redirections, const char **txts,
+                                 size_t *howManyLists) {
+    void **lists = malloc(n * sizeof(void *));
+    if (lists == NULL) {
+        return NULL;
+    }
+
+    size_t i, howMany = 0;
+    BackwardData data = NULL;
+    for (i = 0; i < n; i++) {
+        ForwardData fd = redirections[items[i].id];
+        if (i == 0 || items[i].key != items[i - 1].key
+            || strcmp(phfwdForwardDataTarget(fd), txts[howMany - 1]) != 0) {
+            data = phfwdBackwardDataCreate(pool);
+            if (data == NULL) {
+                free(lists);
+                return NULL;
+            }
+            lists[howMany] = data;
+            txts[howMany] = phfwdForwardDataTarget(fd);
+            howMany++;
+        }
+        if (!phfwdBackwardDataPush(data, fd, pool)) {
+            free(lists);
+            return NULL;
+        }
+    }
+    for (i = 0; i < howMany; i++) {
+        phfwdBackwardDataSort(lists[i], pool);
+    }
+
+    *howManyLists = howMany;
+    return lists;
+}
+
+/**
+ * @brief Numer części do której trafia numer w @ref phfwdBulkLoad.
+ * @param[in] num - wskaźnik na numer.
+ * @return Numer syna korzenia odpowiadającego pierwszej cyfrze @p num.
+ */
+static size_t phfwdBulkLoadPartitionNumber(const char *num) {
+    return (size_t) (num[0] - '0');
+}
+
+/**
+ * @brief Część przekierowań dodawanych przez @ref phfwdBulkLoad,
+ * z której powstaje jeden syn korzenia drzewa forward i jeden
+ * syn korzenia drzewa backward.
+ * Każda część ma własną pulę i drzewa, więc różne części mogą być
+ * budowane współbieżnie.
+ */
+struct BulkLoadPartition {
+    /**
+     * @brief Pula z której przydzielane są węzły drzew i dane części,
+     * NULL jeżeli część jest pusta.
+     */
+    MemoryPool pool;
+
+    /**
+     * @brief Początek przedziału części w BulkLoad->order.
+     */
+    size_t sourceBegin;
+
+    /**
+     * @brief Koniec przedziału części w BulkLoad->order (wyłącznie).
+     */
+    size_t sourceEnd;
+
+    /**
+     * @brief Początek przedziału części w BulkLoad->byTarget.
+     */
+    size_t targetBegin;
+
+    /**
+     * @brief Koniec przedziału części w BulkLoad->byTarget (wyłącznie).
+     */
+    size_t targetEnd;
+
+    /**
+     * @brief Drzewo z przekierowaniami prefiksów zaczynających się cyfrą
+     * części.
+     */
+    RadixTree forward;
+
+    /**
+     * @brief Drzewo z listami przekierowań na prefiksy zaczynające się
+     * cyfrą części.
+     */
+    RadixTree backward;
+
+    /**
+     * @brief Informacje o przekierowaniach z drzewa @p forward
+     * w kolejności leksykograficznej.
+     */
+    void **redirections;
+
+    /**
+     * @brief Liczba elementów @p redirections.
+     */
+    size_t howManyRedirections;
+
+    /**
+     * @brief Czy dotychczasowe fazy budowy części się powiodły.
+     */
+    bool success;
+};
+
+/**
+ * @brief Stan budowy drzew przez @ref phfwdBulkLoad.
+ */
+struct BulkLoad {
+    /**
+     * @brief Pary z wejścia.
+     */
+    const char *const *pairs;
+
+    /**
+     * @brief Pozycje (w @p pairs) prefiksów przekierowywanych
+     * pogrupowane według pierwszej cyfry, w kolejności par.
+     */
+    size_t *order;
+
+    /**
+     * @brief Informacje o przekierowaniach pogrupowane według pierwszej
+     * cyfry prefiksu na który są przekierowania.
+     */
+    void **byTarget;
+
+    /**
+     * @brief Części odpowiadające kolejnym synom korzeni.
+     */
+    struct BulkLoadPartition partitions[RADIX_TREE_NUMBER_OF_SONS];
+
+    /**
+     * @brief Numer następnej części do zbudowania w bieżącej fazie.
+     */
+    atomic_size_t next;
+
+    /**
+     * @brief Funkcja budująca część w bieżącej fazie.
+     */
+    void (*phase)(struct BulkLoad *, struct BulkLoadPartition *);
+
+    /**
+     * @brief Największa liczba wątków budujących części.
+     */
+    size_t threads;
+};
+
+/**
+ * @brief Pierwsza faza budowy części: drzewo forward.
+ * Sortuje pary części, tworzy informacje o przekierowaniach
+ * i buduje z nich BulkLoadPartition->forward.
+ * @param[in] load - wskaźnik na stan budowy.
+ * @param[in, out] part - wskaźnik na budowaną część.
+ */
+static void phfwdBulkLoadSources(struct BulkLoad *load,
+                                 struct BulkLoadPartition *part) {
+    size_t n = part->sourceEnd - part->sourceBegin, i, howMany = SIZE_MAX;
+    struct GetManyItem *items = malloc(n * sizeof(struct GetManyItem));
+    struct GetManyItem *tmp = malloc(n * sizeof(struct GetManyItem));
+    const char **txts = NULL;
+
+    if (items != NULL && tmp != NULL) {
+        for (i = 0; i < n; i++) {
+            items[i].id = load->order[part->sourceBegin + i];
+        }
+        howMany = phfwdBulkLoadUnique(items, load->pairs, n, tmp);
+    }
+    if (howMany != SIZE_MAX) {
+        part->redirections = phfwdBulkLoadRedirections(part->pool, items,
+                                                       load->pairs, howMany);
+        part->howManyRedirections = howMany;
+        txts = malloc(howMany * sizeof(const char *));
+        part->forward = radixTreeCreate(part->pool);
+    }
+    if (part->redirections != NULL && txts != NULL && part->forward != NULL) {
+        for (i = 0; i < howMany; i++) {
+            txts[i] = phfwdForwardDataSource(part->redirections[i]);
+        }
+        part->success = radixTreeInsertSorted(part->forward, txts,
+                                              part->redirections, NULL,
+                                              howMany, part->pool);
+    }
+
+    free(items);
+    free(tmp);
+    free(txts);
+}
+
+/**
+ * @brief Druga faza budowy części: drzewo backward.
+ * Grupuje przekierowania części na równe prefiksy w tablice BackwardData
+ * i buduje z nich BulkLoadPartition->backward, uzupełniając
+ * ForwardData->treeNode.
+ * @param[in] load - wskaźnik na stan budowy.
+ * @param[in, out] part - wskaźnik na budowaną część.
+ */
+static void phfwdBulkLoadTargets(struct BulkLoad *load,
+                                 struct BulkLoadPartition *part) {
+    size_t n = part->targetEnd - part->targetBegin, i, howManyLists = 0;
+    void *const *redirections = load->byTarget + part->targetBegin;
+    if (n == 0) {
+        part->success = true;
+        return;
+    }
+
+    struct GetManyItem *items = malloc(n * sizeof(struct GetManyItem));
+    struct GetManyItem *tmp = malloc(n * sizeof(struct GetManyItem));
+    const char **txts = malloc(n * sizeof(const char *));
+    RadixTreeNode *nodes = malloc(n * sizeof(RadixTreeNode));
+    void **lists = NULL;
+
+    part->backward = radixTreeCreate(part->pool);
+    part->success = items != NULL && tmp != NULL && txts != NULL
+                    && nodes != NULL && part->backward != NULL;
+    if (part->success) {
+        for (i = 0; i < n; i++) {
+            txts[i] = phfwdForwardDataTarget(redirections[i]);
+            items[i].key = phfwdGetManyKey(txts[i]);
+            items[i].id = i;
+        }
+        part->success = phfwdGetManySort(items, n, txts, tmp);
+    }
+    if (part->success) {
+        lists = phfwdBulkLoadLists(part->pool, items, n, redirections, txts,
+                                   &howManyLists);
+        part->success = lists != NULL
+                        && radixTreeInsertSorted(part->backward, txts, lists,
+                                                 nodes, howManyLists,
+                                                 part->pool);
+    }
+    if (part->success) {
+        for (i = 0; i < howManyLists; i++) {
+            BackwardData data = lists[i];
+            size_t j;
+            for (j = 0; j < data->size; j++) {
+                data->items[j]->treeNode = nodes[i];
+            }
+        }
+    }
+
+    free(items);
+    free(tmp);
+    free(txts);
+    free(nodes);
+    free(lists);
+}
+
+/**
+ * @brief Buduje części bieżącej fazy, dopóki są niezbudowane.
+ * @param[in, out] data - wskaźnik na stan budowy (struct BulkLoad).
+ * @return NULL.
+ */
+static void *phfwdBulkLoadWorker(void *data) {
+    struct BulkLoad *load = data;
+    size_t i;
+    while ((i = atomic_fetch_add(&load->next, 1)) < RADIX_TREE_NUMBER_OF_SONS) {
+        if (load->partitions[i].pool != NULL && load->partitions[i].success) {
+            load->partitions[i].success = false;
+            load->phase(load, &load->partitions[i]);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Wykonuje fazę budowy we wszystkich częściach.
+ * Części są rozdzielane między co najwyżej BulkLoad->threads wątków
+ * (nie więcej niż niepustych części), w tym wątek wywołujący. Jeżeli nie uda się utworzyć wątku, jego
+ * części buduje pozostałe.
+ * @param[in, out] load - wskaźnik na stan budowy.
+ * @param[in] phase - funkcja budująca część.
+ * @return true jeżeli faza powiodła się we wszystkich częściach,
+ *         false w przeciwnym przypadku.
+ */
+static bool phfwdBulkLoadRun(struct BulkLoad *load,
+                             void (*phase)(struct BulkLoad *,
+                                           struct BulkLoadPartition *)) {
+    pthread_t threads[RADIX_TREE_NUMBER_OF_SONS];
+    size_t howManyThreads = 0, howManyPartitions = 0, i;
+    for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
+        if (load->partitions[i].pool != NULL) {
+            howManyPartitions++;
+        }
+    }
+
+    load->phase = phase;
+    atomic_store(&load->next, 0);
+    while (howManyThreads + 1 < MIN(load->threads, howManyPartitions)
+           && pthread_create(&threads[howManyThreads], NULL,
+                             phfwdBulkLoadWorker, load) == 0) {
+        howManyThreads++;
+    }
+    phfwdBulkLoadWorker(load);
+    for (i = 0; i < howManyThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
+        if (load->partitions[i].pool != NULL && !load->partitions[i].success) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Dzieli pary na części według pierwszej cyfry prefiksu
+ * przekierowywanego i tworzy pule niepustych części.
+ * @param[in, out] load - wskaźnik na stan budowy.
+ * @param[in] n - liczba par.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
+ */
+static bool phfwdBulkLoadSplitSources(struct BulkLoad *load, size_t n) {
+    size_t count[RADIX_TREE_NUMBER_OF_SONS] = {0}, i, position = 0;
+    load->order = malloc(n * sizeof(size_t));
+    if (load->order == NULL) {
+        return false;
+    }
+
+    for (i = 0; i < n; i++) {
+        count[phfwdBulkLoadPartitionNumber(load->pairs[2 * i])]++;
+    }
+    for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
+        load->partitions[i].sourceBegin = position;
+        load->partitions[i].sourceEnd = position;
+        position += count[i];
+        if (count[i] != 0) {
+            load->partitions[i].pool = memoryPoolCreate();
+            if (load->partitions[i].pool == NULL) {
+                return false;
+            }
+            load->partitions[i].success = true;
+        }
+    }
+    for (i = 0; i < n; i++) {
+        struct BulkLoadPartition *part =
+                &load->partitions[phfwdBulkLoadPartitionNumber(load->pairs[2 * i])];
+        load->order[part->sourceEnd++] = 2 * i;
+    }
+    return true;
+}
+
+/**
+ * @brief Dzieli przekierowania zbudowane w pierwszej fazie według
+ * pierwszej cyfry prefiksu na który są przekierowania.
+ * Przekierowania na prefiksy zaczynające się cyfrą części bez
+ * przekierowywanych prefiksów trafiają do niej, więc tworzona jest
+ * jej pula.
+ * @param[in, out] load - wskaźnik na stan budowy.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
+ */
+static bool phfwdBulkLoadSplitTargets(struct BulkLoad *load) {
+    size_t count[RADIX_TREE_NUMBER_OF_SONS] = {0}, i, j, position = 0;
+    struct BulkLoadPartition *part;
+    for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
+        part = &load->partitions[i];
+        for (j = 0; j < part->howManyRedirections; j++) {
+            count[phfwdBulkLoadPartitionNumber(
+                    phfwdForwardDataTarget(part->redirections[j]))]++;
+        }
+    }
+
+    for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
+        part = &load->partitions[i];
+        part->targetBegin = position;
+        part->targetEnd = position;
+        position += count[i];
+        if (count[i] != 0 && part->pool == NULL) {
+            part->pool = memoryPoolCreate();
+            if (part->pool == NULL) {
+                return false;
+            }
+            part->success = true;
+        }
+    }
+    load->byTarget = malloc(position * sizeof(void *));
+    if (load->byTarget == NULL) {
+        return false;
+    }
+
+    for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
+        for (j = 0; j < load->partitions[i].howManyRedirections; j++) {
+            void *fd = load->partitions[i].redirections[j];
+            part = &load->partitions[phfwdBulkLoadPartitionNumber(
+                    phfwdForwardDataTarget(fd))];
+            load->byTarget[part->targetEnd++] = fd;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Dołącza zbudowane części do drzew struktury @p pf.
+ * Pule części zostają włączone do puli struktury.
+ * @param[in, out] pf - wskaźnik na strukturę bez przekierowań.
+ * @param[in, out] load - wskaźnik na stan budowy.
+ */
+static void phfwdBulkLoadAttach(struct PhoneForward *pf,
+                                struct BulkLoad *load) {
+    size_t i;
+    struct BulkLoadPartition *part;
+    for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
+        part = &load->partitions[i];
+        if (part->backward != NULL) {
+            radixTreeMoveSons(pf->backward, part->backward);
+            radixTreeDelete(part->backward, radixTreeEmptyDelFunction, NULL,
+                            part->pool);
+        }
+        if (part->forward != NULL) {
+            radixTreeMoveSons(pf->forward, part->forward);
+            radixTreeDelete(part->forward, radixTreeEmptyDelFunction, NULL,
+                            part->pool);
+        }
+        if (part->pool != NULL) {
+            memoryPoolMerge(pf->pool, part->pool);
+            part->pool = NULL;
+        }
+    }
+}
+
+/**
+ * @brief Zwalnia stan budowy.
+ * Pule części, które nie zostały dołączone do struktury, są usuwane
+ * razem z całą zbudowaną w nich zawartością.
+ * @param[in, out] load - wskaźnik na stan budowy.
+ */
+static void phfwdBulkLoadFree(struct BulkLoad *load) {
+    size_t i;
+    for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
+        free(load->partitions[i].redirections);
+        memoryPoolDestroy(load->partitions[i].pool);
+    }
+    free(load->order);
+    free(load->byTarget);
+}
+
+/**
+ * @brief Buduje drzewa pustej struktury @p pf z par.
+ * Każdy syn korzeni obu drzew jest budowany osobno, w co najwyżej
+ * @p threads wątkach, z własną pulą pamięci. Wszystkie poddrzewa są
+ * dołączane do korzeni dopiero na końcu, więc w przypadku problemów
+ * z pamięcią wystarczy usunąć pule części.
+ * @param[in, out] pf - wskaźnik na strukturę bez przekierowań.
+ * @param[in] pairs - tablica 2 * @p n wskaźników na numery.
+ * @param[in] n - liczba par (różna od 0).
+ * @param[in] threads - największa liczba wątków.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią
+ *         (struktura pozostaje wtedy pusta).
+ */
+static bool phfwdBulkLoadBuild(struct PhoneForward *pf,
+                               const char *const *pairs, size_t n,
+                               size_t threads) {
+    struct BulkLoad load;
+    memset(&load, 0, sizeof(struct BulkLoad));
+    atomic_init(&load.next, 0);
+    load.pairs = pairs;
+    load.threads = threads;
+
+    bool result = phfwdBulkLoadSplitSources(&load, n)
+                  && phfwdBulkLoadRun(&load, phfwdBulkLoadSources)
+                  && phfwdBulkLoadSplitTargets(&load)
+                  && phfwdBulkLoadRun(&load, phfwdBulkLoadTargets);
+    if (result) {
+        phfwdBulkLoadAttach(pf, &load);
+    }
+    phfwdBulkLoadFree(&load);
+    return result;
+}
+
+/**
+ * @brief Dodaje pary do struktury zawierającej już przekierowania.
+ * Pary są dodawane pojedynczo, w kolejności leksykograficznej prefiksów
+ * przekierowywanych, z pominięciem zastąpionych.
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[in] pairs - tablica 2 * @p n wskaźników na numery.
+ * @param[in] n - liczba par.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
+ */
+static bool phfwdBulkLoadInsert(struct PhoneForward *pf,
+                                const char *const *pairs, size_t n) {
+    struct GetManyItem *items = malloc(n * sizeof(struct GetManyItem));
+    struct GetManyItem *tmp = malloc(n * sizeof(struct GetManyItem));
+    size_t howMany = SIZE_MAX, i;
+    if (items != NULL && tmp != NULL) {
+        for (i = 0; i < n; i++) {
+            items[i].id = 2 * i;
+        }
+        howMany = phfwdBulkLoadUnique(items, pairs, n, tmp);
+    }
+
+    bool result = howMany != SIZE_MAX;
+    RadixTreeNode fwInsert, bwInsert;
+    for (i = 0; result && i < howMany; i++) {
+        const char *num1 = pairs[items[i].id];
+        const char *num2 = pairs[items[i].id + 1];
+        result = phfwdPrepareTreesForAdd(pf, num1, num2, &fwInsert, &bwInsert)
+                 && phfwdAddSetNodes(pf, fwInsert, bwInsert, num1, num2);
+    }
+
+    free(items);
+    free(tmp);
+    return result;
+}
+
+/**
+ * @brief Sprawdza czy struktura nie zawiera przekierowań.
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @return true jeżeli nie zawiera, false w przeciwnym przypadku.
+ */
+static bool phfwdIsEmpty(struct PhoneForward *pf) {
+    size_t i;
+    for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
+        if (radixTreeSon(pf->forward, i) != NULL) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool phfwdBulkLoadParallel(struct PhoneForward *pf, const char *const *pairs,
+                           size_t n, size_t threads) {
+    if (pf->readOnly || !phfwdBulkLoadValid(pairs, n)) {
+        return false;
+    } else if (n == 0) {
+        return true;
+    }
+
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (size_t) online : 1;
+    }
+
+    bool result;
+    phfwdLockWrite(pf);
+    phfwdDropCompiled(pf);
+    if (phfwdIsEmpty(pf)) {
+        result = phfwdBulkLoadBuild(pf, pairs, n,
+                                    MIN(threads, RADIX_TREE_NUMBER_OF_SONS));
+    } else {
+        result = phfwdBulkLoadInsert(pf, pairs, n);
+    }
+    phfwdUnlockWrite(pf);
+    return result;
+}
+
+bool phfwdBulkLoad(struct PhoneForward *pf, const char *const *pairs,
+                   size_t n) {
+    return phfwdBulkLoadParallel(pf, pairs, n, 1);
+}
+
+void phnumDelete(const struct PhoneNumbers *pnum) {
+    if (pnum != NULL) {
+        free(pnum->offsets);
+        free(pnum->chars);
+        free((void *) pnum);
+    }
+}
+
+const char *phnumGet(const struct PhoneNumbers *pnum, size_t idx) {
+    if (pnum == NULL
+        || pnum->howMany <= idx
+        || pnum->offsets[idx] == PHFWD_NO_NUMBER) {
+        return NULL;
+    } else {
+        return pnum->chars + pnum->offsets[idx];
+    }
+}
+
+/**
+ * @brief Maksymalna liczba numerów zwróconych w wyniku phfwdGetReverse.
+ * Razem z powtórzeniami.
+ * @param[in] node - wskaźnik na węzeł
+ * @return Maksymalna liczba numerów zwróconych w wyniku phfwdGetReverse od
+ *         tekstu reprezentowanego przez węzeł @p node.
+ */
+static size_t phfwdHowManyRedirections(RadixTreeNode node) {
+    size_t result = 1;
+    RadixTreeNode pos = node;
+
+    while (!radixTreeIsRoot(pos)) {
+        if (radixTreeGetNodeData(pos) != NULL) {
+            BackwardData data = radixTreeGetNodeData(pos);
+            result += data->size - data->holes;
+        }
+        pos = radixTreeFather(pos);
+    }
+    return result;
+}
+
+/**
+ * @brief Element kopca scalającego w phfwdAddRedir.
+ * Kluczem elementu jest tekst @p first z dołączonym @p second (o ile nie
+ * jest on równy NULL). Element z @p node równym NULL reprezentuje jeden
+ * numer wynikowy. Pozostałe reprezentują ciąg numerów powstających
+ * z pozycji tablicy BackwardData->items od @p node do @p end, a ich klucz
+ * jest nie większy od każdego z tych numerów: jest nim pierwszy numer
+ * ciągu albo, gdy prefiks z @p node jest prefiksem następnego w ciągu, sam
+ * ten prefiks (@p second równe NULL).
+ */
+struct ReverseHeapItem {
+    /**
+     * @brief Początek klucza.
+     */
+    const char *first;
+
+    /**
+     * @brief Koniec klucza, NULL jeżeli klucz stanowi sam @p first.
+     */
+    const char *second;
+
+    /**
+     * @brief Niedopasowana przekierowaniami część numeru dołączana do
+     * prefiksów z ciągu.
+     */
+    const char *suffix;
+
+    /**
+     * @brief Bieżąca pozycja ciągu w tablicy BackwardData->items, NULL dla
+     * elementu gotowego.
+     */
+    ForwardData *node;
+
+    /**
+     * @brief Pozycja za końcem ciągu.
+     */
+    ForwardData *end;
+};
+
+/**
+ * @brief Porównuje leksykograficznie teksty @p a1 + @p a2 i @p b1 + @p b2.
+ * @param[in] a1 - wskaźnik na początek pierwszego tekstu.
+ * @param[in] a2 - wskaźnik na koniec pierwszego tekstu.
+ * @param[in] b1 - wskaźnik na początek drugiego tekstu.
+ * @param[in] b2 - wskaźnik na koniec drugiego tekstu.
+ * @return Wartość ujemna, zero lub dodatnia, gdy pierwszy tekst jest
+ *         odpowiednio mniejszy, równy lub większy od drugiego.
+ */
+static int phfwdReverseCompare(const char *a1, const char *a2,
+                               const char *b1, const char *b2) {
+    while (true) {
+        if (*a1 == '\0' && a2 != NULL) {
+            a1 = a2;
+            a2 = NULL;
+        }
+        if (*b1 == '\0' && b2 != NULL) {
+            b1 = b2;
+            b2 = NULL;
+        }
+        if (*a1 != *b1) {
+            return (int) (unsigned char) *a1 - (int) (unsigned char) *b1;
+        }
+        if (*a1 == '\0') {
+            return 0;
+        }
+        a1++;
+        b1++;
+    }
+}
+
+/**
+ * @brief Sprawdza czy klucz elementu @p a jest mniejszy od klucza @p b.
+ * @param[in] a - wskaźnik na element kopca.
+ * @param[in] b - wskaźnik na element kopca.
+ * @return true jeżeli klucz @p a jest mniejszy, false w przeciwnym przypadku.
+ */
+static bool phfwdReverseHeapLess(const struct ReverseHeapItem *a,
+                                 const struct ReverseHeapItem *b) {
+    return phfwdReverseCompare(a->first, a->second,
+                               b->first, b->second) < 0;
+}
+
+/**
+ * @brief Dodaje element do kopca.
+ * #### Złożoność
+ * O(log k * L), gdzie k to rozmiar kopca, a L to długość kluczy
+ * @param[in, out] heap - tablica z kopcem, z miejscem na nowy element.
+ * @param[in, out] size - wskaźnik na rozmiar kopca.
+ * @param[in] item - dodawany element.
+ */
+static void phfwdReverseHeapPush(struct ReverseHeapItem *heap, size_t *size,
+                                 struct ReverseHeapItem item) {
+    size_t pos = (*size)++;
+    while (pos > 0 && phfwdReverseHeapLess(&item, &heap[(pos - 1) / 2])) {
+        heap[pos] = heap[(pos - 1) / 2];
+        pos = (pos - 1) / 2;
+    }
+    heap[pos] = item;
+}
+
+/**
+ * @brief Zastępuje element o najmniejszym kluczu w kopcu.
+ * #### Złożoność
+ * O(log k * L), gdzie k to rozmiar kopca, a L to długość kluczy
+ * @param[in, out] heap - tablica z niepustym kopcem.
+ * @param[in] size - rozmiar kopca.
+ * @param[in] item - nowy element.
+ */
+static void phfwdReverseHeapReplaceTop(struct ReverseHeapItem *heap,
+                                       size_t size,
+                                       struct ReverseHeapItem item) {
+    size_t pos = 0, son;
+    while ((son = 2 * pos + 1) < size) {
+        if (son + 1 < size && phfwdReverseHeapLess(&heap[son + 1],
+                                                    &heap[son])) {
+            son++;
+        }
+        if (!phfwdReverseHeapLess(&heap[son], &item)) {
+            break;
+        }
+        heap[pos] = heap[son];
+        pos = son;
+    }
+    heap[pos] = item;
+}
+
+/**
+ * @brief Usuwa z kopca element o najmniejszym kluczu.
+ * #### Złożoność
+ * O(log k * L), gdzie k to rozmiar kopca, a L to długość kluczy
+ * @param[in, out] heap - tablica z niepustym kopcem.
+ * @param[in, out] size - wskaźnik na rozmiar kopca.
+ */
+static void phfwdReverseHeapPop(struct ReverseHeapItem *heap, size_t *size) {
+    (*size)--;
+    if (*size > 0) {
+        phfwdReverseHeapReplaceTop(heap, *size, heap[*size]);
     }
 }
 
-const char *phnumGet(const struct PhoneNumbers *pnum, size_t idx) {
-    if (pnum == NULL
-        || pnum->howMany <= idx) {
-        return NULL;
-    } else {
-        return pnum->numbers[idx];
+/**
+ * @brief Tworzy element kopca reprezentujący numery z ciągu.
+ * @param[in] node - pierwsza pozycja ciągu (nie będąca dziurą).
+ * @param[in] end - pozycja za końcem ciągu.
+ * @param[in] suffix - niedopasowana część numeru.
+ * @return Element kopca.
+ */
+static struct ReverseHeapItem phfwdReverseStreamItem(ForwardData *node,
+                                                     ForwardData *end,
+                                                     const char *suffix) {
+    struct ReverseHeapItem item;
+    item.first = phfwdForwardDataSource(*node);
+    item.second = suffix;
+    item.suffix = suffix;
+    item.node = node;
+    item.end = end;
+    ForwardData *next = phfwdBackwardDataSkipHoles(node + 1, end);
+    if (next != end) {
+        if (strncmp(item.first, phfwdForwardDataSource(*next),
+                    strlen(item.first)) == 0) {
+            item.second = NULL;
+        }
     }
+    return item;
 }
 
 /**
- * @brief Maksymalna liczba numerów zwróconych w wyniku phfwdGetReverse.
- * Razem z powtórzeniami.
- * @param[in] node - wskaźnik na węzeł
- * @return Maksymalna liczba numerów zwróconych w wyniku phfwdGetReverse od
- *         tekstu reprezentowanego przez węzeł @p node.
+ * @brief Początkowy rozmiar kopca scalającego.
+ * @see phfwdReverseMergePush
  */
-static size_t phfwdHowManyRedirections(RadixTreeNode node) {
-    size_t result = 1;
-    RadixTreeNode pos = node;
+#define PHFWD_REVERSE_HEAP_INITIAL_CAPACITY 16
 
-    while (!radixTreeIsRoot(pos)) {
-        if (radixTreeGetNodeData(pos) != NULL) {
-            List list = radixTreeGetNodeData(pos);
-            result += listSize(list, SIZE_MAX);
+/**
+ * @brief Stan scalania numerów powstających w wyniku phfwdReverse.
+ * Kopiec zawiera po jednym elemencie na każdy nie wyczerpany ciąg
+ * i elementy gotowe, które czekają na swoją kolej. Ciągami są posortowane
+ * części tablic BackwardData przodków numeru oraz pojedyncze elementy ich
+ * nieposortowanych końcówek, więc rozmiar kopca to O(d + t), gdzie d to
+ * liczba przodków, a t to łączna długość końcówek. Końcówka tablicy nie
+ * przekracza PHFWD_BACKWARD_UNSORTED_LIMIT lub
+ * 1 / PHFWD_BACKWARD_UNSORTED_RATIO jej posortowanej części, a scalanie nie
+ * może jej sortować, bo zapytania nie modyfikują struktury.
+ * @see phfwdReverseMergeStart
+ * @see phfwdReverseMergeNext
+ */
+struct ReverseMerge {
+    /**
+     * @brief Tablica z kopcem.
+     */
+    struct ReverseHeapItem *heap;
+
+    /**
+     * @brief Liczba elementów kopca.
+     */
+    size_t size;
+
+    /**
+     * @brief Rozmiar tablicy @p heap.
+     */
+    size_t capacity;
+};
+
+/**
+ * @brief Dodaje element do kopca scalającego, powiększając go w razie
+ * potrzeby.
+ * @param[in, out] merge - wskaźnik na stan scalania.
+ * @param[in] item - dodawany element.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
+ */
+static bool phfwdReverseMergePush(struct ReverseMerge *merge,
+                                  struct ReverseHeapItem item) {
+    if (merge->size == merge->capacity) {
+        size_t capacity = merge->capacity == 0
+                          ? PHFWD_REVERSE_HEAP_INITIAL_CAPACITY
+                          : 2 * merge->capacity;
+        struct ReverseHeapItem *heap =
+                realloc(merge->heap, capacity * sizeof(struct ReverseHeapItem));
+        if (heap == NULL) {
+            return false;
         }
-        pos = radixTreeFather(pos);
+        merge->heap = heap;
+        merge->capacity = capacity;
     }
-    return result;
+    phfwdReverseHeapPush(merge->heap, &merge->size, item);
+    return true;
 }
 
 /**
- * @brief Dodaje numery które powstają w wyniku phfwdReverse do @p storage.
- * @param[out] storage - wskaźnik na strukturę przechowującą numery, gotową
- *        do przyjęcia numerów (razem z powtórzeniami).
- * @param[in] node - wskaźnik na węzeł reprezentujący najdłuższy
+ * @brief Rozpoczyna scalanie numerów powstających w wyniku phfwdReverse.
+ * Posortowane części tablic BackwardData z przodków @p node oraz elementy
+ * ich nieposortowanych końcówek tworzą ciągi scalane kopcem, do którego
+ * trafia też sam numer.
+ * @param[out] merge - wskaźnik na stan scalania, w przypadku niepowodzenia
+ *        nie wymaga zwolnienia.
+ * @param[in] node - wskaźnik na węzeł reprezentujący najdłuższy
  *        dopasowany prefiks numeru,
  *        z wyłączeniem częściowego dopasowania krawędzi.
  * @param[in] matchedTxt - wskaźnik na dopasowanie numeru (wszystkie znaki
  *        występujące za tym wskaźnikiem nie zostały dopasowane).
- * @return W przypadku udanego dodania true, w przypadku problemów
- *         false.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
  */
-static bool phfwdAddRedir(struct PhoneNumbers *storage,
-                          RadixTreeNode node,
-                          const char *matchedTxt) {
+static bool phfwdReverseMergeStart(struct ReverseMerge *merge,
+                                   RadixTreeNode node,
+                                   const char *matchedTxt) {
+    merge->heap = NULL;
+    merge->size = 0;
+    merge->capacity = 0;
+
+    bool success = true;
     RadixTreeNode pos = node;
-    size_t insertPtr = 0;
-    while (!radixTreeIsRoot(pos)) {
-        if (radixTreeGetNodeData(pos) != NULL) {
-            List list = radixTreeGetNodeData(pos);
-            ListNode p = listFirstNode(list);
-            while (p != NULL) {
-                char *prefix = radixGetFullText(listNodeGetValue(p));
-                if (prefix == NULL) {
-                    return false;
-                } else {
-                    char *toAdd = concatenate(prefix, matchedTxt);
-                    free(prefix);
-                    if (toAdd == NULL) {
-                        return false;
-                    } else {
-                        assert(insertPtr < storage->howMany);
-                        storage->numbers[insertPtr] = toAdd;
-                        insertPtr++;
-                    }
-                }
-                p = listNextNode(p);
+    while (success && !radixTreeIsRoot(pos)) {
+        BackwardData data = radixTreeGetNodeData(pos);
+        if (data != NULL) {
+            ForwardData *sortedEnd = data->items + data->sortedSize;
+            ForwardData *p = phfwdBackwardDataSkipHoles(data->items,
+                                                        sortedEnd);
+            if (p != sortedEnd) {
+                success = phfwdReverseMergePush(
+                        merge, phfwdReverseStreamItem(p, sortedEnd,
+                                                      matchedTxt));
+            }
+            for (p = sortedEnd; success && p != data->items + data->size;
+                 p++) {
+                success = phfwdReverseMergePush(
+                        merge, phfwdReverseStreamItem(p, p + 1, matchedTxt));
             }
         }
         matchedTxt = matchedTxt - radixTreeHowManyChars(pos);
         pos = radixTreeFather(pos);
-
     }
-    char *toAdd = duplicateText(matchedTxt);
-    if (toAdd == NULL) {
-        return false;
-    } else {
-        assert(insertPtr < storage->howMany);
-        storage->numbers[insertPtr] = toAdd;
-        insertPtr++;
+
+    struct ReverseHeapItem identity;
+    identity.first = matchedTxt;
+    identity.second = NULL;
+    identity.suffix = NULL;
+    identity.node = NULL;
+    identity.end = NULL;
+    success = success && phfwdReverseMergePush(merge, identity);
+
+    if (!success) {
+        free(merge->heap);
     }
-    return true;
+    return success;
 }
 
 /**
- * @brief Przygotowuje podane struktury do sortowania numerów
- * @param[out] tree - wskaźnik na wskaźnik na drzewo wykorzystane do sortowania.
- *        Po wykonaniu @p *tree wskazuje na nowe puste drzewo.
- * @param[out] ids - wskaźnik na wskaźnik na tablicę indeksów.
- *        Po wykonaniu @p *ids wskazuje na tablicę indeksów od 0 do
- *        @p out->howMany - 1.
- * @param[in] out - wskaźnik na strukturę przechowującą numery.
- * @return Jeżeli operacja się powiedzie to true, false
- *         w przeciwnym przypadku.
+ * @brief Wyznacza kolejny numer w porządku leksykograficznym.
+ * Numery mogą się powtarzać (kolejno).
+ * #### Złożoność
+ * Zamortyzowana O(log k * L), gdzie k to rozmiar kopca, a L to długość
+ * numerów
+ * @param[in, out] merge - wskaźnik na stan scalania.
+ * @param[out] number - numer to tekst number->first z dołączonym
+ *        number->second (o ile nie jest on równy NULL), number->first
+ *        równe NULL oznacza brak kolejnych numerów.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią
+ *         (scalanie nie może być wtedy kontynuowane).
  */
-static bool phfwdPrepareForSort(RadixTree *tree, size_t **ids,
-                                const struct PhoneNumbers *out) {
-    *tree = radixTreeCreate();
-    if (*tree == NULL) {
-        return false;
-    } else {
-        *ids = malloc(out->howMany * sizeof(size_t));
-        if (*ids == NULL) {
-            radixTreeDelete(*tree, radixTreeEmptyDelFunction, NULL);
-            return false;
+static bool phfwdReverseMergeNext(struct ReverseMerge *merge,
+                                  struct ReverseHeapItem *number) {
+    while (merge->size > 0) {
+        struct ReverseHeapItem item = merge->heap[0];
+        ForwardData *next = NULL;
+        if (item.node != NULL) {
+            next = phfwdBackwardDataSkipHoles(item.node + 1, item.end);
+        }
+        if (next != NULL && next != item.end) {
+            phfwdReverseHeapReplaceTop(merge->heap, merge->size,
+                                       phfwdReverseStreamItem(next, item.end,
+                                                              item.suffix));
         } else {
-            size_t i;
-            for (i = 0; i < out->howMany; i++) {
-                (*ids)[i] = i;
+            phfwdReverseHeapPop(merge->heap, &merge->size);
+        }
+        if (item.node != NULL && item.second == NULL) {
+            item.second = item.suffix;
+            item.node = NULL;
+            if (!phfwdReverseMergePush(merge, item)) {
+                return false;
             }
+        } else {
+            *number = item;
             return true;
         }
     }
+    number->first = NULL;
+    return true;
 }
 
 /**
- * @brief Dodaje numery do drzewa w celu posortowania.
- * Dodaje numery do drzewa w celu posortowania numerów i usunięcia powtórzeń.
- * @param[in] tree - wskaźnik na drzewo wykorzystywane przy sortowaniu.
- * @param[in] ids - tablica indeksów (od 0 do @p out->howMany - 1).
- * @param[in] out - wskaźnik na strukturę z numerami.
- * @return Jeżeli operacja się powiedzie to true, false
- *         w przeciwnym przypadku.
+ * @brief Kończy scalanie.
+ * @param[in, out] merge - wskaźnik na stan scalania.
  */
-static bool phfwdRadixSortOutAddToTree(RadixTree tree, size_t *ids,
-                                       const struct PhoneNumbers *out) {
-    size_t i;
-    for (i = 0; i < out->howMany; i++) {
-        RadixTreeNode ptr = radixTreeInsert(tree, out->numbers[i]);
-        if (ptr == NULL) {
-            return false;
-        } else {
-            radixTreeSetData(ptr, &ids[i]);
+static void phfwdReverseMergeFinish(struct ReverseMerge *merge) {
+    free(merge->heap);
+}
+
+/**
+ * @brief Dodaje numery które powstają w wyniku phfwdReverse do @p storage.
+ * Numery trafiają do @p storage posortowane i bez powtórzeń.
+ * @see phfwdReverseMergeStart
+ * #### Złożoność
+ * O(m log k * L), gdzie m to liczba numerów, k to liczba scalanych ciągów,
+ * a L to długość numerów
+ * @param[in, out] storage - wskaźnik na pustą strukturę przechowującą
+ *        numery.
+ * @param[in] node - wskaźnik na węzeł reprezentujący najdłuższy
+ *        dopasowany prefiks numeru,
+ *        z wyłączeniem częściowego dopasowania krawędzi.
+ * @param[in] matchedTxt - wskaźnik na dopasowanie numeru (wszystkie znaki
+ *        występujące za tym wskaźnikiem nie zostały dopasowane).
+ * @return W przypadku udanego dodania true, w przypadku problemów
+ *         false.
+ */
+static bool phfwdAddRedir(struct PhoneNumbers *storage,
+                          RadixTreeNode node,
+                          const char *matchedTxt) {
+    struct ReverseMerge merge;
+    if (!phfwdReverseMergeStart(&merge, node, matchedTxt)) {
+        return false;
+    }
+
+    struct ReverseHeapItem number;
+    bool success = phfwdReverseMergeNext(&merge, &number);
+    while (success && number.first != NULL) {
+        if (storage->howMany == 0
+            || phfwdReverseCompare(phnumGet(storage, storage->howMany - 1),
+                                   NULL, number.first, number.second) != 0) {
+            success = phfwdNumbersAppend(storage, number.first,
+                                         strlen(number.first), number.second);
         }
+        success = success && phfwdReverseMergeNext(&merge, &number);
     }
-    return true;
+
+    phfwdReverseMergeFinish(&merge);
+    return success;
 }
 
 /**
- * @brief Dane dla funkcji sortującej.
- * @see phfwdRadixSortOutOrganize.
+ * @brief Rozmiar przedziału, poniżej którego numery są sortowane przez
+ * wstawianie.
+ * @see phfwdSortNumbers
  */
-struct SortFoldData {
+#define PHFWD_SORT_INSERTION_THRESHOLD 16
+
+/**
+ * @brief Przedział numerów do posortowania w @ref phfwdSortNumbers.
+ */
+struct SortRange {
     /**
-     * @brief Wskaźnik na strukturę z wynikiem.
+     * @brief Bufor ze znakami numerów (PhoneNumbers->chars).
      */
-    struct PhoneNumbers *newOut;
+    const char *chars;
 
     /**
-     * @brief Wskaźnik na strukturę z nieposortowanymi numerami.
+     * @brief Wskaźnik na pozycję pierwszego numeru przedziału
+     * w @p chars.
      */
-    const struct PhoneNumbers *oldOut;
+    size_t *numbers;
 
     /**
-     * @brief Liczba numerów już dodanych do newOut.
-     * @see newOut
+     * @brief Liczba numerów w przedziale.
      */
-    size_t process;
+    size_t howMany;
 
+    /**
+     * @brief Długość wspólnego prefiksu numerów z przedziału.
+     */
+    size_t depth;
 };
 
 /**
- * @brief Pobiera z drzewa numery w kolejności posortowanej.
- * @see SortFoldData
- * @see radixTreeFold
- * @param[in] data - wskaźnik na indeks (przechowywany przez drzewo).
- * @param[in] fData - wskaźnik na SortFoldData.
- * @see SortFoldData
+ * @brief Znak numeru używany przy sortowaniu.
+ * @param[in] number - wskaźnik na numer.
+ * @param[in] depth - pozycja znaku (nie większa niż długość numeru).
+ * @return Kod znaku na pozycji @p depth, 0 dla końca numeru.
  */
-static void phfwdRadixSortOutOrganize(void *data, void *fData) {
-    struct SortFoldData *sfd = (struct SortFoldData *) fData;
-    size_t *id = (size_t *) data;
-    sfd->newOut->numbers[sfd->process] = sfd->oldOut->numbers[*id];
-    sfd->process++;
-    sfd->oldOut->numbers[*id] = NULL;
+static unsigned char phfwdSortChar(const char *number, size_t depth) {
+    return (unsigned char) number[depth];
 }
 
 /**
- * @brief Sortuje numery.
- * Sortuje numery z @p *out i usuwa powtórzenia.
- * @param[in, out] out - wskaźnik na wskaźnik na strukturę z numerami.
- *        po wykonaniu @p *out wskazuje na strukturę z posortowanymi numerami
- *        (bez powtórzeń) stara struktura zostaje usunięta.
- * @return W przypadku sukcesu true, w przypadku problemów false.
- */
-static bool phfwdRadixSortOut(struct PhoneNumbers **out) {
-    RadixTree tree;
-    size_t *ids;
-    if (phfwdPrepareForSort(&tree, &ids, *out)) {
-        if (phfwdRadixSortOutAddToTree(tree, ids, *out)) {
-            size_t howManyUnique = 0;
-            radixTreeFold(tree, radixTreeCountDataFunction, &howManyUnique);
-            struct PhoneNumbers *newOut =
-                    phfwdCreatePhoneNumbersStructure(howManyUnique);
-
-            if (newOut == NULL) {
-                free(ids);
-                radixTreeDelete(tree, radixTreeEmptyDelFunction, NULL);
-                return false;
-            } else {
-                struct SortFoldData sfd;
-                sfd.oldOut = *out;
-                sfd.newOut = newOut;
-                sfd.process = 0;
-                radixTreeFold(tree, phfwdRadixSortOutOrganize, &sfd);
-                phnumDelete(*out);
-                *out = newOut;
-                free(ids);
-                radixTreeDelete(tree, radixTreeEmptyDelFunction, NULL);
-
-                return true;
-
-            }
+ * @brief Usuwa numery równe poprzedzającym je numerom.
+ * Pozycje usuniętych numerów są ustawiane na PHFWD_NO_NUMBER.
+ * @param[in] range - wskaźnik na przedział posortowanych numerów.
+ */
+static void phfwdSortDropEqual(const struct SortRange *range) {
+    const char *chars = range->chars + range->depth;
+    size_t *numbers = range->numbers;
+    size_t last = 0, i;
+    for (i = 1; i < range->howMany; i++) {
+        if (strcmp(chars + numbers[last], chars + numbers[i]) == 0) {
+            numbers[i] = PHFWD_NO_NUMBER;
         } else {
-            free(ids);
-            radixTreeDelete(tree, radixTreeEmptyDelFunction, NULL);
-            return false;
+            last = i;
+        }
+    }
+}
+
+/**
+ * @brief Sortuje przez wstawianie krótki przedział numerów.
+ * Powtórzenia zostają usunięte (patrz @ref phfwdSortDropEqual).
+ * @param[in] range - wskaźnik na przedział numerów.
+ */
+static void phfwdSortInsertion(const struct SortRange *range) {
+    const char *chars = range->chars + range->depth;
+    size_t *numbers = range->numbers;
+    size_t i, j, number;
+    for (i = 1; i < range->howMany; i++) {
+        number = numbers[i];
+        for (j = i; j > 0 && strcmp(chars + numbers[j - 1],
+                                    chars + number) > 0; j--) {
+            numbers[j] = numbers[j - 1];
         }
+        numbers[j] = number;
+    }
+    phfwdSortDropEqual(range);
+}
 
+/**
+ * @brief Wybiera znak dzielący przedział numerów.
+ * @param[in] range - wskaźnik na przedział (co najmniej trzy numery).
+ * @return Mediana znaków na pozycji SortRange->depth pierwszego,
+ *         środkowego i ostatniego numeru.
+ */
+static unsigned char phfwdSortPivot(const struct SortRange *range) {
+    const char *chars = range->chars;
+    const size_t *numbers = range->numbers;
+    unsigned char a = phfwdSortChar(chars + numbers[0], range->depth);
+    unsigned char b = phfwdSortChar(chars + numbers[range->howMany / 2],
+                                    range->depth);
+    unsigned char c = phfwdSortChar(chars + numbers[range->howMany - 1],
+                                    range->depth);
+    if (a < b) {
+        return b < c ? b : (a < c ? c : a);
     } else {
-        return false;
+        return a < c ? a : (b < c ? c : b);
+    }
+}
+
+/**
+ * @brief Dzieli przedział numerów względem znaku na pozycji
+ * SortRange->depth.
+ * Dzieli @p range na numery o znaku mniejszym, równym i większym od
+ * wybranego (@ref phfwdSortPivot). Jeżeli wybrany znak jest końcem numeru,
+ * numery równe są identyczne i zostają od razu zredukowane do jednego.
+ * @param[in] range - wskaźnik na dzielony przedział.
+ * @param[out] parts - tablica trzech przedziałów, na które podzielono
+ *        @p range.
+ */
+static void phfwdSortPartition(const struct SortRange *range,
+                               struct SortRange *parts) {
+    size_t *numbers = range->numbers;
+    unsigned char pivot = phfwdSortPivot(range), c;
+    size_t lt = 0, i = 0, gt = range->howMany;
+    size_t swap;
+
+    while (i < gt) {
+        c = phfwdSortChar(range->chars + numbers[i], range->depth);
+        if (c < pivot) {
+            swap = numbers[lt];
+            numbers[lt++] = numbers[i];
+            numbers[i++] = swap;
+        } else if (c > pivot) {
+            swap = numbers[--gt];
+            numbers[gt] = numbers[i];
+            numbers[i] = swap;
+        } else {
+            i++;
+        }
+    }
+
+    parts[0].chars = range->chars;
+    parts[1].chars = range->chars;
+    parts[2].chars = range->chars;
+    parts[0].numbers = numbers;
+    parts[0].howMany = lt;
+    parts[0].depth = range->depth;
+    parts[1].numbers = numbers + lt;
+    parts[1].howMany = gt - lt;
+    parts[1].depth = range->depth + 1;
+    parts[2].numbers = numbers + gt;
+    parts[2].howMany = range->howMany - gt;
+    parts[2].depth = range->depth;
+
+    if (pivot == '\0') {
+        for (i = 1; i < parts[1].howMany; i++) {
+            parts[1].numbers[i] = PHFWD_NO_NUMBER;
+        }
+        parts[1].howMany = 0;
+    }
+}
+
+/**
+ * @brief Sortuje przedział numerów wielokluczowym sortowaniem szybkim.
+ * Pozycje powtórzeń zostają ustawione na PHFWD_NO_NUMBER.
+ * Wywołania rekurencyjne dotyczą jedynie dwóch mniejszych z trzech części
+ * przedziału, więc głębokość rekursji nie przekracza
+ * log2(liczba numerów).
+ * #### Złożoność
+ * Oczekiwana O(liczba numerów * log(liczba numerów)
+ * + łączna długość wspólnych prefiksów)
+ * @param[in] range - przedział numerów.
+ */
+static void phfwdSortNumbersRange(struct SortRange range) {
+    struct SortRange parts[3];
+    size_t i, largest;
+
+    while (range.howMany >= PHFWD_SORT_INSERTION_THRESHOLD) {
+        phfwdSortPartition(&range, parts);
+        largest = 0;
+        for (i = 1; i < 3; i++) {
+            if (parts[i].howMany > parts[largest].howMany) {
+                largest = i;
+            }
+        }
+        for (i = 0; i < 3; i++) {
+            if (i != largest) {
+                phfwdSortNumbersRange(parts[i]);
+            }
+        }
+        range = parts[largest];
+    }
+    phfwdSortInsertion(&range);
+}
+
+/**
+ * @brief Sortuje numery.
+ * Sortuje w miejscu pozycje numerów z @p out i usuwa powtórzenia,
+ * nie przydzielając pamięci. Znaki usuniętych numerów pozostają w buforze.
+ * @param[in, out] out - wskaźnik na strukturę z numerami (bez brakujących
+ *        numerów).
+ */
+static void phfwdSortNumbers(struct PhoneNumbers *out) {
+    struct SortRange range;
+    range.chars = out->chars;
+    range.numbers = out->offsets;
+    range.howMany = out->howMany;
+    range.depth = 0;
+    phfwdSortNumbersRange(range);
+
+    size_t unique = 0, i;
+    for (i = 0; i < out->howMany; i++) {
+        if (out->offsets[i] != PHFWD_NO_NUMBER) {
+            out->offsets[unique++] = out->offsets[i];
+        }
     }
+    out->howMany = unique;
 }
 
 /**
@@ -734,10 +3648,11 @@ static bool phfwdRadixSortOut(struct PhoneNumbers **out) {
  *          odwróconych przekierowaniach.
  * @param[in] num - wskaźnik na numer dla którego wykonujemy operację
  *        odwrócenia przekierowania.
- * @return Struktura z numerami dla phfwdReverse.
+ * @param[in, out] result - wskaźnik na pustą strukturę na numery.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
  */
-static const struct PhoneNumbers *phfwdGetReverse(RadixTree backward,
-                                                  const char *num) {
+static bool phfwdGetReverse(RadixTree backward, const char *num,
+                            struct PhoneNumbers *result) {
     RadixTreeNode ptr;
     const char *matchedTxt;
 
@@ -745,34 +3660,288 @@ static const struct PhoneNumbers *phfwdGetReverse(RadixTree backward,
 
     size_t numberOfRedirections = phfwdHowManyRedirections(ptr);
 
-    struct PhoneNumbers *result =
-            phfwdCreatePhoneNumbersStructure(numberOfRedirections);
-    if (result == NULL) {
-        return NULL;
-    } else {
-        if (!phfwdAddRedir(result, ptr, matchedTxt)) {
-            phnumDelete(result);
-            return NULL;
-        } else {
-            if (phfwdRadixSortOut(&result)) {
-                return result;
-            } else {
-                phnumDelete(result);
-                return NULL;
-            }
+    return phfwdNumbersReserve(result, numberOfRedirections, 0)
+           && phfwdAddRedir(result, ptr, matchedTxt);
+}
 
-        }
+/**
+ * @brief Dane dla funkcji zbierających numery w phfwdGetReverseMapped.
+ * @see phfwdMappedReverseCount
+ * @see phfwdMappedReverseAdd
+ */
+struct MappedReverseData {
+    /**
+     * @brief Odwzorowany obraz struktury.
+     */
+    const struct MappedForward *mapped;
+
+    /**
+     * @brief Zwarta postać drzewa forward odwzorowanej struktury.
+     */
+    const struct CompiledForward *compiled;
+
+    /**
+     * @brief Numer dla którego wykonujemy operację odwrócenia przekierowania.
+     */
+    const char *num;
+
+    /**
+     * @brief Struktura na wynik.
+     */
+    struct PhoneNumbers *result;
+
+    /**
+     * @brief Liczba numerów (razem z powtórzeniami), wyznaczana przez
+     * phfwdMappedReverseCount.
+     */
+    size_t howMany;
+
+    /**
+     * @brief Czy udało się dodać wszystkie numery.
+     */
+    bool success;
+};
+
+/**
+ * @brief Dolicza przekierowania z listy do liczby numerów.
+ * Używany w flatTreeForEachPrefix.
+ * @param[in] list - numer listy.
+ * @param[in] length - długość prefiksu numeru reprezentowanego przez węzeł.
+ * @param[in, out] reverseData - wskaźnik na struct MappedReverseData.
+ */
+static void phfwdMappedReverseCount(uint32_t list, size_t length,
+                                    void *reverseData) {
+    (void) length;
+    struct MappedReverseData *state = reverseData;
+    state->howMany += state->mapped->listStarts[list + 1]
+                      - state->mapped->listStarts[list];
+}
+
+/**
+ * @brief Dodaje do wyniku numery powstałe z odwrócenia przekierowań z listy.
+ * Używany w flatTreeForEachPrefix.
+ * @param[in] list - numer listy.
+ * @param[in] length - długość prefiksu numeru reprezentowanego przez węzeł.
+ * @param[in, out] reverseData - wskaźnik na struct MappedReverseData.
+ */
+static void phfwdMappedReverseAdd(uint32_t list, size_t length,
+                                  void *reverseData) {
+    struct MappedReverseData *state = reverseData;
+    uint32_t i;
+    for (i = state->mapped->listStarts[list];
+         i < state->mapped->listStarts[list + 1] && state->success; i++) {
+        ForwardData fd = phfwdCompiledRedirection(
+                state->compiled, state->mapped->listItems[i]);
+        state->success = phfwdNumbersAppend(state->result,
+                                            phfwdForwardDataSource(fd),
+                                            fd->sourceLength,
+                                            state->num + length);
+    }
+}
+
+/**
+ * @brief Pobiera numery dla phfwdReverse z odwzorowanej struktury.
+ * @see phfwdGetReverse
+ * @param[in] pf - wskaźnik na odwzorowaną strukturę.
+ * @param[in] num - wskaźnik na numer dla którego wykonujemy operację
+ *        odwrócenia przekierowania.
+ * @param[in, out] result - wskaźnik na pustą strukturę na numery.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
+ */
+static bool phfwdGetReverseMapped(struct PhoneForward *pf, const char *num,
+                                  struct PhoneNumbers *result) {
+    struct MappedReverseData reverseData;
+    reverseData.mapped = pf->mapped;
+    reverseData.compiled = atomic_load(&pf->compiled);
+    reverseData.num = num;
+    reverseData.result = result;
+    reverseData.howMany = 1;
+    reverseData.success = true;
+    flatTreeForEachPrefix(pf->mapped->backward, num, phfwdMappedReverseCount,
+                          &reverseData);
+
+    if (!phfwdNumbersReserve(result, reverseData.howMany, 0)) {
+        return false;
+    }
+    flatTreeForEachPrefix(pf->mapped->backward, num, phfwdMappedReverseAdd,
+                          &reverseData);
+    if (!reverseData.success
+        || !phfwdNumbersAppend(result, num, strlen(num), NULL)) {
+        return false;
     }
+    phfwdSortNumbers(result);
+    return true;
+}
 
+bool phfwdReverseReuse(struct PhoneForward *pf, const char *num,
+                       struct PhoneNumbers *pnum) {
+    phfwdNumbersClear(pnum);
+    if (!phfwdIsNumber(num)) {
+        return true;
+    }
 
+    bool result;
+    if (pf->mapped != NULL) {
+        result = phfwdGetReverseMapped(pf, num, pnum);
+    } else {
+        phfwdLockRead(pf);
+        result = phfwdGetReverse(pf->backward, num, pnum);
+        phfwdUnlock(pf);
+    }
+    if (!result) {
+        phfwdNumbersClear(pnum);
+    }
+    return result;
 }
 
 const struct PhoneNumbers *phfwdReverse(struct PhoneForward *pf,
                                         const char *num) {
-    if (!phfwdIsNumber(num)) {
-        return phfwdEmptySequenceResult();
+    struct PhoneNumbers *result = phnumNew();
+    if (result != NULL && !phfwdReverseReuse(pf, num, result)) {
+        phnumDelete(result);
+        return NULL;
+    }
+    return result;
+}
+
+/**
+ * @brief Kursor zwracający kolejne numery wyniku phfwdReverse.
+ * @see phfwdReverseOpen
+ */
+struct PhoneReverseCursor {
+    /**
+     * @brief Struktura, której blokada do czytania jest zajęta przez kursor
+     * (patrz phfwdLockRead), NULL jeżeli kursor nie korzysta ze struktury.
+     */
+    struct PhoneForward *pf;
+
+    /**
+     * @brief Wyznaczony od razu wynik phfwdReverse, NULL jeżeli numery są
+     * wyznaczane leniwie przez @p merge.
+     */
+    const struct PhoneNumbers *numbers;
+
+    /**
+     * @brief Numer następnego zwracanego elementu @p numbers.
+     */
+    size_t position;
+
+    /**
+     * @brief Stan scalania numerów.
+     */
+    struct ReverseMerge merge;
+
+    /**
+     * @brief Ostatnio zwrócony numer, NULL jeżeli nie zwrócono żadnego.
+     */
+    char *current;
+
+    /**
+     * @brief Rozmiar bufora @p current.
+     */
+    size_t currentCapacity;
+
+    /**
+     * @brief Kopia numeru, na który wskazują elementy @p merge.
+     */
+    char num[];
+};
+
+struct PhoneReverseCursor *phfwdReverseOpen(struct PhoneForward *pf,
+                                            const char *num) {
+    size_t length = phfwdIsNumber(num) ? strlen(num) : 0;
+    struct PhoneReverseCursor *cursor =
+            malloc(sizeof(struct PhoneReverseCursor) + length + 1);
+    if (cursor == NULL) {
+        return NULL;
+    }
+    cursor->pf = NULL;
+    cursor->numbers = NULL;
+    cursor->position = 0;
+    cursor->current = NULL;
+    cursor->currentCapacity = 0;
+
+    if (length == 0 || pf->mapped != NULL) {
+        cursor->numbers = phfwdReverse(pf, num);
+        if (cursor->numbers == NULL) {
+            free(cursor);
+            return NULL;
+        }
+        return cursor;
+    }
+
+    memcpy(cursor->num, num, length + 1);
+    RadixTreeNode ptr;
+    const char *matchedTxt;
+    phfwdLockRead(pf);
+    phfwdSetPointersForGettingText(pf->backward, cursor->num, &ptr,
+                                   &matchedTxt);
+    if (!phfwdReverseMergeStart(&cursor->merge, ptr, matchedTxt)) {
+        phfwdUnlock(pf);
+        free(cursor);
+        return NULL;
+    }
+    cursor->pf = pf;
+    return cursor;
+}
+
+bool phfwdReverseNext(struct PhoneReverseCursor *cursor,
+                      const char **number) {
+    if (cursor->numbers != NULL) {
+        *number = phnumGet(cursor->numbers, cursor->position);
+        if (*number != NULL) {
+            cursor->position++;
+        }
+        return true;
+    }
+
+    struct ReverseHeapItem item;
+    do {
+        if (!phfwdReverseMergeNext(&cursor->merge, &item)) {
+            return false;
+        }
+    } while (item.first != NULL && cursor->current != NULL
+             && phfwdReverseCompare(cursor->current, NULL,
+                                    item.first, item.second) == 0);
+
+    if (item.first == NULL) {
+        *number = NULL;
+        return true;
+    }
+
+    size_t firstLength = strlen(item.first);
+    size_t length = firstLength
+                    + (item.second == NULL ? 0 : strlen(item.second)) + 1;
+    if (length > cursor->currentCapacity) {
+        size_t capacity = MAX(length, 2 * cursor->currentCapacity);
+        char *current = realloc(cursor->current, capacity);
+        if (current == NULL) {
+            return false;
+        }
+        cursor->current = current;
+        cursor->currentCapacity = capacity;
+    }
+    memcpy(cursor->current, item.first, firstLength);
+    if (item.second == NULL) {
+        cursor->current[firstLength] = '\0';
     } else {
-        return phfwdGetReverse(pf->backward, num);
+        memcpy(cursor->current + firstLength, item.second,
+               length - firstLength);
+    }
+    *number = cursor->current;
+    return true;
+}
+
+void phfwdReverseClose(struct PhoneReverseCursor *cursor) {
+    if (cursor != NULL) {
+        if (cursor->numbers != NULL) {
+            phnumDelete(cursor->numbers);
+        } else {
+            phfwdReverseMergeFinish(&cursor->merge);
+            phfwdUnlock(cursor->pf);
+        }
+        free(cursor->current);
+        free(cursor);
     }
 }
 
@@ -819,10 +3988,18 @@ size_t phfwdNonTrivialCount(struct PhoneForward *pf, const char *set, size_t len
         if (howManyDigitsAvailable == 0) {
             return 0;
         } else {
-            return radixTreeNonTrivialCount(pf->backward,
-                                            len,
-                                            availableDigits,
-                                            howManyDigitsAvailable);
+            if (pf->mapped != NULL) {
+                return flatTreeNonTrivialCount(pf->mapped->backward, len,
+                                               availableDigits,
+                                               howManyDigitsAvailable);
+            }
+            phfwdLockRead(pf);
+            size_t result = radixTreeNonTrivialCount(pf->backward,
+                                                     len,
+                                                     availableDigits,
+                                                     howManyDigitsAvailable);
+            phfwdUnlock(pf);
+            return result;
         }
     }
 }
@@ -23,6 +23,11 @@ struct PhoneForward;
  */
 struct PhoneNumbers;
 
+/**
+ * Kursor zwracający kolejne numery wyniku @ref phfwdReverse.
+ */
+struct PhoneReverseCursor;
+
 /** @brief Tworzy nową strukturę.
  * Tworzy nową strukturę niezawierającą żadnych przekierowań.
  * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
@@ -30,6 +35,82 @@ struct PhoneNumbers;
  */
 struct PhoneForward *phfwdNew(void);
 
+/** @brief Tworzy nową strukturę do współbieżnego użytku.
+ * Tworzy nową strukturę niezawierającą żadnych przekierowań, której mogą
+ * jednocześnie używać różne wątki. Funkcje @ref phfwdGet, @ref phfwdGetInto
+ * i @ref phfwdGetMany nigdy nie czekają na inne wątki i mogą być wykonywane
+ * współbieżnie z modyfikacjami (każdy numer jest wyznaczany względem stanu
+ * sprzed albo po modyfikacji). @ref phfwdReverse
+ * i @ref phfwdNonTrivialCount mogą być wykonywane równolegle ze sobą,
+ * a @ref phfwdAdd i @ref phfwdRemove czekają na ich zakończenie i wykonują
+ * się na wyłączność. Struktura zwrócona przez @ref phfwdNew nie jest
+ * synchronizowana.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ *         zaalokować pamięci.
+ */
+struct PhoneForward *phfwdNewConcurrent(void);
+
+/** @brief Kompiluje strukturę do szybszego wyszukiwania.
+ * Tworzy zwartą postać przekierowań (węzły drzewa w jednej tablicy
+ * w kolejności przeszukiwania wszerz), z której korzystają funkcje
+ * @ref phfwdGet, @ref phfwdGetInto i @ref phfwdGetMany. Zwarta postać jest
+ * porzucana przy następnej zmianie przekierowań przez @ref phfwdAdd lub
+ * @ref phfwdRemove i aby z niej dalej korzystać należy ponownie wywołać tę
+ * funkcję. Dla struktury utworzonej przez @ref phfwdNew funkcję należy
+ * wywołać zanim struktura zostanie udostępniona innym wątkom.
+ * @param[in, out] pf – wskaźnik na strukturę przechowującą przekierowania
+ *                      numerów.
+ * @return Wartość @p true, jeśli zwarta postać została utworzona.
+ *         Wartość @p false, gdy @p pf ma wartość NULL lub nie udało się
+ *         zaalokować pamięci.
+ */
+bool phfwdCompile(struct PhoneForward *pf);
+
+/** @brief Zapisuje strukturę do pliku.
+ * Zapisuje przekierowania ze struktury @p pf do pliku @p filename w postaci
+ * binarnego obrazu, który może zostać odwzorowany w pamięci przez
+ * @ref phfwdLoadMapped. Obraz zależy od architektury komputera (kolejności
+ * bajtów i rozmiaru wskaźnika). W przypadku błędu plik jest usuwany.
+ * @param[in] pf       – wskaźnik na strukturę przechowującą przekierowania
+ *                       numerów;
+ * @param[in] filename – wskaźnik na napis reprezentujący nazwę pliku.
+ * @return Wartość @p true, jeśli obraz został zapisany.
+ *         Wartość @p false, gdy któryś z parametrów ma wartość NULL,
+ *         nie udało się zaalokować pamięci lub zapisać pliku.
+ */
+bool phfwdSave(struct PhoneForward *pf, const char *filename);
+
+/** @brief Wczytuje strukturę z pliku odwzorowanego w pamięci.
+ * Odwzorowuje w pamięci (tylko do odczytu) plik zapisany przez
+ * @ref phfwdSave i tworzy strukturę, która wykonuje zapytania bezpośrednio
+ * na odwzorowanym obrazie, bez odbudowywania drzew. Przy wczytaniu cały
+ * obraz jest jednokrotnie sprawdzany (sekcje, pozycje synów w drzewach,
+ * numery przekierowań i listy), więc uszkodzony plik jest odrzucany,
+ * a nie powoduje odczytu poza obrazem. Plik nie może być modyfikowany
+ * w trakcie używania struktury. Struktura jest tylko do odczytu:
+ * @ref phfwdAdd i @ref phfwdRemove nic nie zmieniają, a wiele wątków może
+ * jej jednocześnie używać bez blokad. Struktura musi być zwolniona za
+ * pomocą funkcji @ref phfwdDelete.
+ * @param[in] filename – wskaźnik na napis reprezentujący nazwę pliku.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy @p filename ma
+ *         wartość NULL, nie udało się odwzorować pliku, plik nie zawiera
+ *         poprawnego obrazu lub nie udało się zaalokować pamięci.
+ */
+struct PhoneForward *phfwdLoadMapped(const char *filename);
+
+/** @brief Wczytuje strukturę z pliku do modyfikacji.
+ * Tworzy nową strukturę (taką jak zwracana przez @ref phfwdNew) zawierającą
+ * przekierowania zapisane przez @ref phfwdSave w pliku @p filename.
+ * W przeciwieństwie do @ref phfwdLoadMapped odbudowuje drzewa, więc czas
+ * wczytania jest proporcjonalny do rozmiaru obrazu. Struktura musi być
+ * zwolniona za pomocą funkcji @ref phfwdDelete.
+ * @param[in] filename – wskaźnik na napis reprezentujący nazwę pliku.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy @p filename ma
+ *         wartość NULL, nie udało się odczytać pliku, plik nie zawiera
+ *         poprawnego obrazu lub nie udało się zaalokować pamięci.
+ */
+struct PhoneForward *phfwdLoad(const char *filename);
+
 /** @brief Usuwa strukturę.
  * Usuwa strukturę wskazywaną przez @p pf. Nic nie robi, jeśli wskaźnik ten ma
  * wartość NULL.
@@ -49,15 +130,57 @@ void phfwdDelete(struct PhoneForward *pf);
  *                   jest wykonywane przekierowanie.
  * @return Wartość @p true, jeśli przekierowanie zostało dodane.
  *         Wartość @p false, jeśli wystąpił błąd, np. podany napis nie
- *         reprezentuje numeru, oba podane numery są identyczne lub nie udało
- *         się zaalokować pamięci.
+ *         reprezentuje numeru, oba podane numery są identyczne, @p pf jest
+ *         tylko do odczytu lub nie udało się zaalokować pamięci.
  */
 bool phfwdAdd(struct PhoneForward *pf, const char *num1, const char *num2);
 
+/** @brief Dodaje wiele przekierowań.
+ * Działa jak wywołania @ref phfwdAdd(@p pf, @p pairs[2i], @p pairs[2i + 1])
+ * dla kolejnych i od 0 do @p n - 1 (przy powtórzonym prefiksie
+ * przekierowywanym obowiązuje ostatnie przekierowanie). Pary są sortowane,
+ * a jeśli @p pf nie zawiera żadnych przekierowań, drzewa struktury są
+ * budowane w jednym przejściu po posortowanych numerach, bez wyszukiwania
+ * i rozcinania krawędzi.
+ * @param[in, out] pf   – wskaźnik na strukturę przechowującą przekierowania numerów;
+ * @param[in] pairs – tablica 2 * @p n wskaźników na napisy: kolejno prefiks
+ *                    przekierowywany i prefiks, na który jest wykonywane
+ *                    przekierowanie;
+ * @param[in] n     – liczba przekierowań.
+ * @return Wartość @p true, jeśli przekierowania zostały dodane.
+ *         Wartość @p false, jeśli któraś z par nie jest poprawnym argumentem
+ *         @ref phfwdAdd lub @p pf jest tylko do odczytu (struktura nie
+ *         jest wtedy zmieniana) albo nie udało się zaalokować pamięci
+ *         (jeśli @p pf zawierała przekierowania, część par mogła zostać
+ *         dodana).
+ */
+bool phfwdBulkLoad(struct PhoneForward *pf, const char *const *pairs,
+                   size_t n);
+
+/** @brief Dodaje wiele przekierowań, korzystając z wielu wątków.
+ * Działa jak @ref phfwdBulkLoad. Jeśli @p pf nie zawiera żadnych
+ * przekierowań, pary są dzielone według pierwszej cyfry numeru, a każde
+ * z poddrzew odpowiadających kolejnym cyfrom jest budowane osobno
+ * (z własną pulą pamięci) przez jeden z co najwyżej @p threads wątków
+ * i dołączane do struktury po zbudowaniu wszystkich.
+ * @param[in, out] pf   – wskaźnik na strukturę przechowującą przekierowania numerów;
+ * @param[in] pairs   – tablica 2 * @p n wskaźników na napisy, jak
+ *                      w @ref phfwdBulkLoad;
+ * @param[in] n       – liczba przekierowań;
+ * @param[in] threads – największa liczba wątków (razem z wątkiem
+ *                      wywołującym), zero oznacza liczbę dostępnych
+ *                      procesorów.
+ * @return Wartość @p true, jeśli przekierowania zostały dodane, w przeciwnym
+ *         przypadku @p false (patrz @ref phfwdBulkLoad).
+ */
+bool phfwdBulkLoadParallel(struct PhoneForward *pf, const char *const *pairs,
+                           size_t n, size_t threads);
+
 /** @brief Usuwa przekierowania.
  * Usuwa wszystkie przekierowania, w których parametr @p num jest prefiksem
- * parametru @p num1 użytego przy dodawaniu. Jeśli nie ma takich przekierowań
- * lub napis nie reprezentuje numeru, nic nie robi.
+ * parametru @p num1 użytego przy dodawaniu. Jeśli nie ma takich przekierowań,
+ * napis nie reprezentuje numeru lub @p pf jest tylko do odczytu, nic nie
+ * robi.
  *
  * @param[in, out] pf  – wskaźnik na strukturę przechowującą przekierowania numerów;
  * @param[in] num – wskaźnik na napis reprezentujący prefiks numerów.
@@ -77,6 +200,62 @@ void phfwdRemove(struct PhoneForward *pf, const char *num);
  */
 const struct PhoneNumbers *phfwdGet(struct PhoneForward *pf, const char *num);
 
+/** @brief Wyznacza przekierowanie numeru do bufora.
+ * Działa jak @ref phfwdGet, ale nie przydziela pamięci: wynik (zakończony
+ * '\0') zapisuje do bufora @p buf o rozmiarze @p cap. Jeśli wynik nie
+ * mieści się w buforze, to zapisywany jest tylko pusty napis (o ile
+ * @p cap jest niezerowe). Wywołanie z @p buf równym NULL i @p cap równym
+ * zeru pozwala poznać długość wyniku.
+ * @param[in] pf  – wskaźnik na strukturę przechowującą przekierowania numerów;
+ * @param[in] num – wskaźnik na napis reprezentujący numer;
+ * @param[out] buf – wskaźnik na bufor na wynik;
+ * @param[in] cap – rozmiar bufora @p buf.
+ * @return Długość przekierowanego numeru (bez '\0'). Wartość zero, jeśli
+ *         @p pf ma wartość NULL lub podany napis nie reprezentuje numeru.
+ *         Wynik został zapisany do @p buf wtedy i tylko wtedy, gdy jest
+ *         niezerowy i mniejszy niż @p cap.
+ */
+size_t phfwdGetInto(struct PhoneForward *pf, const char *num,
+                    char *buf, size_t cap);
+
+/** @brief Wyznacza przekierowanie numeru do istniejącej struktury.
+ * Działa jak @ref phfwdGet, ale wynik zapisuje w strukturze @p pnum
+ * utworzonej przez @ref phnumNew, zastępując jej dotychczasową zawartość.
+ * Pamięć struktury jest używana ponownie, więc jeżeli wynik się w niej
+ * mieści, funkcja nie przydziela pamięci. Wcześniej pobrane z @p pnum
+ * wskaźniki na numery przestają być ważne.
+ * @param[in] pf       – wskaźnik na strukturę przechowującą przekierowania
+ *                       numerów;
+ * @param[in] num      – wskaźnik na napis reprezentujący numer;
+ * @param[in, out] pnum – wskaźnik na strukturę na wynik.
+ * @return Wartość @p true, jeśli wynik został zapisany. Wartość @p false,
+ *         gdy nie udało się zaalokować pamięci; @p pnum przechowuje wtedy
+ *         pusty ciąg.
+ */
+bool phfwdGetReuse(struct PhoneForward *pf, const char *num,
+                   struct PhoneNumbers *pnum);
+
+/** @brief Wyznacza przekierowania wielu numerów.
+ * Wyznacza przekierowanie każdego z numerów @p nums[0], ..., @p nums[n - 1]
+ * tak jak @ref phfwdGet. Numery są przetwarzane w porządku
+ * leksykograficznym, dzięki czemu wspólne prefiksy kolejnych numerów są
+ * wyszukiwane w drzewie tylko raz. Wynikowy ciąg ma @p n elementów, i-ty
+ * z nich jest przekierowaniem numeru @p nums[i] lub wartością NULL, jeśli
+ * @p nums[i] nie reprezentuje numeru. Ciąg może więc zawierać NULL przed
+ * ostatnim elementem i należy go przeglądać funkcją @ref phnumGet dla
+ * indeksów od 0 do @p n - 1, a nie do pierwszej wartości NULL. Wszystkie
+ * wynikowe numery znajdują się w jednym buforze. Alokuje strukturę
+ * @p PhoneNumbers, która musi być zwolniona za pomocą funkcji
+ * @ref phnumDelete.
+ * @param[in] pf   – wskaźnik na strukturę przechowującą przekierowania numerów;
+ * @param[in] nums – tablica wskaźników na napisy reprezentujące numery;
+ * @param[in] n    – liczba numerów.
+ * @return Wskaźnik na strukturę przechowującą ciąg numerów lub NULL, gdy nie
+ *         udało się zaalokować pamięci.
+ */
+const struct PhoneNumbers *phfwdGetMany(struct PhoneForward *pf,
+                                        const char *const *nums, size_t n);
+
 /** @brief Wyznacza przekierowania na dany numer.
  * Wyznacza wszystkie przekierowania na podany numer. Wynikowy ciąg zawiera też
  * dany numer. Wynikowe numery są posortowane leksykograficznie i nie mogą się
@@ -90,6 +269,73 @@ const struct PhoneNumbers *phfwdGet(struct PhoneForward *pf, const char *num);
  */
 const struct PhoneNumbers *phfwdReverse(struct PhoneForward *pf, const char *num);
 
+/** @brief Wyznacza przekierowania na dany numer do istniejącej struktury.
+ * Działa jak @ref phfwdReverse, ale wynik zapisuje w strukturze @p pnum
+ * utworzonej przez @ref phnumNew, zastępując jej dotychczasową zawartość.
+ * Pamięć struktury jest używana ponownie, więc jeżeli wynik się w niej
+ * mieści, funkcja nie przydziela pamięci (z wyjątkiem pomocniczego kopca
+ * scalanych ciągów numerów). Wcześniej pobrane z @p pnum wskaźniki na
+ * numery przestają być ważne.
+ * @param[in] pf       – wskaźnik na strukturę przechowującą przekierowania
+ *                       numerów;
+ * @param[in] num      – wskaźnik na napis reprezentujący numer;
+ * @param[in, out] pnum – wskaźnik na strukturę na wynik.
+ * @return Wartość @p true, jeśli wynik został zapisany. Wartość @p false,
+ *         gdy nie udało się zaalokować pamięci; @p pnum przechowuje wtedy
+ *         pusty ciąg.
+ */
+bool phfwdReverseReuse(struct PhoneForward *pf, const char *num,
+                       struct PhoneNumbers *pnum);
+
+/** @brief Rozpoczyna leniwe wyznaczanie przekierowań na dany numer.
+ * Tworzy kursor, który zwraca kolejno numery wyniku @ref phfwdReverse
+ * (posortowane leksykograficznie, bez powtórzeń), wyznaczając je dopiero
+ * przy pobraniu. Kursor nie przechowuje wszystkich numerów: zajmowana
+ * pamięć jest proporcjonalna do długości numeru @p num i liczby
+ * przekierowań na jego prefiksy, które nie zostały jeszcze uporządkowane
+ * (dla każdego prefiksu co najwyżej 32 lub 1/32 przekierowań na niego,
+ * zależnie od tego, która z tych wartości jest większa). Wyjątkiem jest
+ * struktura wczytana przez @ref phfwdLoadMapped, dla której wynik jest
+ * wyznaczany od razu. Do czasu zamknięcia kursora struktura @p pf nie może
+ * być modyfikowana; w przypadku struktury utworzonej przez
+ * @ref phfwdNewConcurrent kursor wstrzymuje modyfikacje innych wątków, więc
+ * wątek, który go otworzył, nie może jej modyfikować. Kursor musi być
+ * zamknięty za pomocą funkcji @ref phfwdReverseClose.
+ * @param[in] pf  – wskaźnik na strukturę przechowującą przekierowania numerów;
+ * @param[in] num – wskaźnik na napis reprezentujący numer.
+ * @return Wskaźnik na kursor lub NULL, gdy nie udało się zaalokować pamięci.
+ */
+struct PhoneReverseCursor *phfwdReverseOpen(struct PhoneForward *pf,
+                                            const char *num);
+
+/** @brief Pobiera kolejny numer z kursora.
+ * @param[in, out] cursor – wskaźnik na kursor;
+ * @param[out] number     – wskaźnik na kolejny numer, ważny do następnego
+ *                          wywołania funkcji dla @p cursor, lub NULL, gdy
+ *                          numery się skończyły.
+ * @return Wartość @p true, jeśli udało się pobrać numer lub numery się
+ *         skończyły. Wartość @p false, gdy nie udało się zaalokować
+ *         pamięci; kursor można wtedy jedynie zamknąć.
+ */
+bool phfwdReverseNext(struct PhoneReverseCursor *cursor, const char **number);
+
+/** @brief Zamyka kursor.
+ * Zamyka kursor wskazywany przez @p cursor. Nic nie robi, jeśli wskaźnik ten
+ * ma wartość NULL.
+ * @param[in] cursor – wskaźnik na zamykany kursor.
+ */
+void phfwdReverseClose(struct PhoneReverseCursor *cursor);
+
+/** @brief Tworzy pusty ciąg numerów.
+ * Tworzy strukturę @p PhoneNumbers przechowującą pusty ciąg, do której
+ * wielokrotnie można zapisywać wyniki funkcji @ref phfwdGetReuse
+ * i @ref phfwdReverseReuse. Wszystkie numery ciągu znajdują się w jednym
+ * buforze. Struktura musi być zwolniona za pomocą funkcji @ref phnumDelete.
+ * @return Wskaźnik na strukturę lub NULL, gdy nie udało się zaalokować
+ *         pamięci.
+ */
+struct PhoneNumbers *phnumNew(void);
+
 /** @brief Usuwa strukturę.
  * Usuwa strukturę wskazywaną przez @p pnum. Nic nie robi, jeśli wskaźnik ten ma
  * wartość NULL.
@@ -103,7 +349,9 @@ void phnumDelete(const struct PhoneNumbers *pnum);
  * @param[in] pnum – wskaźnik na strukturę przechowującą ciąg napisów;
  * @param[in] idx  – indeks napisu.
  * @return Wskaźnik na napis. Wartość NULL, jeśli wskaźnik @p pnum ma wartość
- *         NULL lub indeks ma za dużą wartość.
+ *         NULL, indeks ma za dużą wartość lub ciąg zwrócony przez
+ *         @ref phfwdGetMany nie zawiera napisu o tym indeksie (numer
+ *         wejściowy był niepoprawny).
  */
 const char *phnumGet(const struct PhoneNumbers *pnum, size_t idx);
 
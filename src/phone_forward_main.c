@@ -6,17 +6,24 @@
  * @date 25.05.2018
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "parser.h"
 #include "phone_bases_system.h"
 #include "vector.h"
 #include "input.h"
+#include "output.h"
 #include "character.h"
 #include "stdfunc.h"
+#include "wal.h"
+#include "worker_pool.h"
 
 /**
  * @brief Bazowy prefiks informacji o błędzie.
@@ -64,6 +71,64 @@
     (CONCAT(" ", PARSER_OPERATOR_NONTRIVIAL_STRING, " "))
 
 
+/**
+ * @brief Infiks informacji o błędzie dziennika operacji.
+ */
+#define WAL_ERROR_INFIX " WAL "
+
+/**
+ * @brief Najmniejsza liczba kolejnych operacji przekierowania, dla której
+ * są one dodawane przez wiele wątków (patrz phfwdBulkLoadParallel).
+ */
+#define PARALLEL_BULK_LOAD_MIN_REDIRECTS 4096
+
+/**
+ * @brief Argument programu wymuszający wypisywanie wyników po każdej linii
+ * (patrz outputSetLineFlush).
+ */
+#define LINE_FLUSH_OPTION "--line-buffered"
+
+/**
+ * @brief Prefiks argumentu programu podającego liczbę wątków wykonujących
+ * zapytania (0 oznacza liczbę dostępnych procesorów).
+ * @see initQueries
+ */
+#define THREADS_OPTION "--threads="
+
+/**
+ * @brief Największa liczba zapytań w jednej paczce.
+ * @see submitQuery
+ */
+#define QUERY_BATCH_SIZE 1024
+
+/**
+ * @brief Liczba wypisanych numerów, powyżej której zmniejszana jest
+ * liczba zapytań w paczce (ogranicza pamięć zajmowaną przez wyniki).
+ * @see printQueryBatch
+ */
+#define QUERY_BATCH_MAX_NUMBERS (1 << 20)
+
+/**
+ * @brief Zapytanie phfwdGet.
+ */
+#define QUERY_TYPE_GET 0
+
+/**
+ * @brief Zapytanie phfwdReverse.
+ */
+#define QUERY_TYPE_REVERSE 1
+
+/**
+ * @brief Zapytanie phfwdNonTrivialCount.
+ */
+#define QUERY_TYPE_NONTRIVIAL 2
+
+/**
+ * @brief Zapytanie phfwdReverse z PARSER_OPERATOR_LIMIT lub
+ * PARSER_OPERATOR_OFFSET, wykonywane kursorem phfwdReverseOpen.
+ */
+#define QUERY_TYPE_REVERSE_PAGE 3
+
 /**
  * @brief Kod błędu zwracany przez program.
  */
@@ -95,6 +160,19 @@ static Vector word1 = NULL;
  */
 static Vector word2 = NULL;
 
+/**
+ * @brief Numery z kolejnych operacji przekierowania, które nie zostały
+ * jeszcze wykonane.
+ * Każda operacja zajmuje dwa kolejne napisy zakończone '\0'.
+ * @see flushRedirects
+ */
+static Vector pendingRedirects = NULL;
+
+/**
+ * @brief Liczba operacji przekierowania w @ref pendingRedirects.
+ */
+static size_t howManyPendingRedirects = 0;
+
 /**
  * @brief Wskaźnik na aktualnie aktywną bazę przekierowań.
  * NULL w przypadku braku.
@@ -106,12 +184,423 @@ static struct PhoneForward *currentBase = NULL;
  */
 static struct Parser parser;
 
+/**
+ * @brief Wskaźnik na dziennik operacji modyfikujących bazy.
+ * NULL jeżeli program uruchomiono bez katalogu dziennika.
+ */
+static Wal wal = NULL;
+
+/**
+ * @brief Struktura opisująca zapytanie nie modyfikujące baz.
+ */
+struct Query {
+    /**
+     * @brief Rodzaj zapytania (QUERY_TYPE_*).
+     */
+    int type;
+
+    /**
+     * @brief Pozycja numeru w @ref QueryBatch::numbers.
+     */
+    size_t number;
+
+    /**
+     * @brief Długość numerów dla zapytania QUERY_TYPE_NONTRIVIAL.
+     */
+    size_t len;
+
+    /**
+     * @brief Liczba pomijanych początkowych numerów wyniku zapytania
+     * QUERY_TYPE_REVERSE_PAGE.
+     */
+    size_t offset;
+
+    /**
+     * @brief Największa liczba numerów wyniku zapytania
+     * QUERY_TYPE_REVERSE_PAGE.
+     */
+    size_t limit;
+
+    /**
+     * @brief Liczba wczytanych bajtów po wczytaniu zapytania
+     * (pozycja ewentualnego błędu).
+     */
+    size_t position;
+
+    /**
+     * @brief Struktura na wynik zapytania QUERY_TYPE_GET
+     * i QUERY_TYPE_REVERSE, używana ponownie przez kolejne zapytania
+     * (patrz phfwdGetReuse), NULL jeżeli nie została jeszcze utworzona.
+     */
+    struct PhoneNumbers *numbers;
+
+    /**
+     * @brief Czy wynik zapytania QUERY_TYPE_GET lub QUERY_TYPE_REVERSE
+     * został wyznaczony (false w przypadku problemów z pamięcią).
+     */
+    bool success;
+
+    /**
+     * @brief Wynik zapytania QUERY_TYPE_REVERSE_PAGE: numery, każdy
+     * zakończony '\0' (NULL w przypadku problemów z pamięcią).
+     */
+    Vector page;
+
+    /**
+     * @brief Wynik zapytania QUERY_TYPE_NONTRIVIAL.
+     */
+    size_t count;
+};
+
+/**
+ * @brief Struktura przechowująca paczkę kolejnych zapytań.
+ */
+struct QueryBatch {
+    /**
+     * @brief Zapytania (tablica QUERY_BATCH_SIZE elementów).
+     */
+    struct Query *queries;
+
+    /**
+     * @brief Liczba zapytań w paczce.
+     */
+    size_t howMany;
+
+    /**
+     * @brief Numery zapytań, każdy zakończony '\0'.
+     */
+    Vector numbers;
+};
+
+/**
+ * @brief Struktura na wyniki zapytań wykonywanych od razu po wczytaniu,
+ * NULL jeżeli nie została jeszcze utworzona.
+ * @see Query::numbers
+ */
+static struct PhoneNumbers *queryNumbers = NULL;
+
+/**
+ * @brief Pula wątków wykonujących zapytania.
+ * NULL jeżeli zapytania są wykonywane od razu po wczytaniu.
+ */
+static WorkerPool queryPool = NULL;
+
+/**
+ * @brief Paczki zapytań: jedna jest wypełniana, a druga może być
+ * w tym czasie wykonywana przez @ref queryPool.
+ */
+static struct QueryBatch queryBatches[2];
+
+/**
+ * @brief Indeks wypełnianej paczki w @ref queryBatches.
+ */
+static size_t fillingBatch = 0;
+
+/**
+ * @brief Czy druga paczka jest wykonywana przez @ref queryPool.
+ */
+static bool batchInFlight = false;
+
+/**
+ * @brief Liczba zapytań, po której wypełniana paczka jest zlecana.
+ * @see printQueryBatch
+ */
+static size_t queryBatchLimit = QUERY_BATCH_SIZE;
+
+/**
+ * @brief Wykonuje operacje przekierowania z @ref pendingRedirects.
+ * Przekierowania są dodawane do bieżącej bazy jednym wywołaniem
+ * phfwdBulkLoad (lub phfwdBulkLoadParallel dla co najmniej
+ * PARALLEL_BULK_LOAD_MIN_REDIRECTS przekierowań), a następnie zapisywane
+ * do dziennika.
+ * @return NULL w przypadku sukcesu, w przeciwnym przypadku infiks
+ *         informacji o błędzie.
+ */
+static const char *applyPendingRedirects() {
+    size_t howMany = howManyPendingRedirects;
+    howManyPendingRedirects = 0;
+    if (howMany == 0) {
+        return NULL;
+    }
+
+    const char **pairs = malloc(2 * howMany * sizeof(const char *));
+    if (pairs == NULL) {
+        vectorSoftClear(pendingRedirects);
+        return MEMORY_ERROR_INFIX;
+    }
+    const char *ptr = vectorBegin(pendingRedirects);
+    size_t i;
+    for (i = 0; i < 2 * howMany; i++) {
+        pairs[i] = ptr;
+        ptr += strlen(ptr) + 1;
+    }
+
+    const char *result = NULL;
+    bool added;
+    if (howMany >= PARALLEL_BULK_LOAD_MIN_REDIRECTS) {
+        added = phfwdBulkLoadParallel(currentBase, pairs, howMany, 0);
+    } else {
+        added = phfwdBulkLoad(currentBase, pairs, howMany);
+    }
+    if (!added) {
+        result = MEMORY_ERROR_INFIX;
+    } else if (wal != NULL) {
+        for (i = 0; i < howMany && result == NULL; i++) {
+            if (!walLogAdd(wal, pairs[2 * i], pairs[2 * i + 1])) {
+                result = WAL_ERROR_INFIX;
+            }
+        }
+    }
+
+    free(pairs);
+    vectorSoftClear(pendingRedirects);
+    return result;
+}
+
+/**
+ * @brief Wypisuje numery.
+ * @param[in] numbers - struktura przechowująca numery do wypisania.
+ */
+static void printNumbers(const struct PhoneNumbers *numbers) {
+    size_t i;
+    const char *number;
+    for (i = 0; (number = phnumGet(numbers, i)) != NULL; i++) {
+        outputAppendString(number);
+        outputEndLine();
+    }
+}
+
+/**
+ * @brief Wykonuje zapytanie QUERY_TYPE_REVERSE_PAGE na bieżącej bazie.
+ * Numery są pobierane kursorem phfwdReverseOpen, więc zapytanie zajmuje
+ * pamięć proporcjonalną do Query->limit, a nie do liczby wszystkich
+ * numerów wyniku.
+ * @param[in, out] query - wskaźnik na zapytanie, zapisywany jest w nim wynik.
+ * @param[in] number - numer zapytania.
+ */
+static void executeReversePage(struct Query *query, const char *number) {
+    struct PhoneReverseCursor *cursor = phfwdReverseOpen(currentBase, number);
+    Vector page = vectorCreate();
+    bool success = cursor != NULL && page != NULL;
+
+    size_t skipped = 0, taken = 0;
+    const char *found = "";
+    while (success && found != NULL && taken < query->limit) {
+        success = phfwdReverseNext(cursor, &found);
+        if (success && found != NULL) {
+            if (skipped < query->offset) {
+                skipped++;
+            } else {
+                success = vectorPushBackArray(page, found, strlen(found) + 1)
+                          == VECTOR_SUCCES;
+                taken++;
+            }
+        }
+    }
+
+    phfwdReverseClose(cursor);
+    if (!success && page != NULL) {
+        vectorDelete(page);
+        page = NULL;
+    }
+    query->page = page;
+}
+
+/**
+ * @brief Wykonuje zapytanie na bieżącej bazie.
+ * @param[in, out] query - wskaźnik na zapytanie, zapisywany jest w nim wynik.
+ * @param[in] number - numer zapytania.
+ */
+static void executeQuery(struct Query *query, const char *number) {
+    if (query->type == QUERY_TYPE_GET || query->type == QUERY_TYPE_REVERSE) {
+        if (query->numbers == NULL) {
+            query->numbers = phnumNew();
+        }
+        if (query->numbers == NULL) {
+            query->success = false;
+        } else if (query->type == QUERY_TYPE_GET) {
+            query->success = phfwdGetReuse(currentBase, number,
+                                           query->numbers);
+        } else {
+            query->success = phfwdReverseReuse(currentBase, number,
+                                               query->numbers);
+        }
+    } else if (query->type == QUERY_TYPE_REVERSE_PAGE) {
+        executeReversePage(query, number);
+    } else {
+        query->count = phfwdNonTrivialCount(currentBase, number, query->len);
+    }
+}
+
+/**
+ * @brief Wykonuje zapytanie z paczki.
+ * Używana jako zadanie @ref queryPool.
+ * @param[in] i - numer zapytania w paczce.
+ * @param[in, out] batch - wskaźnik na struct QueryBatch.
+ */
+static void runQuery(size_t i, void *batch) {
+    struct QueryBatch *queries = batch;
+    executeQuery(&queries->queries[i],
+                 vectorBegin(queries->numbers) + queries->queries[i].number);
+}
+
+/**
+ * @brief Wypisuje wynik zapytania i zwalnia go.
+ * Struktura Query::numbers nie jest zwalniana, aby kolejne zapytania mogły
+ * jej użyć ponownie.
+ * @param[in, out] query - wskaźnik na wykonane zapytanie.
+ * @param[in, out] lines - @p *lines jest zwiększane o liczbę wypisanych
+ *        linii.
+ * @return false jeżeli podczas wykonywania zapytania wystąpiły problemy
+ *         z pamięcią, true w przeciwnym przypadku.
+ */
+static bool printQuery(struct Query *query, size_t *lines) {
+    if (query->type == QUERY_TYPE_NONTRIVIAL) {
+        outputAppendSize(query->count);
+        outputEndLine();
+        (*lines)++;
+        return true;
+    } else if (query->type == QUERY_TYPE_REVERSE_PAGE) {
+        if (query->page == NULL) {
+            return false;
+        }
+        const char *number = vectorBegin(query->page);
+        while (number != vectorEnd(query->page)) {
+            outputAppendString(number);
+            outputEndLine();
+            (*lines)++;
+            number += strlen(number) + 1;
+        }
+        vectorDelete(query->page);
+        query->page = NULL;
+        return true;
+    } else if (!query->success) {
+        return false;
+    } else {
+        size_t i;
+        for (i = 0; phnumGet(query->numbers, i) != NULL; i++);
+        *lines += i;
+        printNumbers(query->numbers);
+        return true;
+    }
+}
+
+/**
+ * @brief Usuwa zapytania z paczki.
+ * @param[in, out] batch - wskaźnik na paczkę.
+ * @param[in] from - numer pierwszego zapytania, którego wynik należy
+ *        zwolnić (wyniki wcześniejszych zostały już zwolnione).
+ */
+static void clearQueryBatch(struct QueryBatch *batch, size_t from) {
+    size_t i;
+    for (i = from; i < batch->howMany; i++) {
+        if (batch->queries[i].page != NULL) {
+            vectorDelete(batch->queries[i].page);
+        }
+    }
+    batch->howMany = 0;
+    vectorSoftClear(batch->numbers);
+}
+
+/**
+ * @brief Wypisuje wyniki wykonanej paczki zapytań w kolejności wczytania.
+ * Dopasowuje @ref queryBatchLimit do liczby wypisanych numerów, aby
+ * ograniczyć pamięć zajmowaną przez wyniki oczekujące na wypisanie.
+ * @param[in, out] batch - wskaźnik na paczkę, po wykonaniu jest pusta.
+ * @param[out] failedPosition - w przypadku niepowodzenia pozycja błędu.
+ * @return true w przypadku sukcesu, false jeżeli wykonanie któregoś
+ *         zapytania nie powiodło się (wcześniejsze wyniki są wypisane).
+ */
+static bool printQueryBatch(struct QueryBatch *batch,
+                            size_t *failedPosition) {
+    size_t lines = 0;
+    size_t i;
+    for (i = 0; i < batch->howMany; i++) {
+        if (!printQuery(&batch->queries[i], &lines)) {
+            *failedPosition = batch->queries[i].position;
+            clearQueryBatch(batch, i + 1);
+            return false;
+        }
+    }
+    clearQueryBatch(batch, batch->howMany);
+
+    if (lines > QUERY_BATCH_MAX_NUMBERS) {
+        queryBatchLimit = MAX(queryBatchLimit / 2, (size_t) 1);
+    } else if (lines < QUERY_BATCH_MAX_NUMBERS / 2) {
+        queryBatchLimit = MIN(queryBatchLimit * 2, (size_t) QUERY_BATCH_SIZE);
+    }
+    return true;
+}
+
+/**
+ * @brief Czeka na wykonanie paczki zleconej @ref queryPool i wypisuje ją.
+ * @param[out] failedPosition - w przypadku niepowodzenia pozycja błędu.
+ * @return true w przypadku sukcesu (lub braku zleconej paczki), false jeżeli
+ *         wykonanie któregoś zapytania nie powiodło się.
+ */
+static bool finishBatchInFlight(size_t *failedPosition) {
+    if (!batchInFlight) {
+        return true;
+    }
+    workerPoolWait(queryPool);
+    batchInFlight = false;
+    return printQueryBatch(&queryBatches[1 - fillingBatch], failedPosition);
+}
+
+/**
+ * @brief Wykonuje i wypisuje wszystkie wczytane zapytania.
+ * Po wykonaniu żadne zapytanie nie jest wykonywane przez @ref queryPool,
+ * więc bazy mogą być modyfikowane.
+ * @param[out] failedPosition - w przypadku niepowodzenia pozycja błędu.
+ * @return true w przypadku sukcesu, false jeżeli wykonanie któregoś
+ *         zapytania nie powiodło się (pozostałe zapytania są porzucane).
+ */
+static bool drainQueries(size_t *failedPosition) {
+    if (queryPool == NULL) {
+        return true;
+    }
+
+    struct QueryBatch *filling = &queryBatches[fillingBatch];
+    if (!finishBatchInFlight(failedPosition)) {
+        clearQueryBatch(filling, 0);
+        return false;
+    }
+    if (filling->howMany == 0) {
+        return true;
+    }
+    workerPoolStart(queryPool, runQuery, filling, filling->howMany);
+    workerPoolWait(queryPool);
+    return printQueryBatch(filling, failedPosition);
+}
+
 /**
  * @brief Kończy program.
- * Zwalnia pamięć i kończy program kodem @p exit_code.
+ * Wykonuje oczekujące zapytania i operacje przekierowania, zwalnia pamięć
+ * i kończy program kodem @p exit_code.
  * @param[in] exit_code - kod zakończenia programu.
  */
 static void exit_and_clean(int exit_code) {
+    size_t failedPosition;
+    if (!drainQueries(&failedPosition) && exit_code == SUCCESS_EXIT_CODE) {
+        fprintf(stderr, "%s%s%zu\n", BASIC_ERROR_MESSAGE, MEMORY_ERROR_INFIX,
+                failedPosition);
+        exit_code = ERROR_EXIT_CODE;
+    }
+    outputFlush();
+
+    const char *infix = applyPendingRedirects();
+    if (infix != NULL && exit_code == SUCCESS_EXIT_CODE) {
+        fprintf(stderr, "%s%s%zu\n", BASIC_ERROR_MESSAGE, infix,
+                parserGetReadBytes(&parser));
+        exit_code = ERROR_EXIT_CODE;
+    }
+
+    if (!walClose(wal) && exit_code == SUCCESS_EXIT_CODE) {
+        fprintf(stderr, "%s%s%zu\n", BASIC_ERROR_MESSAGE, WAL_ERROR_INFIX,
+                parserGetReadBytes(&parser));
+        exit_code = ERROR_EXIT_CODE;
+    }
+    wal = NULL;
 
     if (bases != NULL) {
         phoneBasesDestroyPhoneBases(bases);
@@ -125,16 +614,42 @@ static void exit_and_clean(int exit_code) {
         vectorDelete(word2);
     }
 
+    if (pendingRedirects != NULL) {
+        vectorDelete(pendingRedirects);
+    }
+
+    workerPoolDelete(queryPool);
+    phnumDelete(queryNumbers);
+    size_t i, j;
+    for (i = 0; i < 2; i++) {
+        if (queryBatches[i].queries != NULL) {
+            for (j = 0; j < QUERY_BATCH_SIZE; j++) {
+                phnumDelete(queryBatches[i].queries[j].numbers);
+            }
+        }
+        free(queryBatches[i].queries);
+        if (queryBatches[i].numbers != NULL) {
+            vectorDelete(queryBatches[i].numbers);
+        }
+    }
+
 
     exit(exit_code);
 }
 
 /**
  * @brief Wypisuje informację o błędzie.
+ * Najpierw wykonuje wczytane wcześniej zapytania. Jeżeli któreś z nich
+ * nie powiodło się, wypisuje informację o tym błędzie.
  * @param[in] infix - infiks informacji
  * @param[in] bytes - liczba wczytanych bajtów.
  */
 static void printErrorMessage(const char *infix, size_t bytes) {
+    size_t failedPosition;
+    if (!drainQueries(&failedPosition)) {
+        infix = MEMORY_ERROR_INFIX;
+        bytes = failedPosition;
+    }
     fprintf(stderr, "%s%s%zu\n", BASIC_ERROR_MESSAGE, infix,
             bytes);
 }
@@ -143,7 +658,13 @@ static void printErrorMessage(const char *infix, size_t bytes) {
  * @brief Wypisuje informacje o błędzie związanym z nieoczekiwanym końcem pliku.
  */
 static void printEofError() {
-    fprintf(stderr, "%s%s\n", BASIC_ERROR_MESSAGE, EOF_ERROR_SUFFIX);
+    size_t failedPosition;
+    if (!drainQueries(&failedPosition)) {
+        fprintf(stderr, "%s%s%zu\n", BASIC_ERROR_MESSAGE, MEMORY_ERROR_INFIX,
+                failedPosition);
+    } else {
+        fprintf(stderr, "%s%s\n", BASIC_ERROR_MESSAGE, EOF_ERROR_SUFFIX);
+    }
 }
 
 /**
@@ -153,6 +674,7 @@ static void printEofError() {
  * @ref bases
  * @ref word1
  * @ref word2
+ * @ref pendingRedirects
  * w przypadku problemów z pamięcią kończy program
  * i wypisuje informacje o błędzie.
  */
@@ -177,6 +699,150 @@ static void initProgram() {
         printErrorMessage(MEMORY_ERROR_INFIX, parserGetReadBytes(&parser));
         exit_and_clean(ERROR_EXIT_CODE);
     }
+
+    pendingRedirects = vectorCreate();
+
+    if (pendingRedirects == NULL) {
+        printErrorMessage(MEMORY_ERROR_INFIX, parserGetReadBytes(&parser));
+        exit_and_clean(ERROR_EXIT_CODE);
+    }
+}
+
+/**
+ * @brief Inicjuje dziennik operacji i odtwarza z niego stan baz.
+ * Argumenty programu: katalog dziennika, liczba zapisów utrwalanych razem
+ * (domyślnie WAL_DEFAULT_SYNC_EVERY) i liczba zapisów między punktami
+ * kontrolnymi (domyślnie WAL_DEFAULT_CHECKPOINT_EVERY). Bez argumentów
+ * dziennik nie jest prowadzony. W przypadku problemów wypisuje informację
+ * o błędzie i kończy program.
+ * @param[in] argc - liczba argumentów programu.
+ * @param[in] argv - argumenty programu.
+ */
+static void initWal(int argc, char **argv) {
+    if (argc < 2) {
+        return;
+    }
+
+    size_t syncEvery = WAL_DEFAULT_SYNC_EVERY;
+    size_t checkpointEvery = WAL_DEFAULT_CHECKPOINT_EVERY;
+    if (argc > 2) {
+        syncEvery = (size_t) strtoul(argv[2], NULL, 10);
+    }
+    if (argc > 3) {
+        checkpointEvery = (size_t) strtoul(argv[3], NULL, 10);
+    }
+
+    wal = walCreate(argv[1], syncEvery, checkpointEvery);
+    if (wal == NULL || !walRecover(wal, bases, &currentBase)) {
+        printErrorMessage(WAL_ERROR_INFIX, parserGetReadBytes(&parser));
+        exit_and_clean(ERROR_EXIT_CODE);
+    }
+}
+
+/**
+ * @brief Inicjuje wykonywanie zapytań przez wiele wątków.
+ * Dla @p threads różnego od 1 tworzy @ref queryPool i paczki zapytań.
+ * Jeżeli nie uda się utworzyć wątków, zapytania są wykonywane od razu
+ * po wczytaniu. W przypadku problemów z pamięcią kończy program
+ * i wypisuje informacje o błędzie.
+ * @param[in] threads - liczba wątków wykonujących zapytania (razem
+ *        z wątkiem głównym), 0 oznacza liczbę dostępnych procesorów.
+ */
+static void initQueries(size_t threads) {
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (size_t) online : 1;
+    }
+    if (threads <= 1) {
+        return;
+    }
+
+    size_t i, j;
+    for (i = 0; i < 2; i++) {
+        queryBatches[i].queries = malloc(QUERY_BATCH_SIZE
+                                         * sizeof(struct Query));
+        if (queryBatches[i].queries != NULL) {
+            for (j = 0; j < QUERY_BATCH_SIZE; j++) {
+                queryBatches[i].queries[j].numbers = NULL;
+            }
+        }
+        queryBatches[i].howMany = 0;
+        queryBatches[i].numbers = vectorCreate();
+        if (queryBatches[i].queries == NULL
+            || queryBatches[i].numbers == NULL) {
+            printErrorMessage(MEMORY_ERROR_INFIX, parserGetReadBytes(&parser));
+            exit_and_clean(ERROR_EXIT_CODE);
+        }
+    }
+
+    queryPool = workerPoolCreate(threads - 1);
+}
+
+/**
+ * @brief Sprawdza wynik zapisu operacji do dziennika.
+ * Jeżeli nadszedł czas, tworzy punkt kontrolny. W przypadku problemów
+ * wypisuje informację o błędzie i kończy program.
+ * @param[in] logged - wynik funkcji zapisującej operację.
+ */
+static void checkWalLogged(bool logged) {
+    if (!logged
+        || (walCheckpointDue(wal)
+            && !walCheckpoint(wal, bases, currentBase))) {
+        printErrorMessage(WAL_ERROR_INFIX, parserGetReadBytes(&parser));
+        exit_and_clean(ERROR_EXIT_CODE);
+    }
+}
+
+/**
+ * @brief Wykonuje i wypisuje wszystkie wczytane zapytania.
+ * Wywoływana przed każdą modyfikacją baz. W przypadku problemów wypisuje
+ * informację o błędzie i kończy program.
+ */
+static void finishQueries() {
+    size_t failedPosition;
+    if (!drainQueries(&failedPosition)) {
+        printErrorMessage(MEMORY_ERROR_INFIX, failedPosition);
+        exit_and_clean(ERROR_EXIT_CODE);
+    }
+}
+
+/**
+ * @brief Wykonuje oczekujące operacje przekierowania.
+ * Wywoływana przed każdą operacją inną niż przekierowanie, więc kolejne
+ * przekierowania są dodawane razem. Wcześniej wykonuje wczytane zapytania.
+ * W przypadku problemów wypisuje informację o błędzie i kończy program.
+ */
+static void flushRedirects() {
+    if (howManyPendingRedirects == 0) {
+        return;
+    }
+
+    finishQueries();
+
+    const char *infix = applyPendingRedirects();
+    if (infix != NULL) {
+        printErrorMessage(infix, parserGetReadBytes(&parser));
+        exit_and_clean(ERROR_EXIT_CODE);
+    }
+    if (wal != NULL) {
+        checkWalLogged(true);
+    }
+}
+
+/**
+ * @brief Dopisuje numer do @ref pendingRedirects.
+ * W przypadku problemów z pamięcią kończy program
+ * i wypisuje informacje o błędzie.
+ * @param[in] v - Vector z numerem zakończonym '\0'.
+ */
+static void appendPendingRedirect(Vector v) {
+    size_t size = vectorSize(pendingRedirects);
+    if (!vectorSoftResize(pendingRedirects, size + vectorSize(v))) {
+        printErrorMessage(MEMORY_ERROR_INFIX, parserGetReadBytes(&parser));
+        exit_and_clean(ERROR_EXIT_CODE);
+    }
+    memcpy(vectorBegin(pendingRedirects) + size, vectorBegin(v),
+           vectorSize(v));
 }
 
 /**
@@ -192,6 +858,70 @@ static void makeVectorCStringCompatible(Vector v) {
     }
 }
 
+/**
+ * @brief Zleca zapytanie.
+ * Bez @ref queryPool wykonuje zapytanie i wypisuje wynik od razu,
+ * w przeciwnym przypadku dodaje je do wypełnianej paczki. Zapełniona paczka
+ * jest zlecana @ref queryPool po wypisaniu wyników poprzedniej paczki,
+ * a kolejna paczka jest wypełniana w czasie jej wykonywania.
+ * W przypadku problemów wypisuje informację o błędzie i kończy program.
+ * @param[in] type - rodzaj zapytania (QUERY_TYPE_*).
+ * @param[in] number - Vector z numerem zakończonym '\0'.
+ * @param[in] len - długość numerów dla zapytania QUERY_TYPE_NONTRIVIAL.
+ * @param[in] offset - liczba pomijanych numerów dla zapytania
+ *        QUERY_TYPE_REVERSE_PAGE.
+ * @param[in] limit - największa liczba numerów dla zapytania
+ *        QUERY_TYPE_REVERSE_PAGE.
+ */
+static void submitQuery(int type, Vector number, size_t len, size_t offset,
+                        size_t limit) {
+    struct Query query;
+    query.type = type;
+    query.len = len;
+    query.offset = offset;
+    query.limit = limit;
+    query.position = parserGetReadBytes(&parser);
+    query.numbers = NULL;
+    query.success = false;
+    query.page = NULL;
+    query.count = 0;
+
+    if (queryPool == NULL) {
+        size_t lines = 0;
+        query.numbers = queryNumbers;
+        executeQuery(&query, vectorBegin(number));
+        queryNumbers = query.numbers;
+        if (!printQuery(&query, &lines)) {
+            printErrorMessage(MEMORY_ERROR_INFIX, query.position);
+            exit_and_clean(ERROR_EXIT_CODE);
+        }
+        return;
+    }
+
+    struct QueryBatch *batch = &queryBatches[fillingBatch];
+    query.number = vectorSize(batch->numbers);
+    if (vectorPushBackArray(batch->numbers, vectorBegin(number),
+                            vectorSize(number)) != VECTOR_SUCCES) {
+        printErrorMessage(MEMORY_ERROR_INFIX, query.position);
+        exit_and_clean(ERROR_EXIT_CODE);
+    }
+    query.numbers = batch->queries[batch->howMany].numbers;
+    batch->queries[batch->howMany] = query;
+    batch->howMany++;
+
+    if (batch->howMany >= queryBatchLimit) {
+        size_t failedPosition;
+        if (!finishBatchInFlight(&failedPosition)) {
+            clearQueryBatch(batch, 0);
+            printErrorMessage(MEMORY_ERROR_INFIX, failedPosition);
+            exit_and_clean(ERROR_EXIT_CODE);
+        }
+        workerPoolStart(queryPool, runQuery, batch, batch->howMany);
+        batchInFlight = true;
+        fillingBatch = 1 - fillingBatch;
+    }
+}
+
 /**
  * @brief Czyści Vectory @p word1 @p word2.
  */
@@ -256,6 +986,8 @@ static void skipSkipable() {
  * i kończy program.
  */
 static void readOperationNew() {
+    finishQueries();
+    flushRedirects();
     skipSkipable();
     checkEofError();
 
@@ -295,6 +1027,9 @@ static void readOperationNew() {
         exit_and_clean(ERROR_EXIT_CODE);
     }
 
+    if (wal != NULL) {
+        checkWalLogged(walLogNewBase(wal, vectorBegin(word1)));
+    }
 }
 
 /**
@@ -319,6 +1054,10 @@ static void readOperationDeleteNumber(size_t operatorPos) {
 
     makeVectorCStringCompatible(word1);
     phfwdRemove(currentBase, vectorBegin(word1));
+
+    if (wal != NULL) {
+        checkWalLogged(walLogRemove(wal, vectorBegin(word1)));
+    }
 }
 
 /**
@@ -358,6 +1097,9 @@ static void readOperationDeleteBase(size_t operatorPos) {
 
     phoneBasesDelBase(bases, vectorBegin(word1));
 
+    if (wal != NULL) {
+        checkWalLogged(walLogDelBase(wal, vectorBegin(word1)));
+    }
 }
 
 /**
@@ -367,6 +1109,8 @@ static void readOperationDeleteBase(size_t operatorPos) {
 static void readOperationDelete() {
     size_t operatorPos =
             parserGetReadBytes(&parser) - strlen(PARSER_OPERATOR_DELETE) + 1;
+    finishQueries();
+    flushRedirects();
     skipSkipable();
     checkEofError();
 
@@ -385,22 +1129,124 @@ static void readOperationDelete() {
 }
 
 /**
- * @brief Wypisuje numery.
- * @param[in] numbers - struktura przechowująca numery do wypisania.
+ * @brief Pozycja błędu oznaczająca nieoczekiwany koniec wejścia.
+ * @see readReversePage
  */
-static void printNumbers(const struct PhoneNumbers *numbers) {
-    size_t i;
-    for (i = 0; phnumGet(numbers, i) != NULL; i++) {
-        fprintf(stdout, "%s\n", phnumGet(numbers, i));
+#define PAGE_EOF_ERROR SIZE_MAX
+
+/**
+ * @brief Wczytuje liczbę występującą po PARSER_OPERATOR_LIMIT lub
+ * PARSER_OPERATOR_OFFSET.
+ * Liczba składa się z cyfr dziesiętnych, wartości większe od SIZE_MAX są
+ * zastępowane przez SIZE_MAX. Błędy składni nie kończą programu, tylko są
+ * zwracane, aby zapytanie zostało wykonane przed ich zgłoszeniem.
+ * W przypadku problemów z pamięcią wypisuje informację o błędzie i kończy
+ * program.
+ * @param[out] number - wczytana liczba.
+ * @return 0 w przypadku sukcesu, w przeciwnym przypadku pozycja błędu
+ *         (PAGE_EOF_ERROR dla nieoczekiwanego końca wejścia).
+ */
+static size_t readPageNumber(size_t *number) {
+    parserSkipSkipable(&parser);
+    if (parserIsCommentEofError(&parser) || inputIsEOF()) {
+        return PAGE_EOF_ERROR;
+    } else if (parserError(&parser)) {
+        return parserGetReadBytes(&parser);
+    }
+
+    int nextType = parserNextType(&parser);
+    if (parserError(&parser)) {
+        return parserGetReadBytes(&parser);
+    } else if (nextType != PARSER_ELEMENT_TYPE_NUMBER) {
+        return parserGetReadBytes(&parser) + 1;
     }
+
+    size_t position = parserGetReadBytes(&parser) + 1;
+    vectorSoftClear(word2);
+    if (!parserReadNumber(&parser, word2)) {
+        printErrorMessage(MEMORY_ERROR_INFIX, parserGetReadBytes(&parser));
+        exit_and_clean(ERROR_EXIT_CODE);
+    }
+    if (parserError(&parser)) {
+        return parserGetReadBytes(&parser);
+    }
+
+    size_t result = 0, i;
+    for (i = 0; i < vectorSize(word2); i++) {
+        char digit = vectorBegin(word2)[i];
+        if (digit < '0' || digit > '9') {
+            return position + i;
+        }
+        if (result > (SIZE_MAX - (size_t) (digit - '0')) / 10) {
+            result = SIZE_MAX;
+        } else {
+            result = result * 10 + (size_t) (digit - '0');
+        }
+    }
+    *number = result;
+    return 0;
+}
+
+/**
+ * @brief Wczytuje opcjonalne PARSER_OPERATOR_LIMIT i PARSER_OPERATOR_OFFSET
+ * (w tej kolejności) występujące po numerze operacji phfwdReverse.
+ * Błędy składni (w tym słowa jedynie zaczynające się tak jak operator)
+ * nie kończą programu: @p offset i @p limit opisują wtedy poprawnie
+ * wczytaną część, a błąd jest zgłaszany dopiero po wykonaniu zapytania.
+ * Błędy pomijania komentarzy przed operatorami pozostają w @ref parser.
+ * @param[out] offset - liczba pomijanych numerów wyniku.
+ * @param[out] limit - największa liczba numerów wyniku.
+ * @param[out] errorPosition - 0 jeżeli nie wystąpił błąd, w przeciwnym
+ *        przypadku pozycja błędu (PAGE_EOF_ERROR dla nieoczekiwanego końca
+ *        wejścia).
+ * @return true jeżeli wczytano któryś z operatorów razem z liczbą, false
+ *         w przeciwnym przypadku.
+ */
+static bool readReversePage(size_t *offset, size_t *limit,
+                            size_t *errorPosition) {
+    bool result = false;
+    *errorPosition = 0;
+    parserSkipSkipable(&parser);
+    if (parserNextWordOperator(&parser) == PARSER_ELEMENT_TYPE_OPERATOR_LIMIT) {
+        if (parserReadOperator(&parser) == PARSER_FAIL) {
+            *errorPosition = parserGetReadBytes(&parser);
+            return result;
+        }
+        *errorPosition = readPageNumber(limit);
+        if (*errorPosition != 0) {
+            return result;
+        }
+        result = true;
+        parserSkipSkipable(&parser);
+    }
+    if (parserNextWordOperator(&parser)
+        == PARSER_ELEMENT_TYPE_OPERATOR_OFFSET) {
+        size_t number;
+        if (parserReadOperator(&parser) == PARSER_FAIL) {
+            *errorPosition = parserGetReadBytes(&parser);
+            return result;
+        }
+        *errorPosition = readPageNumber(&number);
+        if (*errorPosition != 0) {
+            return result;
+        }
+        *offset = number;
+        result = true;
+    }
+    return result;
 }
 
 /**
  * @brief Obsługuje operację phwfdReverse.
- * Oczekuje, że poprzednio wczytano PARSER_OPERATOR_QM.
+ * Oczekuje, że poprzednio wczytano PARSER_OPERATOR_QM. Po numerze mogą
+ * wystąpić PARSER_OPERATOR_LIMIT z liczbą i PARSER_OPERATOR_OFFSET z liczbą,
+ * ograniczające wynik do numerów od pozycji OFFSET (liczonej od zera),
+ * nie więcej niż LIMIT. Błąd w tych operatorach jest zgłaszany po wypisaniu
+ * wyniku poprawnie wczytanej części zapytania.
  */
 static void readOperationReverse() {
     size_t operatorPos = parserGetReadBytes(&parser);
+    flushRedirects();
     skipSkipable();
     checkEofError();
 
@@ -420,18 +1266,21 @@ static void readOperationReverse() {
             exit_and_clean(ERROR_EXIT_CODE);
         }
         makeVectorCStringCompatible(word1);
-        const struct PhoneNumbers *numbers
-                = phfwdReverse(currentBase, vectorBegin(word1));
 
-        if (numbers == NULL) {
-            printErrorMessage(MEMORY_ERROR_INFIX, parserGetReadBytes(&parser));
-            exit_and_clean(ERROR_EXIT_CODE);
+        size_t offset = 0, limit = SIZE_MAX, errorPosition;
+        if (readReversePage(&offset, &limit, &errorPosition)) {
+            submitQuery(QUERY_TYPE_REVERSE_PAGE, word1, 0, offset, limit);
+        } else {
+            submitQuery(QUERY_TYPE_REVERSE, word1, 0, 0, SIZE_MAX);
         }
 
-        printNumbers(numbers);
-
-        phnumDelete(numbers);
-
+        if (errorPosition == PAGE_EOF_ERROR) {
+            printEofError();
+            exit_and_clean(ERROR_EXIT_CODE);
+        } else if (errorPosition != 0) {
+            printErrorMessage(BASIC_ERROR_INFIX, errorPosition);
+            exit_and_clean(ERROR_EXIT_CODE);
+        }
 
     } else {
         printErrorMessage(BASIC_ERROR_INFIX, parserGetReadBytes(&parser) + 1);
@@ -446,6 +1295,7 @@ static void readOperationReverse() {
  */
 static void readOperationNonTrivial() {
     size_t operatorPos = parserGetReadBytes(&parser);
+    flushRedirects();
     skipSkipable();
     checkEofError();
 
@@ -471,9 +1321,7 @@ static void readOperationNonTrivial() {
             len -= 12;
         }
         makeVectorCStringCompatible(word1);
-        size_t result = phfwdNonTrivialCount(currentBase, vectorBegin(word1), len);
-
-        fprintf(stdout, "%zu\n", result);
+        submitQuery(QUERY_TYPE_NONTRIVIAL, word1, len, 0, SIZE_MAX);
 
 
     } else {
@@ -487,6 +1335,7 @@ static void readOperationNonTrivial() {
  * @brief Obsługuje operację phfwdGet(word1).
  */
 static void readOperatorGetFromWord1() {
+    flushRedirects();
     makeVectorCStringCompatible(word1);
 
     if (currentBase == NULL) {
@@ -494,23 +1343,15 @@ static void readOperatorGetFromWord1() {
         exit_and_clean(ERROR_EXIT_CODE);
     }
 
-    const struct PhoneNumbers *numbers = phfwdGet(currentBase, vectorBegin(word1));
-
-    if (numbers == NULL) {
-        printErrorMessage(MEMORY_ERROR_INFIX, parserGetReadBytes(&parser));
-        exit_and_clean(ERROR_EXIT_CODE);
-    }
-
-    printNumbers(numbers);
-
-    phnumDelete(numbers);
+    submitQuery(QUERY_TYPE_GET, word1, 0, 0, SIZE_MAX);
 
 }
 
 /**
  * @brief Obsługuje operację przekierowania numerów word1 > word2.
  * Oczekuje wczytania pierwszego numeru do word1
- * i wczytania operatora przekierowania.
+ * i wczytania operatora przekierowania. Przekierowanie nie jest dodawane
+ * od razu, tylko trafia do @ref pendingRedirects.
  */
 static void readOperatorRedirectWord1() {
     size_t operatorPos = parserGetReadBytes(&parser);
@@ -543,10 +1384,9 @@ static void readOperatorRedirectWord1() {
         exit_and_clean(ERROR_EXIT_CODE);
     }
 
-    if (!phfwdAdd(currentBase, vectorBegin(word1), vectorBegin(word2))) {
-        printErrorMessage(MEMORY_ERROR_INFIX, parserGetReadBytes(&parser));
-        exit_and_clean(ERROR_EXIT_CODE);
-    }
+    appendPendingRedirect(word1);
+    appendPendingRedirect(word2);
+    howManyPendingRedirects++;
 }
 
 /**
@@ -556,6 +1396,7 @@ static void readOperatorRedirectWord1() {
  */
 static void readOperation(int nextType) {
     if (nextType == PARSER_ELEMENT_TYPE_WORD) {
+        size_t wordPos = parserGetReadBytes(&parser) + 1;
         int operator = parserReadOperator(&parser);
         checkParserError();
         checkEofError();
@@ -565,7 +1406,7 @@ static void readOperation(int nextType) {
         } else if (operator == PARSER_ELEMENT_TYPE_OPERATOR_DELETE) {
             readOperationDelete();
         } else {
-            printErrorMessage(BASIC_ERROR_INFIX, parserGetReadBytes(&parser));
+            printErrorMessage(BASIC_ERROR_INFIX, wordPos);
             exit_and_clean(ERROR_EXIT_CODE);
         }
 
@@ -628,10 +1469,31 @@ static void readOperation(int nextType) {
 
 /**
  * @brief Główna pętla programu.
+ * @param[in] argc - liczba argumentów programu.
+ * @param[in] argv - argumenty programu: opcjonalnie LINE_FLUSH_OPTION
+ *        i THREADS_OPTION z liczbą wątków, a następnie argumenty dziennika
+ *        (patrz @ref initWal).
  * @return
  */
-int main() {
+int main(int argc, char **argv) {
+    size_t threads = 1;
+    while (argc > 1) {
+        if (strcmp(argv[1], LINE_FLUSH_OPTION) == 0) {
+            outputSetLineFlush(true);
+        } else if (strncmp(argv[1], THREADS_OPTION,
+                           strlen(THREADS_OPTION)) == 0) {
+            threads = (size_t) strtoul(argv[1] + strlen(THREADS_OPTION),
+                                       NULL, 10);
+        } else {
+            break;
+        }
+        argc--;
+        argv++;
+    }
+
     initProgram();
+    initQueries(threads);
+    initWal(argc, argv);
 
     while (true) {
         loopStepClear();
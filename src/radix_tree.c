@@ -7,7 +7,9 @@
  * @date 04.05.2018
  */
 
+#include <stdatomic.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -26,55 +28,298 @@
  */
 #define RADIX_TREE_OPERATION_FAIL 0
 
+/**
+ * @brief Maksymalna długość numeru na krawędzi przechowywanego
+ * bezpośrednio w węźle.
+ * @see RadixTreeNode
+ */
+#define RADIX_TREE_INLINE_TXT_LENGTH 16
+
+/**
+ * @brief Liczba bitów przeznaczonych na jeden znak spakowanego numeru.
+ */
+#define RADIX_TREE_PACKED_CHAR_BITS 4
+
+/**
+ * @brief Maska wycinająca jeden znak spakowanego numeru.
+ */
+#define RADIX_TREE_PACKED_CHAR_MASK ((uint64_t) 0xF)
+
+/**
+ * @brief Podsumowanie poddrzewa używane przez @ref radixTreeNonTrivialCount.
+ * Węzeł z danymi jest najpłytszy, jeżeli żaden z jego przodków należących
+ * do poddrzewa nie przechowuje danych.
+ */
+struct RadixTreeSummary {
+    /**
+     * @brief Liczba najpłytszych węzłów z danymi w poddrzewie.
+     */
+    size_t dataCount;
+
+    /**
+     * @brief Najmniejsza liczba znaków na ścieżce od korzenia poddrzewa
+     * do węzła z danymi, SIZE_MAX jeżeli @p dataCount jest równe 0.
+     */
+    size_t dataDepth;
+
+    /**
+     * @brief Liczba najpłytszych węzłów z danymi w odległości
+     * @p dataDepth od korzenia poddrzewa.
+     */
+    size_t dataAtDepth;
+
+    /**
+     * @brief Cyfry występujące na krawędziach poddrzewa, z wyłączeniem
+     * krawędzi wchodzącej do jego korzenia.
+     * Bit o numerze i jest ustawiony gdy występuje cyfra o numerze i
+     * (kod_ascii - '0').
+     */
+    uint16_t digits;
+};
+
 /**
  * @brief Struktura reprezentująca węzeł drzewa.
+ * Numer na krawędzi wchodzącej do węzła o długości nie większej niż
+ * RADIX_TREE_INLINE_TXT_LENGTH jest przechowywany w polu @p packedTxt,
+ * dłuższe numery w polu @p txt.
+ * Korzeń jako jedyny węzeł nie ma ojca, a numer na krawędzi do niego
+ * wchodzącej jest pusty.
+ * Pola @p data, @p sons i @p father mogą być odczytywane współbieżnie
+ * z ich zmianą (patrz @ref radixTreeInsert), pozostałe pola węzła
+ * dołączonego do drzewa zarządzanego przez epoki, poza podsumowaniem
+ * poddrzewa, nie zmieniają się.
+ * Podsumowanie poddrzewa (pole @p summary) jest uaktualniane przez
+ * wszystkie operacje modyfikujące drzewo i odczytywane jedynie przez
+ * @ref radixTreeNonTrivialCount, które nie może być wykonywane
+ * współbieżnie z modyfikacjami.
  */
 struct RadixTreeNode {
     /**
-     * @brief Numer przechowywany przez węzeł.
-     * Numer odpowiadający krawędzi wchodzącej do węzła.
-     * Korzeń przechowuje wartość RADIX_TREE_ROOT_TXT.
-     * @see RADIX_TREE_ROOT_TXT
+     * @brief Spakowany numer krawędzi wchodzącej do węzła.
+     * Znak o indeksie i zajmuje bity od RADIX_TREE_PACKED_CHAR_BITS * i
+     * i ma wartość (kod_ascii - '0'). Używany gdy @p txt jest równe NULL.
      */
-    CharSequence txt;
+    uint64_t packedTxt;
 
     /**
-     * @brief Długość @p txt.
+     * @brief Długość numeru na krawędzi wchodzącej do węzła.
      */
     size_t txtLength;
 
     /**
-     * @brief Dane przechowywane przez węzeł.
+     * @brief Cyfry występujące w numerze na krawędzi wchodzącej do węzła.
+     * @see RadixTreeSummary->digits
      */
-    void *data;
+    uint16_t txtDigits;
 
     /**
-     * @brief Zmienna pomocnicza do przechodzenia drzewa bez użycia rekurencji,
-     * Zmienna wykorzystywana przez funkcje: @ref radixTreeFold,
-     * @ref radixTreeDeleteSubTree, @ref radixTreeDelete.
+     * @brief Podsumowanie poddrzewa węzła.
      */
-    size_t foldI;
+    struct RadixTreeSummary summary;
 
     /**
-     * @see radixTreeNonTrivialCount
+     * @brief Dane przechowywane przez węzeł.
      */
-    size_t helper;
+    _Atomic(void *) data;
 
     /**
      * @brief Synowie węzła w drzewie.
      * @see RADIX_TREE_NUMBER_OF_SONS
      */
-    RadixTreeNode sons[RADIX_TREE_NUMBER_OF_SONS];
+    _Atomic(RadixTreeNode) sons[RADIX_TREE_NUMBER_OF_SONS];
 
     /**
-     * @brief Ojciec węzła w drzewie.
+     * @brief Ojciec węzła w drzewie, NULL dla korzenia.
      */
-    RadixTreeNode father;
+    _Atomic(RadixTreeNode) father;
+
+    /**
+     * @brief Numer przechowywany przez węzeł, jeżeli nie mieści się
+     * w @p packedTxt, w przeciwnym przypadku NULL.
+     * Numer odpowiadający krawędzi wchodzącej do węzła.
+     */
+    CharSequence txt;
 };
 
+RadixTreeNode radixTreeFather(RadixTreeNode node) {
+    return atomic_load_explicit(&node->father, memory_order_acquire);
+}
+
+/**
+ * @brief Ustawia ojca węzła.
+ * @param[in, out] node - wskaźnik na węzeł.
+ * @param[in] father - wskaźnik na nowego ojca.
+ */
+static void radixTreeSetFather(RadixTreeNode node, RadixTreeNode father) {
+    atomic_store_explicit(&node->father, father, memory_order_release);
+}
+
+RadixTreeNode radixTreeSon(RadixTreeNode node, size_t i) {
+    return atomic_load_explicit(&node->sons[i], memory_order_acquire);
+}
+
+/**
+ * @brief Ustawia syna o danym numerze.
+ * Nowy syn staje się widoczny dla czytelników razem z całą swoją
+ * zawartością zapisaną przed wywołaniem.
+ * @param[in, out] node - wskaźnik na węzeł.
+ * @param[in] i - numer syna.
+ * @param[in] son - wskaźnik na nowego syna, NULL w przypadku jego usunięcia.
+ */
+static void radixTreeSetSon(RadixTreeNode node, size_t i, RadixTreeNode son) {
+    atomic_store_explicit(&node->sons[i], son, memory_order_release);
+}
+
 int radixTreeIsRoot(RadixTreeNode node) {
-    return node->txt != NULL
-           && charSequenceEqualToString(node->txt, RADIX_TREE_ROOT_TXT);
+    return radixTreeFather(node) == NULL;
+}
+
+/**
+ * @brief Sprawdza czy numer krawędzi wchodzącej do @p node jest spakowany.
+ * @param[in] node - wskaźnik na węzeł.
+ * @return Niezerowa wartość jeżeli jest, zerowa w przeciwnym wypadku.
+ */
+static int radixTreeIsTxtPacked(RadixTreeNode node) {
+    return node->txt == NULL;
+}
+
+/**
+ * @brief Odczytuje znak spakowanego numeru.
+ * @param[in] packed - spakowany numer.
+ * @param[in] i - indeks znaku.
+ * @return Znak o indeksie @p i.
+ */
+static char radixTreeUnpackChar(uint64_t packed, size_t i) {
+    return (char) ('0' + ((packed >> (RADIX_TREE_PACKED_CHAR_BITS * i))
+                          & RADIX_TREE_PACKED_CHAR_MASK));
+}
+
+/**
+ * @brief Pierwszy znak numeru na krawędzi wchodzącej do @p node.
+ * @param[in] node - wskaźnik na węzeł.
+ * @return Pierwszy znak numeru (znak odpowiadający węzłowi u ojca).
+ */
+static char radixTreeFirstChar(RadixTreeNode node) {
+    if (radixTreeIsTxtPacked(node)) {
+        return radixTreeUnpackChar(node->packedTxt, 0);
+    } else {
+        CharSequenceIterator it = charSequenceGetIterator(node->txt);
+        return charSequenceGetChar(&it);
+    }
+}
+
+void radixTreeCopyTxt(RadixTreeNode node, char *out) {
+    size_t i;
+    if (radixTreeIsTxtPacked(node)) {
+        uint64_t packed = node->packedTxt;
+        for (i = 0; i < node->txtLength; i++) {
+            out[i] = (char) ('0' + (packed & RADIX_TREE_PACKED_CHAR_MASK));
+            packed >>= RADIX_TREE_PACKED_CHAR_BITS;
+        }
+    } else {
+        assert(node->txtLength == charSequenceLength(node->txt));
+        CharSequenceIterator it = charSequenceGetIterator(node->txt);
+        for (i = 0; i < node->txtLength; i++) {
+            charSequenceNextChar(&it, &out[i]);
+        }
+    }
+}
+
+/**
+ * @brief Wyznacza cyfry występujące w numerze krawędzi wchodzącej do @p node.
+ * #### Złożoność
+ * O(długość numeru na krawędzi)
+ * @param[in] node - wskaźnik na węzeł.
+ * @return Maska cyfr (patrz RadixTreeNode->txtDigits).
+ */
+static uint16_t radixTreeTxtDigits(RadixTreeNode node) {
+    uint16_t result = 0;
+    size_t i;
+    if (radixTreeIsTxtPacked(node)) {
+        uint64_t packed = node->packedTxt;
+        for (i = 0; i < node->txtLength; i++) {
+            result |= (uint16_t) (1u << (packed & RADIX_TREE_PACKED_CHAR_MASK));
+            packed >>= RADIX_TREE_PACKED_CHAR_BITS;
+        }
+    } else {
+        CharSequenceIterator it = charSequenceGetIterator(node->txt);
+        char ch;
+        for (i = 0; i < node->txtLength; i++) {
+            charSequenceNextChar(&it, &ch);
+            result |= (uint16_t) (1u << (ch - '0'));
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Ustawia numer krawędzi wchodzącej do @p node.
+ * Numer nie dłuższy niż RADIX_TREE_INLINE_TXT_LENGTH zostaje spakowany,
+ * dłuższy trafia do ciągu znaków.
+ * @remarks Zakłada, że węzeł nie ma przypisanego numeru.
+ * @param[in, out] node - wskaźnik na węzeł.
+ * @param[in] txt - wskaźnik na numer.
+ * @param[in] length - długość numeru.
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ * @return RADIX_TREE_OPERATION_FAIL w przypadku problemów z pamięcią,
+ *         w przeciwnym przypadku RADIX_TREE_OPERATION_SUCCESS.
+ */
+static int radixTreeSetTxt(RadixTreeNode node, const char *txt,
+                           size_t length, MemoryPool pool) {
+    assert(node->txt == NULL);
+    if (length <= RADIX_TREE_INLINE_TXT_LENGTH) {
+        uint64_t packed = 0;
+        size_t i;
+        for (i = length; i != 0; i--) {
+            packed <<= RADIX_TREE_PACKED_CHAR_BITS;
+            packed |= (uint64_t) (txt[i - 1] - '0');
+        }
+        node->packedTxt = packed;
+    } else {
+        node->txt = charSequenceFromText(txt, length, pool);
+        if (node->txt == NULL) {
+            return RADIX_TREE_OPERATION_FAIL;
+        }
+    }
+    node->txtLength = length;
+    node->txtDigits = radixTreeTxtDigits(node);
+    return RADIX_TREE_OPERATION_SUCCESS;
+}
+
+/**
+ * @brief Pakuje numer węzła @p node jeżeli jest dostatecznie krótki.
+ * @param[in, out] node - wskaźnik na węzeł nie będący korzeniem.
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ */
+static void radixTreePackTxt(RadixTreeNode node, MemoryPool pool) {
+    if (!radixTreeIsTxtPacked(node)
+        && node->txtLength <= RADIX_TREE_INLINE_TXT_LENGTH) {
+        char buffer[RADIX_TREE_INLINE_TXT_LENGTH];
+        radixTreeCopyTxt(node, buffer);
+        charSequenceDelete(node->txt, pool);
+        node->txt = NULL;
+        radixTreeSetTxt(node, buffer, node->txtLength, pool);
+    }
+}
+
+/**
+ * @brief Przenosi spakowany numer węzła @p node do ciągu znaków.
+ * @param[in, out] node - wskaźnik na węzeł.
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ * @return RADIX_TREE_OPERATION_FAIL w przypadku problemów z pamięcią,
+ *         w przeciwnym przypadku RADIX_TREE_OPERATION_SUCCESS.
+ */
+static int radixTreeUnpackTxt(RadixTreeNode node, MemoryPool pool) {
+    if (radixTreeIsTxtPacked(node)) {
+        char buffer[RADIX_TREE_INLINE_TXT_LENGTH + 1];
+        radixTreeCopyTxt(node, buffer);
+        buffer[node->txtLength] = '\0';
+        node->txt = charSequenceFromCString(buffer, pool);
+        if (node->txt == NULL) {
+            return RADIX_TREE_OPERATION_FAIL;
+        }
+    }
+    return RADIX_TREE_OPERATION_SUCCESS;
 }
 
 /**
@@ -84,15 +329,21 @@ int radixTreeIsRoot(RadixTreeNode node) {
  * @param[in] node  - wskaźnik na węzeł.
  */
 static void radixTreeInitNode(RadixTreeNode node) {
-    node->data = NULL;
+    atomic_init(&node->data, NULL);
     node->txt = NULL;
+    node->packedTxt = 0;
     node->txtLength = 0;
+    node->txtDigits = 0;
+    node->summary.dataCount = 0;
+    node->summary.dataDepth = SIZE_MAX;
+    node->summary.dataAtDepth = 0;
+    node->summary.digits = 0;
 
-    node->father = NULL;
+    atomic_init(&node->father, NULL);
 
     size_t i;
     for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
-        node->sons[i] = NULL;
+        atomic_init(&node->sons[i], NULL);
     }
 
 }
@@ -103,46 +354,44 @@ static void radixTreeInitNode(RadixTreeNode node) {
  * O(1)
  * @remarks Zakłada, że do węzła nie są przypisane dane.
  * @param[in] node - wskaźnik na węzeł drzewa.
+ * @param[in, out] pool - pula z której przydzielono węzeł.
  */
-static void radixTreeFreeNode(RadixTreeNode node) {
-    assert(node->data == NULL);
+static void radixTreeFreeNode(RadixTreeNode node, MemoryPool pool) {
+    assert(radixTreeGetNodeData(node) == NULL);
     if (node->txt != NULL) {
-        charSequenceDelete(node->txt);
+        charSequenceDelete(node->txt, pool);
         node->txtLength = 0;
         node->txt = NULL;
     }
-    free(node);
+    memoryPoolFree(pool, node, sizeof(struct RadixTreeNode));
 }
 
 /**
- * @brief Inicjuje nowo powstałe drzewo.
- * #### Złożoność
- * O(1)
- * @param[in] tree  - wskaźnik na drzewo.
- * @return RADIX_TREE_OPERATION_FAIL w przypadku problemów,
- *         w przeciwnym przypadku RADIX_TREE_OPERATION_SUCCESS.
+ * @brief Zwalnia węzeł odłączony od drzewa.
+ * W przeciwieństwie do @ref radixTreeFreeNode nie wymaga, aby węzeł nie
+ * wskazywał na dane (nie są one zwalniane). Do przekazania
+ * @ref epochRetire.
+ * @param[in] node - wskaźnik na węzeł drzewa.
+ * @param[in, out] pool - pula z której przydzielono węzeł.
  */
-static int radixTreeInitTree(RadixTree tree) {
-    radixTreeInitNode(tree);
-    tree->txt = charSequenceFromCString(RADIX_TREE_ROOT_TXT);
-
-    if (tree->txt == NULL) {
-        return RADIX_TREE_OPERATION_FAIL;
-    } else {
-        tree->txtLength = charSequenceLength(tree->txt);
-        return RADIX_TREE_OPERATION_SUCCESS;
+static void radixTreeReclaimNode(void *node, void *pool) {
+    RadixTreeNode ptr = node;
+    if (ptr->txt != NULL) {
+        charSequenceDelete(ptr->txt, pool);
     }
+    memoryPoolFree(pool, ptr, sizeof(struct RadixTreeNode));
 }
 
 /**
  * @brief Tworzy węzeł drzewa i inicjuje go.
  * #### Złożoność
  * O(1)
+ * @param[in, out] pool - pula z której zostanie przydzielony węzeł.
  * @return Wskaźnik na stworzony węzeł, w przypadku
  *         problemów z pamięcią NULL.
  */
-static RadixTreeNode radixTreeCreateNode() {
-    RadixTreeNode result = malloc(sizeof(struct RadixTreeNode));
+static RadixTreeNode radixTreeCreateNode(MemoryPool pool) {
+    RadixTreeNode result = memoryPoolAlloc(pool, sizeof(struct RadixTreeNode));
     if (result == NULL) {
         return NULL;
     } else {
@@ -151,18 +400,8 @@ static RadixTreeNode radixTreeCreateNode() {
     }
 }
 
-RadixTree radixTreeCreate() {
-    RadixTree result = malloc(sizeof(struct RadixTreeNode));
-    if (result == NULL) {
-        return NULL;
-    } else {
-        if (radixTreeInitTree(result) != RADIX_TREE_OPERATION_SUCCESS) {
-            free(result);
-            return NULL;
-        } else {
-            return result;
-        }
-    }
+RadixTree radixTreeCreate(MemoryPool pool) {
+    return radixTreeCreateNode(pool);
 }
 
 /**
@@ -174,16 +413,6 @@ static size_t radixTreeConvertCharToNumber(char sonCh) {
     return (size_t) sonCh - (size_t) '0';
 }
 
-/**
- * @brief Sprawdza czy węzeł @p node ma syna o numerze @p son.
- * @param[in] node - wskaźnik na węzeł.
- * @param[in] son - pierwsza litera na krawędzi do syna.
- * @return Niezerowa wartość jeżeli ma, zerowa w przeciwnym wypadku.
- */
-static int radixTreeHasSon(RadixTreeNode node, char son) {
-    return node->sons[radixTreeConvertCharToNumber(son)] != NULL;
-}
-
 /**
  * @brief Liczba synów węzła @p node.
  * @param[in] node - wskaźnik na węzeł.
@@ -193,7 +422,7 @@ static size_t radixTreeHowManySons(RadixTreeNode node) {
     size_t result = 0;
     size_t i;
     for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
-        if (node->sons[i] != NULL) {
+        if (radixTreeSon(node, i) != NULL) {
             result++;
         }
     }
@@ -215,9 +444,9 @@ static int radixTreeHasSons(RadixTreeNode node) {
  * @return Niezerowa wartość jeżeli może, zerowa w przeciwnym wypadku.
  */
 static int radixTreeIsNodeRedundant(RadixTreeNode node) {
-    return (!radixTreeIsRoot(node))
+    return !radixTreeIsRoot(node)
            && (!radixTreeHasSons(node))
-           && node->data == NULL;
+           && radixTreeGetNodeData(node) == NULL;
 }
 
 /**
@@ -226,21 +455,9 @@ static int radixTreeIsNodeRedundant(RadixTreeNode node) {
  * @return Niezerowa wartość jeżeli może, zerowa w przeciwnym wypadku.
  */
 static int radixTreeCanBeMergedWithSon(RadixTreeNode node) {
-    return (!radixTreeIsRoot(node))
+    return !radixTreeIsRoot(node)
            && radixTreeHowManySons(node) == 1
-           && node->data == NULL;
-}
-
-/**
- * @brief Przesuwa do @p son.
- * Sprawia że wskaźnik @p *ptr wskazuje na syna węzła @p *ptr do którego
- * prowadzi krawędź z pierwszą literą @p son.
- * @param[in,out] ptr - wskaźnik na wskaźnik na węzeł.
- * @param[in] son - znak odpowiadający synowi.
- */
-static void radixTreeMoveToSon(RadixTreeNode *ptr, char son) {
-    assert(radixTreeHasSon(*ptr, son));
-    *ptr = (*ptr)->sons[radixTreeConvertCharToNumber(son)];
+           && radixTreeGetNodeData(node) == NULL;
 }
 
 /**
@@ -254,8 +471,36 @@ static void radixTreeMoveToSon(RadixTreeNode *ptr, char son) {
 static void radixTreeChangeSon(RadixTreeNode node, char son,
                                RadixTreeNode ch) {
     if (node != NULL) {
-        node->sons[radixTreeConvertCharToNumber(son)] = ch;
+        radixTreeSetSon(node, radixTreeConvertCharToNumber(son), ch);
+    }
+}
+
+/**
+ * @brief Numer syna odpowiadającego węzłowi @p node u jego ojca.
+ * @param[in] node - wskaźnik na węzeł nie będący korzeniem.
+ * @return Numer syna.
+ */
+static size_t radixTreeSonNumber(RadixTreeNode node) {
+    return radixTreeConvertCharToNumber(radixTreeFirstChar(node));
+}
+
+/**
+ * @brief Zwraca pierwszego syna węzła @p node o numerze nie mniejszym
+ * niż @p from.
+ * @param[in] node - wskaźnik na węzeł.
+ * @param[in] from - najmniejszy rozważany numer syna.
+ * @return Wskaźnik na syna, NULL w przypadku braku.
+ */
+static RadixTreeNode radixTreeNextSon(RadixTreeNode node, size_t from) {
+    size_t i;
+    RadixTreeNode son;
+    for (i = from; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
+        son = radixTreeSon(node, i);
+        if (son != NULL) {
+            return son;
+        }
     }
+    return NULL;
 }
 
 /**
@@ -263,8 +508,8 @@ static void radixTreeChangeSon(RadixTreeNode node, char son,
  * Po wykonaniu się procedury wartość wkaźnika @p *txt oznacza, że
  * wszystkie znaki występujące przed @p **txt występują w drzewie
  * jako podciąg pewnej drogi od korzenia do liścia.
- * Wartość wskaźnika @p nodeTxtPtr oznacza, że wszystkie znaki występujące
- * na krawędzi wchodzącej do @p node wyłącznie są sufiksem dopasowania
+ * Wartość @p *nodeTxtMatch oznacza, że wszystkie znaki występujące
+ * na krawędzi wchodzącej do @p node przed tą pozycją są sufiksem dopasowania
  * @p *txt.
  * @param[in] node - wskaźnik na węzeł drzewa.
  * @param[in,out] txt - wskaźnik na wskaźnik na dopasowanie numeru.
@@ -272,32 +517,40 @@ static void radixTreeChangeSon(RadixTreeNode node, char son,
  *        po próbie dopasowania wskazuje
  *        na element za ostatnim pasującym, w przypadku pełnego
  *        dopasowania na '\0'.
- * @param[out] nodeTxtPtr - wskaźnik na iterator dopasowania
- *        w ramach węzła @p node (krawędzi do niego wchodzącej).
- *        @p *nodeTxtPtr
- *        po próbie dopasowania wskazuje
- *        na element za ostatnim pasującym, w przypadku pełnego
- *        dopasowania na węzeł odpowiadający znakowi '\0'.
+ * @param[out] nodeTxtMatch - długość dopasowania
+ *        w ramach węzła @p node (krawędzi do niego wchodzącej),
+ *        w przypadku pełnego dopasowania długość numeru na krawędzi.
  * @return RADIX_TREE_OPERATION_SUCCESS w przypadku pełnego dopasowania,
  *         RADIX_TREE_OPERATION_FAIL w przeciwnym przypadku.
  */
 static int radixTreeMoveTxt(RadixTreeNode node, const char **txt,
-                            CharSequenceIterator *nodeTxtPtr) {
-    CharSequenceIterator i = charSequenceGetIterator(node->txt);
+                            size_t *nodeTxtMatch) {
+    size_t i = 0;
 
-    if (radixTreeIsRoot(node)) {
-        i = charSequenceSequenceEnd(node->txt);
+    assert(!radixTreeIsRoot(node));
+    if (radixTreeIsTxtPacked(node)) {
+        uint64_t packed = node->packedTxt;
+        while (i < node->txtLength
+               && *(*txt) != '\0'
+               && (char) ('0' + (packed & RADIX_TREE_PACKED_CHAR_MASK))
+                  == *(*txt)) {
+            packed >>= RADIX_TREE_PACKED_CHAR_BITS;
+            i++;
+            (*txt)++;
+        }
     } else {
-        while (charSequenceGetChar(&i) != '\0'
+        CharSequenceIterator it = charSequenceGetIterator(node->txt);
+        while (charSequenceGetChar(&it) != '\0'
                && *(*txt) != '\0'
-               && charSequenceGetChar(&i) == *(*txt)) {
-            charSequenceNextChar(&i, NULL);
+               && charSequenceGetChar(&it) == *(*txt)) {
+            charSequenceNextChar(&it, NULL);
+            i++;
             (*txt)++;
         }
     }
 
-    *nodeTxtPtr = i;
-    if (charSequenceGetChar(&i) == '\0') {
+    *nodeTxtMatch = i;
+    if (i == node->txtLength) {
         return RADIX_TREE_OPERATION_SUCCESS;
     } else {
         return RADIX_TREE_OPERATION_FAIL;
@@ -314,19 +567,20 @@ static int radixTreeMoveTxt(RadixTreeNode node, const char **txt,
  *        Po próbie @p *txt dopasowania wskazuje
  *        na element za ostatnim pasującym, w przypadku pełnego
  *        dopasowania na '\0'.
- * @param[out] nodeTxtPtr - podobnie do @p txt tylko dotyczy dopasowania
- *        w ramach węzła.
+ * @param[out] nodeTxtMatch - długość dopasowania w ramach węzła.
  * @return RADIX_TREE_OPERATION_FAIL w przypadku niemożności dalszego
  *         dopasowania, RADIX_TREE_OPERATION_SUCCESS w przeciwnym przypadku.
  */
 static int radixTreeMove(RadixTreeNode *node, const char **txt,
-                         CharSequenceIterator *nodeTxtPtr) {
+                         size_t *nodeTxtMatch) {
     assert(*(*txt) != '\0');
-    if (!radixTreeHasSon(*node, *(*txt))) {
+    RadixTreeNode son = radixTreeSon(*node,
+                                     radixTreeConvertCharToNumber(*(*txt)));
+    if (son == NULL) {
         return RADIX_TREE_OPERATION_FAIL;
     } else {
-        radixTreeMoveToSon(node, *(*txt));
-        return radixTreeMoveTxt(*node, txt, nodeTxtPtr);
+        *node = son;
+        return radixTreeMoveTxt(*node, txt, nodeTxtMatch);
     }
 
 }
@@ -340,9 +594,8 @@ static int radixTreeMove(RadixTreeNode *node, const char **txt,
  *       @p *txtMatchPtr wyłącznie jest dopasowany w drzewie
  *       @p tree (istnieje droga od korzenia do liścia idąca w dół,
  *       taka, że @p txt jest jej podciągiem).
- * @param[out] nodeMatchPtr - wskaźnik iterator dopasowania krawędzi wchodzącej
- *       do
- *       @p *ptr.
+ * @param[out] nodeMatch - długość dopasowania krawędzi wchodzącej
+ *       do @p *ptr.
  * @return W przypadku gdy węzeł reprezentujący @p txt istnieje w drzewie
  *         RADIX_TREE_FOUND, w przypadku gdy @p txt jest podciągiem
  *         tekstu reprezentowanego przez któryś z węzłów RADIX_TREE_SUBSTR,
@@ -352,16 +605,16 @@ static int radixTreeFindEx(RadixTree tree,
                            const char *txt,
                            RadixTreeNode *ptr,
                            const char **txtMatchPtr,
-                           CharSequenceIterator *nodeMatchPtr) {
+                           size_t *nodeMatch) {
     *ptr = tree;
     *txtMatchPtr = txt;
-    *nodeMatchPtr = charSequenceSequenceEnd((*ptr)->txt);
+    *nodeMatch = (*ptr)->txtLength;
 
     while (*(*txtMatchPtr) != '\0'
-           && radixTreeMove(ptr, txtMatchPtr, nodeMatchPtr)
+           && radixTreeMove(ptr, txtMatchPtr, nodeMatch)
               == RADIX_TREE_OPERATION_SUCCESS);
 
-    if (charSequenceGetChar((nodeMatchPtr)) == '\0'
+    if (*nodeMatch == (*ptr)->txtLength
         && *(*txtMatchPtr) == '\0') {
         return RADIX_TREE_FOUND;
     } else if (*(*txtMatchPtr) == '\0') {
@@ -371,83 +624,367 @@ static int radixTreeFindEx(RadixTree tree,
     }
 }
 
-/**
- * @see radixTreeFind
- * @param[in] node - wskaźnik na węzeł drzewa.
- * @param[in] txt - wskaźnik na tekst *nodeMatchPtr z @ref radixTreeFindEx.
- * @return Długość dopasowania krawędzi wchodzącej do węzła @p node.
- */
-static size_t radixTreeHowManyCharsOffset(RadixTreeNode node,
-                                          CharSequenceIterator *txt) {
-    CharSequenceIterator ptr = charSequenceGetIterator(node->txt);
-    size_t result = 0;
-    while (!charSequenceIteratorsEqual(&ptr, txt)) {
-        charSequenceNextChar(&ptr, NULL);
-        result++;
-    }
-    return result;
-}
-
 int radixTreeFind(RadixTree tree, const char *txt, RadixTreeNode *ptr,
                   const char **txtMatchPtr, size_t *nodeMatch,
                   int *nodeMatchMode) {
-    CharSequenceIterator nodeMatchPtr;
-    int result = radixTreeFindEx(tree, txt, ptr, txtMatchPtr, &nodeMatchPtr);
+    int result = radixTreeFindEx(tree, txt, ptr, txtMatchPtr, nodeMatch);
 
-    if (charSequenceGetChar(&nodeMatchPtr) == '\0') {
-        assert((*ptr)->txtLength == charSequenceLength((*ptr)->txt));
-        *nodeMatch = (*ptr)->txtLength;
+    if (*nodeMatch == (*ptr)->txtLength) {
         *nodeMatchMode = RADIX_TREE_NODE_MATCH_FULL;
     } else {
-        *nodeMatch = radixTreeHowManyCharsOffset(*ptr, &nodeMatchPtr);
         *nodeMatchMode = RADIX_TREE_NODE_MATCH_PARTIAL;
     }
     return result;
 }
 
 size_t radixTreeHowManyChars(RadixTreeNode node) {
-    assert(charSequenceLength(node->txt) == node->txtLength);
+    assert(radixTreeIsTxtPacked(node)
+           || charSequenceLength(node->txt) == node->txtLength);
     return node->txtLength;
 }
 
 /**
- * @brief Rozdziela węzeł na dwa.
+ * @brief Porównuje podsumowania poddrzew.
+ * @param[in] a - wskaźnik na podsumowanie.
+ * @param[in] b - wskaźnik na podsumowanie.
+ * @return true jeżeli podsumowania są równe, false w przeciwnym przypadku.
+ */
+static bool radixTreeSummaryEqual(const struct RadixTreeSummary *a,
+                                  const struct RadixTreeSummary *b) {
+    return a->dataCount == b->dataCount && a->dataDepth == b->dataDepth
+           && a->dataAtDepth == b->dataAtDepth && a->digits == b->digits;
+}
+
+/**
+ * @brief Dolicza syna do podsumowania poddrzewa.
+ * @param[in, out] summary - wskaźnik na podsumowanie poddrzewa ojca.
+ * @param[in] son - wskaźnik na syna.
+ * @param[in] sonSummary - wskaźnik na podsumowanie poddrzewa syna.
+ */
+static void radixTreeSummaryAddSon(struct RadixTreeSummary *summary,
+                                   RadixTreeNode son,
+                                   const struct RadixTreeSummary *sonSummary) {
+    summary->digits |= son->txtDigits | sonSummary->digits;
+    if (sonSummary->dataCount != 0) {
+        size_t depth = son->txtLength + sonSummary->dataDepth;
+        summary->dataCount += sonSummary->dataCount;
+        if (depth < summary->dataDepth) {
+            summary->dataDepth = depth;
+            summary->dataAtDepth = sonSummary->dataAtDepth;
+        } else if (depth == summary->dataDepth) {
+            summary->dataAtDepth += sonSummary->dataAtDepth;
+        }
+    }
+}
+
+/**
+ * @brief Wyznacza podsumowanie poddrzewa węzła @p node.
+ * Korzysta z podsumowań synów węzła, które muszą być aktualne.
+ * #### Złożoność
+ * O(1)
+ * @param[in, out] node - wskaźnik na węzeł.
+ */
+static void radixTreeUpdateSummary(RadixTreeNode node) {
+    struct RadixTreeSummary summary = {0, SIZE_MAX, 0, 0};
+    size_t i;
+    RadixTreeNode son;
+
+    for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
+        son = radixTreeSon(node, i);
+        if (son != NULL) {
+            radixTreeSummaryAddSon(&summary, son, &son->summary);
+        }
+    }
+    if (radixTreeGetNodeData(node) != NULL) {
+        summary.dataCount = 1;
+        summary.dataDepth = 0;
+        summary.dataAtDepth = 1;
+    }
+    node->summary = summary;
+}
+
+/**
+ * @brief Uwzględnia zmianę podsumowania syna bez przeglądania
+ * pozostałych synów.
+ * @param[in, out] node - wskaźnik na węzeł.
+ * @param[in] son - wskaźnik na syna, którego podsumowanie się zmieniło.
+ * @param[in] old - wskaźnik na poprzednie podsumowanie syna.
+ * @return true w przypadku sukcesu, false jeżeli podsumowania nie da się
+ *         uaktualnić w ten sposób (syn przestał zawierać cyfrę lub
+ *         najpłytszy węzeł z danymi) i należy je wyznaczyć od nowa.
+ */
+static bool radixTreeApplySonChange(RadixTreeNode node, RadixTreeNode son,
+                                    const struct RadixTreeSummary *old) {
+    struct RadixTreeSummary *summary = &node->summary;
+    if ((old->digits & ~son->summary.digits) != 0) {
+        return false;
+    } else if (radixTreeGetNodeData(node) != NULL) {
+        summary->digits |= son->summary.digits;
+        return true;
+    }
+
+    if (old->dataCount != 0) {
+        summary->dataCount -= old->dataCount;
+        if (son->txtLength + old->dataDepth == summary->dataDepth) {
+            summary->dataAtDepth -= old->dataAtDepth;
+            if (summary->dataAtDepth == 0) {
+                return false;
+            }
+        }
+    }
+    radixTreeSummaryAddSon(summary, son, &son->summary);
+    return true;
+}
+
+/**
+ * @brief Uaktualnia podsumowania poddrzew na ścieżce od @p node do korzenia.
+ * Podsumowanie @p node jest wyznaczane od nowa, a podsumowania przodków
+ * w miarę możliwości jedynie poprawiane o zmianę podsumowania syna.
+ * Kończy, gdy podsumowanie któregoś węzła się nie zmieni.
+ * #### Złożoność
+ * O(głębokość węzła)
+ * @param[in, out] node - wskaźnik na węzeł, którego syn lub dane
+ *        się zmieniły.
+ */
+static void radixTreeUpdatePath(RadixTreeNode node) {
+    struct RadixTreeSummary old = node->summary, fatherOld;
+    RadixTreeNode son = node, father;
+
+    radixTreeUpdateSummary(node);
+    while (!radixTreeSummaryEqual(&old, &son->summary)
+           && (father = radixTreeFather(son)) != NULL) {
+        fatherOld = father->summary;
+        if (!radixTreeApplySonChange(father, son, &old)) {
+            radixTreeUpdateSummary(father);
+        }
+        old = fatherOld;
+        son = father;
+    }
+}
+
+/**
+ * @brief Dodaje cyfry do podsumowań poddrzew od @p node do korzenia.
+ * Wystarcza po dołączeniu do @p node syna bez węzłów z danymi.
+ * #### Złożoność
+ * O(głębokość węzła)
+ * @param[in, out] node - wskaźnik na węzeł.
+ * @param[in] digits - maska dodawanych cyfr.
+ */
+static void radixTreeAddDigits(RadixTreeNode node, uint16_t digits) {
+    RadixTreeNode pos = node;
+    while (pos != NULL && (digits & ~pos->summary.digits) != 0) {
+        pos->summary.digits |= digits;
+        pos = radixTreeFather(pos);
+    }
+}
+
+/**
+ * @brief Rozdziela węzeł na dwa w miejscu.
  * Rozdziela węzeł @p node na dwa tnąc krawędź do niego wchodzącą w punkcie
- * @p splitPtr.
+ * po @p splitPos znakach. Węzeł @p node staje się dolną częścią.
  * @param[in] node - wskaźnik na węzeł.
- * @param[in] splitPtr - wskaźnik na iterator wskazujący na
- *        miejsce rozcinające w tekście krawędzi
- *        (przechowywane w węźle).
- * @return RADIX_TREE_OPERATION_SUCCESS w przypadku udanego rozcięcia,
- *         RADIX_TREE_OPERATION_FAIL w przeciwnym przypadku.
+ * @param[in] splitPos - długość prefiksu krawędzi, który trafi do nowego
+ *        węzła (0 < @p splitPos < długość krawędzi).
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ * @return Wskaźnik na nowy węzeł (górną część) w przypadku udanego
+ *         rozcięcia, NULL w przeciwnym przypadku.
  */
-static int radixTreeSplitNode(RadixTreeNode node, CharSequenceIterator *splitPtr) {
-    RadixTreeNode newNode = radixTreeCreateNode();
+static RadixTreeNode radixTreeSplitNodeInPlace(RadixTreeNode node,
+                                               size_t splitPos,
+                                               MemoryPool pool) {
+    assert(0 < splitPos && splitPos < node->txtLength);
+    RadixTreeNode newNode = radixTreeCreateNode(pool);
 
     if (newNode == NULL) {
-        return RADIX_TREE_OPERATION_FAIL;
+        return NULL;
     } else {
-        newNode->txt = node->txt;
+        if (radixTreeIsTxtPacked(node)) {
+            size_t shift = RADIX_TREE_PACKED_CHAR_BITS * splitPos;
+            newNode->packedTxt = node->packedTxt
+                                 & (((uint64_t) 1 << shift) - 1);
+            node->packedTxt >>= shift;
+        } else {
+            CharSequenceIterator splitPtr = charSequenceGetIterator(node->txt);
+            size_t i;
+            for (i = 0; i < splitPos; i++) {
+                charSequenceNextChar(&splitPtr, NULL);
+            }
+            CharSequence ptr = charSequenceSplitByIterator(node->txt,
+                                                           &splitPtr, pool);
+            if (ptr == NULL) {
+                radixTreeFreeNode(newNode, pool);
+                return NULL;
+            }
+            newNode->txt = node->txt;
+            node->txt = ptr;
+        }
+        newNode->txtLength = splitPos;
+        node->txtLength -= splitPos;
 
-        CharSequence ptr = charSequenceSplitByIterator(node->txt, splitPtr);
-        newNode->txtLength = charSequenceLength(newNode->txt);
+        radixTreePackTxt(newNode, pool);
+        radixTreePackTxt(node, pool);
+        newNode->txtDigits = radixTreeTxtDigits(newNode);
+        node->txtDigits = radixTreeTxtDigits(node);
 
-        node->txt = ptr;
-        node->txtLength -= newNode->txtLength;
+        RadixTreeNode father = radixTreeFather(node);
+        radixTreeSetFather(newNode, father);
+        radixTreeChangeSon(father, radixTreeFirstChar(newNode), newNode);
 
-        assert(charSequenceLength(node->txt) == node->txtLength);
-        assert(charSequenceLength(newNode->txt) == newNode->txtLength);
+        radixTreeSetFather(node, newNode);
+        radixTreeChangeSon(newNode, radixTreeFirstChar(node), node);
+        radixTreeUpdateSummary(newNode);
+        return newNode;
 
-        newNode->father = node->father;
-        CharSequenceIterator it = charSequenceGetIterator(newNode->txt);
-        radixTreeChangeSon(node->father, charSequenceGetChar(&it),
-                           newNode);
+    }
+}
 
-        node->father = newNode;
-        it = charSequenceGetIterator(node->txt);
-        radixTreeChangeSon(newNode, charSequenceGetChar(&it), node);
-        return RADIX_TREE_OPERATION_SUCCESS;
+/**
+ * @brief Tworzy kopię węzła z innym numerem na krawędzi wchodzącej.
+ * Kopia przejmuje dane, synów i podsumowanie poddrzewa węzła @p node (ich
+ * ojcem pozostaje @p node, patrz @ref radixTreeAdoptSons), ale nie jest
+ * jeszcze podłączona do drzewa.
+ * @param[in] node - wskaźnik na kopiowany węzeł, NULL jeżeli nowy węzeł
+ *        ma nie mieć danych ani synów.
+ * @param[in] father - wskaźnik na ojca kopii.
+ * @param[in] txt - wskaźnik na numer kopii.
+ * @param[in] length - długość numeru kopii.
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ * @return Wskaźnik na kopię, w przypadku problemów z pamięcią NULL.
+ */
+static RadixTreeNode radixTreeCopyNode(RadixTreeNode node,
+                                       RadixTreeNode father,
+                                       const char *txt, size_t length,
+                                       MemoryPool pool) {
+    RadixTreeNode result = radixTreeCreateNode(pool);
+    if (result == NULL) {
+        return NULL;
+    } else if (radixTreeSetTxt(result, txt, length, pool)
+               != RADIX_TREE_OPERATION_SUCCESS) {
+        radixTreeFreeNode(result, pool);
+        return NULL;
+    } else {
+        atomic_init(&result->father, father);
+        if (node != NULL) {
+            atomic_init(&result->data, radixTreeGetNodeData(node));
+            size_t i;
+            for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
+                atomic_init(&result->sons[i], radixTreeSon(node, i));
+            }
+            result->summary = node->summary;
+        }
+        return result;
+    }
+}
 
+/**
+ * @brief Ustawia węzeł @p node jako ojca wszystkich jego synów.
+ * @param[in] node - wskaźnik na węzeł.
+ */
+static void radixTreeAdoptSons(RadixTreeNode node) {
+    size_t i;
+    RadixTreeNode son;
+    for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
+        son = radixTreeSon(node, i);
+        if (son != NULL) {
+            radixTreeSetFather(son, node);
+        }
+    }
+}
+
+/**
+ * @brief Przydziela bufor na numer długości @p length.
+ * @param[in] buffer - bufor o rozmiarze
+ *        2 * RADIX_TREE_INLINE_TXT_LENGTH + 1 używany dla krótkich numerów.
+ * @param[in] length - długość numeru.
+ * @return Wskaźnik na bufor o rozmiarze co najmniej @p length + 1,
+ *         w przypadku problemów z pamięcią NULL.
+ */
+static char *radixTreeTxtBuffer(char *buffer, size_t length) {
+    if (length <= 2 * RADIX_TREE_INLINE_TXT_LENGTH) {
+        return buffer;
+    } else {
+        return malloc(length + (size_t) 1);
+    }
+}
+
+/**
+ * @brief Rozdziela węzeł na dwa bez modyfikowania go.
+ * Zastępuje węzeł @p node dwoma nowymi węzłami, z których górny
+ * przechowuje pierwsze @p splitPos znaków krawędzi, a dolny pozostałe
+ * oraz dane i synów @p node. Węzeł @p node zostaje przekazany do
+ * @ref epochRetire.
+ * @param[in] node - wskaźnik na węzeł.
+ * @param[in] splitPos - długość prefiksu krawędzi, który trafi do górnego
+ *        węzła (0 < @p splitPos < długość krawędzi).
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ * @param[in, out] epoch - wskaźnik na strukturę epok czytelników drzewa.
+ * @return Wskaźnik na górny węzeł w przypadku udanego rozcięcia,
+ *         NULL w przeciwnym przypadku.
+ */
+static RadixTreeNode radixTreeSplitNodeCopy(RadixTreeNode node,
+                                            size_t splitPos,
+                                            MemoryPool pool, Epoch epoch) {
+    assert(0 < splitPos && splitPos < node->txtLength);
+    char local[2 * RADIX_TREE_INLINE_TXT_LENGTH + 1];
+    char *txt = radixTreeTxtBuffer(local, node->txtLength);
+    if (txt == NULL) {
+        return NULL;
+    }
+    radixTreeCopyTxt(node, txt);
+    txt[node->txtLength] = '\0';
+
+    RadixTreeNode father = radixTreeFather(node);
+    char afterSplit = txt[splitPos];
+    txt[splitPos] = '\0';
+    RadixTreeNode upper = radixTreeCopyNode(NULL, father, txt, splitPos,
+                                            pool);
+    txt[splitPos] = afterSplit;
+    RadixTreeNode lower = NULL;
+    if (upper != NULL) {
+        lower = radixTreeCopyNode(node, upper, txt + splitPos,
+                                  node->txtLength - splitPos, pool);
+    }
+    if (txt != local) {
+        free(txt);
+    }
+
+    if (lower == NULL) {
+        if (upper != NULL) {
+            radixTreeFreeNode(upper, pool);
+        }
+        return NULL;
+    } else {
+        atomic_init(&upper->sons[radixTreeSonNumber(lower)], lower);
+        radixTreeUpdateSummary(upper);
+        radixTreeChangeSon(father, radixTreeFirstChar(upper), upper);
+        radixTreeAdoptSons(lower);
+        epochRetire(epoch, node, radixTreeReclaimNode, pool);
+        return upper;
+    }
+}
+
+/**
+ * @brief Rozdziela węzeł na dwa.
+ * Rozdziela węzeł @p node na dwa tnąc krawędź do niego wchodzącą w punkcie
+ * po @p splitPos znakach.
+ * @see radixTreeSplitNodeInPlace
+ * @see radixTreeSplitNodeCopy
+ * @param[in] node - wskaźnik na węzeł.
+ * @param[in] splitPos - długość prefiksu krawędzi, który trafi do nowego
+ *        węzła (0 < @p splitPos < długość krawędzi).
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ * @param[in, out] epoch - wskaźnik na strukturę epok czytelników drzewa,
+ *        NULL jeżeli węzeł może zostać zmodyfikowany w miejscu.
+ * @return Wskaźnik na węzeł reprezentujący pierwsze @p splitPos znaków
+ *         krawędzi w przypadku udanego rozcięcia, NULL w przeciwnym
+ *         przypadku.
+ */
+static RadixTreeNode radixTreeSplitNode(RadixTreeNode node, size_t splitPos,
+                                        MemoryPool pool, Epoch epoch) {
+    if (epoch == NULL) {
+        return radixTreeSplitNodeInPlace(node, splitPos, pool);
+    } else {
+        return radixTreeSplitNodeCopy(node, splitPos, pool, epoch);
     }
 }
 
@@ -455,121 +992,409 @@ static int radixTreeSplitNode(RadixTreeNode node, CharSequenceIterator *splitPtr
  * @brief Dodaje węzłowi @p node pustego syna.
  * @param[in] node - wskaźnik na węzeł.
  * @param[in] txt - wskaźnik na tekst krawędzi do syna.
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
  * @return Wskaźnik na dodany węzeł, w przypadku problemów z
  *         przydzieleniem pamięci NULL.
  */
-static RadixTreeNode radixTreeInsertLeaf(RadixTreeNode node, const char *txt) {
-    CharSequence textToInsert = charSequenceFromCString(txt);
-    if (textToInsert == NULL) {
+static RadixTreeNode radixTreeInsertLeaf(RadixTreeNode node, const char *txt,
+                                         MemoryPool pool) {
+    RadixTreeNode newNode = radixTreeCreateNode(pool);
+    if (newNode == NULL) {
         return NULL;
     } else {
-        RadixTreeNode newNode = radixTreeCreateNode();
-        if (newNode == NULL) {
-            charSequenceDelete(textToInsert);
+        if (radixTreeSetTxt(newNode, txt, strlen(txt), pool)
+            != RADIX_TREE_OPERATION_SUCCESS) {
+            radixTreeFreeNode(newNode, pool);
             return NULL;
         } else {
-            newNode->txt = textToInsert;
-            newNode->txtLength = charSequenceLength(textToInsert);
-
-            newNode->father = node;
-            CharSequenceIterator it = charSequenceGetIterator(newNode->txt);
-            assert(!radixTreeHasSon(node, charSequenceGetChar(&it)));
-            radixTreeChangeSon(node, charSequenceGetChar(&it),
-                               newNode);
+            atomic_init(&newNode->father, node);
+            assert(radixTreeSon(node, radixTreeSonNumber(newNode)) == NULL);
+            radixTreeChangeSon(node, radixTreeFirstChar(newNode), newNode);
+            radixTreeAddDigits(node, newNode->txtDigits);
 
             return newNode;
         }
     }
 }
 
-RadixTreeNode radixTreeInsert(RadixTree tree, const char *txt) {
+RadixTreeNode radixTreeInsert(RadixTree tree, const char *txt,
+                              MemoryPool pool, Epoch epoch) {
     RadixTreeNode insertPtr;
     const char *matchPtr;
-    CharSequenceIterator nodeMatchPtr;
+    size_t nodeMatch;
     int findResult = radixTreeFindEx(tree, txt, &insertPtr,
-                                     &matchPtr, &nodeMatchPtr);
+                                     &matchPtr, &nodeMatch);
 
     if (findResult == RADIX_TREE_FOUND) {
         return insertPtr;
     } else if (findResult == RADIX_TREE_SUBSTR) {
-        int splitResult = radixTreeSplitNode(insertPtr, &nodeMatchPtr);
-        if (splitResult == RADIX_TREE_OPERATION_SUCCESS) {
-            return insertPtr->father;
-        } else {
-            return NULL;
-        }
+        return radixTreeSplitNode(insertPtr, nodeMatch, pool, epoch);
     } else if (findResult == RADIX_TREE_NOT_FOUND) {
-        if (charSequenceGetChar(&nodeMatchPtr) != '\0') {
-            int splitResult = radixTreeSplitNode(insertPtr, &nodeMatchPtr);
-            if (splitResult == RADIX_TREE_OPERATION_SUCCESS) {
-                return radixTreeInsert(tree, txt);
+        if (nodeMatch != insertPtr->txtLength) {
+            if (radixTreeSplitNode(insertPtr, nodeMatch, pool, epoch)
+                != NULL) {
+                return radixTreeInsert(tree, txt, pool, epoch);
             } else {
                 return NULL;
             }
         } else {
-            return radixTreeInsertLeaf(insertPtr, matchPtr);
+            return radixTreeInsertLeaf(insertPtr, matchPtr, pool);
         }
     } else {
         return NULL;
     }
 }
 
+/**
+ * @brief Najbardziej lewy liść poddrzewa.
+ * @param[in] node - wskaźnik na korzeń poddrzewa.
+ * @return Wskaźnik na liść osiągany przez przechodzenie do synów
+ *         o najmniejszym numerze.
+ */
+static RadixTreeNode radixTreeLeftmostLeaf(RadixTreeNode node) {
+    RadixTreeNode son = radixTreeNextSon(node, 0);
+    while (son != NULL) {
+        node = son;
+        son = radixTreeNextSon(node, 0);
+    }
+    return node;
+}
+
+/**
+ * @brief Usuwa węzeł odłączony od drzewa.
+ * Wywołuje f(dane_węzła, @p fData) jeżeli węzeł przechowuje dane,
+ * a następnie przekazuje węzeł do @ref epochRetire.
+ * @param[in] node - wskaźnik na węzeł.
+ * @param[in] f - wskaźnik na funkcję czyszczącą.
+ * @param fData - dane pomocnicze do funkcji czyszczącej.
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ * @param[in, out] epoch - wskaźnik na strukturę epok czytelników drzewa.
+ */
+static void radixTreeRetireNode(RadixTreeNode node,
+                                void (*f)(void *, void *), void *fData,
+                                MemoryPool pool, Epoch epoch) {
+    void *data = radixTreeGetNodeData(node);
+    if (data != NULL) {
+        f(data, fData);
+    }
+    epochRetire(epoch, node, radixTreeReclaimNode, pool);
+}
+
 void radixTreeDeleteSubTree(RadixTreeNode subTreeNode,
                             void (*f)(void *, void *),
-                            void *fData) {
-    RadixTreeNode pos = subTreeNode, tmp;
-    pos->foldI = 0;
-
-    while (!(pos == subTreeNode
-             && pos->foldI == RADIX_TREE_NUMBER_OF_SONS)) {
-        size_t *i = &pos->foldI;
-        if (*i == RADIX_TREE_NUMBER_OF_SONS) {
-            if (pos->data != NULL) {
-                f(pos->data, fData);
-                pos->data = NULL;
-            }
-            tmp = pos;
-            pos = pos->father;
-            CharSequenceIterator it = charSequenceGetIterator(tmp->txt);
-            radixTreeChangeSon(pos, charSequenceGetChar(&it), NULL);
-            radixTreeFreeNode(tmp);
+                            void *fData, MemoryPool pool, Epoch epoch) {
+    RadixTreeNode father = radixTreeFather(subTreeNode);
+    if (father != NULL) {
+        radixTreeChangeSon(father, radixTreeFirstChar(subTreeNode), NULL);
+        radixTreeUpdatePath(father);
+    }
 
+    RadixTreeNode pos = radixTreeLeftmostLeaf(subTreeNode), next;
+    while (pos != subTreeNode) {
+        father = radixTreeFather(pos);
+        next = radixTreeNextSon(father, radixTreeSonNumber(pos) + 1);
+        radixTreeRetireNode(pos, f, fData, pool, epoch);
+        if (next != NULL) {
+            pos = radixTreeLeftmostLeaf(next);
         } else {
-            if (pos->sons[*i] != NULL) {
-                pos = pos->sons[*i];
-                pos->foldI = 0;
+            pos = father;
+        }
+    }
+    radixTreeRetireNode(subTreeNode, f, fData, pool, epoch);
+}
+
+void radixTreeDelete(RadixTree tree, void (*f)(void *, void *), void *fData,
+                     MemoryPool pool) {
+    radixTreeDeleteSubTree(tree, f, fData, pool, NULL);
+}
+
+void radixTreeEmptyDelFunction(void *ptrA, void *ptrB) {
+    (void) ptrA;
+    (void) ptrB;
+}
+
+/**
+ * @brief Początkowy rozmiar stosu w @ref radixTreeInsertSorted.
+ */
+#define RADIX_TREE_INITIAL_STACK_SIZE 64
+
+/**
+ * @brief Element stosu węzłów w @ref radixTreeInsertSorted.
+ * Stos przechowuje ścieżkę od korzenia do ostatnio wstawionego numeru.
+ * Węzeł na stosie nie ma jeszcze numeru na krawędzi i nie jest
+ * dołączony do ojca, dostaje je dopiero przy zdjęciu ze stosu.
+ */
+struct RadixTreeStackItem {
+    /**
+     * @brief Wskaźnik na węzeł.
+     */
+    RadixTreeNode node;
+
+    /**
+     * @brief Długość numeru reprezentowanego przez węzeł.
+     */
+    size_t depth;
+
+    /**
+     * @brief Numer, którego prefiksem długości @p depth jest numer
+     * reprezentowany przez węzeł.
+     */
+    const char *txt;
+};
+
+/**
+ * @brief Stos węzłów w @ref radixTreeInsertSorted.
+ */
+struct RadixTreeStack {
+    /**
+     * @brief Elementy stosu, na dnie korzeń drzewa.
+     */
+    struct RadixTreeStackItem *items;
+
+    /**
+     * @brief Liczba elementów stosu.
+     */
+    size_t size;
+
+    /**
+     * @brief Rozmiar tablicy @p items.
+     */
+    size_t capacity;
+
+    /**
+     * @brief Synowie korzenia, dołączani do niego dopiero
+     * po zbudowaniu wszystkich poddrzew.
+     */
+    RadixTreeNode rootSons[RADIX_TREE_NUMBER_OF_SONS];
+};
+
+/**
+ * @brief Odkłada węzeł na stos.
+ * @param[in, out] stack - wskaźnik na stos.
+ * @param[in] node - wskaźnik na węzeł.
+ * @param[in] depth - długość numeru reprezentowanego przez węzeł.
+ * @param[in] txt - numer, którego prefiksem jest numer węzła.
+ * @return RADIX_TREE_OPERATION_FAIL w przypadku problemów z pamięcią,
+ *         w przeciwnym przypadku RADIX_TREE_OPERATION_SUCCESS.
+ */
+static int radixTreeStackPush(struct RadixTreeStack *stack, RadixTreeNode node,
+                              size_t depth, const char *txt) {
+    if (stack->size == stack->capacity) {
+        struct RadixTreeStackItem *grown =
+                realloc(stack->items, 2 * stack->capacity
+                                      * sizeof(struct RadixTreeStackItem));
+        if (grown == NULL) {
+            return RADIX_TREE_OPERATION_FAIL;
+        }
+        stack->items = grown;
+        stack->capacity *= 2;
+    }
+    stack->items[stack->size].node = node;
+    stack->items[stack->size].depth = depth;
+    stack->items[stack->size].txt = txt;
+    stack->size++;
+    return RADIX_TREE_OPERATION_SUCCESS;
+}
+
+/**
+ * @brief Zdejmuje węzeł ze stosu i dołącza go do ojca.
+ * Ojcem zostaje węzeł na szczycie stosu, a jeżeli reprezentuje on numer
+ * krótszy niż @p depth, nowy węzeł reprezentujący prefiks długości
+ * @p depth, który trafia na stos. Synowie korzenia są zapamiętywani
+ * w RadixTreeStack->rootSons.
+ * @param[in, out] stack - wskaźnik na stos (co najmniej dwa elementy).
+ * @param[in] depth - najmniejsza długość numeru ojca.
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ * @param[out] orphan - @p *orphan wskazuje na zdjęty węzeł, jeżeli nie udało
+ *        się go dołączyć, w przeciwnym przypadku NULL.
+ * @return RADIX_TREE_OPERATION_FAIL w przypadku problemów z pamięcią,
+ *         w przeciwnym przypadku RADIX_TREE_OPERATION_SUCCESS.
+ */
+static int radixTreeStackPop(struct RadixTreeStack *stack, size_t depth,
+                             MemoryPool pool, RadixTreeNode *orphan) {
+    struct RadixTreeStackItem item = stack->items[--stack->size];
+    struct RadixTreeStackItem *top = &stack->items[stack->size - 1];
+    *orphan = item.node;
+
+    if (top->depth < depth) {
+        RadixTreeNode middle = radixTreeCreateNode(pool);
+        if (middle == NULL
+            || radixTreeStackPush(stack, middle, depth, item.txt)
+               != RADIX_TREE_OPERATION_SUCCESS) {
+            if (middle != NULL) {
+                radixTreeFreeNode(middle, pool);
             }
-            (*i)++;
+            return RADIX_TREE_OPERATION_FAIL;
         }
+        top = &stack->items[stack->size - 1];
     }
 
-    if (subTreeNode->data != NULL) {
-        f(subTreeNode->data, fData);
-        subTreeNode->data = NULL;
+    if (radixTreeSetTxt(item.node, item.txt + top->depth,
+                        item.depth - top->depth, pool)
+        != RADIX_TREE_OPERATION_SUCCESS) {
+        return RADIX_TREE_OPERATION_FAIL;
     }
-    if (!radixTreeIsRoot(subTreeNode)) {
-        CharSequenceIterator it = charSequenceGetIterator(subTreeNode->txt);
-        radixTreeChangeSon(subTreeNode->father,
-                           charSequenceGetChar(&it), NULL);
+    radixTreeUpdateSummary(item.node);
+    size_t son = radixTreeSonNumber(item.node);
+    if (stack->size == 1) {
+        stack->rootSons[son] = item.node;
+    } else {
+        atomic_init(&item.node->father, top->node);
+        atomic_init(&top->node->sons[son], item.node);
     }
-    radixTreeFreeNode(subTreeNode);
+    *orphan = NULL;
+    return RADIX_TREE_OPERATION_SUCCESS;
 }
 
-void radixTreeDelete(RadixTree tree, void (*f)(void *, void *), void *fData) {
-    radixTreeDeleteSubTree(tree, f, fData);
+/**
+ * @brief Usuwa węzły zbudowane przez nieudane @ref radixTreeInsertSorted.
+ * Dane przechowywane przez węzły nie są zwalniane.
+ * @param[in, out] stack - wskaźnik na stos.
+ * @param[in] orphan - wskaźnik na węzeł zdjęty ze stosu i nie dołączony
+ *        do ojca lub NULL.
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ */
+static void radixTreeStackDelete(struct RadixTreeStack *stack,
+                                 RadixTreeNode orphan, MemoryPool pool) {
+    size_t i;
+    for (i = 1; i < stack->size; i++) {
+        radixTreeDeleteSubTree(stack->items[i].node, radixTreeEmptyDelFunction,
+                               NULL, pool, NULL);
+    }
+    if (orphan != NULL) {
+        radixTreeDeleteSubTree(orphan, radixTreeEmptyDelFunction, NULL, pool,
+                               NULL);
+    }
+    for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
+        if (stack->rootSons[i] != NULL) {
+            radixTreeDeleteSubTree(stack->rootSons[i],
+                                   radixTreeEmptyDelFunction, NULL, pool,
+                                   NULL);
+        }
+    }
+    free(stack->items);
 }
 
-void radixTreeEmptyDelFunction(void *ptrA, void *ptrB) {
-    (void) ptrA;
-    (void) ptrB;
+/**
+ * @brief Długość najdłuższego wspólnego prefiksu dwóch numerów.
+ * @param[in] a - wskaźnik na numer.
+ * @param[in] b - wskaźnik na numer.
+ * @return Długość najdłuższego wspólnego prefiksu @p a i @p b.
+ */
+static size_t radixTreeCommonPrefix(const char *a, const char *b) {
+    size_t result = 0;
+    while (a[result] != '\0' && a[result] == b[result]) {
+        result++;
+    }
+    return result;
 }
 
-void *radixTreeGetNodeData(RadixTreeNode node) {
-    return node->data;
+/**
+ * @brief Wstawia kolejny numer w @ref radixTreeInsertSorted.
+ * Zdejmuje ze stosu węzły nie będące prefiksami @p txt i odkłada na niego
+ * liść reprezentujący @p txt.
+ * @param[in, out] stack - wskaźnik na stos.
+ * @param[in] txt - wskaźnik na numer większy od poprzednio wstawionego.
+ * @param[in] common - długość wspólnego prefiksu @p txt i poprzednio
+ *        wstawionego numeru.
+ * @param[in] data - dane przypisywane liściowi.
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ * @param[out] orphan - patrz @ref radixTreeStackPop.
+ * @return Wskaźnik na liść, NULL w przypadku problemów z pamięcią.
+ */
+static RadixTreeNode radixTreeStackInsert(struct RadixTreeStack *stack,
+                                          const char *txt, size_t common,
+                                          void *data, MemoryPool pool,
+                                          RadixTreeNode *orphan) {
+    while (stack->items[stack->size - 1].depth > common) {
+        if (radixTreeStackPop(stack, common, pool, orphan)
+            != RADIX_TREE_OPERATION_SUCCESS) {
+            return NULL;
+        }
+    }
+
+    size_t length = common + strlen(txt + common);
+    assert(stack->items[stack->size - 1].depth == common && common < length);
+    RadixTreeNode leaf = radixTreeCreateNode(pool);
+    if (leaf == NULL) {
+        return NULL;
+    } else if (radixTreeStackPush(stack, leaf, length, txt)
+               != RADIX_TREE_OPERATION_SUCCESS) {
+        radixTreeFreeNode(leaf, pool);
+        return NULL;
+    } else {
+        atomic_init(&leaf->data, data);
+        return leaf;
+    }
 }
 
-RadixTreeNode radixTreeFather(RadixTreeNode node) {
-    return node->father;
+bool radixTreeInsertSorted(RadixTree tree, const char *const *txts,
+                           void *const *data, RadixTreeNode *nodes, size_t n,
+                           MemoryPool pool) {
+    struct RadixTreeStack stack;
+    RadixTreeNode orphan = NULL, leaf;
+    size_t i;
+
+    assert(!radixTreeHasSons(tree) && radixTreeGetNodeData(tree) == NULL);
+    memset(stack.rootSons, 0, sizeof(stack.rootSons));
+    stack.size = 0;
+    stack.capacity = RADIX_TREE_INITIAL_STACK_SIZE;
+    stack.items = malloc(stack.capacity * sizeof(struct RadixTreeStackItem));
+    if (stack.items == NULL) {
+        return false;
+    }
+    radixTreeStackPush(&stack, tree, 0, "");
+
+    for (i = 0; i < n; i++) {
+        leaf = radixTreeStackInsert(
+                &stack, txts[i],
+                i == 0 ? 0 : radixTreeCommonPrefix(txts[i - 1], txts[i]),
+                data[i], pool, &orphan);
+        if (leaf == NULL) {
+            radixTreeStackDelete(&stack, orphan, pool);
+            return false;
+        } else if (nodes != NULL) {
+            nodes[i] = leaf;
+        }
+    }
+
+    while (stack.size > 1) {
+        if (radixTreeStackPop(&stack, 0, pool, &orphan)
+            != RADIX_TREE_OPERATION_SUCCESS) {
+            radixTreeStackDelete(&stack, orphan, pool);
+            return false;
+        }
+    }
+
+    for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
+        if (stack.rootSons[i] != NULL) {
+            radixTreeSetFather(stack.rootSons[i], tree);
+            radixTreeSetSon(tree, i, stack.rootSons[i]);
+        }
+    }
+    radixTreeUpdateSummary(tree);
+    free(stack.items);
+    return true;
+}
+
+void radixTreeMoveSons(RadixTree tree, RadixTree from) {
+    size_t i;
+    RadixTreeNode son;
+    for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
+        son = radixTreeSon(from, i);
+        if (son != NULL) {
+            assert(radixTreeSon(tree, i) == NULL);
+            radixTreeSetSon(from, i, NULL);
+            radixTreeSetFather(son, tree);
+            radixTreeSetSon(tree, i, son);
+        }
+    }
+    radixTreeUpdatePath(from);
+    radixTreeUpdatePath(tree);
+}
+
+void *radixTreeGetNodeData(RadixTreeNode node) {
+    return atomic_load_explicit(&node->data, memory_order_acquire);
 }
 
 /**
@@ -579,49 +1404,124 @@ RadixTreeNode radixTreeFather(RadixTreeNode node) {
  * @return Wskaźnik na pierwszego syna węzła @p node.
  */
 static RadixTreeNode radixTreeFirstSon(RadixTreeNode node) {
-    size_t i;
-    for (i = 0; i < RADIX_TREE_NUMBER_OF_SONS; i++) {
-        if (node->sons[i] != NULL) {
-            return node->sons[i];
-        }
-    }
-    return NULL;
+    return radixTreeNextSon(node, 0);
 }
 
 /**
- * @brief Próbuje scalić węzeł @p a z węzłem @p b.
+ * @brief Próbuje scalić węzeł @p a z węzłem @p b w miejscu.
  * @remarks Zakłada że węzeł @p a spełnia
  *          predykat radixTreeCanBeMergedWithSon
  * @see radixTreeCanBeMergedWithSon
  * @remarks Adres węzła ba nie ulega zmianie.
  * @param[in] a - wskaźnik na węzeł (zostanie usunięty po scaleniu).
  * @param[in] b - wskaźnik na węzeł (zostanie tym scalonym).
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
  * @return  W przypadku problemów RADIX_TREE_OPERATION_FAIL,
  *          w przeciwnym przypadku RADIX_TREE_OPERATION_SUCCESS.
  */
-static int radixTreeMerge(RadixTreeNode a, RadixTreeNode b) {
-    assert(charSequenceLength(b->txt) != 0);
-    assert(charSequenceLength((b->txt)) == b->txtLength);
-    assert(charSequenceLength((a->txt)) == a->txtLength);
+static int radixTreeMergeInPlace(RadixTreeNode a, RadixTreeNode b,
+                                 MemoryPool pool) {
+    assert(b->txtLength != 0);
+
+    if (radixTreeIsTxtPacked(a) && radixTreeIsTxtPacked(b)
+        && a->txtLength + b->txtLength <= RADIX_TREE_INLINE_TXT_LENGTH) {
+        b->packedTxt = a->packedTxt
+                       | (b->packedTxt
+                          << (RADIX_TREE_PACKED_CHAR_BITS * a->txtLength));
+    } else {
+        if (radixTreeUnpackTxt(a, pool) != RADIX_TREE_OPERATION_SUCCESS) {
+            return RADIX_TREE_OPERATION_FAIL;
+        }
+        if (radixTreeUnpackTxt(b, pool) != RADIX_TREE_OPERATION_SUCCESS) {
+            radixTreePackTxt(a, pool);
+            return RADIX_TREE_OPERATION_FAIL;
+        }
+        assert(charSequenceLength((b->txt)) == b->txtLength);
+        assert(charSequenceLength((a->txt)) == a->txtLength);
 
-    charSequenceMerge(a->txt, b->txt);
-    b->txt = a->txt;
+        charSequenceMerge(a->txt, b->txt, pool);
+        b->txt = a->txt;
+        a->txt = NULL;
+    }
     b->txtLength += a->txtLength;
-    a->txt = NULL;
+    b->txtDigits |= a->txtDigits;
     a->txtLength = 0;
 
-    assert(charSequenceLength(b->txt) != 0);
-
-    b->father = a->father;
-    CharSequenceIterator it = charSequenceGetIterator(b->txt);
-    radixTreeChangeSon(a->father, charSequenceGetChar(&it), b);
-    radixTreeFreeNode(a);
+    RadixTreeNode father = radixTreeFather(a);
+    radixTreeSetFather(b, father);
+    radixTreeChangeSon(father, radixTreeFirstChar(b), b);
+    radixTreeFreeNode(a, pool);
 
     return RADIX_TREE_OPERATION_SUCCESS;
 
 }
 
-void radixTreeBalance(RadixTreeNode node) {
+/**
+ * @brief Próbuje scalić węzeł @p a z węzłem @p b bez modyfikowania ich.
+ * Zastępuje oba węzły nowym węzłem z numerem będącym złączeniem ich
+ * numerów oraz danymi i synami @p b. Węzły @p a i @p b zostają przekazane
+ * do @ref epochRetire.
+ * @remarks Zakłada że węzeł @p a spełnia
+ *          predykat radixTreeCanBeMergedWithSon
+ * @param[in] a - wskaźnik na węzeł.
+ * @param[in] b - wskaźnik na jedynego syna @p a.
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ * @param[in, out] epoch - wskaźnik na strukturę epok czytelników drzewa.
+ * @return  W przypadku problemów RADIX_TREE_OPERATION_FAIL,
+ *          w przeciwnym przypadku RADIX_TREE_OPERATION_SUCCESS.
+ */
+static int radixTreeMergeCopy(RadixTreeNode a, RadixTreeNode b,
+                              MemoryPool pool, Epoch epoch) {
+    size_t length = a->txtLength + b->txtLength;
+    char local[2 * RADIX_TREE_INLINE_TXT_LENGTH + 1];
+    char *txt = radixTreeTxtBuffer(local, length);
+    if (txt == NULL) {
+        return RADIX_TREE_OPERATION_FAIL;
+    }
+    radixTreeCopyTxt(a, txt);
+    radixTreeCopyTxt(b, txt + a->txtLength);
+    txt[length] = '\0';
+
+    RadixTreeNode father = radixTreeFather(a);
+    RadixTreeNode merged = radixTreeCopyNode(b, father, txt, length, pool);
+    if (txt != local) {
+        free(txt);
+    }
+
+    if (merged == NULL) {
+        return RADIX_TREE_OPERATION_FAIL;
+    } else {
+        radixTreeChangeSon(father, radixTreeFirstChar(merged), merged);
+        radixTreeAdoptSons(merged);
+        epochRetire(epoch, a, radixTreeReclaimNode, pool);
+        epochRetire(epoch, b, radixTreeReclaimNode, pool);
+        return RADIX_TREE_OPERATION_SUCCESS;
+    }
+}
+
+/**
+ * @brief Próbuje scalić węzeł @p a z węzłem @p b.
+ * @see radixTreeMergeInPlace
+ * @see radixTreeMergeCopy
+ * @param[in] a - wskaźnik na węzeł spełniający predykat
+ *        radixTreeCanBeMergedWithSon.
+ * @param[in] b - wskaźnik na jedynego syna @p a.
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ * @param[in, out] epoch - wskaźnik na strukturę epok czytelników drzewa,
+ *        NULL jeżeli węzły mogą zostać zmodyfikowane w miejscu.
+ * @return  W przypadku problemów RADIX_TREE_OPERATION_FAIL,
+ *          w przeciwnym przypadku RADIX_TREE_OPERATION_SUCCESS.
+ */
+static int radixTreeMerge(RadixTreeNode a, RadixTreeNode b, MemoryPool pool,
+                          Epoch epoch) {
+    if (epoch == NULL) {
+        return radixTreeMergeInPlace(a, b, pool);
+    } else {
+        return radixTreeMergeCopy(a, b, pool, epoch);
+    }
+}
+
+void radixTreeBalance(RadixTreeNode node, MemoryPool pool, Epoch epoch) {
     RadixTreeNode pos = node, tmp;
     size_t skipped = 0;
     const size_t canSkip = 5;
@@ -630,19 +1530,20 @@ void radixTreeBalance(RadixTreeNode node) {
            && skipped <= canSkip) {
         if (radixTreeIsNodeRedundant(pos)) {
             tmp = pos;
-            pos = pos->father;
-            CharSequenceIterator it = charSequenceGetIterator(tmp->txt);
-            radixTreeChangeSon(pos, charSequenceGetChar(&it), NULL);
-            radixTreeFreeNode(tmp);
+            pos = radixTreeFather(pos);
+            radixTreeChangeSon(pos, radixTreeFirstChar(tmp), NULL);
+            radixTreeUpdatePath(pos);
+            epochRetire(epoch, tmp, radixTreeReclaimNode, pool);
         } else if (radixTreeCanBeMergedWithSon(pos)) {
             tmp = pos;
-            pos = pos->father;
-            int mergeResult = radixTreeMerge(tmp, radixTreeFirstSon(tmp));
+            pos = radixTreeFather(pos);
+            int mergeResult = radixTreeMerge(tmp, radixTreeFirstSon(tmp),
+                                             pool, epoch);
             if (mergeResult != RADIX_TREE_OPERATION_SUCCESS) {
                 skipped++;
             }
         } else {
-            pos = pos->father;
+            pos = radixTreeFather(pos);
             skipped++;
         }
     }
@@ -650,7 +1551,8 @@ void radixTreeBalance(RadixTreeNode node) {
 }
 
 void radixTreeSetData(RadixTreeNode node, void *ptr) {
-    node->data = ptr;
+    atomic_store_explicit(&node->data, ptr, memory_order_release);
+    radixTreeUpdatePath(node);
 }
 
 int radixTreeFindLite(RadixTree tree, const char *txt, RadixTreeNode *ptr) {
@@ -660,63 +1562,58 @@ int radixTreeFindLite(RadixTree tree, const char *txt, RadixTreeNode *ptr) {
     return radixTreeFind(tree, txt, ptr, &unused1, &unused2, &unused3);
 }
 
-char *radixGetFullText(RadixTreeNode node) {
+size_t radixTreeFullTextLength(RadixTreeNode node) {
     RadixTreeNode pos = node;
     size_t length = 0;
 
     while (!radixTreeIsRoot(pos)) {
-        length += radixTreeHowManyChars(pos);
+        length += pos->txtLength;
+        pos = radixTreeFather(pos);
+    }
+    return length;
+}
+
+void radixTreeCopyFullText(RadixTreeNode node, size_t length, char *out) {
+    RadixTreeNode pos = node;
+    while (!radixTreeIsRoot(pos)) {
+        assert(length >= pos->txtLength);
+        length -= pos->txtLength;
+        radixTreeCopyTxt(pos, out + length);
         pos = radixTreeFather(pos);
     }
+    assert(length == 0);
+}
+
+char *radixGetFullText(RadixTreeNode node) {
+    size_t length = radixTreeFullTextLength(node);
 
     char *result = malloc(length + (size_t) 1);
     if (result == NULL) {
         return NULL;
     } else {
         result[length] = '\0';
-        pos = node;
-        while (!radixTreeIsRoot(pos)) {
-            assert(pos->txtLength == charSequenceLength(pos->txt));
-            size_t len = pos->txtLength;
-            size_t i;
-            length -= len;
-            CharSequenceIterator ptr = charSequenceGetIterator(pos->txt);
-            char out;
-            for (i = 0; i < len; i++) {
-                charSequenceNextChar(&ptr, &out);
-                result[length + i] = out;
-            }
-            pos = radixTreeFather(pos);
-        }
+        radixTreeCopyFullText(node, length, result);
         return result;
     }
 
 }
 
 void radixTreeFold(RadixTree tree, void (*f)(void *, void *), void *fData) {
+    RadixTreeNode pos = tree, next;
 
-    RadixTreeNode pos = tree;
-    pos->foldI = 0;
-
-    while (!(pos == tree
-             && pos->foldI == RADIX_TREE_NUMBER_OF_SONS)) {
-        size_t *i = &pos->foldI;
-        if (*i == 0) {
-            if (pos->data != NULL) {
-                f(pos->data, fData);
-            }
+    while (pos != NULL) {
+        void *data = radixTreeGetNodeData(pos);
+        if (data != NULL) {
+            f(data, fData);
         }
 
-        if (*i == RADIX_TREE_NUMBER_OF_SONS) {
-            pos = pos->father;
-
-        } else {
-            if (pos->sons[*i] != NULL) {
-                pos = pos->sons[*i];
-                pos->foldI = 0;
-            }
-            (*i)++;
+        next = radixTreeNextSon(pos, 0);
+        while (next == NULL && pos != tree) {
+            next = radixTreeNextSon(radixTreeFather(pos),
+                                    radixTreeSonNumber(pos) + 1);
+            pos = radixTreeFather(pos);
         }
+        pos = next;
     }
 }
 
@@ -751,22 +1648,50 @@ static size_t radixTreeNonTrivialCountCount(size_t lettersLeft,
 }
 
 /**
- * Sprawdza czy część numeru reprezentowana przez seq
- * składa się tylko z cyfr opisywanych przez @p availableDigits.
- * @param[in] seq - ciąg cyfr.
- * @param[in] availableDigits - dostępne cyfry. Tablica wartości bool,
- *       gdzie @p digits[i] = true
- *       oznacza, że cyfra o numerze i (kod_ascii - '0') jest dostępna,
- *       a false, że nie.
- * @return true jeżeli tak, false w przeciwnym wypadku.
+ * @brief Rozpatruje syna w @ref radixTreeNonTrivialCount.
+ * Dolicza do @p *result numery, których prefiksem jest numer reprezentowany
+ * przez @p node lub któryś z jego potomków, jeżeli można je policzyć na
+ * podstawie podsumowania poddrzewa @p node. Poddrzewa bez węzłów z danymi
+ * na głębokości co najwyżej @p maxLen oraz poddrzewa, których krawędź
+ * wchodząca zawiera niedostępną cyfrę, są pomijane.
+ * @param[in] node - wskaźnik na węzeł.
+ * @param[in] len - długość numeru reprezentowanego przez ojca @p node.
+ * @param[in] maxLen - szukana długość numeru.
+ * @param[in] availableDigits - maska dostępnych cyfr
+ *        (patrz RadixTreeNode->txtDigits).
+ * @param[in] howManyDigitsAvailable - liczba różnych dostępnych cyfr.
+ * @param[in, out] result - wskaźnik na wynik.
+ * @return true jeżeli należy rozpatrzyć synów węzła @p node,
+ *         false w przeciwnym przypadku.
  */
-static bool radixTreeNonTrivialCountCheck(CharSequence seq,
-                                          const bool *availableDigits) {
+static bool radixTreeNonTrivialCountVisit(RadixTreeNode node, size_t len,
+                                          size_t maxLen,
+                                          uint16_t availableDigits,
+                                          size_t howManyDigitsAvailable,
+                                          size_t *result) {
+    const struct RadixTreeSummary *summary = &node->summary;
+    if (summary->dataCount == 0
+        || node->txtLength > maxLen - len
+        || summary->dataDepth > maxLen - len - node->txtLength
+        || (node->txtDigits & ~availableDigits) != 0) {
+        return false;
+    }
 
-    return charSequenceCheckDigits(seq, availableDigits);
+    len += node->txtLength;
+    if (radixTreeGetNodeData(node) != NULL) {
+        *result += radixTreeNonTrivialCountCount(maxLen - len,
+                                                 howManyDigitsAvailable);
+        return false;
+    } else if ((summary->digits & ~availableDigits) == 0
+               && summary->dataAtDepth == summary->dataCount) {
+        *result += summary->dataCount * radixTreeNonTrivialCountCount(
+                maxLen - len - summary->dataDepth, howManyDigitsAvailable);
+        return false;
+    } else {
+        return true;
+    }
 }
 
-
 size_t radixTreeNonTrivialCount(RadixTree tree, size_t maxLen,
                                 const bool *availableDigits,
                                 size_t howManyDigitsAvailable) {
@@ -774,58 +1699,41 @@ size_t radixTreeNonTrivialCount(RadixTree tree, size_t maxLen,
     assert(maxLen != 0);
     size_t result = 0;
     size_t len = 0;
-    RadixTreeNode pos = tree;
-    pos->foldI = 0;
-    pos->helper = 0;
-
-    while (!(pos == tree
-             && pos->foldI == RADIX_TREE_NUMBER_OF_SONS)) {
-        size_t *i = &pos->foldI;
-
-
-        if (*i == 0 && pos != tree) {
-            bool isGreater = false;
-            assert(charSequenceLengthLimited(pos->txt, maxLen - len,
-                                             &isGreater)
-                   == MIN(pos->txtLength, maxLen - len));
-
-            pos->helper = MIN(pos->txtLength, maxLen - len);
-            if (pos->txtLength > maxLen - len) {
-                isGreater = true;
-            } else {
-                isGreater = false;
-            }
+    size_t from = 0;
+    RadixTreeNode pos = tree, son, next;
+    uint16_t digits = 0;
 
-            len += pos->helper;
-            assert(len <= maxLen);
-            if (isGreater
-                || !radixTreeNonTrivialCountCheck(pos->txt, availableDigits)) {
-                *i = RADIX_TREE_NUMBER_OF_SONS;
-            } else {
-                if (pos->data != NULL) {
-                    result += radixTreeNonTrivialCountCount(maxLen - len,
-                                                            howManyDigitsAvailable);
-                    *i = RADIX_TREE_NUMBER_OF_SONS;
-                }
-
-                if (maxLen == len) {
-                    *i = RADIX_TREE_NUMBER_OF_SONS;
-                }
+    for (from = 0; from < RADIX_TREE_NUMBER_OF_SONS; from++) {
+        if (availableDigits[from]) {
+            digits |= (uint16_t) (1u << from);
+        }
+    }
+    from = 0;
+
+    while (true) {
+        son = NULL;
+        while (son == NULL && from < RADIX_TREE_NUMBER_OF_SONS) {
+            next = radixTreeSon(pos, from);
+            if (next != NULL && availableDigits[from]
+                && radixTreeNonTrivialCountVisit(next, len,
+                                                 maxLen, digits,
+                                                 howManyDigitsAvailable,
+                                                 &result)) {
+                son = next;
             }
+            from++;
         }
 
-        if (*i == RADIX_TREE_NUMBER_OF_SONS) {
-            len -= pos->helper;
-            pos = pos->father;
+        if (son != NULL) {
+            pos = son;
+            len += pos->txtLength;
+            from = 0;
+        } else if (pos == tree) {
+            return result;
         } else {
-            if (pos->sons[*i] != NULL
-                && availableDigits[*i]) {
-                pos = pos->sons[*i];
-                pos->foldI = 0;
-                pos->helper = 0;
-            }
-            (*i)++;
+            from = radixTreeSonNumber(pos) + 1;
+            len -= pos->txtLength;
+            pos = radixTreeFather(pos);
         }
     }
-    return result;
 }
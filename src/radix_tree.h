@@ -4,6 +4,16 @@
  * https://en.wikipedia.org/wiki/Radix_tree
  * @remarks Drzewo samo się nie balansuje.
  *
+ * Funkcje modyfikujące drzewo przyjmują strukturę epok. Jeżeli jest ona
+ * równa NULL, węzły są modyfikowane w miejscu i zwalniane od razu, a adresy
+ * węzłów przechowujących dane nie zmieniają się. W przeciwnym przypadku
+ * węzły dołączone do drzewa nie są modyfikowane poza ich danymi i synami:
+ * zmieniane węzły są zastępowane kopiami, a stare przekazywane do
+ * @ref epochRetire. Pozwala to czytelnikom przebywającym w epoce
+ * przeszukiwać drzewo (@ref radixTreeFind, @ref radixTreeFather,
+ * @ref radixTreeGetNodeData) współbieżnie z jednym pisarzem, ale adresy
+ * węzłów mogą się wtedy zmieniać.
+ *
  * @author Konrad Staniszewski
  * @copyright Konrad Staniszewski
  * @date 04.05.2018
@@ -16,6 +26,8 @@
 #include <stdbool.h>
 #include "character.h"
 #include "char_sequence.h"
+#include "memory_pool.h"
+#include "epoch.h"
 
 /**
  * @see RadixTreeNode
@@ -32,11 +44,6 @@
  */
 #define RADIX_TREE_NODE_MATCH_PARTIAL 0
 
-/**
- * @see RadixTreeNode
- */
-#define RADIX_TREE_ROOT_TXT "r"
-
 /**
  * @see radixTreeFind
  */
@@ -73,14 +80,18 @@ struct RadixTreeNode;
  * @brief Tworzy drzewo i inicjuje je.
  * #### Złożoność
  * O(1)
+ * @param[in, out] pool - pula z której będą przydzielane węzły drzewa.
  * @return Wskaźnik na stworzone drzewo, w przypadku
  *         problemów z pamięcią NULL.
  */
-RadixTree radixTreeCreate();
+RadixTree radixTreeCreate(MemoryPool pool);
 
 /**
  * @brief Sprawdza, czy @p node jest korzeniem drzewa.
- * Sprzawdza, czy @p node jest węzłem reprezentującym drzewo.
+ * Sprzawdza, czy @p node jest węzłem reprezentującym drzewo
+ * (jedynym węzłem bez ojca).
+ * #### Złożoność
+ * O(1)
  * @param[in] node - wskaźnik na węzeł drzewa.
  * @return Niezerowa wartość w przypadku gdy @p node jest korzeniem,
  *         zero w przeciwnym wypadku.
@@ -93,6 +104,17 @@ int radixTreeIsRoot(RadixTreeNode node);
  */
 size_t radixTreeHowManyChars(RadixTreeNode node);
 
+/**
+ * @brief Kopiuje numer krawędzi wchodzącej do @p node do @p out.
+ * Nie dopisuje '\0'.
+ * #### Złożoność
+ * O(długość numeru)
+ * @param[in] node - wskaźnik na węzeł.
+ * @param[out] out - wskaźnik na bufor o rozmiarze co najmniej
+ *       radixTreeHowManyChars(@p node).
+ */
+void radixTreeCopyTxt(RadixTreeNode node, char *out);
+
 /**
  * @brief Wyszukuje węzeł reprezentujący @p txt.
  * @param[in] tree - wskaźnik na drzewo.
@@ -140,11 +162,52 @@ int radixTreeFindLite(RadixTree tree, const char *txt, RadixTreeNode *ptr);
  * @see radixGetFullText
  * @param[in, out] tree - wskaźnik na drzewo.
  * @param[in] txt - wskaźnik na tekst reprezentujący numer.
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ * @param[in, out] epoch - wskaźnik na strukturę epok czytelników drzewa
+ *        lub NULL.
  * @return Wskaźnik do węzła dla którego wywołanie
  *         radixGetFullText zwróci @p txt,
  *         w przypadku problemów z przydzieleniem pamięci NULL.
  */
-RadixTreeNode radixTreeInsert(RadixTree tree, const char *txt);
+RadixTreeNode radixTreeInsert(RadixTree tree, const char *txt,
+                              MemoryPool pool, Epoch epoch);
+
+/**
+ * @brief Wstawia do pustego drzewa posortowane numery.
+ * Buduje drzewo od liści w jednym przejściu po numerach, bez rozcinania
+ * krawędzi. Poddrzewa są dołączane do korzenia dopiero po zbudowaniu
+ * wszystkich, więc czytelnicy (patrz @ref radixTreeFind) mogą przeszukiwać
+ * drzewo w trakcie budowy.
+ * #### Złożoność
+ * O(łączna długość numerów)
+ * @param[in, out] tree - wskaźnik na drzewo bez synów i danych.
+ * @param[in] txts - tablica @p n różnych numerów, posortowanych rosnąco
+ *        według strcmp.
+ * @param[in] data - tablica @p n wskaźników na dane, data[i] zostanie
+ *        przypisane węzłowi reprezentującemu txts[i].
+ * @param[out] nodes - tablica @p n wskaźników, w której nodes[i] zostanie
+ *        ustawione na węzeł reprezentujący txts[i], NULL jeżeli niepotrzebna.
+ * @param[in] n - liczba numerów.
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią
+ *         (drzewo pozostaje wtedy puste).
+ */
+bool radixTreeInsertSorted(RadixTree tree, const char *const *txts,
+                           void *const *data, RadixTreeNode *nodes, size_t n,
+                           MemoryPool pool);
+
+/**
+ * @brief Przenosi synów korzenia @p from do korzenia @p tree.
+ * Pozwala zbudować poddrzewa osobno (np. w różnych wątkach, patrz
+ * @ref radixTreeInsertSorted) i dołączyć je do drzewa na końcu. Każde
+ * poddrzewo staje się widoczne dla czytelników w całości.
+ * #### Złożoność
+ * O(1)
+ * @param[in, out] tree - wskaźnik na drzewo bez synów o numerach synów
+ *        @p from.
+ * @param[in, out] from - wskaźnik na drzewo, po wykonaniu nie ma synów.
+ */
+void radixTreeMoveSons(RadixTree tree, RadixTree from);
 
 /**
  * @brief Nie robi nic.
@@ -169,13 +232,18 @@ void radixTreeCountDataFunction(void *ptrA, void *ptrB);
  * Usuwa poddrzewo reprezentowane przez @p subTreeNode
  * wywołując dla węzłów z przypisanymi danymi
  * f(wskaźnik_na_dane_przechowywane_przez_węzeł, fData).
+ * Poddrzewo jest najpierw odłączane od drzewa, więc czytelnicy widzą
+ * je w całości albo wcale, a węzły z danymi nie są zmieniane.
  * @param[in, out] subTreeNode - wskaźnik na węzeł drzewa.
  * @param[in] f - wskaźnik na funkcję czyszczącą.
  * @param fData - dane pomocnicze do funkcji czyszczącej.
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ * @param[in, out] epoch - wskaźnik na strukturę epok czytelników drzewa
+ *        lub NULL.
  */
 void radixTreeDeleteSubTree(RadixTreeNode subTreeNode,
                             void (*f)(void *, void *),
-                            void *fData);
+                            void *fData, MemoryPool pool, Epoch epoch);
 
 /**
  * @brief Usuwa drzewo.
@@ -184,8 +252,12 @@ void radixTreeDeleteSubTree(RadixTreeNode subTreeNode,
  * @param[in, out] tree - wskaźnik na drzewo.
  * @param[in] f - wskaźnik na funkcję czyszczącą.
  * @param fData - dane pomocnicze do funkcji czyszczącej.
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ * @remarks Jeżeli pula służy wyłącznie temu drzewu, to zamiast usuwać
+ *          drzewo węzeł po węźle wystarczy usunąć całą pulę.
  */
-void radixTreeDelete(RadixTree tree, void (*f)(void *, void *), void *fData);
+void radixTreeDelete(RadixTree tree, void (*f)(void *, void *), void *fData,
+                     MemoryPool pool);
 
 /**
  * @brief Pobiera dane z węzła.
@@ -199,6 +271,9 @@ void *radixTreeGetNodeData(RadixTreeNode node);
  * @brief Przypisuje dane do węzła
  * Sprawia że węzeł @p node posiada wskaźnik na dane wskazywane przez
  * @p ptr.
+ * Uaktualnia podsumowania poddrzew przodków węzła.
+ * #### Złożoność
+ * O(głębokość węzła)
  * @param[in, out] node - wskaźnik na węzeł.
  * @param[in] ptr - wskaźnik na dane.
  */
@@ -212,13 +287,25 @@ void radixTreeSetData(RadixTreeNode node, void *ptr);
  */
 RadixTreeNode radixTreeFather(RadixTreeNode node);
 
+/**
+ * @brief Syn węzła o danym numerze.
+ * @param[in] node - wskaźnik na węzeł.
+ * @param[in] i - numer syna (kod_ascii - '0' pierwszego znaku na krawędzi
+ *        do syna), mniejszy niż RADIX_TREE_NUMBER_OF_SONS.
+ * @return Wskaźnik na syna, NULL w przypadku braku.
+ */
+RadixTreeNode radixTreeSon(RadixTreeNode node, size_t i);
+
 /**
  * @brief Optymalizuje pamięć zajmowaną przez drzewo.
  * Część węzłów na ścieżce od @p node do korzenia nie przechowująca danych
  * zostaje w miarę możliwości usunięta lub scalona.
  * @param[in] node - wskaźnik na węzeł.
+ * @param[in, out] pool - pula z której przydzielane są węzły drzewa.
+ * @param[in, out] epoch - wskaźnik na strukturę epok czytelników drzewa
+ *        lub NULL.
  */
-void radixTreeBalance(RadixTreeNode node);
+void radixTreeBalance(RadixTreeNode node, MemoryPool pool, Epoch epoch);
 
 /**
  * @brief Tekst reprezentujący węzeł.
@@ -229,6 +316,27 @@ void radixTreeBalance(RadixTreeNode node);
  */
 char *radixGetFullText(RadixTreeNode node);
 
+/**
+ * @brief Długość tekstu reprezentującego węzeł.
+ * #### Złożoność
+ * O(głębokość węzła)
+ * @param[in] node - wskaźnik na węzeł drzewa.
+ * @return Długość tekstu reprezentującego ścieżkę od korzenia do węzła.
+ */
+size_t radixTreeFullTextLength(RadixTreeNode node);
+
+/**
+ * @brief Kopiuje tekst reprezentujący węzeł do @p out.
+ * Nie przydziela pamięci i nie dopisuje '\0'.
+ * #### Złożoność
+ * O(długość tekstu)
+ * @see radixTreeFullTextLength
+ * @param[in] node - wskaźnik na węzeł drzewa.
+ * @param[in] length - wynik radixTreeFullTextLength(node).
+ * @param[out] out - wskaźnik na bufor o rozmiarze co najmniej @p length.
+ */
+void radixTreeCopyFullText(RadixTreeNode node, size_t length, char *out);
+
 /**
  * @brief Przetwarza drzewo.
  * Przechodzi po węzłach drzewa @p tree w porządku leksykograficznym
@@ -244,6 +352,14 @@ void radixTreeFold(RadixTree tree, void (*f)(void *, void *), void *fData);
  * @brief Funkcja licząca wynik dla  @ref phfwdNonTrivialCount
  * z wyjątkiem uwzględnionych przez @p phfwdNonTrivialCount
  * przypadków szczególnych.
+ * Korzysta z podsumowań poddrzew utrzymywanych przez operacje modyfikujące
+ * drzewo: pomija poddrzewa bez węzłów z danymi na głębokości co najwyżej
+ * @p goalLen i poddrzewa zawierające na krawędzi wejściowej niedostępną
+ * cyfrę, a poddrzewa, w których wszystkie cyfry są dostępne i wszystkie
+ * najpłytsze węzły z danymi mają tę samą głębokość, liczy bez schodzenia
+ * w głąb. Nie może być wykonywana współbieżnie z modyfikacjami drzewa.
+ * #### Złożoność
+ * O(liczba rozpatrzonych węzłów)
  * @see phfwdNonTrivialCount
  * @param[in] tree - drzewo z informacjami pozwalającymi odwrócić przekierowanie.
  * @param[in] goalLen - szukana długość numeru.
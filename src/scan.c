@@ -0,0 +1,284 @@
+/** @file
+ * Implementacja funkcji wyszukujących w tekście granice ciągów znaków.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "scan.h"
+
+#if defined(__GNUC__) && defined(__SSE2__) \
+    && (defined(__x86_64__) || defined(__i386__))
+
+/**
+ * @brief Czy dostępne są wersje korzystające z instrukcji wektorowych.
+ */
+#define SCAN_X86 1
+
+#include <immintrin.h>
+
+#endif
+
+/**
+ * @brief Liczba cyfr numeru ('0'..'9', ':', ';').
+ */
+#define SCAN_NUMBER_OF_DIGITS 12
+
+/**
+ * @brief Kod pierwszego białego znaku z przedziału '\\t'..'\\r'.
+ */
+#define SCAN_WHITE_FIRST '\t'
+
+/**
+ * @brief Liczba białych znaków z przedziału '\\t'..'\\r'.
+ */
+#define SCAN_WHITE_RANGE 5
+
+/**
+ * @param[in] character - znak.
+ * @return true jeżeli @p character jest cyfrą numeru, false w przeciwnym
+ *         przypadku.
+ */
+static inline bool scanIsDigit(char character) {
+    return (uint8_t) (character - '0') < SCAN_NUMBER_OF_DIGITS;
+}
+
+/**
+ * @param[in] character - znak.
+ * @return true jeżeli @p character jest białym znakiem, false w przeciwnym
+ *         przypadku.
+ */
+static inline bool scanIsWhite(char character) {
+    return character == ' '
+           || (uint8_t) (character - SCAN_WHITE_FIRST) < SCAN_WHITE_RANGE;
+}
+
+#ifdef SCAN_X86
+
+/**
+ * @brief Wyznacza maskę cyfr numeru w bloku 16 bajtów.
+ * @param[in] block - blok.
+ * @return Maska bitowa, i-ty bit jest ustawiony gdy i-ty bajt jest cyfrą.
+ */
+static inline unsigned scanDigitMask16(__m128i block) {
+    __m128i shifted = _mm_sub_epi8(block, _mm_set1_epi8('0'));
+    __m128i limited = _mm_min_epu8(shifted,
+                                   _mm_set1_epi8(SCAN_NUMBER_OF_DIGITS - 1));
+    return (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(shifted, limited));
+}
+
+/**
+ * @brief Wyznacza maskę białych znaków w bloku 16 bajtów.
+ * @param[in] block - blok.
+ * @return Maska bitowa, i-ty bit jest ustawiony gdy i-ty bajt jest białym
+ *         znakiem.
+ */
+static inline unsigned scanWhiteMask16(__m128i block) {
+    __m128i shifted = _mm_sub_epi8(block, _mm_set1_epi8(SCAN_WHITE_FIRST));
+    __m128i limited = _mm_min_epu8(shifted,
+                                   _mm_set1_epi8(SCAN_WHITE_RANGE - 1));
+    __m128i white = _mm_or_si128(_mm_cmpeq_epi8(shifted, limited),
+                                 _mm_cmpeq_epi8(block, _mm_set1_epi8(' ')));
+    return (unsigned) _mm_movemask_epi8(white);
+}
+
+/**
+ * @brief Wyznacza maskę cyfr numeru w bloku 32 bajtów.
+ * @param[in] block - blok.
+ * @return Maska bitowa, i-ty bit jest ustawiony gdy i-ty bajt jest cyfrą.
+ */
+__attribute__((target("avx2")))
+static inline uint32_t scanDigitMask32(__m256i block) {
+    __m256i shifted = _mm256_sub_epi8(block, _mm256_set1_epi8('0'));
+    __m256i limited = _mm256_min_epu8(
+            shifted, _mm256_set1_epi8(SCAN_NUMBER_OF_DIGITS - 1));
+    return (uint32_t) _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(shifted, limited));
+}
+
+/**
+ * @brief Wyznacza maskę białych znaków w bloku 32 bajtów.
+ * @param[in] block - blok.
+ * @return Maska bitowa, i-ty bit jest ustawiony gdy i-ty bajt jest białym
+ *         znakiem.
+ */
+__attribute__((target("avx2")))
+static inline uint32_t scanWhiteMask32(__m256i block) {
+    __m256i shifted = _mm256_sub_epi8(block,
+                                      _mm256_set1_epi8(SCAN_WHITE_FIRST));
+    __m256i limited = _mm256_min_epu8(
+            shifted, _mm256_set1_epi8(SCAN_WHITE_RANGE - 1));
+    __m256i white = _mm256_or_si256(
+            _mm256_cmpeq_epi8(shifted, limited),
+            _mm256_cmpeq_epi8(block, _mm256_set1_epi8(' ')));
+    return (uint32_t) _mm256_movemask_epi8(white);
+}
+
+/**
+ * @brief Wersja @ref scanDigitRun dla AVX2.
+ * Przegląda jedynie pełne bloki 32 bajtów.
+ * @param[in] txt - wskaźnik na tekst.
+ * @param[in] length - długość tekstu.
+ * @param[out] position - pozycja pierwszego znaku nie będącego cyfrą
+ *        lub pierwszego nieprzejrzanego znaku.
+ * @return true jeżeli znaleziono znak nie będący cyfrą.
+ */
+__attribute__((target("avx2")))
+static bool scanDigitRunAvx2(const char *txt, size_t length,
+                             size_t *position) {
+    size_t i = 0;
+    while (i + 32 <= length) {
+        uint32_t mask = scanDigitMask32(
+                _mm256_loadu_si256((const __m256i *) (txt + i)));
+        if (mask != UINT32_MAX) {
+            *position = i + (size_t) __builtin_ctz(~mask);
+            return true;
+        }
+        i += 32;
+    }
+    *position = i;
+    return false;
+}
+
+/**
+ * @brief Wersja @ref scanWhiteRun dla AVX2.
+ * Przegląda jedynie pełne bloki 32 bajtów.
+ * @param[in] txt - wskaźnik na tekst.
+ * @param[in] length - długość tekstu.
+ * @param[out] position - pozycja pierwszego znaku nie będącego białym
+ *        znakiem lub pierwszego nieprzejrzanego znaku.
+ * @return true jeżeli znaleziono znak nie będący białym znakiem.
+ */
+__attribute__((target("avx2")))
+static bool scanWhiteRunAvx2(const char *txt, size_t length,
+                             size_t *position) {
+    size_t i = 0;
+    while (i + 32 <= length) {
+        uint32_t mask = scanWhiteMask32(
+                _mm256_loadu_si256((const __m256i *) (txt + i)));
+        if (mask != UINT32_MAX) {
+            *position = i + (size_t) __builtin_ctz(~mask);
+            return true;
+        }
+        i += 32;
+    }
+    *position = i;
+    return false;
+}
+
+/**
+ * @brief Wersja @ref scanFindDouble dla AVX2.
+ * Przegląda jedynie pełne bloki 32 bajtów, po których następuje
+ * co najmniej jeden znak.
+ * @param[in] txt - wskaźnik na tekst.
+ * @param[in] length - długość tekstu.
+ * @param[in] character - wyszukiwany znak.
+ * @param[out] position - pozycja pary lub pierwszego nieprzejrzanego znaku.
+ * @return true jeżeli znaleziono parę.
+ */
+__attribute__((target("avx2")))
+static bool scanFindDoubleAvx2(const char *txt, size_t length,
+                               char character, size_t *position) {
+    __m256i pattern = _mm256_set1_epi8(character);
+    size_t i = 0;
+    while (i + 33 <= length) {
+        __m256i first = _mm256_loadu_si256((const __m256i *) (txt + i));
+        __m256i second = _mm256_loadu_si256((const __m256i *) (txt + i + 1));
+        uint32_t mask = (uint32_t) _mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(first, pattern),
+                                 _mm256_cmpeq_epi8(second, pattern)));
+        if (mask != 0) {
+            *position = i + (size_t) __builtin_ctz(mask);
+            return true;
+        }
+        i += 32;
+    }
+    *position = i;
+    return false;
+}
+
+/**
+ * @return true jeżeli procesor obsługuje instrukcje AVX2.
+ */
+static inline bool scanHasAvx2() {
+    return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+size_t scanDigitRun(const char *txt, size_t length) {
+    size_t i = 0;
+#ifdef SCAN_X86
+    if (length >= 32 && scanHasAvx2()
+        && scanDigitRunAvx2(txt, length, &i)) {
+        return i;
+    }
+    while (i + 16 <= length) {
+        unsigned mask = scanDigitMask16(
+                _mm_loadu_si128((const __m128i *) (txt + i)));
+        if (mask != 0xFFFFu) {
+            return i + (size_t) __builtin_ctz(~mask);
+        }
+        i += 16;
+    }
+#endif
+    while (i < length && scanIsDigit(txt[i])) {
+        i++;
+    }
+    return i;
+}
+
+size_t scanWhiteRun(const char *txt, size_t length) {
+    size_t i = 0;
+#ifdef SCAN_X86
+    if (length >= 32 && scanHasAvx2()
+        && scanWhiteRunAvx2(txt, length, &i)) {
+        return i;
+    }
+    while (i + 16 <= length) {
+        unsigned mask = scanWhiteMask16(
+                _mm_loadu_si128((const __m128i *) (txt + i)));
+        if (mask != 0xFFFFu) {
+            return i + (size_t) __builtin_ctz(~mask);
+        }
+        i += 16;
+    }
+#endif
+    while (i < length && scanIsWhite(txt[i])) {
+        i++;
+    }
+    return i;
+}
+
+size_t scanFindDouble(const char *txt, size_t length, char character) {
+    size_t i = 0;
+#ifdef SCAN_X86
+    if (length >= 33 && scanHasAvx2()
+        && scanFindDoubleAvx2(txt, length, character, &i)) {
+        return i;
+    }
+    __m128i pattern = _mm_set1_epi8(character);
+    while (i + 17 <= length) {
+        __m128i first = _mm_loadu_si128((const __m128i *) (txt + i));
+        __m128i second = _mm_loadu_si128((const __m128i *) (txt + i + 1));
+        unsigned mask = (unsigned) _mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(first, pattern),
+                              _mm_cmpeq_epi8(second, pattern)));
+        if (mask != 0) {
+            return i + (size_t) __builtin_ctz(mask);
+        }
+        i += 16;
+    }
+#endif
+    while (i < length) {
+        if (txt[i] == character
+            && (i + 1 == length || txt[i + 1] == character)) {
+            return i;
+        }
+        i++;
+    }
+    return length;
+}
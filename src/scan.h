@@ -0,0 +1,54 @@
+/** @file
+ * Interfejs funkcji wyszukujących w tekście granice ciągów znaków.
+ * Na procesorach x86 tekst jest przeglądany blokami po 16 (SSE2)
+ * lub 32 (AVX2, jeżeli procesor je obsługuje) bajtów, na pozostałych
+ * architekturach znak po znaku.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#ifndef TELEFONY_SCAN_H
+#define TELEFONY_SCAN_H
+
+#include <stddef.h>
+
+/**
+ * @brief Wyznacza długość ciągu cyfr numeru.
+ * Cyframi numeru są znaki spełniające characterIsDigit ('0'..'9', ':', ';').
+ * #### Złożoność
+ * O(wynik)
+ * @param[in] txt - wskaźnik na tekst.
+ * @param[in] length - długość tekstu.
+ * @return Długość najdłuższego prefiksu @p txt złożonego z cyfr numeru.
+ */
+size_t scanDigitRun(const char *txt, size_t length);
+
+/**
+ * @brief Wyznacza długość ciągu białych znaków.
+ * Białymi znakami są znaki spełniające isspace w lokalizacji "C".
+ * #### Złożoność
+ * O(wynik)
+ * @param[in] txt - wskaźnik na tekst.
+ * @param[in] length - długość tekstu.
+ * @return Długość najdłuższego prefiksu @p txt złożonego z białych znaków.
+ */
+size_t scanWhiteRun(const char *txt, size_t length);
+
+/**
+ * @brief Wyszukuje dwa kolejne znaki @p character.
+ * Ostatni znak tekstu równy @p character również jest zwracany, ponieważ
+ * para może być kontynuowana poza tekstem.
+ * #### Złożoność
+ * O(wynik)
+ * @param[in] txt - wskaźnik na tekst.
+ * @param[in] length - długość tekstu.
+ * @param[in] character - wyszukiwany znak.
+ * @return Najmniejsza pozycja i taka, że txt[i] == character oraz
+ *         i + 1 == length lub txt[i + 1] == character,
+ *         @p length jeżeli takiej nie ma.
+ */
+size_t scanFindDouble(const char *txt, size_t length, char character);
+
+#endif //TELEFONY_SCAN_H
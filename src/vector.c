@@ -172,6 +172,21 @@ int vectorPushBack(Vector vector, VECTOR_ELEMENT_TYPE element) {
     }
 }
 
+int vectorPushBackArray(Vector vector, const VECTOR_ELEMENT_TYPE *elements,
+                        size_t count) {
+    if (count == 0) {
+        return VECTOR_SUCCES;
+    } else if (vectorReserve(vector, vectorSize(vector) + count)
+               == VECTOR_MEMORY_ERROR) {
+        return VECTOR_MEMORY_ERROR;
+    } else {
+        memcpy(&vector->array[vectorSize(vector)], elements,
+               count * sizeof(VECTOR_ELEMENT_TYPE));
+        vector->size += count;
+        return VECTOR_SUCCES;
+    }
+}
+
 int vectorPopBack(Vector vector) {
     if (vectorSize(vector) == 0) {
         return VECTOR_OPERATION_ERROR;
@@ -136,6 +136,19 @@ void vectorDelete(Vector vector);
  */
 int vectorPushBack(Vector vector, VECTOR_ELEMENT_TYPE element);
 
+/**
+ * @brief Wstawia tablicę elementów na koniec Vectora.
+ * Działa jak @p count wywołań vectorPushBack, ale rezerwuje pamięć
+ * i kopiuje elementy jednokrotnie.
+ * @param[in] vector    - wskaźnik na strukturę Vectora.
+ * @param[in] elements  - wskaźnik na tablicę elementów do wstawienia.
+ * @param[in] count     - liczba elementów do wstawienia.
+ * @return W przypadku problemów z przydzieleniem pamięci VECTOR_MEMORY_ERROR,
+ *         w przeciwnym wypadku VECTOR_SUCCESS.
+ */
+int vectorPushBackArray(Vector vector, const VECTOR_ELEMENT_TYPE *elements,
+                        size_t count);
+
 /**
  * @brief Usuwa z końca Vectora.
  * Jeżeli vectorSize(vector) jest różne od 0 to
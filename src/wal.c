@@ -0,0 +1,872 @@
+/** @file
+ * Implementacja dziennika zapisu z wyprzedzeniem operacji modyfikujących
+ * bazy przekierowań.
+ *
+ * Zapis operacji składa się z nagłówka (długość danych i suma kontrolna,
+ * obie typu uint32_t, oraz jednobajtowy typ operacji) i danych, czyli
+ * jednego lub dwóch napisów zakończonych '\0'. Suma kontrolna (FNV-1a)
+ * obejmuje typ i dane, co pozwala wykryć przerwany zapis na końcu pliku.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "wal.h"
+#include "text.h"
+
+/**
+ * @brief Typ zapisu operacji phoneBasesAddBase.
+ */
+#define WAL_RECORD_NEW_BASE 1
+
+/**
+ * @brief Typ zapisu operacji phoneBasesDelBase.
+ */
+#define WAL_RECORD_DEL_BASE 2
+
+/**
+ * @brief Typ zapisu operacji phfwdAdd.
+ */
+#define WAL_RECORD_ADD 3
+
+/**
+ * @brief Typ zapisu operacji phfwdRemove.
+ */
+#define WAL_RECORD_REMOVE 4
+
+/**
+ * @brief Rozmiar nagłówka zapisu w bajtach.
+ */
+#define WAL_RECORD_HEADER_SIZE 9
+
+/**
+ * @brief Początkowy rozmiar bufora zapisów w bajtach.
+ */
+#define WAL_BUFFER_SIZE 65536
+
+/**
+ * @brief Maksymalna długość nazwy pliku w katalogu dziennika.
+ */
+#define WAL_MAX_NAME_LENGTH 64
+
+/**
+ * @brief Nazwa pliku opisującego punkt kontrolny.
+ */
+#define WAL_CHECKPOINT_NAME "checkpoint"
+
+/**
+ * @brief Nazwa pliku tymczasowego przy tworzeniu punktu kontrolnego.
+ */
+#define WAL_CHECKPOINT_TMP_NAME "checkpoint.tmp"
+
+/**
+ * @brief Początek pliku opisującego punkt kontrolny.
+ */
+#define WAL_CHECKPOINT_MAGIC "PHFWDCKP"
+
+/**
+ * @brief Długość @ref WAL_CHECKPOINT_MAGIC.
+ */
+#define WAL_CHECKPOINT_MAGIC_LENGTH 8
+
+/**
+ * @brief Wersja formatu pliku opisującego punkt kontrolny.
+ */
+#define WAL_CHECKPOINT_VERSION 1
+
+/**
+ * @brief Wartość oznaczająca brak bieżącej bazy w punkcie kontrolnym.
+ */
+#define WAL_NO_BASE UINT64_MAX
+
+/**
+ * @brief Wartość początkowa funkcji skrótu FNV-1a.
+ */
+#define WAL_FNV_OFFSET ((uint32_t) 2166136261u)
+
+/**
+ * @brief Mnożnik funkcji skrótu FNV-1a.
+ */
+#define WAL_FNV_PRIME ((uint32_t) 16777619u)
+
+/**
+ * @brief Zapis został wykonany.
+ * @see walApply
+ */
+#define WAL_APPLY_OK 0
+
+/**
+ * @brief Zapis jest niepoprawny.
+ * @see walApply
+ */
+#define WAL_APPLY_INVALID 1
+
+/**
+ * @brief Wykonanie zapisu nie powiodło się z powodu problemów z pamięcią.
+ * @see walApply
+ */
+#define WAL_APPLY_ERROR 2
+
+/**
+ * @brief Struktura reprezentująca otwarty dziennik.
+ */
+struct Wal {
+    /**
+     * @brief Ścieżka do katalogu dziennika.
+     */
+    char *directory;
+
+    /**
+     * @brief Bufor na ścieżkę do pliku w katalogu dziennika.
+     */
+    char *path;
+
+    /**
+     * @brief Drugi bufor na ścieżkę do pliku w katalogu dziennika.
+     */
+    char *otherPath;
+
+    /**
+     * @brief Rozmiar buforów @p path i @p otherPath.
+     */
+    size_t pathCapacity;
+
+    /**
+     * @brief Numer pokolenia ostatniego punktu kontrolnego.
+     */
+    uint64_t generation;
+
+    /**
+     * @brief Liczba baz w ostatnim punkcie kontrolnym.
+     */
+    uint64_t howManyBases;
+
+    /**
+     * @brief Deskryptor pliku dziennika bieżącego pokolenia, -1 przed
+     * @ref walRecover.
+     */
+    int fd;
+
+    /**
+     * @brief Rozmiar pliku dziennika bieżącego pokolenia, czyli łączny
+     * rozmiar zapisanych w całości zapisów.
+     */
+    off_t fileSize;
+
+    /**
+     * @brief Czy w pliku dziennika mogą znajdować się dane częściowo
+     * zapisanego bufora.
+     * Kolejne zapisy znalazłyby się wtedy za uszkodzonym fragmentem
+     * i zostałyby pominięte przy odtwarzaniu, więc dziennik nie przyjmuje
+     * już zapisów.
+     */
+    bool broken;
+
+    /**
+     * @brief Bufor zapisów oczekujących na zapisanie do pliku.
+     */
+    char *buffer;
+
+    /**
+     * @brief Liczba zajętych bajtów @p buffer.
+     */
+    size_t bufferSize;
+
+    /**
+     * @brief Rozmiar @p buffer.
+     */
+    size_t bufferCapacity;
+
+    /**
+     * @brief Liczba zapisów od ostatniego utrwalenia.
+     */
+    size_t pending;
+
+    /**
+     * @brief Liczba zapisów utrwalanych razem.
+     */
+    size_t syncEvery;
+
+    /**
+     * @brief Liczba zapisów między punktami kontrolnymi.
+     */
+    size_t checkpointEvery;
+
+    /**
+     * @brief Liczba zapisów od ostatniego punktu kontrolnego.
+     */
+    size_t sinceCheckpoint;
+};
+
+/**
+ * @brief Nagłówek pliku opisującego punkt kontrolny.
+ * Za nagłówkiem znajdują się identyfikatory baz, każdy poprzedzony długością
+ * (uint64_t, razem z kończącym '\0'). Obraz i-tej bazy znajduje się
+ * w pliku base.<generation>.<i>.
+ */
+struct WalCheckpointHeader {
+    /**
+     * @brief WAL_CHECKPOINT_MAGIC (bez kończącego '\0').
+     */
+    char magic[WAL_CHECKPOINT_MAGIC_LENGTH];
+
+    /**
+     * @brief WAL_CHECKPOINT_VERSION.
+     */
+    uint32_t version;
+
+    /**
+     * @brief Nieużywane (zero).
+     */
+    uint32_t reserved;
+
+    /**
+     * @brief Numer pokolenia.
+     */
+    uint64_t generation;
+
+    /**
+     * @brief Liczba baz.
+     */
+    uint64_t howManyBases;
+
+    /**
+     * @brief Numer bieżącej bazy, WAL_NO_BASE jeżeli jej nie ma.
+     */
+    uint64_t currentBase;
+};
+
+/**
+ * @brief Wyznacza ścieżkę do pliku w katalogu dziennika.
+ * @param[in] wal - wskaźnik na dziennik.
+ * @param[out] out - bufor o rozmiarze Wal->pathCapacity.
+ * @param[in] name - nazwa pliku.
+ * @return @p out.
+ */
+static const char *walFileName(Wal wal, char *out, const char *name) {
+    snprintf(out, wal->pathCapacity, "%s/%s", wal->directory, name);
+    return out;
+}
+
+/**
+ * @brief Wyznacza ścieżkę do pliku dziennika pokolenia @p generation.
+ * @param[in] wal - wskaźnik na dziennik.
+ * @param[out] out - bufor o rozmiarze Wal->pathCapacity.
+ * @param[in] generation - numer pokolenia.
+ * @return @p out.
+ */
+static const char *walLogName(Wal wal, char *out, uint64_t generation) {
+    snprintf(out, wal->pathCapacity, "%s/wal.%" PRIu64, wal->directory,
+             generation);
+    return out;
+}
+
+/**
+ * @brief Wyznacza ścieżkę do obrazu bazy z punktu kontrolnego.
+ * @param[in] wal - wskaźnik na dziennik.
+ * @param[out] out - bufor o rozmiarze Wal->pathCapacity.
+ * @param[in] generation - numer pokolenia.
+ * @param[in] index - numer bazy.
+ * @return @p out.
+ */
+static const char *walBaseName(Wal wal, char *out, uint64_t generation,
+                               uint64_t index) {
+    snprintf(out, wal->pathCapacity, "%s/base.%" PRIu64 ".%" PRIu64,
+             wal->directory, generation, index);
+    return out;
+}
+
+Wal walCreate(const char *directory, size_t syncEvery,
+              size_t checkpointEvery) {
+    if (mkdir(directory, 0777) != 0 && errno != EEXIST) {
+        return NULL;
+    }
+
+    Wal wal = malloc(sizeof(struct Wal));
+    if (wal == NULL) {
+        return NULL;
+    }
+    wal->pathCapacity = strlen(directory) + WAL_MAX_NAME_LENGTH;
+    wal->directory = duplicateText(directory);
+    wal->path = malloc(wal->pathCapacity);
+    wal->otherPath = malloc(wal->pathCapacity);
+    wal->buffer = malloc(WAL_BUFFER_SIZE);
+    if (wal->directory == NULL || wal->path == NULL || wal->otherPath == NULL
+        || wal->buffer == NULL) {
+        free(wal->directory);
+        free(wal->path);
+        free(wal->otherPath);
+        free(wal->buffer);
+        free(wal);
+        return NULL;
+    } else {
+        wal->generation = 0;
+        wal->howManyBases = 0;
+        wal->fd = -1;
+        wal->fileSize = 0;
+        wal->broken = false;
+        wal->bufferSize = 0;
+        wal->bufferCapacity = WAL_BUFFER_SIZE;
+        wal->pending = 0;
+        wal->syncEvery = syncEvery;
+        wal->checkpointEvery = checkpointEvery;
+        wal->sinceCheckpoint = 0;
+        return wal;
+    }
+}
+
+/**
+ * @brief Suma kontrolna zapisu.
+ * @param[in] type - typ zapisu.
+ * @param[in] data - wskaźnik na dane zapisu.
+ * @param[in] length - długość danych w bajtach.
+ * @return Wartość funkcji skrótu FNV-1a dla typu i danych.
+ */
+static uint32_t walChecksum(unsigned char type, const char *data,
+                            size_t length) {
+    uint32_t result = (WAL_FNV_OFFSET ^ type) * WAL_FNV_PRIME;
+    size_t i;
+    for (i = 0; i < length; i++) {
+        result = (result ^ (unsigned char) data[i]) * WAL_FNV_PRIME;
+    }
+    return result;
+}
+
+/**
+ * @brief Zapisuje cały bufor do deskryptora.
+ * @param[in] fd - deskryptor pliku.
+ * @param[in] data - wskaźnik na dane.
+ * @param[in] size - rozmiar danych w bajtach.
+ * @return true w przypadku sukcesu, false w przypadku błędu zapisu.
+ */
+static bool walWriteAll(int fd, const char *data, size_t size) {
+    ssize_t written;
+    while (size != 0) {
+        written = write(fd, data, size);
+        if (written > 0) {
+            data += written;
+            size -= (size_t) written;
+        } else if (written == 0 || errno != EINTR) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Zapisuje bufor zapisów do pliku dziennika (bez utrwalania).
+ * W przypadku błędu zapisu zapisy pozostają w buforze, a częściowo
+ * zapisane dane są obcinane, aby kolejna próba dopisała bufor za ostatnim
+ * całym zapisem.
+ * @param[in, out] wal - wskaźnik na dziennik.
+ * @return true w przypadku sukcesu, false w przypadku błędu zapisu.
+ */
+static bool walWriteBuffer(Wal wal) {
+    if (wal->broken) {
+        return false;
+    } else if (!walWriteAll(wal->fd, wal->buffer, wal->bufferSize)) {
+        wal->broken = ftruncate(wal->fd, wal->fileSize) != 0;
+        return false;
+    }
+    wal->fileSize += (off_t) wal->bufferSize;
+    wal->bufferSize = 0;
+    return true;
+}
+
+bool walCommit(Wal wal) {
+    assert(wal->fd >= 0);
+    bool result = walWriteBuffer(wal)
+                  && (wal->syncEvery == 0 || fdatasync(wal->fd) == 0);
+    if (result) {
+        wal->pending = 0;
+    }
+    return result;
+}
+
+/**
+ * @brief Dodaje zapis do bufora.
+ * Po zebraniu Wal->syncEvery zapisów zapisuje je i utrwala.
+ * @param[in, out] wal - wskaźnik na dziennik.
+ * @param[in] type - typ zapisu.
+ * @param[in] first - pierwszy napis.
+ * @param[in] second - drugi napis, NULL dla zapisów z jednym napisem.
+ * @return true w przypadku sukcesu, false w przypadku błędu zapisu
+ *         lub problemów z pamięcią.
+ */
+static bool walAppend(Wal wal, unsigned char type, const char *first,
+                      const char *second) {
+    assert(wal->fd >= 0);
+    size_t firstLength = strlen(first) + 1;
+    size_t secondLength = second == NULL ? 0 : strlen(second) + 1;
+    size_t length = firstLength + secondLength;
+    size_t recordSize = WAL_RECORD_HEADER_SIZE + length;
+    if (length > UINT32_MAX) {
+        return false;
+    }
+
+    if (wal->bufferSize + recordSize > wal->bufferCapacity) {
+        if (!walWriteBuffer(wal)) {
+            return false;
+        }
+        if (recordSize > wal->bufferCapacity) {
+            char *grown = realloc(wal->buffer, recordSize);
+            if (grown == NULL) {
+                return false;
+            }
+            wal->buffer = grown;
+            wal->bufferCapacity = recordSize;
+        }
+    }
+
+    char *record = wal->buffer + wal->bufferSize;
+    char *data = record + WAL_RECORD_HEADER_SIZE;
+    uint32_t header[2];
+    memcpy(data, first, firstLength);
+    if (second != NULL) {
+        memcpy(data + firstLength, second, secondLength);
+    }
+    header[0] = (uint32_t) length;
+    header[1] = walChecksum(type, data, length);
+    memcpy(record, header, sizeof(header));
+    record[sizeof(header)] = (char) type;
+    wal->bufferSize += recordSize;
+    wal->sinceCheckpoint++;
+    wal->pending++;
+
+    if (wal->syncEvery != 0 && wal->pending >= wal->syncEvery) {
+        return walCommit(wal);
+    } else {
+        return true;
+    }
+}
+
+bool walLogNewBase(Wal wal, const char *id) {
+    return walAppend(wal, WAL_RECORD_NEW_BASE, id, NULL);
+}
+
+bool walLogDelBase(Wal wal, const char *id) {
+    return walAppend(wal, WAL_RECORD_DEL_BASE, id, NULL);
+}
+
+bool walLogAdd(Wal wal, const char *num1, const char *num2) {
+    return walAppend(wal, WAL_RECORD_ADD, num1, num2);
+}
+
+bool walLogRemove(Wal wal, const char *num) {
+    return walAppend(wal, WAL_RECORD_REMOVE, num, NULL);
+}
+
+bool walCheckpointDue(Wal wal) {
+    return wal->checkpointEvery != 0
+           && wal->sinceCheckpoint >= wal->checkpointEvery;
+}
+
+/**
+ * @brief Wczytuje cały plik do pamięci.
+ * @param[in] path - ścieżka do pliku.
+ * @param[out] data - @p *data wskazuje na zawartość pliku (do zwolnienia
+ *        przez free), NULL jeżeli plik nie istnieje.
+ * @param[out] size - rozmiar pliku w bajtach.
+ * @return true w przypadku sukcesu lub braku pliku, false w przypadku
+ *         błędu odczytu lub problemów z pamięcią.
+ */
+static bool walReadFile(const char *path, char **data, size_t *size) {
+    *data = NULL;
+    *size = 0;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return errno == ENOENT;
+    }
+
+    struct stat status;
+    bool result = fstat(fd, &status) == 0
+                  && (uintmax_t) status.st_size < SIZE_MAX;
+    if (result) {
+        *data = malloc((size_t) status.st_size + 1);
+        result = *data != NULL;
+    }
+    ssize_t got;
+    while (result && *size < (size_t) status.st_size) {
+        got = read(fd, *data + *size, (size_t) status.st_size - *size);
+        if (got < 0 && errno != EINTR) {
+            result = false;
+        } else if (got == 0) {
+            break;
+        } else if (got > 0) {
+            *size += (size_t) got;
+        }
+    }
+    close(fd);
+    if (!result) {
+        free(*data);
+        *data = NULL;
+    }
+    return result;
+}
+
+/**
+ * @brief Wykonuje zapis operacji.
+ * @param[in] type - typ zapisu.
+ * @param[in] first - pierwszy napis zapisu.
+ * @param[in] second - drugi napis zapisu (NULL jeżeli go nie ma).
+ * @param[in, out] bases - wskaźnik na strukturę baz.
+ * @param[in, out] currentBase - wskaźnik na wskaźnik na bieżącą bazę.
+ * @return WAL_APPLY_OK, WAL_APPLY_INVALID jeżeli zapis nie mógł zostać
+ *         utworzony przez program lub WAL_APPLY_ERROR w przypadku
+ *         problemów z pamięcią.
+ */
+static int walApply(unsigned char type, const char *first,
+                    const char *second, PhoneBases bases,
+                    struct PhoneForward **currentBase) {
+    if (type == WAL_RECORD_NEW_BASE && second == NULL) {
+        *currentBase = phoneBasesAddBase(bases, first);
+        return *currentBase == NULL ? WAL_APPLY_ERROR : WAL_APPLY_OK;
+    } else if (type == WAL_RECORD_DEL_BASE && second == NULL) {
+        struct PhoneForward *base = phoneBasesGetBase(bases, first);
+        if (base == NULL) {
+            return WAL_APPLY_INVALID;
+        }
+        if (base == *currentBase) {
+            *currentBase = NULL;
+        }
+        phoneBasesDelBase(bases, first);
+        return WAL_APPLY_OK;
+    } else if (*currentBase == NULL) {
+        return WAL_APPLY_INVALID;
+    } else if (type == WAL_RECORD_ADD && second != NULL) {
+        return phfwdAdd(*currentBase, first, second) ? WAL_APPLY_OK
+                                                     : WAL_APPLY_ERROR;
+    } else if (type == WAL_RECORD_REMOVE && second == NULL) {
+        phfwdRemove(*currentBase, first);
+        return WAL_APPLY_OK;
+    } else {
+        return WAL_APPLY_INVALID;
+    }
+}
+
+/**
+ * @brief Wykonuje kolejne poprawne zapisy z pliku dziennika.
+ * Kończy na pierwszym uszkodzonym lub niepełnym zapisie.
+ * @param[in, out] wal - wskaźnik na dziennik.
+ * @param[in] data - zawartość pliku dziennika.
+ * @param[in] size - rozmiar pliku w bajtach.
+ * @param[in, out] bases - wskaźnik na strukturę baz.
+ * @param[in, out] currentBase - wskaźnik na wskaźnik na bieżącą bazę.
+ * @param[out] validSize - łączny rozmiar wykonanych zapisów.
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
+ */
+static bool walReplay(Wal wal, const char *data, size_t size,
+                      PhoneBases bases, struct PhoneForward **currentBase,
+                      size_t *validSize) {
+    size_t pos = 0;
+    uint32_t header[2];
+    unsigned char type;
+    const char *payload, *second;
+    int applied = WAL_APPLY_OK;
+
+    while (size - pos >= WAL_RECORD_HEADER_SIZE) {
+        memcpy(header, data + pos, sizeof(header));
+        type = (unsigned char) data[pos + sizeof(header)];
+        payload = data + pos + WAL_RECORD_HEADER_SIZE;
+        if (header[0] == 0
+            || header[0] > size - pos - WAL_RECORD_HEADER_SIZE
+            || payload[header[0] - 1] != '\0'
+            || walChecksum(type, payload, header[0]) != header[1]) {
+            break;
+        }
+
+        second = payload + strlen(payload) + 1;
+        if (second == payload + header[0]) {
+            second = NULL;
+        } else if (second + strlen(second) + 1 != payload + header[0]) {
+            break;
+        }
+        applied = walApply(type, payload, second, bases, currentBase);
+        if (applied != WAL_APPLY_OK) {
+            break;
+        }
+        pos += WAL_RECORD_HEADER_SIZE + header[0];
+        wal->sinceCheckpoint++;
+    }
+
+    *validSize = pos;
+    return applied != WAL_APPLY_ERROR;
+}
+
+/**
+ * @brief Wczytuje bazy z punktu kontrolnego.
+ * @param[in, out] wal - wskaźnik na dziennik.
+ * @param[in] data - zawartość pliku opisującego punkt kontrolny.
+ * @param[in] size - rozmiar pliku w bajtach.
+ * @param[in, out] bases - wskaźnik na pustą strukturę baz.
+ * @param[out] currentBase - wskaźnik na wskaźnik na bieżącą bazę.
+ * @return true w przypadku sukcesu, false w przypadku niepoprawnego
+ *         punktu kontrolnego, błędu odczytu lub problemów z pamięcią.
+ */
+static bool walLoadCheckpoint(Wal wal, const char *data, size_t size,
+                              PhoneBases bases,
+                              struct PhoneForward **currentBase) {
+    struct WalCheckpointHeader header;
+    if (size < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, WAL_CHECKPOINT_MAGIC,
+               WAL_CHECKPOINT_MAGIC_LENGTH) != 0
+        || header.version != WAL_CHECKPOINT_VERSION) {
+        return false;
+    }
+
+    size_t pos = sizeof(header);
+    uint64_t i, length;
+    struct PhoneForward *base;
+    for (i = 0; i < header.howManyBases; i++) {
+        if (size - pos < sizeof(length)) {
+            return false;
+        }
+        memcpy(&length, data + pos, sizeof(length));
+        pos += sizeof(length);
+        if (length == 0 || length > size - pos
+            || data[pos + length - 1] != '\0') {
+            return false;
+        }
+
+        base = phfwdLoad(walBaseName(wal, wal->path, header.generation, i));
+        if (base == NULL) {
+            return false;
+        } else if (!phoneBasesAttachBase(bases, data + pos, base)) {
+            phfwdDelete(base);
+            return false;
+        }
+        if (i == header.currentBase) {
+            *currentBase = base;
+        }
+        pos += length;
+    }
+
+    wal->generation = header.generation;
+    wal->howManyBases = header.howManyBases;
+    return true;
+}
+
+bool walRecover(Wal wal, PhoneBases bases, struct PhoneForward **currentBase) {
+    char *data;
+    size_t size, validSize;
+    *currentBase = NULL;
+
+    if (!walReadFile(walFileName(wal, wal->path, WAL_CHECKPOINT_NAME),
+                     &data, &size)) {
+        return false;
+    } else if (data != NULL) {
+        bool loaded = walLoadCheckpoint(wal, data, size, bases, currentBase);
+        free(data);
+        if (!loaded) {
+            return false;
+        }
+    }
+
+    walLogName(wal, wal->path, wal->generation);
+    if (!walReadFile(wal->path, &data, &size)) {
+        return false;
+    }
+    bool result = walReplay(wal, data, size, bases, currentBase, &validSize);
+    free(data);
+
+    if (result) {
+        wal->fd = open(wal->path, O_WRONLY | O_CREAT | O_APPEND, 0666);
+        result = wal->fd >= 0 && ftruncate(wal->fd, (off_t) validSize) == 0;
+        wal->fileSize = (off_t) validSize;
+    }
+    return result;
+}
+
+/**
+ * @brief Utrwala zawartość pliku.
+ * @param[in] path - ścieżka do pliku.
+ * @return true w przypadku sukcesu, false w przeciwnym przypadku.
+ */
+static bool walSyncFile(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    } else {
+        bool result = fsync(fd) == 0;
+        close(fd);
+        return result;
+    }
+}
+
+/**
+ * @brief Dane dla funkcji zapisującej bazy do punktu kontrolnego.
+ * @see walCheckpointBase
+ */
+struct WalCheckpointData {
+    /**
+     * @brief Wskaźnik na dziennik.
+     */
+    Wal wal;
+
+    /**
+     * @brief Plik opisujący tworzony punkt kontrolny.
+     */
+    FILE *manifest;
+
+    /**
+     * @brief Nagłówek tworzonego punktu kontrolnego.
+     */
+    struct WalCheckpointHeader header;
+
+    /**
+     * @brief Wskaźnik na bieżącą bazę.
+     */
+    struct PhoneForward *currentBase;
+
+    /**
+     * @brief Czy wszystkie dotychczasowe bazy udało się zapisać.
+     */
+    bool success;
+};
+
+/**
+ * @brief Zapisuje bazę do tworzonego punktu kontrolnego.
+ * Używany w phoneBasesFold.
+ * @param[in] id - identyfikator bazy.
+ * @param[in] base - wskaźnik na bazę.
+ * @param[in, out] checkpointData - wskaźnik na struct WalCheckpointData.
+ */
+static void walCheckpointBase(const char *id, struct PhoneForward *base,
+                              void *checkpointData) {
+    struct WalCheckpointData *state = checkpointData;
+    if (!state->success) {
+        return;
+    }
+
+    const char *path = walBaseName(state->wal, state->wal->otherPath,
+                                   state->header.generation,
+                                   state->header.howManyBases);
+    uint64_t length = strlen(id) + 1;
+    state->success = phfwdSave(base, path) && walSyncFile(path)
+                     && fwrite(&length, sizeof(length), 1,
+                               state->manifest) == 1
+                     && fwrite(id, 1, length, state->manifest) == length;
+    if (base == state->currentBase) {
+        state->header.currentBase = state->header.howManyBases;
+    }
+    state->header.howManyBases++;
+}
+
+/**
+ * @brief Zapisuje plik opisujący punkt kontrolny pod nazwą tymczasową.
+ * @param[in, out] wal - wskaźnik na dziennik.
+ * @param[in] bases - wskaźnik na strukturę baz.
+ * @param[in] currentBase - wskaźnik na bieżącą bazę.
+ * @param[out] header - nagłówek zapisanego punktu kontrolnego.
+ * @return true w przypadku sukcesu, false w przypadku błędu zapisu
+ *         lub problemów z pamięcią.
+ */
+static bool walWriteCheckpoint(Wal wal, PhoneBases bases,
+                               struct PhoneForward *currentBase,
+                               struct WalCheckpointHeader *header) {
+    struct WalCheckpointData state;
+    state.wal = wal;
+    state.currentBase = currentBase;
+    state.success = true;
+    memset(&state.header, 0, sizeof(state.header));
+    memcpy(state.header.magic, WAL_CHECKPOINT_MAGIC,
+           WAL_CHECKPOINT_MAGIC_LENGTH);
+    state.header.version = WAL_CHECKPOINT_VERSION;
+    state.header.generation = wal->generation + 1;
+    state.header.howManyBases = 0;
+    state.header.currentBase = WAL_NO_BASE;
+
+    state.manifest = fopen(walFileName(wal, wal->path,
+                                       WAL_CHECKPOINT_TMP_NAME), "wb");
+    if (state.manifest == NULL) {
+        return false;
+    }
+    state.success = fwrite(&state.header, sizeof(state.header), 1,
+                           state.manifest) == 1;
+    phoneBasesFold(bases, walCheckpointBase, &state);
+    state.success = state.success
+                    && fseek(state.manifest, 0, SEEK_SET) == 0
+                    && fwrite(&state.header, sizeof(state.header), 1,
+                              state.manifest) == 1
+                    && fflush(state.manifest) == 0
+                    && fsync(fileno(state.manifest)) == 0;
+    state.success = fclose(state.manifest) == 0 && state.success;
+    *header = state.header;
+    return state.success;
+}
+
+/**
+ * @brief Utrwala zmiany w katalogu dziennika (utworzenie i zmiany nazw
+ * plików).
+ * @param[in] wal - wskaźnik na dziennik.
+ * @return true w przypadku sukcesu, false w przeciwnym przypadku.
+ */
+static bool walSyncDirectory(Wal wal) {
+    return walSyncFile(wal->directory);
+}
+
+bool walCheckpoint(Wal wal, PhoneBases bases,
+                   struct PhoneForward *currentBase) {
+    struct WalCheckpointHeader header;
+    if (!walCommit(wal)
+        || !walWriteCheckpoint(wal, bases, currentBase, &header)
+        || rename(wal->path, walFileName(wal, wal->otherPath,
+                                         WAL_CHECKPOINT_NAME)) != 0
+        || !walSyncDirectory(wal)) {
+        remove(walFileName(wal, wal->path, WAL_CHECKPOINT_TMP_NAME));
+        return false;
+    }
+
+    uint64_t oldGeneration = wal->generation, i;
+    uint64_t oldHowManyBases = wal->howManyBases;
+    close(wal->fd);
+    wal->generation = header.generation;
+    wal->howManyBases = header.howManyBases;
+    wal->sinceCheckpoint = 0;
+    wal->fd = open(walLogName(wal, wal->path, wal->generation),
+                   O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0666);
+    wal->fileSize = 0;
+    if (wal->fd < 0) {
+        return false;
+    }
+
+    remove(walLogName(wal, wal->path, oldGeneration));
+    for (i = 0; i < oldHowManyBases; i++) {
+        remove(walBaseName(wal, wal->path, oldGeneration, i));
+    }
+    return walSyncDirectory(wal);
+}
+
+bool walClose(Wal wal) {
+    if (wal == NULL) {
+        return true;
+    }
+
+    bool result = true;
+    if (wal->fd >= 0) {
+        result = walCommit(wal);
+        result = close(wal->fd) == 0 && result;
+    }
+    free(wal->directory);
+    free(wal->path);
+    free(wal->otherPath);
+    free(wal->buffer);
+    free(wal);
+    return result;
+}
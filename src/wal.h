@@ -0,0 +1,158 @@
+/** @file
+ * Interfejs dziennika zapisu z wyprzedzeniem (ang. write-ahead log)
+ * operacji modyfikujących bazy przekierowań.
+ *
+ * Dziennik przechowywany jest w katalogu, w którym znajdują się:
+ * - plik checkpoint opisujący ostatni punkt kontrolny (numer pokolenia,
+ *   identyfikatory baz i bieżącą bazę),
+ * - pliki base.<pokolenie>.<i> z obrazami baz punktu kontrolnego
+ *   (zapisanymi przez @ref phfwdSave),
+ * - plik wal.<pokolenie> z binarnymi zapisami operacji wykonanych po
+ *   punkcie kontrolnym.
+ *
+ * Zapisy są buforowane i zapisywane do pliku grupami: po zebraniu
+ * zadanej liczby zapisów bufor jest zapisywany i utrwalany (fdatasync).
+ * Jeżeli zapis bufora się nie powiedzie, zapisy pozostają w buforze
+ * (a częściowo zapisane dane są obcinane) i są zapisywane przy kolejnej
+ * próbie, np. przez @ref walCommit.
+ * Odtwarzanie wczytuje punkt kontrolny i wykonuje jedynie zapisy z pliku
+ * bieżącego pokolenia, pomijając uszkodzoną końcówkę pliku.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#ifndef TELEFONY_WAL_H
+#define TELEFONY_WAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "phone_bases_system.h"
+
+/**
+ * @brief Domyślna liczba zapisów utrwalanych razem.
+ * @see walCreate
+ */
+#define WAL_DEFAULT_SYNC_EVERY 64
+
+/**
+ * @brief Domyślna liczba zapisów między punktami kontrolnymi.
+ * @see walCreate
+ */
+#define WAL_DEFAULT_CHECKPOINT_EVERY 1000000
+
+/**
+ * @brief Wskaźnik na dziennik.
+ * @see struct Wal
+ */
+typedef struct Wal *Wal;
+
+/**
+ * @brief Struktura reprezentująca otwarty dziennik.
+ */
+struct Wal;
+
+/**
+ * @brief Tworzy dziennik w katalogu @p directory.
+ * Tworzy katalog jeżeli nie istnieje. Przed zapisywaniem operacji należy
+ * wywołać @ref walRecover.
+ * @param[in] directory - ścieżka do katalogu dziennika.
+ * @param[in] syncEvery - liczba zapisów utrwalanych razem, 0 oznacza
+ *        zapisywanie bufora dopiero po jego zapełnieniu, bez utrwalania.
+ * @param[in] checkpointEvery - liczba zapisów, po której @ref walCheckpointDue
+ *        zgłasza potrzebę utworzenia punktu kontrolnego, 0 oznacza nigdy.
+ * @return Wskaźnik na dziennik, NULL w przypadku problemów z pamięcią
+ *         lub utworzeniem katalogu.
+ */
+Wal walCreate(const char *directory, size_t syncEvery, size_t checkpointEvery);
+
+/**
+ * @brief Odtwarza stan baz z dziennika.
+ * Wczytuje ostatni punkt kontrolny do @p bases i wykonuje zapisane po nim
+ * operacje. Uszkodzona końcówka pliku dziennika (np. przerwany zapis)
+ * jest pomijana i usuwana.
+ * @param[in, out] wal - wskaźnik na dziennik.
+ * @param[in, out] bases - wskaźnik na pustą strukturę baz.
+ * @param[out] currentBase - @p *currentBase wskazuje na bieżącą bazę
+ *        po odtworzeniu (NULL jeżeli jej nie ma).
+ * @return true w przypadku sukcesu, false w przypadku błędu odczytu,
+ *         niepoprawnego punktu kontrolnego lub problemów z pamięcią.
+ */
+bool walRecover(Wal wal, PhoneBases bases, struct PhoneForward **currentBase);
+
+/**
+ * @brief Zapisuje operację dodania (wybrania) bazy.
+ * @param[in, out] wal - wskaźnik na dziennik.
+ * @param[in] id - identyfikator bazy.
+ * @return true w przypadku sukcesu, false w przypadku błędu zapisu
+ *         lub problemów z pamięcią.
+ */
+bool walLogNewBase(Wal wal, const char *id);
+
+/**
+ * @brief Zapisuje operację usunięcia bazy.
+ * @param[in, out] wal - wskaźnik na dziennik.
+ * @param[in] id - identyfikator bazy.
+ * @return true w przypadku sukcesu, false w przypadku błędu zapisu
+ *         lub problemów z pamięcią.
+ */
+bool walLogDelBase(Wal wal, const char *id);
+
+/**
+ * @brief Zapisuje operację phfwdAdd na bieżącej bazie.
+ * @param[in, out] wal - wskaźnik na dziennik.
+ * @param[in] num1 - przekierowywany prefiks.
+ * @param[in] num2 - prefiks na który jest przekierowywany @p num1.
+ * @return true w przypadku sukcesu, false w przypadku błędu zapisu
+ *         lub problemów z pamięcią.
+ */
+bool walLogAdd(Wal wal, const char *num1, const char *num2);
+
+/**
+ * @brief Zapisuje operację phfwdRemove na bieżącej bazie.
+ * @param[in, out] wal - wskaźnik na dziennik.
+ * @param[in] num - usuwany prefiks.
+ * @return true w przypadku sukcesu, false w przypadku błędu zapisu
+ *         lub problemów z pamięcią.
+ */
+bool walLogRemove(Wal wal, const char *num);
+
+/**
+ * @brief Zapisuje do pliku i utrwala zbuforowane zapisy.
+ * @param[in, out] wal - wskaźnik na dziennik.
+ * @return true w przypadku sukcesu, false w przypadku błędu zapisu
+ *         (zapisy pozostają wtedy w buforze).
+ */
+bool walCommit(Wal wal);
+
+/**
+ * @param[in] wal - wskaźnik na dziennik.
+ * @return true jeżeli od ostatniego punktu kontrolnego zapisano co najmniej
+ *         tyle operacji ile podano przy tworzeniu dziennika.
+ */
+bool walCheckpointDue(Wal wal);
+
+/**
+ * @brief Tworzy punkt kontrolny.
+ * Zapisuje obrazy wszystkich baz, atomowo podmienia plik checkpoint
+ * i rozpoczyna nowy plik dziennika, a następnie usuwa pliki poprzedniego
+ * pokolenia. Przerwanie w dowolnym momencie pozostawia spójny dziennik.
+ * @param[in, out] wal - wskaźnik na dziennik.
+ * @param[in] bases - wskaźnik na strukturę baz.
+ * @param[in] currentBase - wskaźnik na bieżącą bazę (NULL jeżeli jej nie ma).
+ * @return true w przypadku sukcesu, false w przypadku błędu zapisu
+ *         lub problemów z pamięcią.
+ */
+bool walCheckpoint(Wal wal, PhoneBases bases,
+                   struct PhoneForward *currentBase);
+
+/**
+ * @brief Zamyka dziennik.
+ * Zapisuje i utrwala zbuforowane zapisy oraz zwalnia pamięć.
+ * @param[in] wal - wskaźnik na dziennik (NULL jest ignorowany).
+ * @return true w przypadku sukcesu, false w przypadku błędu zapisu.
+ */
+bool walClose(Wal wal);
+
+#endif //TELEFONY_WAL_H
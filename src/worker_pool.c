@@ -0,0 +1,255 @@
+/** @file
+ * Implementacja puli wątków wykonujących zadania ponumerowane od zera.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "worker_pool.h"
+#include "stdfunc.h"
+
+/**
+ * @brief Liczba zadań pobieranych przez wątek naraz.
+ */
+#define WORKER_POOL_CHUNK 8
+
+/**
+ * @brief Struktura reprezentująca pulę wątków.
+ * Pola opisujące zlecone zadania są zmieniane jedynie pod blokadą @p mutex,
+ * gdy żaden wątek puli nie wykonuje zadań (@p busy równe 0).
+ */
+struct WorkerPool {
+    /**
+     * @brief Wątki puli.
+     */
+    pthread_t *threads;
+
+    /**
+     * @brief Liczba wątków puli.
+     */
+    size_t howManyThreads;
+
+    /**
+     * @brief Blokada chroniąca stan puli.
+     */
+    pthread_mutex_t mutex;
+
+    /**
+     * @brief Zmienna warunkowa, na której wątki puli czekają na zadania.
+     */
+    pthread_cond_t workAvailable;
+
+    /**
+     * @brief Zmienna warunkowa, na której wątek zlecający czeka
+     * na zakończenie zadań.
+     */
+    pthread_cond_t workDone;
+
+    /**
+     * @brief Funkcja wykonująca zadanie.
+     */
+    void (*function)(size_t, void *);
+
+    /**
+     * @brief Dane pomocnicze do @p function.
+     */
+    void *data;
+
+    /**
+     * @brief Liczba zleconych zadań.
+     */
+    size_t howMany;
+
+    /**
+     * @brief Numer następnego niepobranego zadania.
+     */
+    atomic_size_t next;
+
+    /**
+     * @brief Liczba wykonanych zadań.
+     */
+    size_t finished;
+
+    /**
+     * @brief Numer zestawu zadań, zwiększany przy każdym zleceniu.
+     */
+    size_t generation;
+
+    /**
+     * @brief Liczba wątków puli wykonujących zadania.
+     */
+    size_t busy;
+
+    /**
+     * @brief Czy wątki puli mają się zakończyć.
+     */
+    bool closing;
+};
+
+/**
+ * @brief Pobiera i wykonuje zadania dopóki są niepobrane zadania.
+ * @param[in, out] pool - wskaźnik na pulę.
+ */
+static void workerPoolRun(WorkerPool pool) {
+    while (true) {
+        size_t begin = atomic_fetch_add(&pool->next, WORKER_POOL_CHUNK);
+        if (begin >= pool->howMany) {
+            return;
+        }
+        size_t end = MIN(begin + WORKER_POOL_CHUNK, pool->howMany);
+        size_t i;
+        for (i = begin; i < end; i++) {
+            (*pool->function)(i, pool->data);
+        }
+
+        pthread_mutex_lock(&pool->mutex);
+        pool->finished += end - begin;
+        if (pool->finished == pool->howMany) {
+            pthread_cond_broadcast(&pool->workDone);
+        }
+        pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+/**
+ * @brief Pętla wątku puli.
+ * @param[in, out] arg - wskaźnik na pulę.
+ * @return NULL.
+ */
+static void *workerPoolThread(void *arg) {
+    WorkerPool pool = arg;
+    size_t seen = 0;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (true) {
+        while (!pool->closing && pool->generation == seen) {
+            pthread_cond_wait(&pool->workAvailable, &pool->mutex);
+        }
+        if (pool->closing) {
+            break;
+        }
+        seen = pool->generation;
+        pool->busy++;
+        pthread_mutex_unlock(&pool->mutex);
+
+        workerPoolRun(pool);
+
+        pthread_mutex_lock(&pool->mutex);
+        pool->busy--;
+        if (pool->busy == 0) {
+            pthread_cond_broadcast(&pool->workDone);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+/**
+ * @brief Kończy wątki puli i zwalnia ją.
+ * @param[in] pool - wskaźnik na pulę.
+ * @param[in] started - liczba uruchomionych wątków.
+ */
+static void workerPoolFree(WorkerPool pool, size_t started) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->closing = true;
+    pthread_cond_broadcast(&pool->workAvailable);
+    pthread_mutex_unlock(&pool->mutex);
+
+    size_t i;
+    for (i = 0; i < started; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->workDone);
+    pthread_cond_destroy(&pool->workAvailable);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool->threads);
+    free(pool);
+}
+
+WorkerPool workerPoolCreate(size_t threads) {
+    WorkerPool pool = malloc(sizeof(struct WorkerPool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->threads = malloc(threads * sizeof(pthread_t));
+    if (pool->threads == NULL) {
+        free(pool);
+        return NULL;
+    }
+    if (pthread_mutex_init(&pool->mutex, NULL) != 0) {
+        free(pool->threads);
+        free(pool);
+        return NULL;
+    }
+    if (pthread_cond_init(&pool->workAvailable, NULL) != 0) {
+        pthread_mutex_destroy(&pool->mutex);
+        free(pool->threads);
+        free(pool);
+        return NULL;
+    }
+    if (pthread_cond_init(&pool->workDone, NULL) != 0) {
+        pthread_cond_destroy(&pool->workAvailable);
+        pthread_mutex_destroy(&pool->mutex);
+        free(pool->threads);
+        free(pool);
+        return NULL;
+    }
+
+    pool->howManyThreads = threads;
+    pool->function = NULL;
+    pool->data = NULL;
+    pool->howMany = 0;
+    atomic_init(&pool->next, 0);
+    pool->finished = 0;
+    pool->generation = 0;
+    pool->busy = 0;
+    pool->closing = false;
+
+    size_t i;
+    for (i = 0; i < threads; i++) {
+        if (pthread_create(&pool->threads[i], NULL, workerPoolThread,
+                           pool) != 0) {
+            workerPoolFree(pool, i);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+void workerPoolStart(WorkerPool pool, void (*f)(size_t, void *), void *data,
+                     size_t howMany) {
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->busy != 0) {
+        pthread_cond_wait(&pool->workDone, &pool->mutex);
+    }
+    pool->function = f;
+    pool->data = data;
+    pool->howMany = howMany;
+    atomic_store(&pool->next, 0);
+    pool->finished = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->workAvailable);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+void workerPoolWait(WorkerPool pool) {
+    workerPoolRun(pool);
+
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->finished != pool->howMany || pool->busy != 0) {
+        pthread_cond_wait(&pool->workDone, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+void workerPoolDelete(WorkerPool pool) {
+    if (pool != NULL) {
+        workerPoolFree(pool, pool->howManyThreads);
+    }
+}
@@ -0,0 +1,68 @@
+/** @file
+ * Interfejs puli wątków wykonujących zadania ponumerowane od zera.
+ * Zlecone zadania są wykonywane przez wątki puli w tle, a wątek
+ * zlecający może w tym czasie wykonywać inną pracę. Oczekując na
+ * zakończenie zadań (@ref workerPoolWait) wątek zlecający wykonuje
+ * zadania, których wątki puli jeszcze nie rozpoczęły. Jednocześnie może
+ * być zlecony jeden zestaw zadań, a funkcje puli mogą być wywoływane
+ * tylko przez jeden wątek.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#ifndef TELEFONY_WORKER_POOL_H
+#define TELEFONY_WORKER_POOL_H
+
+#include <stddef.h>
+
+/**
+ * @brief Wskaźnik na pulę wątków.
+ * @see struct WorkerPool
+ */
+typedef struct WorkerPool *WorkerPool;
+
+/**
+ * @brief Struktura reprezentująca pulę wątków.
+ */
+struct WorkerPool;
+
+/**
+ * @brief Tworzy pulę wątków.
+ * @param[in] threads - liczba wątków puli (różna od 0), nie licząc wątku
+ *        zlecającego zadania.
+ * @return Wskaźnik na pulę, NULL w przypadku problemów z pamięcią
+ *         lub utworzeniem wątków.
+ */
+WorkerPool workerPoolCreate(size_t threads);
+
+/**
+ * @brief Zleca wykonanie zadań.
+ * Zadanie o numerze i polega na wywołaniu f(i, data). Zadania mogą być
+ * wykonywane współbieżnie i w dowolnej kolejności. Przed zleceniem
+ * kolejnych zadań należy wywołać @ref workerPoolWait.
+ * @param[in, out] pool - wskaźnik na pulę.
+ * @param[in] f - wskaźnik na funkcję wykonującą zadanie.
+ * @param data - dane pomocnicze do funkcji @p f.
+ * @param[in] howMany - liczba zadań.
+ */
+void workerPoolStart(WorkerPool pool, void (*f)(size_t, void *), void *data,
+                     size_t howMany);
+
+/**
+ * @brief Czeka na wykonanie zleconych zadań.
+ * Wątek wywołujący funkcję również wykonuje zadania.
+ * @param[in, out] pool - wskaźnik na pulę.
+ */
+void workerPoolWait(WorkerPool pool);
+
+/**
+ * @brief Usuwa pulę.
+ * Kończy wątki puli. Zlecone zadania muszą być zakończone
+ * (patrz @ref workerPoolWait).
+ * @param[in] pool - wskaźnik na pulę (NULL jest ignorowany).
+ */
+void workerPoolDelete(WorkerPool pool);
+
+#endif //TELEFONY_WORKER_POOL_H
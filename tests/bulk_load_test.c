@@ -0,0 +1,382 @@
+/** @file
+ * Testy phfwdBulkLoad i phfwdBulkLoadParallel: wynik ma być taki sam jak
+ * po kolejnych wywołaniach phfwdAdd.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "phone_forward.h"
+#include "test_utils.h"
+
+/**
+ * @brief Znaki numerów.
+ */
+#define TEST_DIGITS "0123456789:;"
+
+/**
+ * @brief Największa długość losowanych numerów.
+ */
+#define TEST_MAX_LENGTH 10
+
+/**
+ * @brief Miejsce zajmowane przez jeden numer w tablicy numerów.
+ */
+#define TEST_SLOT (TEST_MAX_LENGTH + 1)
+
+/**
+ * @brief Liczba zapytań, na podstawie których porównywane są struktury.
+ */
+#define TEST_QUERIES 1000
+
+/**
+ * @brief Przekierowania do dodania.
+ */
+struct TestPairs {
+    /**
+     * @brief Numery, każdy zajmuje TEST_SLOT znaków.
+     */
+    char *numbers;
+
+    /**
+     * @brief Wskaźniki na numery: kolejno prefiks przekierowywany
+     * i prefiks, na który jest przekierowanie.
+     */
+    const char **pairs;
+
+    /**
+     * @brief Liczba przekierowań.
+     */
+    size_t howMany;
+};
+
+/**
+ * @brief Losuje przekierowania.
+ * Prefiksy są krótkie i złożone z kilku cyfr, więc wiele z nich się
+ * powtarza, a prefiksy, na które są przekierowania, są często prefiksami
+ * innych przekierowywanych numerów.
+ * @param[out] pairs - wskaźnik na przekierowania do zwolnienia przez
+ *             testPairsFree.
+ * @param[in] howMany - liczba przekierowań.
+ * @param[in] digits - znaki numerów.
+ * @param[in] maxLength - największa długość numerów (nie większa niż
+ *            TEST_MAX_LENGTH).
+ * @return true w przypadku sukcesu, false w przypadku problemów z pamięcią.
+ */
+static bool testRandomPairs(struct TestPairs *pairs, size_t howMany,
+                            const char *digits, size_t maxLength) {
+    size_t i;
+    pairs->numbers = malloc(2 * howMany * TEST_SLOT + 1);
+    pairs->pairs = malloc((2 * howMany + 1) * sizeof(const char *));
+    pairs->howMany = howMany;
+    if (pairs->numbers == NULL || pairs->pairs == NULL) {
+        return false;
+    }
+    for (i = 0; i < 2 * howMany; i += 2) {
+        char *source = pairs->numbers + i * TEST_SLOT;
+        char *target = source + TEST_SLOT;
+        testRandomNumber(source, 1, maxLength, digits);
+        do {
+            testRandomNumber(target, 1, maxLength, digits);
+        } while (strcmp(source, target) == 0);
+        pairs->pairs[i] = source;
+        pairs->pairs[i + 1] = target;
+    }
+    return true;
+}
+
+/**
+ * @brief Zwalnia przekierowania.
+ * @param[in] pairs - wskaźnik na przekierowania.
+ */
+static void testPairsFree(struct TestPairs *pairs) {
+    free(pairs->numbers);
+    free(pairs->pairs);
+}
+
+/**
+ * @brief Dodaje przekierowania kolejnymi wywołaniami phfwdAdd.
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[in] pairs - wskaźnik na przekierowania.
+ * @return true jeżeli wszystkie przekierowania zostały dodane.
+ */
+static bool testAddAll(struct PhoneForward *pf,
+                       const struct TestPairs *pairs) {
+    size_t i;
+    for (i = 0; i < pairs->howMany; i++) {
+        if (!phfwdAdd(pf, pairs->pairs[2 * i], pairs->pairs[2 * i + 1])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Porównuje wyniki phfwdGet, phfwdReverse i phfwdNonTrivialCount
+ * dwóch struktur.
+ * @param[in] a - wskaźnik na pierwszą strukturę.
+ * @param[in] b - wskaźnik na drugą strukturę.
+ * @param[in] digits - znaki numerów w zapytaniach.
+ * @param[in] maxLength - największa długość prefiksów przekierowań.
+ * @return true jeżeli struktury dają te same wyniki.
+ */
+static bool testSameBase(struct PhoneForward *a, struct PhoneForward *b,
+                         const char *digits, size_t maxLength) {
+    char num[TEST_MAX_LENGTH + 3];
+    bool result = true;
+    size_t length;
+    for (length = 1; length <= 3 && result; length++) {
+        result = phfwdNonTrivialCount(a, digits, length)
+                 == phfwdNonTrivialCount(b, digits, length);
+    }
+    int i;
+    for (i = 0; i < TEST_QUERIES && result; i++) {
+        testRandomNumber(num, 1, maxLength + 2, digits);
+        const struct PhoneNumbers *x = phfwdGet(a, num);
+        const struct PhoneNumbers *y = phfwdGet(b, num);
+        result = testSameNumbers(x, y);
+        phnumDelete(x);
+        phnumDelete(y);
+        x = phfwdReverse(a, num);
+        y = phfwdReverse(b, num);
+        result = result && testSameNumbers(x, y);
+        phnumDelete(x);
+        phnumDelete(y);
+    }
+    return result;
+}
+
+/**
+ * @brief phfwdBulkLoad na pustej i na niepustej strukturze daje ten sam
+ * wynik co phfwdAdd, także po kolejnych modyfikacjach.
+ * @param[in] concurrent - czy struktury mają być utworzone przez
+ *            phfwdNewConcurrent.
+ * @param[in] howMany - liczba przekierowań.
+ * @param[in] digits - znaki numerów.
+ * @param[in] maxLength - największa długość numerów.
+ */
+static void testMatchesAdd(bool concurrent, size_t howMany,
+                           const char *digits, size_t maxLength) {
+    struct TestPairs pairs = {NULL, NULL, 0}, more = {NULL, NULL, 0};
+    struct PhoneForward *bulk = concurrent ? phfwdNewConcurrent() : phfwdNew();
+    struct PhoneForward *added = concurrent ? phfwdNewConcurrent()
+                                            : phfwdNew();
+    if (!testExpect(testRandomPairs(&pairs, howMany, digits, maxLength)
+                    && testRandomPairs(&more, howMany / 2 + 1, digits,
+                                       maxLength)
+                    && bulk != NULL && added != NULL,
+                    "przygotowanie przekierowań")) {
+        testPairsFree(&pairs);
+        testPairsFree(&more);
+        phfwdDelete(bulk);
+        phfwdDelete(added);
+        return;
+    }
+
+    testExpect(phfwdBulkLoad(bulk, pairs.pairs, pairs.howMany)
+               && testAddAll(added, &pairs),
+               "dodanie przekierowań do pustej struktury");
+    testExpect(testSameBase(bulk, added, digits, maxLength),
+               "phfwdBulkLoad na pustej strukturze jak phfwdAdd");
+
+    testExpect(phfwdBulkLoad(bulk, more.pairs, more.howMany)
+               && testAddAll(added, &more),
+               "dodanie przekierowań do niepustej struktury");
+    testExpect(testSameBase(bulk, added, digits, maxLength),
+               "phfwdBulkLoad na niepustej strukturze jak phfwdAdd");
+
+    size_t i;
+    for (i = 0; i < howMany / 8; i++) {
+        phfwdRemove(bulk, pairs.pairs[2 * i]);
+        phfwdRemove(added, pairs.pairs[2 * i]);
+        phfwdAdd(bulk, more.pairs[2 * i + 1], pairs.pairs[2 * i]);
+        phfwdAdd(added, more.pairs[2 * i + 1], pairs.pairs[2 * i]);
+    }
+    testExpect(testSameBase(bulk, added, digits, maxLength),
+               "modyfikacje po phfwdBulkLoad");
+
+    testPairsFree(&pairs);
+    testPairsFree(&more);
+    phfwdDelete(bulk);
+    phfwdDelete(added);
+}
+
+/**
+ * @brief Zmienia pierwszą cyfrę większości numerów na @p digit, tak aby
+ * prawie wszystkie przekierowania trafiły do jednego poddrzewa.
+ * @param[in, out] pairs - wskaźnik na przekierowania.
+ * @param[in] digit - dominująca pierwsza cyfra.
+ * @param[in] percent - odsetek zmienianych numerów.
+ */
+static void testSkewPairs(struct TestPairs *pairs, char digit,
+                          unsigned percent) {
+    size_t i;
+    for (i = 0; i < 2 * pairs->howMany; i += 2) {
+        char *source = pairs->numbers + i * TEST_SLOT;
+        char *target = source + TEST_SLOT;
+        if (testRandom() % 100 < percent) {
+            source[0] = digit;
+        }
+        if (testRandom() % 100 < percent) {
+            target[0] = digit;
+        }
+        if (strcmp(source, target) == 0) {
+            target[0] = digit == '0' ? '1' : '0';
+        }
+    }
+}
+
+/**
+ * @brief phfwdBulkLoadParallel daje ten sam wynik co phfwdBulkLoad.
+ * @param[in] concurrent - czy struktury mają być utworzone przez
+ *            phfwdNewConcurrent.
+ * @param[in] howMany - liczba przekierowań.
+ * @param[in] threads - liczba wątków.
+ * @param[in] percent - odsetek numerów zaczynających się od 7
+ *            (patrz testSkewPairs).
+ * @param[in] description - opis sprawdzanego przypadku.
+ */
+static void testParallelMatchesSerial(bool concurrent, size_t howMany,
+                                      size_t threads, unsigned percent,
+                                      const char *description) {
+    struct TestPairs pairs = {NULL, NULL, 0}, more = {NULL, NULL, 0};
+    struct PhoneForward *parallel = concurrent ? phfwdNewConcurrent()
+                                               : phfwdNew();
+    struct PhoneForward *serial = concurrent ? phfwdNewConcurrent()
+                                             : phfwdNew();
+    if (!testExpect(testRandomPairs(&pairs, howMany, TEST_DIGITS, 6)
+                    && testRandomPairs(&more, howMany, TEST_DIGITS, 6)
+                    && parallel != NULL && serial != NULL,
+                    "przygotowanie przekierowań")) {
+        testPairsFree(&pairs);
+        testPairsFree(&more);
+        phfwdDelete(parallel);
+        phfwdDelete(serial);
+        return;
+    }
+    testSkewPairs(&pairs, '7', percent);
+    testSkewPairs(&more, '7', percent);
+
+    testExpect(phfwdBulkLoadParallel(parallel, pairs.pairs, pairs.howMany,
+                                     threads)
+               && phfwdBulkLoad(serial, pairs.pairs, pairs.howMany)
+               && testSameBase(parallel, serial, TEST_DIGITS, 6),
+               description);
+    testExpect(phfwdBulkLoadParallel(parallel, more.pairs, more.howMany,
+                                     threads)
+               && phfwdBulkLoad(serial, more.pairs, more.howMany)
+               && testSameBase(parallel, serial, TEST_DIGITS, 6),
+               description);
+
+    testPairsFree(&pairs);
+    testPairsFree(&more);
+    phfwdDelete(parallel);
+    phfwdDelete(serial);
+}
+
+/**
+ * @brief Niepoprawne pary nie zmieniają struktury.
+ * @param[in] nonEmpty - czy struktura ma zawierać przekierowania przed
+ *            wywołaniem phfwdBulkLoad.
+ */
+static void testInvalid(bool nonEmpty) {
+    static const char *const invalid[][2] = {
+            {"12a", "3"}, {"1", "3-"}, {"", "3"}, {"1", ""}, {"44", "44"},
+            {NULL, "3"}, {"1", NULL}
+    };
+    struct TestPairs pairs;
+    struct PhoneForward *bulk = phfwdNew();
+    struct PhoneForward *expected = phfwdNew();
+    if (!testExpect(testRandomPairs(&pairs, 100, "0123", 4) && bulk != NULL
+                    && expected != NULL, "przygotowanie przekierowań")) {
+        testPairsFree(&pairs);
+        phfwdDelete(bulk);
+        phfwdDelete(expected);
+        return;
+    }
+    if (nonEmpty) {
+        phfwdAdd(bulk, "1", "2");
+        phfwdAdd(expected, "1", "2");
+    }
+
+    size_t i;
+    for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        pairs.pairs[100] = invalid[i][0];
+        pairs.pairs[101] = invalid[i][1];
+        testExpect(!phfwdBulkLoad(bulk, pairs.pairs, pairs.howMany),
+                   "phfwdBulkLoad odrzuca niepoprawną parę");
+        testExpect(testSameBase(bulk, expected, "0123", 4),
+                   "niepoprawna para nie zmienia struktury");
+    }
+    testExpect(phfwdBulkLoad(bulk, pairs.pairs, 0),
+               "phfwdBulkLoad bez przekierowań");
+    pairs.howMany = 50;
+    testExpect(phfwdBulkLoad(bulk, pairs.pairs, pairs.howMany)
+               && testAddAll(expected, &pairs)
+               && testSameBase(bulk, expected, "0123", 4),
+               "phfwdBulkLoad po odrzuceniu niepoprawnych par");
+
+    testPairsFree(&pairs);
+    phfwdDelete(bulk);
+    phfwdDelete(expected);
+}
+
+/**
+ * @brief phfwdBulkLoad nie zmienia struktury wczytanej przez
+ * phfwdLoadMapped.
+ */
+static void testReadOnly(void) {
+    char path[256];
+    const char *const pairs[] = {"1", "2"};
+    struct PhoneForward *pf = phfwdNew();
+    if (!testExpect(testTemporaryPath(path, sizeof(path), "bulk.pf")
+                    && pf != NULL && phfwdAdd(pf, "3", "4")
+                    && phfwdSave(pf, path), "zapis struktury")) {
+        phfwdDelete(pf);
+        return;
+    }
+    struct PhoneForward *mapped = phfwdLoadMapped(path);
+    testExpect(mapped != NULL && !phfwdBulkLoad(mapped, pairs, 1)
+               && testSameBase(pf, mapped, "1234", 2),
+               "phfwdBulkLoad na strukturze tylko do odczytu");
+    phfwdDelete(mapped);
+    phfwdDelete(pf);
+    remove(path);
+}
+
+/**
+ * @brief Uruchamia testy phfwdBulkLoad i phfwdBulkLoadParallel.
+ * @return 0 jeżeli wszystkie testy się powiodły, 1 w przeciwnym przypadku.
+ */
+int main(void) {
+    testMatchesAdd(false, 1, "01", 2);
+    testMatchesAdd(false, 3000, "0123", 4);
+    testMatchesAdd(true, 3000, "0123", 4);
+    testMatchesAdd(false, 20000, TEST_DIGITS, TEST_MAX_LENGTH);
+    testMatchesAdd(true, 5000, "5", TEST_MAX_LENGTH);
+    testParallelMatchesSerial(false, 20000, 4, 0,
+                              "równomiernie rozłożone pierwsze cyfry");
+    testParallelMatchesSerial(false, 20000, 3, 95,
+                              "prawie wszystkie numery od jednej cyfry");
+    testParallelMatchesSerial(true, 5000, 12, 100,
+                              "wszystkie numery od jednej cyfry");
+    testParallelMatchesSerial(false, 5000, 64, 50,
+                              "więcej wątków niż poddrzew");
+    size_t howMany;
+    for (howMany = 1; howMany <= 3; howMany++) {
+        testParallelMatchesSerial(false, howMany, 8, 0,
+                                  "mniej przekierowań niż wątków");
+        testParallelMatchesSerial(true, howMany, 8, 100,
+                                  "mniej przekierowań niż wątków");
+    }
+    testInvalid(false);
+    testInvalid(true);
+    testReadOnly();
+    return testResult();
+}
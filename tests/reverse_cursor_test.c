@@ -0,0 +1,307 @@
+/** @file
+ * Testy kursora phfwdReverseOpen, phfwdReverseNext i phfwdReverseClose.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "phone_forward.h"
+#include "test_utils.h"
+
+/**
+ * @brief Znaki numerów.
+ */
+#define TEST_DIGITS "0123456789:;"
+
+/**
+ * @brief Największa długość losowanych numerów.
+ */
+#define TEST_MAX_LENGTH 8
+
+/**
+ * @brief Liczba przekierowań na wspólny prefiks, po której końcówki
+ * tablic przekierowań na niego nie są puste.
+ */
+#define TEST_FAN_IN 3000
+
+/**
+ * @brief Pobiera z kursora wszystkie pozostałe numery i porównuje je
+ * z numerami @p expected od pozycji @p from.
+ * @param[in, out] cursor - wskaźnik na kursor.
+ * @param[in] expected - oczekiwany wynik.
+ * @param[in] from - pozycja pierwszego oczekiwanego numeru.
+ * @return true jeżeli kursor zwrócił dokładnie oczekiwane numery.
+ */
+static bool testCursorRest(struct PhoneReverseCursor *cursor,
+                           const struct PhoneNumbers *expected, size_t from) {
+    const char *number;
+    size_t i = from;
+    while (phfwdReverseNext(cursor, &number) && number != NULL) {
+        const char *wanted = phnumGet(expected, i);
+        if (wanted == NULL || strcmp(wanted, number) != 0) {
+            return false;
+        }
+        i++;
+    }
+    return number == NULL && phnumGet(expected, i) == NULL;
+}
+
+/**
+ * @brief Sprawdza, czy kursor zwraca ten sam ciąg numerów co phfwdReverse.
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[in] num - numer.
+ * @return true jeżeli wyniki są równe.
+ */
+static bool testCursorMatches(struct PhoneForward *pf, const char *num) {
+    const struct PhoneNumbers *expected = phfwdReverse(pf, num);
+    struct PhoneReverseCursor *cursor = phfwdReverseOpen(pf, num);
+    bool result = expected != NULL && cursor != NULL
+                  && testCursorRest(cursor, expected, 0);
+    phfwdReverseClose(cursor);
+    phnumDelete(expected);
+    return result;
+}
+
+/**
+ * @brief Dodaje losowe przekierowania na krótkie prefiksy zaczynające się
+ * od 5 i usuwa część z nich, tak aby tablice przekierowań miały dziury
+ * i nieposortowane końcówki.
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[in] howMany - liczba dodawanych przekierowań.
+ */
+static void testFillBase(struct PhoneForward *pf, size_t howMany) {
+    char source[TEST_MAX_LENGTH + 1], target[TEST_MAX_LENGTH + 1];
+    size_t i;
+    for (i = 0; i < howMany; i++) {
+        testRandomNumber(source, 1, TEST_MAX_LENGTH, TEST_DIGITS);
+        testRandomNumber(target + 1, 0, 2, "01");
+        target[0] = '5';
+        phfwdAdd(pf, source, target);
+        if (testRandom() % 16 == 0) {
+            testRandomNumber(source, 3, 4, TEST_DIGITS);
+            phfwdRemove(pf, source);
+        }
+    }
+}
+
+/**
+ * @brief Numery, dla których porównywane są wyniki.
+ */
+static const char *const testQueries[] = {
+        "5", "50", "51", "500", "501", "510", "5011", "5000123", "1", "",
+        "5a", "99999999"
+};
+
+/**
+ * @brief Porównuje kursor z phfwdReverse dla wszystkich numerów
+ * z testQueries.
+ * @param[in] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[in] description - opis sprawdzanej struktury.
+ */
+static void testAllQueries(struct PhoneForward *pf, const char *description) {
+    size_t i;
+    for (i = 0; i < sizeof(testQueries) / sizeof(testQueries[0]); i++) {
+        if (!testCursorMatches(pf, testQueries[i])) {
+            fprintf(stderr, "numer \"%s\"\n", testQueries[i]);
+            testExpect(false, description);
+        }
+    }
+}
+
+/**
+ * @brief Kursor zwraca to samo co phfwdReverse, także po kolejnych
+ * dodaniach i usunięciach przekierowań między otwarciami kursora.
+ * @param[in] concurrent - czy struktura ma być utworzona przez
+ *            phfwdNewConcurrent.
+ */
+static void testMatchesReverse(bool concurrent) {
+    struct PhoneForward *pf = concurrent ? phfwdNewConcurrent() : phfwdNew();
+    testAllQueries(pf, "kursor na pustej strukturze");
+
+    int round;
+    for (round = 0; round < 4; round++) {
+        testFillBase(pf, TEST_FAN_IN);
+        testAllQueries(pf, "kursor po dodaniu i usunięciu przekierowań");
+    }
+    phfwdRemove(pf, "1");
+    phfwdRemove(pf, "2");
+    testAllQueries(pf, "kursor po usunięciu poddrzew");
+    phfwdDelete(pf);
+}
+
+/**
+ * @brief Kursor na strukturze wczytanej przez phfwdLoadMapped.
+ */
+static void testMapped(void) {
+    char path[256];
+    if (!testExpect(testTemporaryPath(path, sizeof(path), "cursor.pf"),
+                    "nazwa pliku tymczasowego")) {
+        return;
+    }
+
+    struct PhoneForward *pf = phfwdNew();
+    testFillBase(pf, TEST_FAN_IN);
+    struct PhoneForward *mapped = NULL;
+    if (testExpect(phfwdSave(pf, path), "phfwdSave")) {
+        mapped = phfwdLoadMapped(path);
+        testExpect(mapped != NULL, "phfwdLoadMapped");
+    }
+    if (mapped != NULL) {
+        testAllQueries(mapped, "kursor na odwzorowanej strukturze");
+        struct PhoneReverseCursor *cursor = phfwdReverseOpen(mapped, "5");
+        const char *number;
+        testExpect(cursor != NULL && phfwdReverseNext(cursor, &number)
+                   && number != NULL,
+                   "pierwszy numer z kursora na odwzorowanej strukturze");
+        phfwdReverseClose(cursor);
+    }
+    phfwdDelete(mapped);
+    phfwdDelete(pf);
+    remove(path);
+}
+
+/**
+ * @brief Dane wątku modyfikującego strukturę.
+ */
+struct TestWriter {
+    /**
+     * @brief Modyfikowana struktura.
+     */
+    struct PhoneForward *pf;
+
+    /**
+     * @brief Czy wątek zakończył modyfikacje.
+     */
+    atomic_bool done;
+};
+
+/**
+ * @brief Dodaje i usuwa przekierowanie na prefiks 5.
+ * @param[in, out] data - wskaźnik na struct TestWriter.
+ * @return NULL.
+ */
+static void *testWriterRun(void *data) {
+    struct TestWriter *writer = data;
+    phfwdAdd(writer->pf, "777", "5");
+    phfwdRemove(writer->pf, "1");
+    atomic_store(&writer->done, true);
+    return NULL;
+}
+
+/**
+ * @brief Modyfikacje z innego wątku czekają na zamknięcie kursora, który
+ * do tego czasu zwraca numery ze stanu z chwili otwarcia, a kolejny kursor
+ * widzi już zmiany.
+ */
+static void testConcurrentWriter(void) {
+    struct PhoneForward *pf = phfwdNewConcurrent();
+    testFillBase(pf, TEST_FAN_IN);
+    phfwdAdd(pf, "1", "5");
+
+    const struct PhoneNumbers *before = phfwdReverse(pf, "5");
+    struct PhoneReverseCursor *cursor = phfwdReverseOpen(pf, "5");
+    if (!testExpect(before != NULL && cursor != NULL
+                    && phnumGet(before, 1) != NULL,
+                    "otwarcie kursora przed modyfikacjami")) {
+        phfwdReverseClose(cursor);
+        phnumDelete(before);
+        phfwdDelete(pf);
+        return;
+    }
+    const char *number;
+    testExpect(phfwdReverseNext(cursor, &number) && number != NULL
+               && strcmp(number, phnumGet(before, 0)) == 0,
+               "pierwszy numer przed modyfikacjami");
+
+    struct TestWriter writer;
+    writer.pf = pf;
+    atomic_init(&writer.done, false);
+    pthread_t thread;
+    if (!testExpect(pthread_create(&thread, NULL, testWriterRun, &writer) == 0,
+                    "utworzenie wątku")) {
+        phfwdReverseClose(cursor);
+        phnumDelete(before);
+        phfwdDelete(pf);
+        return;
+    }
+    struct timespec pause = {0, 50 * 1000 * 1000};
+    nanosleep(&pause, NULL);
+    testExpect(!atomic_load(&writer.done),
+               "modyfikacja czeka na zamknięcie kursora");
+    testExpect(testCursorRest(cursor, before, 1),
+               "kursor zwraca stan z chwili otwarcia");
+    phfwdReverseClose(cursor);
+    pthread_join(thread, NULL);
+    testExpect(atomic_load(&writer.done), "modyfikacja po zamknięciu");
+
+    const struct PhoneNumbers *after = phfwdReverse(pf, "5");
+    bool found777 = false, found1 = false;
+    size_t i;
+    for (i = 0; phnumGet(after, i) != NULL; i++) {
+        found777 = found777 || strcmp(phnumGet(after, i), "777") == 0;
+        found1 = found1 || strcmp(phnumGet(after, i), "1") == 0;
+    }
+    testExpect(found777 && !found1, "phfwdReverse widzi modyfikacje");
+    testAllQueries(pf, "kursor po modyfikacjach z innego wątku");
+
+    phnumDelete(after);
+    phnumDelete(before);
+    phfwdDelete(pf);
+}
+
+/**
+ * @brief Zamykanie kursora, z którego nie pobrano wszystkich numerów.
+ * @param[in] concurrent - czy struktura ma być utworzona przez
+ *            phfwdNewConcurrent.
+ */
+static void testCloseUnfinished(bool concurrent) {
+    struct PhoneForward *pf = concurrent ? phfwdNewConcurrent() : phfwdNew();
+    testFillBase(pf, TEST_FAN_IN);
+
+    struct PhoneReverseCursor *cursor = phfwdReverseOpen(pf, "5");
+    testExpect(cursor != NULL, "otwarcie kursora");
+    phfwdReverseClose(cursor);
+
+    cursor = phfwdReverseOpen(pf, "50");
+    const char *number;
+    testExpect(cursor != NULL && phfwdReverseNext(cursor, &number)
+               && number != NULL, "pierwszy numer z kursora");
+    phfwdReverseClose(cursor);
+
+    struct PhoneReverseCursor *first = phfwdReverseOpen(pf, "5");
+    struct PhoneReverseCursor *second = phfwdReverseOpen(pf, "51");
+    testExpect(first != NULL && second != NULL
+               && phfwdReverseNext(first, &number) && number != NULL
+               && phfwdReverseNext(second, &number) && number != NULL,
+               "dwa jednocześnie otwarte kursory");
+    phfwdReverseClose(second);
+    phfwdReverseClose(first);
+    phfwdReverseClose(NULL);
+
+    testExpect(phfwdAdd(pf, "12345", "5"),
+               "modyfikacja po zamknięciu niedokończonych kursorów");
+    testAllQueries(pf, "kursor po zamknięciu niedokończonych kursorów");
+    phfwdDelete(pf);
+}
+
+/**
+ * @brief Uruchamia testy kursora.
+ * @return 0 jeżeli wszystkie testy się powiodły, 1 w przeciwnym przypadku.
+ */
+int main(void) {
+    testMatchesReverse(false);
+    testMatchesReverse(true);
+    testMapped();
+    testConcurrentWriter();
+    testCloseUnfinished(false);
+    testCloseUnfinished(true);
+    return testResult();
+}
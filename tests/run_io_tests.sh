@@ -0,0 +1,44 @@
+#!/bin/bash
+
+#Uruchamia program $1 dla każdego pliku <nazwa>.in z katalogu $2
+#i porównuje standardowe wyjście z <nazwa>.out, a wyjście diagnostyczne
+#z <nazwa>.err. Program powinien zakończyć się kodem 1 wtedy i tylko wtedy,
+#gdy plik <nazwa>.err nie jest pusty.
+#Kończy skrypt kodem 1, jeżeli któryś z testów się nie powiódł.
+
+if [ "$#" != "2" ]
+then
+	echo 'Zła liczba argumentów oczekiwano <prog> <katalog>'
+	exit 1
+fi
+
+PROGRAM_PATH=$1
+DIRECTORY=$2
+
+TMP_OUTPUT=$(mktemp) || exit 1
+TMP_ERROR=$(mktemp) || exit 1
+trap 'rm -f "$TMP_OUTPUT" "$TMP_ERROR"' EXIT
+
+failed=0
+for input in "$DIRECTORY"/*.in
+do
+	name=${input%.in}
+	"$PROGRAM_PATH" < "$input" > "$TMP_OUTPUT" 2> "$TMP_ERROR"
+	exitCode=$?
+
+	expectedCode=0
+	if [ -s "$name.err" ]
+	then
+		expectedCode=1
+	fi
+
+	if ! cmp -s "$TMP_OUTPUT" "$name.out" \
+		|| ! cmp -s "$TMP_ERROR" "$name.err" \
+		|| [ "$exitCode" != "$expectedCode" ]
+	then
+		echo "Błąd: $(basename "$name")"
+		failed=1
+	fi
+done
+
+exit $failed
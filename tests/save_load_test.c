@@ -0,0 +1,279 @@
+/** @file
+ * Testy zapisu struktury przez phfwdSave i jej wczytania przez phfwdLoad
+ * i phfwdLoadMapped.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "phone_forward.h"
+#include "test_utils.h"
+
+/**
+ * @brief Znaki numerów.
+ */
+#define TEST_DIGITS "0123456789:;"
+
+/**
+ * @brief Największa długość losowanych numerów.
+ */
+#define TEST_MAX_LENGTH 12
+
+/**
+ * @brief Liczba zapytań, na podstawie których porównywane są struktury.
+ */
+#define TEST_QUERIES 2000
+
+/**
+ * @brief Dodaje losowe przekierowania i usuwa część z nich.
+ * Przekierowania są na krótkie prefiksy, aby phfwdReverse zwracało wiele
+ * numerów, a przekierowywane prefiksy mają różne długości, aby drzewa miały
+ * zarówno krótkie, jak i długie krawędzie.
+ * @param[in, out] pf - wskaźnik na strukturę przechowującą przekierowania.
+ * @param[in] howMany - liczba dodawanych przekierowań.
+ */
+static void testFillBase(struct PhoneForward *pf, size_t howMany) {
+    char source[TEST_MAX_LENGTH + 1], target[TEST_MAX_LENGTH + 1];
+    size_t i;
+    for (i = 0; i < howMany; i++) {
+        testRandomNumber(source, 1, TEST_MAX_LENGTH, TEST_DIGITS);
+        if (testRandom() % 4 == 0) {
+            testRandomNumber(target, 1, TEST_MAX_LENGTH, TEST_DIGITS);
+        } else {
+            testRandomNumber(target, 1, 3, "12");
+        }
+        phfwdAdd(pf, source, target);
+        if (testRandom() % 8 == 0) {
+            testRandomNumber(source, 1, 3, TEST_DIGITS);
+            phfwdRemove(pf, source);
+        }
+    }
+}
+
+/**
+ * @brief Porównuje wyniki phfwdGet, phfwdReverse i phfwdNonTrivialCount
+ * dwóch struktur.
+ * @param[in] a - wskaźnik na pierwszą strukturę.
+ * @param[in] b - wskaźnik na drugą strukturę.
+ * @return true jeżeli struktury dają te same wyniki.
+ */
+static bool testSameBase(struct PhoneForward *a, struct PhoneForward *b) {
+    char num[TEST_MAX_LENGTH + 1];
+    bool result = phfwdNonTrivialCount(a, "12", 3)
+                  == phfwdNonTrivialCount(b, "12", 3)
+                  && phfwdNonTrivialCount(a, TEST_DIGITS, 2)
+                     == phfwdNonTrivialCount(b, TEST_DIGITS, 2);
+    int i;
+    for (i = 0; i < TEST_QUERIES && result; i++) {
+        const struct PhoneNumbers *x, *y;
+        if (i % 2 == 0) {
+            testRandomNumber(num, 1, TEST_MAX_LENGTH, TEST_DIGITS);
+            x = phfwdGet(a, num);
+            y = phfwdGet(b, num);
+        } else {
+            testRandomNumber(num, 1, 4, "12");
+            x = phfwdReverse(a, num);
+            y = phfwdReverse(b, num);
+        }
+        result = testSameNumbers(x, y);
+        phnumDelete(x);
+        phnumDelete(y);
+    }
+    return result;
+}
+
+/**
+ * @brief Zapisuje strukturę i porównuje z nią struktury wczytane przez
+ * phfwdLoad i phfwdLoadMapped.
+ * @param[in] pf - wskaźnik na zapisywaną strukturę.
+ * @param[in] path - ścieżka do pliku.
+ * @param[in] description - opis zapisywanej struktury.
+ */
+static void testRoundTrip(struct PhoneForward *pf, const char *path,
+                          const char *description) {
+    if (!testExpect(phfwdSave(pf, path), description)) {
+        return;
+    }
+    struct PhoneForward *loaded = phfwdLoad(path);
+    struct PhoneForward *mapped = phfwdLoadMapped(path);
+    testExpect(loaded != NULL && testSameBase(pf, loaded), description);
+    testExpect(mapped != NULL && testSameBase(pf, mapped), description);
+
+    if (loaded != NULL && mapped != NULL) {
+        const struct PhoneNumbers *before = phfwdGet(mapped, "123");
+        testExpect(phfwdAdd(loaded, "123", "4")
+                   && !phfwdAdd(mapped, "123", "4"),
+                   "phfwdLoad można modyfikować, a phfwdLoadMapped nie");
+        const struct PhoneNumbers *after = phfwdGet(mapped, "123");
+        testExpect(testSameNumbers(before, after),
+                   "phfwdLoadMapped tylko do odczytu");
+        phnumDelete(before);
+        phnumDelete(after);
+    }
+    phfwdDelete(loaded);
+    phfwdDelete(mapped);
+}
+
+/**
+ * @brief Obraz odczytany z pliku.
+ */
+struct TestImage {
+    /**
+     * @brief Zawartość pliku.
+     */
+    char *data;
+
+    /**
+     * @brief Rozmiar pliku w bajtach.
+     */
+    size_t size;
+};
+
+/**
+ * @brief Wczytuje cały plik.
+ * @param[in] path - ścieżka do pliku.
+ * @param[out] image - wskaźnik na obraz (data równe NULL w przypadku
+ *             błędu).
+ */
+static void testReadImage(const char *path, struct TestImage *image) {
+    FILE *file = fopen(path, "rb");
+    long length = -1;
+    image->data = NULL;
+    image->size = 0;
+    if (file != NULL && fseek(file, 0, SEEK_END) == 0
+        && (length = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0) {
+        image->data = malloc((size_t) length);
+        image->size = (size_t) length;
+        if (image->data != NULL
+            && fread(image->data, 1, image->size, file) != image->size) {
+            free(image->data);
+            image->data = NULL;
+        }
+    }
+    if (file != NULL) {
+        fclose(file);
+    }
+}
+
+/**
+ * @brief Zapisuje początek obrazu do pliku.
+ * @param[in] path - ścieżka do pliku.
+ * @param[in] image - wskaźnik na obraz.
+ * @param[in] size - liczba zapisywanych bajtów.
+ * @return true w przypadku sukcesu.
+ */
+static bool testWriteImage(const char *path, const struct TestImage *image,
+                           size_t size) {
+    FILE *file = fopen(path, "wb");
+    bool result = file != NULL && fwrite(image->data, 1, size, file) == size;
+    if (file != NULL) {
+        result = fclose(file) == 0 && result;
+    }
+    return result;
+}
+
+/**
+ * @brief Wykonuje zapytania na strukturze wczytanej z uszkodzonego pliku.
+ * Wyniki nie są sprawdzane: struktura może być wczytana, jeżeli uszkodzenie
+ * trafiło np. w dopełnienie, ale zapytania nie mogą wyjść poza obraz
+ * (co wykrywa uruchomienie testu z AddressSanitizerem).
+ * @param[in] pf - wskaźnik na strukturę albo NULL.
+ */
+static void testQueryCorrupted(struct PhoneForward *pf) {
+    char num[TEST_MAX_LENGTH + 1];
+    int i;
+    if (pf == NULL) {
+        return;
+    }
+    for (i = 0; i < 20; i++) {
+        testRandomNumber(num, 1, TEST_MAX_LENGTH, TEST_DIGITS);
+        phnumDelete(phfwdGet(pf, num));
+        testRandomNumber(num, 1, 4, "12");
+        phnumDelete(phfwdReverse(pf, num));
+    }
+    phfwdNonTrivialCount(pf, TEST_DIGITS, 3);
+}
+
+/**
+ * @brief Uszkodzone pliki są odrzucane lub wczytywane bez wychodzenia
+ * poza obraz.
+ * @param[in] path - ścieżka do pliku.
+ */
+static void testCorrupted(const char *path) {
+    struct PhoneForward *pf = phfwdNew();
+    struct TestImage image;
+    size_t i;
+    testFillBase(pf, 60);
+    testExpect(phfwdSave(pf, path), "zapis małej struktury");
+    phfwdDelete(pf);
+    testReadImage(path, &image);
+    if (!testExpect(image.data != NULL, "odczyt obrazu")) {
+        return;
+    }
+
+    for (i = 0; i < image.size; i += 1 + i / 16) {
+        testExpect(testWriteImage(path, &image, i),
+                   "zapis obciętego obrazu");
+        pf = phfwdLoadMapped(path);
+        testExpect(pf == NULL, "phfwdLoadMapped odrzuca obcięty plik");
+        phfwdDelete(pf);
+        pf = phfwdLoad(path);
+        testExpect(pf == NULL, "phfwdLoad odrzuca obcięty plik");
+        phfwdDelete(pf);
+    }
+
+    for (i = 0; i < image.size; i++) {
+        image.data[i] ^= (char) (1 << (i % 8));
+        testExpect(testWriteImage(path, &image, image.size),
+                   "zapis uszkodzonego obrazu");
+        pf = phfwdLoadMapped(path);
+        testQueryCorrupted(pf);
+        phfwdDelete(pf);
+        pf = phfwdLoad(path);
+        testQueryCorrupted(pf);
+        phfwdDelete(pf);
+        image.data[i] ^= (char) (1 << (i % 8));
+    }
+    free(image.data);
+}
+
+/**
+ * @brief Uruchamia testy zapisu i wczytywania.
+ * @return 0 jeżeli wszystkie testy się powiodły, 1 w przeciwnym przypadku.
+ */
+int main(void) {
+    char path[256];
+    if (!testExpect(testTemporaryPath(path, sizeof(path), "save.pf"),
+                    "nazwa pliku tymczasowego")) {
+        return testResult();
+    }
+
+    struct PhoneForward *pf = phfwdNew();
+    testRoundTrip(pf, path, "pusta struktura");
+    phfwdAdd(pf, "1", "2");
+    testRoundTrip(pf, path, "jedno przekierowanie");
+    int round;
+    for (round = 0; round < 3; round++) {
+        testFillBase(pf, 3000);
+        testRoundTrip(pf, path, "losowe przekierowania");
+    }
+    phfwdRemove(pf, "1");
+    phfwdRemove(pf, "2");
+    testRoundTrip(pf, path, "po usunięciu poddrzew");
+    testExpect(phfwdCompile(pf), "phfwdCompile");
+    testRoundTrip(pf, path, "skompilowana struktura");
+    phfwdDelete(pf);
+
+    testExpect(phfwdLoad("/nonexistent/phone_forward.pf") == NULL
+               && phfwdLoadMapped(NULL) == NULL,
+               "brak pliku");
+    testCorrupted(path);
+    remove(path);
+    return testResult();
+}
@@ -0,0 +1,86 @@
+/** @file
+ * Implementacja funkcji pomocniczych testów modułów.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "test_utils.h"
+
+/**
+ * @brief Liczba niespełnionych warunków.
+ */
+static size_t testFailures = 0;
+
+/**
+ * @brief Stan generatora liczb pseudolosowych.
+ */
+static uint64_t testState = 88172645463325252ULL;
+
+bool testExpect(bool condition, const char *description) {
+    if (!condition) {
+        fprintf(stderr, "Błąd: %s\n", description);
+        testFailures++;
+    }
+    return condition;
+}
+
+int testResult(void) {
+    return testFailures == 0 ? 0 : 1;
+}
+
+void testSeed(uint64_t seed) {
+    testState = seed;
+}
+
+uint64_t testRandom(void) {
+    testState ^= testState << 13;
+    testState ^= testState >> 7;
+    testState ^= testState << 17;
+    return testState;
+}
+
+void testRandomNumber(char *buf, size_t minLength, size_t maxLength,
+                      const char *alphabet) {
+    size_t alphabetSize = 0, length, i;
+    while (alphabet[alphabetSize] != '\0') {
+        alphabetSize++;
+    }
+    length = minLength + testRandom() % (maxLength - minLength + 1);
+    for (i = 0; i < length; i++) {
+        buf[i] = alphabet[testRandom() % alphabetSize];
+    }
+    buf[length] = '\0';
+}
+
+bool testTemporaryPath(char *buf, size_t size, const char *name) {
+    const char *directory = getenv("TMPDIR");
+    if (directory == NULL || *directory == '\0') {
+        directory = "/tmp";
+    }
+    int length = snprintf(buf, size, "%s/phone_forward_%ld_%s", directory,
+                          (long) getpid(), name);
+    return length > 0 && (size_t) length < size;
+}
+
+bool testSameNumbers(const struct PhoneNumbers *a,
+                     const struct PhoneNumbers *b) {
+    size_t i;
+    if (a == NULL || b == NULL) {
+        return false;
+    }
+    for (i = 0; phnumGet(a, i) != NULL; i++) {
+        if (phnumGet(b, i) == NULL
+            || strcmp(phnumGet(a, i), phnumGet(b, i)) != 0) {
+            return false;
+        }
+    }
+    return phnumGet(b, i) == NULL;
+}
@@ -0,0 +1,76 @@
+/** @file
+ * Interfejs funkcji pomocniczych testów modułów.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#ifndef TELEFONY_TEST_UTILS_H
+#define TELEFONY_TEST_UTILS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "phone_forward.h"
+
+/**
+ * @brief Sprawdza warunek testu.
+ * Jeżeli warunek nie jest spełniony, wypisuje opis na wyjście diagnostyczne
+ * i zapamiętuje niepowodzenie.
+ * @param[in] condition - sprawdzany warunek.
+ * @param[in] description - opis sprawdzanej własności.
+ * @return Wartość @p condition.
+ */
+bool testExpect(bool condition, const char *description);
+
+/**
+ * @brief Podaje kod wyjścia programu testującego.
+ * @return 0 jeżeli wszystkie sprawdzone warunki były spełnione,
+ *         1 w przeciwnym przypadku.
+ */
+int testResult(void);
+
+/**
+ * @brief Ustawia ziarno generatora liczb pseudolosowych.
+ * @param[in] seed - niezerowe ziarno.
+ */
+void testSeed(uint64_t seed);
+
+/**
+ * @brief Losuje kolejną liczbę (xorshift64).
+ * @return Liczba pseudolosowa.
+ */
+uint64_t testRandom(void);
+
+/**
+ * @brief Losuje numer złożony ze znaków @p alphabet.
+ * @param[out] buf - bufor na co najmniej @p maxLength + 1 znaków.
+ * @param[in] minLength - najmniejsza długość numeru.
+ * @param[in] maxLength - największa długość numeru.
+ * @param[in] alphabet - niepusty napis ze znakami numeru.
+ */
+void testRandomNumber(char *buf, size_t minLength, size_t maxLength,
+                      const char *alphabet);
+
+/**
+ * @brief Tworzy nazwę nieistniejącego pliku tymczasowego.
+ * @param[out] buf - bufor na nazwę.
+ * @param[in] size - rozmiar bufora @p buf.
+ * @param[in] name - część nazwy opisująca zawartość.
+ * @return true w przypadku sukcesu, false gdy nazwa nie zmieściła się
+ *         w buforze.
+ */
+bool testTemporaryPath(char *buf, size_t size, const char *name);
+
+/**
+ * @brief Porównuje dwa ciągi numerów.
+ * @param[in] a - wskaźnik na pierwszy ciąg numerów.
+ * @param[in] b - wskaźnik na drugi ciąg numerów.
+ * @return true jeżeli oba wskaźniki są różne od NULL, a ciągi są równe,
+ *         false w przeciwnym przypadku.
+ */
+bool testSameNumbers(const struct PhoneNumbers *a,
+                     const struct PhoneNumbers *b);
+
+#endif //TELEFONY_TEST_UTILS_H
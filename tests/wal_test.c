@@ -0,0 +1,740 @@
+/** @file
+ * Testy odtwarzania baz z dziennika zapisu z wyprzedzeniem.
+ *
+ * @author Konrad Staniszewski
+ * @copyright Konrad Staniszewski
+ * @date 16.10.2026
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <dirent.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "phone_forward.h"
+#include "phone_bases_system.h"
+#include "wal.h"
+#include "test_utils.h"
+
+/**
+ * @brief Maksymalna długość ścieżki do pliku w teście.
+ */
+#define TEST_PATH_LENGTH 512
+
+/**
+ * @brief Maksymalna długość ścieżki do katalogu dziennika.
+ */
+#define TEST_DIRECTORY_LENGTH 256
+
+/**
+ * @brief Maksymalna długość napisu w operacji.
+ */
+#define TEST_OP_LENGTH 8
+
+/**
+ * @brief Rozmiar nagłówka zapisu w pliku dziennika (patrz wal.c).
+ */
+#define TEST_RECORD_HEADER_SIZE 9
+
+/**
+ * @brief Liczba zapytań, na podstawie których porównywane są bazy.
+ */
+#define TEST_QUERIES 300
+
+/**
+ * @brief Rodzaj operacji na bazach.
+ */
+enum TestOpType {
+    TEST_OP_NEW, /**< wybranie (utworzenie) bazy */
+    TEST_OP_DEL, /**< usunięcie bazy */
+    TEST_OP_ADD, /**< phfwdAdd na bieżącej bazie */
+    TEST_OP_REMOVE /**< phfwdRemove na bieżącej bazie */
+};
+
+/**
+ * @brief Operacja na bazach.
+ */
+struct TestOp {
+    /**
+     * @brief Rodzaj operacji.
+     */
+    enum TestOpType type;
+
+    /**
+     * @brief Identyfikator bazy lub pierwszy numer.
+     */
+    char first[TEST_OP_LENGTH + 1];
+
+    /**
+     * @brief Drugi numer (dla TEST_OP_ADD).
+     */
+    char second[TEST_OP_LENGTH + 1];
+};
+
+/**
+ * @brief Stan baz utworzonych bezpośrednio, bez dziennika.
+ */
+struct TestState {
+    /**
+     * @brief Bazy.
+     */
+    PhoneBases bases;
+
+    /**
+     * @brief Bieżąca baza, NULL jeżeli jej nie ma.
+     */
+    struct PhoneForward *current;
+};
+
+/**
+ * @brief Identyfikatory baz używane w testach.
+ */
+static const char *const testIds[] = {"a", "b", "c"};
+
+/**
+ * @brief Tworzy pusty stan baz.
+ * @param[out] state - wskaźnik na stan.
+ */
+static void testStateInit(struct TestState *state) {
+    state->bases = phoneBasesCreateNewPhoneBases();
+    state->current = NULL;
+}
+
+/**
+ * @brief Usuwa stan baz.
+ * @param[in, out] state - wskaźnik na stan.
+ */
+static void testStateDestroy(struct TestState *state) {
+    phoneBasesDestroyPhoneBases(state->bases);
+}
+
+/**
+ * @brief Losuje operację.
+ * @param[out] op - wskaźnik na operację.
+ */
+static void testRandomOp(struct TestOp *op) {
+    uint64_t kind = testRandom() % 100;
+    const char *id = testIds[testRandom() % 3];
+    op->second[0] = '\0';
+    if (kind < 5) {
+        op->type = TEST_OP_NEW;
+        strcpy(op->first, id);
+    } else if (kind < 7) {
+        op->type = TEST_OP_DEL;
+        strcpy(op->first, id);
+    } else if (kind < 20) {
+        op->type = TEST_OP_REMOVE;
+        testRandomNumber(op->first, 1, 2, "0123");
+    } else {
+        op->type = TEST_OP_ADD;
+        testRandomNumber(op->first, 1, 4, "0123");
+        testRandomNumber(op->second + 1, 0, 2, "01");
+        op->second[0] = '5';
+    }
+}
+
+/**
+ * @brief Wykonuje operację bezpośrednio na bazach.
+ * @param[in, out] state - wskaźnik na stan baz.
+ * @param[in] op - wskaźnik na operację.
+ * @return true jeżeli operacja jest poprawna (program zapisałby ją do
+ *         dziennika), false w przeciwnym przypadku.
+ */
+static bool testApply(struct TestState *state, const struct TestOp *op) {
+    struct PhoneForward *base;
+    switch (op->type) {
+        case TEST_OP_NEW:
+            state->current = phoneBasesAddBase(state->bases, op->first);
+            return state->current != NULL;
+        case TEST_OP_DEL:
+            base = phoneBasesGetBase(state->bases, op->first);
+            if (base == NULL) {
+                return false;
+            }
+            if (base == state->current) {
+                state->current = NULL;
+            }
+            return phoneBasesDelBase(state->bases, op->first);
+        case TEST_OP_ADD:
+            return state->current != NULL
+                   && phfwdAdd(state->current, op->first, op->second);
+        case TEST_OP_REMOVE:
+            if (state->current == NULL) {
+                return false;
+            }
+            phfwdRemove(state->current, op->first);
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Zapisuje operację do dziennika.
+ * @param[in, out] wal - wskaźnik na dziennik.
+ * @param[in] op - wskaźnik na operację.
+ * @return Wynik funkcji zapisującej operację.
+ */
+static bool testLog(Wal wal, const struct TestOp *op) {
+    switch (op->type) {
+        case TEST_OP_NEW:
+            return walLogNewBase(wal, op->first);
+        case TEST_OP_DEL:
+            return walLogDelBase(wal, op->first);
+        case TEST_OP_ADD:
+            return walLogAdd(wal, op->first, op->second);
+        case TEST_OP_REMOVE:
+            return walLogRemove(wal, op->first);
+    }
+    return false;
+}
+
+/**
+ * @brief Losuje ciąg poprawnych operacji, wykonując je na bazach
+ * @p state.
+ * @param[in, out] state - wskaźnik na stan baz.
+ * @param[out] ops - tablica na @p howMany operacji.
+ * @param[in] howMany - liczba operacji.
+ */
+static void testRandomOps(struct TestState *state, struct TestOp *ops,
+                          size_t howMany) {
+    size_t i = 0;
+    if (state->current == NULL && howMany > 0) {
+        ops[0].type = TEST_OP_NEW;
+        strcpy(ops[0].first, testIds[0]);
+        testApply(state, &ops[0]);
+        i++;
+    }
+    while (i < howMany) {
+        testRandomOp(&ops[i]);
+        if (testApply(state, &ops[i])) {
+            i++;
+        }
+    }
+}
+
+/**
+ * @brief Porównuje dwie bazy przekierowań na losowych numerach.
+ * @param[in] a - wskaźnik na pierwszą bazę.
+ * @param[in] b - wskaźnik na drugą bazę.
+ * @return true jeżeli bazy dają te same wyniki.
+ */
+static bool testSameBase(struct PhoneForward *a, struct PhoneForward *b) {
+    char num[TEST_OP_LENGTH + 1];
+    bool result = true;
+    int i;
+    for (i = 0; i < TEST_QUERIES && result; i++) {
+        const struct PhoneNumbers *x, *y;
+        if (i % 2 == 0) {
+            testRandomNumber(num, 1, 6, "0123");
+            x = phfwdGet(a, num);
+            y = phfwdGet(b, num);
+        } else {
+            testRandomNumber(num + 1, 0, 3, "01");
+            num[0] = '5';
+            x = phfwdReverse(a, num);
+            y = phfwdReverse(b, num);
+        }
+        result = testSameNumbers(x, y);
+        phnumDelete(x);
+        phnumDelete(y);
+    }
+    return result;
+}
+
+/**
+ * @brief Porównuje bazy odtworzone z dziennika z oczekiwanymi.
+ * @param[in] expected - wskaźnik na oczekiwany stan baz.
+ * @param[in] bases - wskaźnik na odtworzone bazy.
+ * @param[in] current - odtworzona bieżąca baza.
+ * @return true jeżeli bazy i bieżąca baza są takie same.
+ */
+static bool testSameState(const struct TestState *expected, PhoneBases bases,
+                          struct PhoneForward *current) {
+    if (phoneBasesHowManyBases(expected->bases)
+        != phoneBasesHowManyBases(bases)) {
+        return false;
+    }
+    size_t i;
+    for (i = 0; i < sizeof(testIds) / sizeof(testIds[0]); i++) {
+        struct PhoneForward *a = phoneBasesGetBase(expected->bases,
+                                                   testIds[i]);
+        struct PhoneForward *b = phoneBasesGetBase(bases, testIds[i]);
+        if ((a == NULL) != (b == NULL)
+            || (a == expected->current) != (b == current)
+            || (a != NULL && !testSameBase(a, b))) {
+            return false;
+        }
+    }
+    return (expected->current == NULL) == (current == NULL);
+}
+
+/**
+ * @brief Odtwarza bazy z dziennika w katalogu @p directory i porównuje je
+ * z oczekiwanymi.
+ * @param[in] directory - katalog dziennika.
+ * @param[in] expected - wskaźnik na oczekiwany stan baz.
+ * @param[in] description - opis sprawdzanej własności.
+ */
+static void testRecoverEquals(const char *directory,
+                              const struct TestState *expected,
+                              const char *description) {
+    Wal wal = walCreate(directory, 1, 0);
+    PhoneBases bases = phoneBasesCreateNewPhoneBases();
+    struct PhoneForward *current = NULL;
+    testExpect(wal != NULL && bases != NULL
+               && walRecover(wal, bases, &current)
+               && testSameState(expected, bases, current), description);
+    walClose(wal);
+    phoneBasesDestroyPhoneBases(bases);
+}
+
+/**
+ * @brief Otwiera dziennik i odtwarza z niego bazy.
+ * @param[in] directory - katalog dziennika.
+ * @param[in] syncEvery - liczba zapisów utrwalanych razem.
+ * @param[out] state - odtworzony stan baz (do usunięcia przez
+ *             testStateDestroy również w przypadku niepowodzenia).
+ * @return Wskaźnik na dziennik, NULL w przypadku niepowodzenia.
+ */
+static Wal testOpen(const char *directory, size_t syncEvery,
+                    struct TestState *state) {
+    Wal wal = walCreate(directory, syncEvery, 0);
+    testStateInit(state);
+    if (wal == NULL || state->bases == NULL
+        || !walRecover(wal, state->bases, &state->current)) {
+        walClose(wal);
+        return NULL;
+    }
+    return wal;
+}
+
+/**
+ * @brief Wykonuje ciąg operacji na bazach i zapisuje je do dziennika.
+ * @param[in, out] wal - wskaźnik na dziennik.
+ * @param[in, out] state - wskaźnik na stan baz, do których należy
+ *                 dziennik.
+ * @param[in] ops - tablica operacji.
+ * @param[in] howMany - liczba operacji.
+ * @return true jeżeli wszystkie operacje zostały zapisane.
+ */
+static bool testLogAll(Wal wal, struct TestState *state,
+                       const struct TestOp *ops, size_t howMany) {
+    size_t i;
+    for (i = 0; i < howMany; i++) {
+        if (!testApply(state, &ops[i]) || !testLog(wal, &ops[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Usuwa katalog razem z plikami.
+ * @param[in] directory - ścieżka do katalogu.
+ */
+static void testRemoveDirectory(const char *directory) {
+    char path[TEST_PATH_LENGTH];
+    DIR *dir = opendir(directory);
+    if (dir != NULL) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (strcmp(entry->d_name, ".") != 0
+                && strcmp(entry->d_name, "..") != 0) {
+                snprintf(path, sizeof(path), "%s/%s", directory,
+                         entry->d_name);
+                remove(path);
+            }
+        }
+        closedir(dir);
+    }
+    rmdir(directory);
+}
+
+/**
+ * @brief Kopiuje plik.
+ * @param[in] from - ścieżka do kopiowanego pliku.
+ * @param[in] to - ścieżka do kopii.
+ * @return true w przypadku sukcesu.
+ */
+static bool testCopyFile(const char *from, const char *to) {
+    FILE *in = fopen(from, "rb");
+    FILE *out = fopen(to, "wb");
+    bool result = in != NULL && out != NULL;
+    char chunk[4096];
+    size_t got;
+    while (result && (got = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        result = fwrite(chunk, 1, got, out) == got;
+    }
+    if (in != NULL) {
+        fclose(in);
+    }
+    if (out != NULL) {
+        result = fclose(out) == 0 && result;
+    }
+    return result;
+}
+
+/**
+ * @brief Kopiuje pliki z katalogu @p from, których nazwy zaczynają się od
+ * @p prefix, do katalogu @p to.
+ * @param[in] from - katalog źródłowy.
+ * @param[in] to - katalog docelowy.
+ * @param[in] prefix - początek nazw kopiowanych plików.
+ * @param[in] rename - nowa nazwa pliku (NULL oznacza tę samą nazwę).
+ * @return true w przypadku sukcesu.
+ */
+static bool testCopyFiles(const char *from, const char *to,
+                          const char *prefix, const char *rename) {
+    char source[TEST_PATH_LENGTH], target[TEST_PATH_LENGTH];
+    DIR *dir = opendir(from);
+    bool result = dir != NULL;
+    struct dirent *entry;
+    while (result && (entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") != 0
+            && strcmp(entry->d_name, "..") != 0
+            && strncmp(entry->d_name, prefix, strlen(prefix)) == 0) {
+            snprintf(source, sizeof(source), "%s/%s", from, entry->d_name);
+            snprintf(target, sizeof(target), "%s/%s", to,
+                     rename == NULL ? entry->d_name : rename);
+            result = testCopyFile(source, target);
+        }
+    }
+    if (dir != NULL) {
+        closedir(dir);
+    }
+    return result;
+}
+
+/**
+ * @brief Wczytuje cały plik.
+ * @param[in] path - ścieżka do pliku.
+ * @param[out] size - rozmiar pliku.
+ * @return Zawartość pliku (do zwolnienia przez free), NULL w przypadku
+ *         błędu.
+ */
+static char *testReadFile(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    char *data = NULL;
+    *size = 0;
+    if (file != NULL && fseek(file, 0, SEEK_END) == 0) {
+        long length = ftell(file);
+        if (length >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+            data = malloc((size_t) length + 1);
+            if (data != NULL
+                && fread(data, 1, (size_t) length, file) != (size_t) length) {
+                free(data);
+                data = NULL;
+            }
+            *size = (size_t) length;
+        }
+    }
+    if (file != NULL) {
+        fclose(file);
+    }
+    return data;
+}
+
+/**
+ * @brief Zapisuje cały plik.
+ * @param[in] path - ścieżka do pliku.
+ * @param[in] data - zawartość.
+ * @param[in] size - rozmiar zawartości.
+ * @return true w przypadku sukcesu.
+ */
+static bool testWriteFile(const char *path, const char *data, size_t size) {
+    FILE *file = fopen(path, "wb");
+    bool result = file != NULL && fwrite(data, 1, size, file) == size;
+    if (file != NULL) {
+        result = fclose(file) == 0 && result;
+    }
+    return result;
+}
+
+/**
+ * @brief Wyznacza pozycję zapisu o numerze @p index w pliku dziennika.
+ * @param[in] data - zawartość pliku dziennika.
+ * @param[in] size - rozmiar pliku.
+ * @param[in] index - numer zapisu.
+ * @return Pozycja początku zapisu (równa @p size, jeżeli zapisów jest
+ *         dokładnie @p index).
+ */
+static size_t testRecordOffset(const char *data, size_t size, size_t index) {
+    size_t pos = 0;
+    uint32_t length;
+    while (index > 0 && pos + TEST_RECORD_HEADER_SIZE <= size) {
+        memcpy(&length, data + pos, sizeof(length));
+        pos += TEST_RECORD_HEADER_SIZE + length;
+        index--;
+    }
+    return pos;
+}
+
+/**
+ * @brief Liczba operacji w jednym scenariuszu.
+ */
+#define TEST_OPS 400
+
+/**
+ * @brief Zapisane operacje są odtwarzane, również z punktem kontrolnym
+ * w trakcie.
+ * @param[in] directory - pusty katalog dziennika.
+ */
+static void testRoundTrip(const char *directory) {
+    struct TestState expected;
+    struct TestOp ops[TEST_OPS];
+    struct TestState logged;
+    testStateInit(&expected);
+    testRandomOps(&expected, ops, TEST_OPS);
+
+    Wal wal = testOpen(directory, 4, &logged);
+    bool written = wal != NULL
+                   && testLogAll(wal, &logged, ops, TEST_OPS / 2)
+                   && walCheckpoint(wal, logged.bases, logged.current)
+                   && testLogAll(wal, &logged, ops + TEST_OPS / 2,
+                                TEST_OPS - TEST_OPS / 2);
+    testExpect(walClose(wal) && written, "zapis operacji do dziennika");
+    testRecoverEquals(directory, &expected,
+                      "odtworzenie z punktu kontrolnego i dziennika");
+
+    testStateDestroy(&logged);
+    testStateDestroy(&expected);
+}
+
+/**
+ * @brief Przerwany zapis ostatniej operacji jest pomijany i usuwany,
+ * a kolejne zapisy są odtwarzane.
+ * @param[in] directory - pusty katalog dziennika.
+ */
+static void testTornTail(const char *directory) {
+    char path[TEST_PATH_LENGTH];
+    size_t size, cut;
+    struct TestOp ops[TEST_OPS];
+    snprintf(path, sizeof(path), "%s/wal.0", directory);
+
+    for (cut = 1; cut <= TEST_RECORD_HEADER_SIZE + 1; cut += 3) {
+        struct TestState expected, complete;
+        struct TestState logged;
+        testRemoveDirectory(directory);
+        testStateInit(&expected);
+        testStateInit(&complete);
+        testSeed(1000 + cut);
+        testRandomOps(&complete, ops, TEST_OPS);
+        size_t i;
+        for (i = 0; i + 1 < TEST_OPS; i++) {
+            testApply(&expected, &ops[i]);
+        }
+
+        Wal wal = testOpen(directory, 0, &logged);
+        testExpect(wal != NULL && testLogAll(wal, &logged, ops, TEST_OPS)
+                   && walClose(wal), "zapis operacji do dziennika");
+        testStateDestroy(&logged);
+
+        char *data = testReadFile(path, &size);
+        size_t lastRecord = testRecordOffset(data, size, TEST_OPS - 1);
+        testExpect(data != NULL && lastRecord + cut < size
+                   && truncate(path, (off_t) (size - cut)) == 0,
+                   "obcięcie pliku dziennika");
+        testRecoverEquals(directory, &expected,
+                          "odtworzenie z przerwanym ostatnim zapisem");
+
+        struct stat status;
+        testExpect(stat(path, &status) == 0
+                   && (size_t) status.st_size == lastRecord,
+                   "usunięcie przerwanego zapisu");
+
+        wal = testOpen(directory, 0, &logged);
+        testExpect(wal != NULL
+                   && testLogAll(wal, &logged, &ops[TEST_OPS - 1], 1)
+                   && walClose(wal), "zapis po odtworzeniu");
+        testStateDestroy(&logged);
+        testRecoverEquals(directory, &complete,
+                          "odtworzenie zapisów dopisanych po odtworzeniu");
+
+        free(data);
+        testStateDestroy(&expected);
+        testStateDestroy(&complete);
+    }
+}
+
+/**
+ * @brief Zapis z błędną sumą kontrolną w środku dziennika kończy
+ * odtwarzanie: wykonywane są jedynie zapisy przed nim.
+ * @param[in] directory - pusty katalog dziennika.
+ */
+static void testBadChecksum(const char *directory) {
+    char path[TEST_PATH_LENGTH];
+    size_t size, i;
+    struct TestOp ops[TEST_OPS];
+    struct TestState expected, complete;
+    struct TestState logged;
+    snprintf(path, sizeof(path), "%s/wal.0", directory);
+    testStateInit(&expected);
+    testStateInit(&complete);
+    testRandomOps(&complete, ops, TEST_OPS);
+    for (i = 0; i < TEST_OPS / 2; i++) {
+        testApply(&expected, &ops[i]);
+    }
+
+    Wal wal = testOpen(directory, 0, &logged);
+    testExpect(wal != NULL && testLogAll(wal, &logged, ops, TEST_OPS)
+               && walClose(wal), "zapis operacji do dziennika");
+    testStateDestroy(&logged);
+
+    char *data = testReadFile(path, &size);
+    size_t corrupted = testRecordOffset(data, size, TEST_OPS / 2);
+    if (testExpect(data != NULL && corrupted + TEST_RECORD_HEADER_SIZE < size,
+                   "odczyt pliku dziennika")) {
+        data[corrupted + TEST_RECORD_HEADER_SIZE] ^= 1;
+        testExpect(testWriteFile(path, data, size),
+                   "uszkodzenie zapisu w środku dziennika");
+    }
+    testRecoverEquals(directory, &expected,
+                      "odtworzenie do zapisu z błędną sumą kontrolną");
+
+    struct stat status;
+    testExpect(stat(path, &status) == 0
+               && (size_t) status.st_size == corrupted,
+               "usunięcie zapisów od uszkodzonego");
+
+    free(data);
+    testStateDestroy(&expected);
+    testStateDestroy(&complete);
+}
+
+/**
+ * @brief Przerwanie tworzenia punktu kontrolnego po zapisaniu
+ * checkpoint.tmp (przed zmianą nazwy) lub po zmianie nazwy (przed
+ * utworzeniem nowego pliku dziennika) nie zmienia odtwarzanego stanu.
+ * @param[in] directory - pusty katalog dziennika.
+ * @param[in] scratch - pusty katalog pomocniczy.
+ */
+static void testInterruptedCheckpoint(const char *directory,
+                                      const char *scratch) {
+    char path[TEST_PATH_LENGTH];
+    struct TestOp ops[TEST_OPS];
+    struct TestState expected;
+    struct TestState logged;
+    testStateInit(&expected);
+    testRandomOps(&expected, ops, TEST_OPS);
+
+    Wal wal = testOpen(directory, 0, &logged);
+    testExpect(wal != NULL && testLogAll(wal, &logged, ops, TEST_OPS / 2)
+               && walCheckpoint(wal, logged.bases, logged.current)
+               && testLogAll(wal, &logged, ops + TEST_OPS / 2,
+                             TEST_OPS - TEST_OPS / 2)
+               && walClose(wal), "zapis operacji do dziennika");
+    testStateDestroy(&logged);
+
+    testExpect(mkdir(scratch, 0777) == 0
+               && testCopyFiles(directory, scratch, "", NULL),
+               "kopia katalogu dziennika");
+    wal = testOpen(scratch, 0, &logged);
+    testExpect(wal != NULL && walCheckpoint(wal, logged.bases, logged.current)
+               && walClose(wal), "punkt kontrolny w kopii");
+    testStateDestroy(&logged);
+
+    testExpect(testCopyFiles(scratch, directory, "checkpoint",
+                             "checkpoint.tmp")
+               && testCopyFiles(scratch, directory, "base.2.", NULL),
+               "pliki przerwanego punktu kontrolnego");
+    testRecoverEquals(directory, &expected,
+                      "odtworzenie przy pozostawionym checkpoint.tmp");
+
+    wal = testOpen(directory, 0, &logged);
+    testExpect(wal != NULL && walCheckpoint(wal, logged.bases, logged.current)
+               && walClose(wal),
+               "punkt kontrolny po przerwanym punkcie kontrolnym");
+    testStateDestroy(&logged);
+    snprintf(path, sizeof(path), "%s/checkpoint.tmp", directory);
+    testExpect(access(path, F_OK) != 0, "usunięcie checkpoint.tmp");
+    testRecoverEquals(directory, &expected,
+                      "odtworzenie po ponownym punkcie kontrolnym");
+
+    snprintf(path, sizeof(path), "%s/wal.2", scratch);
+    testExpect(remove(path) == 0, "usunięcie nowego pliku dziennika");
+    testRecoverEquals(scratch, &expected,
+                      "odtworzenie po zmianie nazwy checkpoint.tmp");
+
+    testRemoveDirectory(scratch);
+    testStateDestroy(&expected);
+}
+
+/**
+ * @brief Zapisy, których nie udało się zapisać do pliku, pozostają
+ * w buforze i trafiają do dziennika przy kolejnej próbie, a częściowo
+ * zapisane dane nie uszkadzają dziennika.
+ * @param[in] directory - pusty katalog dziennika.
+ */
+static void testWriteFailure(const char *directory) {
+    char path[TEST_PATH_LENGTH];
+    struct TestOp ops[TEST_OPS];
+    struct TestState expected;
+    struct TestState logged;
+    struct rlimit limit, lowered;
+    struct stat status;
+    snprintf(path, sizeof(path), "%s/wal.0", directory);
+    testStateInit(&expected);
+    testRandomOps(&expected, ops, TEST_OPS);
+
+    Wal wal = testOpen(directory, 1, &logged);
+    testExpect(wal != NULL && testLogAll(wal, &logged, ops, TEST_OPS / 2),
+               "zapis operacji do dziennika");
+    if (wal != NULL && stat(path, &status) == 0
+        && getrlimit(RLIMIT_FSIZE, &limit) == 0) {
+        signal(SIGXFSZ, SIG_IGN);
+        lowered = limit;
+        lowered.rlim_cur = (rlim_t) status.st_size + 3;
+        testExpect(setrlimit(RLIMIT_FSIZE, &lowered) == 0,
+                   "ograniczenie rozmiaru pliku");
+        testExpect(!testLogAll(wal, &logged, &ops[TEST_OPS / 2], 1),
+                   "błąd zapisu przy ograniczonym rozmiarze pliku");
+        testExpect(!walCommit(wal), "ponowny błąd zapisu");
+        testExpect(stat(path, &status) == 0
+                   && (rlim_t) status.st_size + 3 == lowered.rlim_cur,
+                   "obcięcie częściowo zapisanych danych");
+        testExpect(setrlimit(RLIMIT_FSIZE, &limit) == 0,
+                   "przywrócenie rozmiaru pliku");
+        testExpect(walCommit(wal), "zapis bufora po usunięciu przyczyny");
+    }
+    testExpect(wal != NULL && testLogAll(wal, &logged, ops + TEST_OPS / 2 + 1,
+                                         TEST_OPS - TEST_OPS / 2 - 1)
+               && walClose(wal), "zapis kolejnych operacji");
+    testStateDestroy(&logged);
+    testRecoverEquals(directory, &expected,
+                      "odtworzenie zapisu, którego zapis się nie powiódł");
+    testStateDestroy(&expected);
+}
+
+/**
+ * @brief Uruchamia testy dziennika.
+ * @return 0 jeżeli wszystkie testy się powiodły, 1 w przeciwnym przypadku.
+ */
+int main(void) {
+    char directory[TEST_DIRECTORY_LENGTH], scratch[TEST_DIRECTORY_LENGTH];
+    if (!testExpect(testTemporaryPath(directory, sizeof(directory), "wal")
+                    && testTemporaryPath(scratch, sizeof(scratch),
+                                         "wal_copy"),
+                    "nazwa katalogu tymczasowego")) {
+        return testResult();
+    }
+
+    testRemoveDirectory(directory);
+    testRemoveDirectory(scratch);
+    testRoundTrip(directory);
+    testRemoveDirectory(directory);
+    testTornTail(directory);
+    testRemoveDirectory(directory);
+    testBadChecksum(directory);
+    testRemoveDirectory(directory);
+    testInterruptedCheckpoint(directory, scratch);
+    testRemoveDirectory(directory);
+    testWriteFailure(directory);
+    testRemoveDirectory(directory);
+    return testResult();
+}